@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "bench_run.hpp"
+#include "os.hpp"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+double bench_now_seconds(void) {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>(now).count();
+}
+
+double bench_run_output(const char *exe, ZigList<const char *> &args, Buf *out_stdout) {
+    Termination term;
+    Buf out_stderr = BUF_INIT;
+    buf_resize(out_stdout, 0);
+    double start = bench_now_seconds();
+    int err = os_exec_process(exe, args, &term, &out_stderr, out_stdout);
+    double elapsed = bench_now_seconds() - start;
+    if (err || term.how != TerminationIdClean || term.code != 0) {
+        fprintf(stderr, "%s", exe);
+        for (size_t i = 0; i < args.length; i += 1) {
+            fprintf(stderr, " %s", args.at(i));
+        }
+        fprintf(stderr, "\nfailed:\n%s%s", buf_ptr(out_stdout), buf_ptr(&out_stderr));
+        exit(1);
+    }
+    buf_deinit(&out_stderr);
+    return elapsed;
+}
+
+double bench_run(const char *exe, ZigList<const char *> &args) {
+    Buf out_stdout = BUF_INIT;
+    double elapsed = bench_run_output(exe, args, &out_stdout);
+    buf_deinit(&out_stdout);
+    return elapsed;
+}
+
+double bench_best_run(const char *exe, ZigList<const char *> &args, int rounds) {
+    double best = 0.0;
+    for (int round = 0; round < rounds; round += 1) {
+        double elapsed = bench_run(exe, args);
+        if (round == 0 || elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
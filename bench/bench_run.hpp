@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef ZIG_BENCH_RUN_HPP
+#define ZIG_BENCH_RUN_HPP
+
+// Runs processes for the benchmarks which time the zig binary from the outside.
+
+#include "buffer.hpp"
+#include "list.hpp"
+
+double bench_now_seconds(void);
+
+// Runs exe with args and returns the seconds it took. If it cannot be started or
+// exits with an error, prints its output and exits.
+double bench_run(const char *exe, ZigList<const char *> &args);
+
+// Like bench_run, and replaces the contents of out_stdout with what exe printed to
+// stdout.
+double bench_run_output(const char *exe, ZigList<const char *> &args, Buf *out_stdout);
+
+// The shortest time of rounds runs of exe with args.
+double bench_best_run(const char *exe, ZigList<const char *> &args, int rounds);
+
+#endif
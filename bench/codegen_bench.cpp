@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+// Times the Code Generation phase of zig build-obj --enable-timing-info on a
+// generated file of exported functions whose bodies are blocks nested depth deep,
+// 2000 functions of depth 32 by default. Every level does arithmetic with
+// overflow checks, so rendering each instruction asks its scope for the safety
+// and float mode settings.
+//
+//     codegen_bench <zig exe> <work dir> [function count] [depth]
+
+#include "bench_run.hpp"
+#include "os.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int rounds = 5;
+
+static void append_indent(Buf *out, size_t level) {
+    for (size_t i = 0; i < level; i += 1) {
+        buf_append_str(out, "    ");
+    }
+}
+
+static void generate_source(size_t fn_count, size_t depth, Buf *out) {
+    buf_resize(out, 0);
+    for (size_t fn_i = 0; fn_i < fn_count; fn_i += 1) {
+        buf_appendf(out, "export fn nested%" ZIG_PRI_usize "(a: i32, b: i32) -> i32 {\n", fn_i);
+        buf_append_str(out, "    var x = a;\n");
+        for (size_t level = 1; level <= depth; level += 1) {
+            append_indent(out, level);
+            buf_append_str(out, "{\n");
+            append_indent(out, level + 1);
+            buf_append_str(out, "x = x * 3 + b;\n");
+        }
+        for (size_t level = depth; level >= 1; level -= 1) {
+            append_indent(out, level);
+            buf_append_str(out, "}\n");
+        }
+        buf_append_str(out, "    return x;\n}\n\n");
+    }
+}
+
+// The duration column of the Code Generation row of the timing report.
+static bool parse_codegen_seconds(Buf *report, double *out_seconds) {
+    const char *row = strstr(buf_ptr(report), "Code Generation");
+    if (row == nullptr)
+        return false;
+    double start, end, duration;
+    if (sscanf(row + strlen("Code Generation"), "%lf %lf %lf", &start, &end, &duration) != 3)
+        return false;
+    *out_seconds = duration;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <zig exe> <work dir> [function count] [depth]\n", argv[0]);
+        return 1;
+    }
+    const char *zig_exe = argv[1];
+    Buf *work_dir = buf_create_from_str(argv[2]);
+    size_t fn_count = (argc >= 4) ? strtoul(argv[3], nullptr, 10) : 2000;
+    size_t depth = (argc >= 5) ? strtoul(argv[4], nullptr, 10) : 32;
+    if (fn_count == 0 || depth == 0) {
+        fprintf(stderr, "the function count and the depth have to be positive\n");
+        return 1;
+    }
+
+    if (os_make_path(work_dir)) {
+        fprintf(stderr, "unable to create %s\n", buf_ptr(work_dir));
+        return 1;
+    }
+    Buf *source_path = buf_alloc();
+    Buf *obj_path = buf_alloc();
+    Buf *cache_dir = buf_alloc();
+    os_path_join(work_dir, buf_create_from_str("codegen_bench.zig"), source_path);
+    os_path_join(work_dir, buf_create_from_str("codegen_bench.o"), obj_path);
+    os_path_join(work_dir, buf_create_from_str("zig-cache"), cache_dir);
+
+    Buf source = BUF_INIT;
+    generate_source(fn_count, depth, &source);
+    os_write_file(source_path, &source);
+
+    ZigList<const char *> args = {0};
+    args.append("build-obj");
+    args.append(buf_ptr(source_path));
+    args.append("--output");
+    args.append(buf_ptr(obj_path));
+    args.append("--cache-dir");
+    args.append(buf_ptr(cache_dir));
+    args.append("--enable-timing-info");
+
+    double best_total = 0.0;
+    double best_codegen = 0.0;
+    Buf report = BUF_INIT;
+    for (int round = 0; round < rounds; round += 1) {
+        double total = bench_run_output(zig_exe, args, &report);
+        double codegen;
+        if (!parse_codegen_seconds(&report, &codegen)) {
+            fprintf(stderr, "no Code Generation row in the timing report:\n%s", buf_ptr(&report));
+            return 1;
+        }
+        if (round == 0 || total < best_total)
+            best_total = total;
+        if (round == 0 || codegen < best_codegen)
+            best_codegen = codegen;
+    }
+
+    printf("%" ZIG_PRI_usize " functions of depth %" ZIG_PRI_usize ", %" ZIG_PRI_usize " bytes, best of %d builds\n",
+            fn_count, depth, buf_len(&source), rounds);
+    printf("%-16s %8.3f s\n", "build-obj", best_total);
+    printf("%-16s %8.3f s %8.3f us/function\n", "Code Generation", best_codegen,
+            best_codegen * 1000000.0 / fn_count);
+    return 0;
+}
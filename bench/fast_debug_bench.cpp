@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+// Times zig build-obj in Debug and with --fast-debug on a generated file of about
+// the given number of thousand lines, 20 by default, and reports the time per
+// thousand lines. The file is a series of structs, each with a method and an
+// exported function which loops over an array, so that every line is analyzed
+// and generated.
+//
+//     fast_debug_bench <zig exe> <work dir> [kloc]
+
+#include "bench_run.hpp"
+#include "os.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static const int rounds = 5;
+
+static size_t generate_source(size_t kloc, Buf *out) {
+    buf_resize(out, 0);
+    size_t line_count = 0;
+    for (size_t i = 0; line_count < kloc * 1000; i += 1) {
+        buf_appendf(out,
+            "const Point%" ZIG_PRI_usize " = struct {\n"
+            "    x: i32,\n"
+            "    y: i32,\n"
+            "\n"
+            "    fn scaled(self: &const Point%" ZIG_PRI_usize ", factor: i32) -> Point%" ZIG_PRI_usize " {\n"
+            "        return Point%" ZIG_PRI_usize " { .x = self.x *%% factor, .y = self.y *%% factor };\n"
+            "    }\n"
+            "};\n"
+            "\n"
+            "export fn work%" ZIG_PRI_usize "(values: &const [16]i32, count: usize) -> i32 {\n"
+            "    var total: i32 = 0;\n"
+            "    var i: usize = 0;\n"
+            "    while (i < count and i < 16) : (i += 1) {\n"
+            "        const p = Point%" ZIG_PRI_usize " { .x = (*values)[i], .y = (*values)[15 - i] };\n"
+            "        const q = p.scaled(3);\n"
+            "        if (q.x > q.y) {\n"
+            "            total +%%= q.x;\n"
+            "        } else {\n"
+            "            total -%%= q.y;\n"
+            "        }\n"
+            "    }\n"
+            "    return total;\n"
+            "}\n"
+            "\n",
+            i, i, i, i, i, i);
+        line_count += 24;
+    }
+    return line_count;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <zig exe> <work dir> [kloc]\n", argv[0]);
+        return 1;
+    }
+    const char *zig_exe = argv[1];
+    Buf *work_dir = buf_create_from_str(argv[2]);
+    size_t kloc = (argc >= 4) ? strtoul(argv[3], nullptr, 10) : 20;
+    if (kloc == 0) {
+        fprintf(stderr, "invalid number of thousand lines: %s\n", argv[3]);
+        return 1;
+    }
+
+    if (os_make_path(work_dir)) {
+        fprintf(stderr, "unable to create %s\n", buf_ptr(work_dir));
+        return 1;
+    }
+    Buf *source_path = buf_alloc();
+    Buf *obj_path = buf_alloc();
+    Buf *cache_dir = buf_alloc();
+    os_path_join(work_dir, buf_create_from_str("fast_debug_bench.zig"), source_path);
+    os_path_join(work_dir, buf_create_from_str("fast_debug_bench.o"), obj_path);
+    os_path_join(work_dir, buf_create_from_str("zig-cache"), cache_dir);
+
+    Buf source = BUF_INIT;
+    size_t line_count = generate_source(kloc, &source);
+    os_write_file(source_path, &source);
+
+    double times[2];
+    const char *mode_names[2] = {"Debug", "--fast-debug"};
+    for (size_t mode = 0; mode < 2; mode += 1) {
+        ZigList<const char *> args = {0};
+        args.append("build-obj");
+        args.append(buf_ptr(source_path));
+        args.append("--output");
+        args.append(buf_ptr(obj_path));
+        args.append("--cache-dir");
+        args.append(buf_ptr(cache_dir));
+        if (mode == 1)
+            args.append("--fast-debug");
+        times[mode] = bench_best_run(zig_exe, args, rounds);
+        args.deinit();
+    }
+
+    double kloc_count = line_count / 1000.0;
+    printf("%" ZIG_PRI_usize " lines, best of %d builds\n", line_count, rounds);
+    for (size_t mode = 0; mode < 2; mode += 1) {
+        printf("%-16s %8.3f s %8.3f s/KLOC %6.2fx\n", mode_names[mode], times[mode],
+                times[mode] / kloc_count, times[0] / times[mode]);
+    }
+    return 0;
+}
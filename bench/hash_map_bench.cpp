@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+// Compares HashMap with the map it replaced on workloads shaped like the three
+// busiest tables of the compiler. The keys and hash functions copy those of
+// import_table (file paths hashed with buf_hash), type_table (TypeId of pointer
+// types, hashed like type_id_hash) and fn_type_table (FnTypeId, hashed like
+// fn_type_id_hash). Each workload fills a map and then looks up every key many
+// times, the way analysis does, with a share of misses.
+
+#include "buffer.hpp"
+#include "hash_map.hpp"
+#include "old_hash_map.hpp"
+#include "os.hpp"
+
+#include <chrono>
+#include <stdio.h>
+
+static double now_seconds(void) {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>(now).count();
+}
+
+static uint32_t hash_ptr(void *ptr) {
+    return (uint32_t)(((uintptr_t)ptr) % UINT32_MAX);
+}
+
+struct PtrTypeKey {
+    void *child_type;
+    bool is_const;
+    bool is_volatile;
+    uint32_t alignment;
+    uint32_t bit_offset;
+    uint32_t unaligned_bit_count;
+};
+
+static uint32_t ptr_type_key_hash(PtrTypeKey x) {
+    return hash_ptr(x.child_type) +
+        (x.is_const ? (uint32_t)2749109194 : (uint32_t)4047371087) +
+        (x.is_volatile ? (uint32_t)536730450 : (uint32_t)1685612214) +
+        (((uint32_t)x.alignment) ^ (uint32_t)0x777fbe0e) +
+        (((uint32_t)x.bit_offset) ^ (uint32_t)2639019452) +
+        (((uint32_t)x.unaligned_bit_count) ^ (uint32_t)529908881);
+}
+
+static bool ptr_type_key_eql(PtrTypeKey a, PtrTypeKey b) {
+    return a.child_type == b.child_type && a.is_const == b.is_const && a.is_volatile == b.is_volatile &&
+        a.alignment == b.alignment && a.bit_offset == b.bit_offset &&
+        a.unaligned_bit_count == b.unaligned_bit_count;
+}
+
+struct FnTypeKey {
+    void *return_type;
+    uint32_t alignment;
+    size_t param_count;
+    void **param_types;
+};
+
+static uint32_t fn_type_key_hash(FnTypeKey *id) {
+    uint32_t result = 0;
+    result += hash_ptr(id->return_type);
+    result += id->alignment * 0xd3b3f3e2;
+    for (size_t i = 0; i < id->param_count; i += 1) {
+        result = result * 31 + hash_ptr(id->param_types[i]);
+    }
+    return result;
+}
+
+static bool fn_type_key_eql(FnTypeKey *a, FnTypeKey *b) {
+    if (a->return_type != b->return_type || a->alignment != b->alignment || a->param_count != b->param_count)
+        return false;
+    for (size_t i = 0; i < a->param_count; i += 1) {
+        if (a->param_types[i] != b->param_types[i])
+            return false;
+    }
+    return true;
+}
+
+// how many times each key is looked up after the map is filled
+static const size_t lookups_per_key = 20;
+static const int rounds = 5;
+
+// Fills a map with keys, then looks up lookup_keys lookups_per_key times. Returns the
+// best time of a few rounds, and the number of hits so that nothing is optimized out.
+template<typename Map, typename K>
+static double run_workload(ZigList<K> *keys, ZigList<K> *lookup_keys, size_t *out_hits) {
+    double best = 0.0;
+    for (int round = 0; round < rounds; round += 1) {
+        double start = now_seconds();
+        Map map = {};
+        map.init(16);
+        for (size_t i = 0; i < keys->length; i += 1) {
+            map.put(keys->at(i), i);
+        }
+        size_t hits = 0;
+        for (size_t n = 0; n < lookups_per_key; n += 1) {
+            for (size_t i = 0; i < lookup_keys->length; i += 1) {
+                if (map.maybe_get(lookup_keys->at(i)) != nullptr)
+                    hits += 1;
+            }
+        }
+        map.deinit();
+        double elapsed = now_seconds() - start;
+        if (round == 0 || elapsed < best)
+            best = elapsed;
+        *out_hits = hits;
+    }
+    return best;
+}
+
+template<typename NewMap, typename OldMap, typename K>
+static void compare(const char *name, ZigList<K> *keys, ZigList<K> *lookup_keys) {
+    size_t new_hits;
+    size_t old_hits;
+    double new_time = run_workload<NewMap>(keys, lookup_keys, &new_hits);
+    double old_time = run_workload<OldMap>(keys, lookup_keys, &old_hits);
+    if (new_hits != old_hits) {
+        fprintf(stderr, "%s: the maps disagree: %" ZIG_PRI_usize " hits and %" ZIG_PRI_usize " hits\n",
+                name, new_hits, old_hits);
+        exit(1);
+    }
+    printf("%-14s %8" ZIG_PRI_usize " keys %12.3f ms %12.3f ms %8.2fx\n", name, keys->length,
+            old_time * 1000.0, new_time * 1000.0, old_time / new_time);
+}
+
+static void bench_import_table(size_t count) {
+    static const char *dirs[] = {"/usr/lib/zig/std/", "/usr/lib/zig/std/os/", "/home/user/project/src/"};
+    ZigList<Buf *> keys = {0};
+    ZigList<Buf *> lookup_keys = {0};
+    for (size_t i = 0; i < count; i += 1) {
+        keys.append(buf_sprintf("%sfile_%" ZIG_PRI_usize ".zig", dirs[i % 3], i));
+    }
+    // @import looks paths up in fresh buffers, and misses on every new file
+    for (size_t i = 0; i < count; i += 1) {
+        lookup_keys.append(buf_create_from_buf(keys.at(i)));
+        if (i % 4 == 0)
+            lookup_keys.append(buf_sprintf("%smissing_%" ZIG_PRI_usize ".zig", dirs[i % 3], i));
+    }
+    compare<HashMap<Buf *, size_t, buf_hash, buf_eql_buf>,
+        OldHashMap<Buf *, size_t, buf_hash, buf_eql_buf>>("import_table", &keys, &lookup_keys);
+}
+
+static void bench_type_table(size_t count) {
+    // pointer types to a few thousand child types, in all const/volatile/alignment variations
+    size_t child_count = count / 8 + 1;
+    char *children = allocate<char>(child_count * 64);
+    ZigList<PtrTypeKey> keys = {0};
+    for (size_t i = 0; keys.length < count; i += 1) {
+        PtrTypeKey key = {};
+        key.child_type = children + (i % child_count) * 64;
+        key.is_const = (i / child_count) & 1;
+        key.is_volatile = (i / child_count) & 2;
+        key.alignment = 1 << ((i / child_count) & 4 ? 3 : 0);
+        keys.append(key);
+    }
+    ZigList<PtrTypeKey> lookup_keys = {0};
+    for (size_t i = 0; i < count; i += 1) {
+        lookup_keys.append(keys.at(i));
+        if (i % 4 == 0) {
+            PtrTypeKey missing = keys.at(i);
+            missing.bit_offset = 3;
+            lookup_keys.append(missing);
+        }
+    }
+    compare<HashMap<PtrTypeKey, size_t, ptr_type_key_hash, ptr_type_key_eql>,
+        OldHashMap<PtrTypeKey, size_t, ptr_type_key_hash, ptr_type_key_eql>>("type_table", &keys, &lookup_keys);
+}
+
+static void bench_fn_type_table(size_t count) {
+    size_t type_count = 64;
+    char *types = allocate<char>(type_count * 64);
+    ZigList<FnTypeKey *> keys = {0};
+    ZigList<FnTypeKey *> lookup_keys = {0};
+    for (size_t i = 0; i < count; i += 1) {
+        FnTypeKey *key = allocate<FnTypeKey>(1);
+        key->return_type = types + (i % type_count) * 64;
+        key->alignment = 0;
+        key->param_count = 1 + i % 5;
+        key->param_types = allocate<void *>(key->param_count);
+        size_t x = i;
+        for (size_t param_i = 0; param_i < key->param_count; param_i += 1) {
+            key->param_types[param_i] = types + (x % type_count) * 64;
+            x = x / type_count + param_i * 7;
+        }
+        keys.append(key);
+    }
+    // fn types are looked up by a FnTypeId built on the stack of the caller
+    for (size_t i = 0; i < count; i += 1) {
+        FnTypeKey *copy = allocate<FnTypeKey>(1);
+        *copy = *keys.at(i);
+        lookup_keys.append(copy);
+        if (i % 4 == 0) {
+            FnTypeKey *missing = allocate<FnTypeKey>(1);
+            *missing = *keys.at(i);
+            missing->alignment = 16;
+            lookup_keys.append(missing);
+        }
+    }
+    compare<HashMap<FnTypeKey *, size_t, fn_type_key_hash, fn_type_key_eql>,
+        OldHashMap<FnTypeKey *, size_t, fn_type_key_hash, fn_type_key_eql>>("fn_type_table", &keys, &lookup_keys);
+}
+
+int main(int argc, char **argv) {
+    printf("%-14s %13s %15s %15s %9s\n", "workload", "", "old map", "new map", "speedup");
+    size_t sizes[] = {500, 5000, 50000};
+    for (size_t i = 0; i < array_length(sizes); i += 1) {
+        bench_import_table(sizes[i]);
+        bench_type_table(sizes[i]);
+        bench_fn_type_table(sizes[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+// Builds the behavior tests in ReleaseSafe and in ReleaseFast and compares the
+// build time, the size of the test binary and the time it takes to run, which
+// shows what the safety checks cost. The test binaries are copied to the work
+// dir; zig test itself also writes ./test.
+//
+//     release_bench <zig exe> <work dir> [behavior.zig]
+
+#include "bench_run.hpp"
+#include "os.hpp"
+
+#include <stdio.h>
+
+static const int build_rounds = 3;
+static const int run_rounds = 20;
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <zig exe> <work dir> [behavior.zig]\n", argv[0]);
+        return 1;
+    }
+    const char *zig_exe = argv[1];
+    Buf *work_dir = buf_create_from_str(argv[2]);
+    const char *behavior_path = (argc >= 4) ? argv[3] : "test/behavior.zig";
+    if (os_make_path(work_dir)) {
+        fprintf(stderr, "unable to create %s\n", buf_ptr(work_dir));
+        return 1;
+    }
+
+    const char *mode_flags[2] = {"--release-safe", "--release-fast"};
+    const char *bin_names[2] = {"behavior-release-safe", "behavior-release-fast"};
+    Buf bin_paths[2] = {BUF_INIT, BUF_INIT};
+    double build_times[2];
+    double run_times[2];
+    uint64_t sizes[2];
+    for (size_t mode = 0; mode < 2; mode += 1) {
+        // the test command copies the binary, so that it can be run without zig test
+        os_path_join(work_dir, buf_create_from_str(bin_names[mode]), &bin_paths[mode]);
+        ZigList<const char *> args = {0};
+        args.append("test");
+        args.append(behavior_path);
+        args.append(mode_flags[mode]);
+        args.append("--test-cmd");
+        args.append("cp");
+        args.append("--test-cmd-bin");
+        args.append("--test-cmd");
+        args.append(buf_ptr(&bin_paths[mode]));
+        build_times[mode] = bench_best_run(zig_exe, args, build_rounds);
+        args.deinit();
+
+        OsTimeStamp mtime;
+        if (os_file_stat(&bin_paths[mode], &mtime, &sizes[mode])) {
+            fprintf(stderr, "unable to find the test binary %s\n", buf_ptr(&bin_paths[mode]));
+            return 1;
+        }
+        ZigList<const char *> no_args = {0};
+        run_times[mode] = bench_best_run(buf_ptr(&bin_paths[mode]), no_args, run_rounds);
+    }
+
+    printf("build: best of %d, run: best of %d\n", build_rounds, run_rounds);
+    printf("%-16s %10s %12s %10s\n", "", "build", "binary", "run");
+    for (size_t mode = 0; mode < 2; mode += 1) {
+        printf("%-16s %8.3f s %10" PRIu64 " B %8.3f ms\n", mode_flags[mode], build_times[mode], sizes[mode],
+                run_times[mode] * 1000.0);
+    }
+    printf("ReleaseSafe / ReleaseFast: build %.2fx, binary %.2fx, run %.2fx\n",
+            build_times[0] / build_times[1], (double)sizes[0] / (double)sizes[1], run_times[0] / run_times[1]);
+    return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+// Compares the tokenizer with the one it replaced by tokenizing every .zig file
+// below a directory, std/ by default. The old tokenizer computes the value of
+// every literal and the line and column of every token as it goes, while the new
+// one leaves that to the parser, so the new tokenizer is also timed together with
+// decoding every literal value, which is the work the parser adds back. The goal
+// of at least 3x on std/ is for lexing alone, the ratio of the "new tokenizer"
+// line. The "new tokenizer + values" line is what the parser gains.
+
+#include "old_tokenizer.hpp"
+#include "os.hpp"
+#include "tokenizer.hpp"
+
+#include <chrono>
+#include <stdio.h>
+
+static double now_seconds(void) {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>(now).count();
+}
+
+static void collect_sources(Buf *dir_path, ZigList<Buf *> *sources, size_t *total_bytes) {
+    ZigList<OsDirEntry> entries = {0};
+    if (os_list_dir(dir_path, &entries))
+        return;
+    for (size_t i = 0; i < entries.length; i += 1) {
+        OsDirEntry *entry = &entries.at(i);
+        Buf *full_path = buf_alloc();
+        os_path_join(dir_path, entry->name, full_path);
+        if (entry->is_dir) {
+            collect_sources(full_path, sources, total_bytes);
+        } else if (buf_ends_with_str(entry->name, ".zig")) {
+            Buf *contents = buf_alloc();
+            if (os_fetch_file_path(full_path, contents))
+                continue;
+            sources->append(contents);
+            *total_bytes += buf_len(contents);
+        }
+    }
+    entries.deinit();
+}
+
+static size_t run_old(ZigList<Buf *> *sources) {
+    size_t token_count = 0;
+    for (size_t i = 0; i < sources->length; i += 1) {
+        old_tokenizer::Tokenization tokenization = {0};
+        old_tokenizer::tokenize(sources->at(i), &tokenization);
+        token_count += tokenization.tokens->length;
+        for (size_t token_i = 0; token_i < tokenization.tokens->length; token_i += 1) {
+            old_tokenizer::Token *token = &tokenization.tokens->at(token_i);
+            if (token->id == old_tokenizer::TokenIdStringLiteral || token->id == old_tokenizer::TokenIdSymbol)
+                buf_deinit(&token->data.str_lit.str);
+        }
+        tokenization.tokens->deinit();
+        tokenization.line_offsets->deinit();
+    }
+    return token_count;
+}
+
+static size_t run_new(ZigList<Buf *> *sources, bool decode) {
+    size_t token_count = 0;
+    Buf *str = buf_alloc();
+    for (size_t i = 0; i < sources->length; i += 1) {
+        Buf *source = sources->at(i);
+        Tokenization tokenization = {0};
+        tokenize(source, &tokenization);
+        token_count += tokenization.tokens->length;
+        // the tokens of a file with an error can be unfinished
+        bool decode_values = decode && tokenization.err == nullptr;
+        for (size_t token_i = 0; decode_values && token_i < tokenization.tokens->length; token_i += 1) {
+            Token *token = &tokenization.tokens->at(token_i);
+            size_t line, column;
+            token_line_column(tokenization.line_offsets, token->start_pos, &line, &column);
+            bool is_c_str;
+            switch (token->id) {
+                case TokenIdIntLiteral:
+                    {
+                        BigInt bigint;
+                        token_int_lit(source, token, &bigint);
+                        break;
+                    }
+                case TokenIdFloatLiteral:
+                    {
+                        BigFloat bigfloat;
+                        token_float_lit(source, token, &bigfloat);
+                        break;
+                    }
+                case TokenIdStringLiteral:
+                case TokenIdSymbol:
+                    token_str_lit(source, token, str, &is_c_str);
+                    break;
+                case TokenIdCharLiteral:
+                    token_char_lit(source, token);
+                    break;
+                default:
+                    break;
+            }
+        }
+        tokenization.tokens->deinit();
+        tokenization.line_offsets->deinit();
+    }
+    return token_count;
+}
+
+static const int rounds = 10;
+
+template<typename F>
+static double best_time(F run, size_t *out_token_count) {
+    double best = 0.0;
+    for (int round = 0; round < rounds; round += 1) {
+        double start = now_seconds();
+        *out_token_count = run();
+        double elapsed = now_seconds() - start;
+        if (round == 0 || elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    Buf *dir_path = buf_create_from_str((argc >= 2) ? argv[1] : "std");
+    ZigList<Buf *> sources = {0};
+    size_t total_bytes = 0;
+    collect_sources(dir_path, &sources, &total_bytes);
+    if (sources.length == 0) {
+        fprintf(stderr, "no .zig files found in %s\n", buf_ptr(dir_path));
+        return 1;
+    }
+
+    size_t old_tokens;
+    size_t new_tokens;
+    size_t decoded_tokens;
+    double old_time = best_time([&]() { return run_old(&sources); }, &old_tokens);
+    double new_time = best_time([&]() { return run_new(&sources, false); }, &new_tokens);
+    double decoded_time = best_time([&]() { return run_new(&sources, true); }, &decoded_tokens);
+    if (old_tokens != new_tokens) {
+        fprintf(stderr, "the tokenizers disagree: %" ZIG_PRI_usize " tokens and %" ZIG_PRI_usize " tokens\n",
+                old_tokens, new_tokens);
+        return 1;
+    }
+
+    double mb = total_bytes / (1024.0 * 1024.0);
+    printf("%" ZIG_PRI_usize " files, %" ZIG_PRI_usize " bytes, %" ZIG_PRI_usize " tokens\n",
+            sources.length, total_bytes, new_tokens);
+    printf("%-24s %10.3f ms %8.1f MB/s\n", "old tokenizer", old_time * 1000.0, mb / old_time);
+    printf("%-24s %10.3f ms %8.1f MB/s %6.2fx\n", "new tokenizer", new_time * 1000.0, mb / new_time,
+            old_time / new_time);
+    printf("%-24s %10.3f ms %8.1f MB/s %6.2fx\n", "new tokenizer + values", decoded_time * 1000.0,
+            mb / decoded_time, old_time / decoded_time);
+    return 0;
+}
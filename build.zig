@@ -1,5 +1,6 @@
 const Builder = @import("std").build.Builder;
 const tests = @import("test/tests.zig");
+const builtin = @import("builtin");
 
 pub fn build(b: &Builder) {
     const test_filter = b.option([]const u8, "test-filter", "Skip tests that do not match filter");
@@ -24,4 +25,15 @@ pub fn build(b: &Builder) {
     test_step.dependOn(tests.addAssembleAndLinkTests(b, test_filter));
     test_step.dependOn(tests.addDebugSafetyTests(b, test_filter));
     test_step.dependOn(tests.addParseCTests(b, test_filter));
+    test_step.dependOn(tests.addCommandSequenceTests(b, test_filter));
+    test_step.dependOn(tests.addCodegenThreadsTests(b));
+    if (builtin.os != builtin.Os.windows) {
+        // the test command copies the binary with cp
+        test_step.dependOn(tests.addIrGenThreadsTests(b));
+    }
+    // LLD has no link time optimization for MachO
+    switch (builtin.os) {
+        builtin.Os.darwin, builtin.Os.ios, builtin.Os.macosx => {},
+        else => test_step.dependOn(tests.addLtoTests(b)),
+    }
 }
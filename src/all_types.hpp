@@ -9,6 +9,7 @@
 #define ZIG_ALL_TYPES_HPP
 
 #include "list.hpp"
+#include "arena.hpp"
 #include "buffer.hpp"
 #include "zig_llvm.hpp"
 #include "hash_map.hpp"
@@ -35,6 +36,9 @@ struct IrInstruction;
 struct IrInstructionCast;
 struct IrBasicBlock;
 struct ScopeDecls;
+struct ComptimeCache;
+struct ParsecState;
+struct TimeReport;
 
 struct IrGotoItem {
     AstNode *source_node;
@@ -99,17 +103,38 @@ struct ConstStructValue {
     ConstParent parent;
 };
 
+// Arrays other than ConstArraySpecialNone are expanded with expand_const_array
+// before their elements are accessed by pointer or modified.
 enum ConstArraySpecial {
     ConstArraySpecialNone,
     ConstArraySpecialUndef,
+    // every element has the same value
+    ConstArraySpecialRepeat,
+    // only for arrays of u8; the elements are the bytes of a buffer
+    ConstArraySpecialBuf,
+    // only for arrays of other integers of at most 64 bits, see const_array_elem_is_packable;
+    // each element is stored in a uint64_t, in two's complement for signed types
+    ConstArraySpecialInts,
 };
 
 struct ConstArrayValue {
     ConstArraySpecial special;
-    struct {
-        ConstExprValue *elements;
-        ConstParent parent;
-    } s_none;
+    union {
+        struct {
+            ConstExprValue *elements;
+        } s_none;
+        struct {
+            // shared by every copy of the array, so it is never modified
+            ConstExprValue *elem;
+        } s_repeat;
+        struct {
+            Buf *bytes;
+        } s_buf;
+        struct {
+            uint64_t *values;
+        } s_ints;
+    };
+    ConstParent parent;
 };
 
 enum ConstPtrSpecial {
@@ -237,6 +262,7 @@ struct ConstExprValue {
         ErrorTableEntry *x_pure_err;
         ConstEnumValue x_enum;
         ConstStructValue x_struct;
+        // also the elements of a vector, which are always ConstArraySpecialNone
         ConstArrayValue x_array;
         ConstPtrValue x_ptr;
         ImportTableEntry *x_import;
@@ -454,10 +480,6 @@ struct AstNodeReturnExpr {
 struct AstNodeDefer {
     ReturnKind kind;
     AstNode *expr;
-
-    // temporary data used in IR generation
-    Scope *child_scope;
-    Scope *expr_scope;
 };
 
 struct AstNodeVariableDeclaration {
@@ -552,6 +574,8 @@ enum CastOp {
     CastOpResizeSlice,
     CastOpBytesToSlice,
     CastOpNumLitToConcrete,
+    CastOpArrayToVector,
+    CastOpVectorToArray,
 };
 
 struct AstNodeFnCallExpr {
@@ -943,6 +967,12 @@ struct TypeTableEntryArray {
     uint64_t len;
 };
 
+// the elements are integers, floats or bools
+struct TypeTableEntryVector {
+    TypeTableEntry *elem_type;
+    uint32_t len;
+};
+
 struct TypeStructField {
     Buf *name;
     TypeTableEntry *type_entry;
@@ -1088,6 +1118,7 @@ enum TypeTableEntryId {
     TypeTableEntryIdBoundFn,
     TypeTableEntryIdArgTuple,
     TypeTableEntryIdOpaque,
+    TypeTableEntryIdVector,
 };
 
 struct TypeTableEntry {
@@ -1105,6 +1136,7 @@ struct TypeTableEntry {
         TypeTableEntryInt integral;
         TypeTableEntryFloat floating;
         TypeTableEntryArray array;
+        TypeTableEntryVector vector;
         TypeTableEntryStruct structure;
         TypeTableEntryMaybe maybe;
         TypeTableEntryError error;
@@ -1193,6 +1225,8 @@ struct FnTableEntry {
     GlobalLinkageId linkage;
     AstNode *set_alignstack_node;
     uint32_t alignstack_value;
+    // instances of one generic function share body_node
+    bool is_generic_instance;
 };
 
 uint32_t fn_table_entry_hash(FnTableEntry*);
@@ -1257,6 +1291,13 @@ enum BuiltinFnId {
     BuiltinFnIdAlignCast,
     BuiltinFnIdOpaqueType,
     BuiltinFnIdSetAlignStack,
+    BuiltinFnIdVectorType,
+    BuiltinFnIdSplat,
+    BuiltinFnIdShuffle,
+    BuiltinFnIdReduce,
+    BuiltinFnIdAtomicRmw,
+    BuiltinFnIdAtomicLoad,
+    BuiltinFnIdAtomicStore,
 };
 
 struct BuiltinFnEntry {
@@ -1303,6 +1344,10 @@ struct TypeId {
             TypeTableEntry *child_type;
             uint64_t size;
         } array;
+        struct {
+            TypeTableEntry *elem_type;
+            uint32_t len;
+        } vector;
         struct {
             bool is_signed;
             uint32_t bit_count;
@@ -1360,6 +1405,9 @@ enum BuildMode {
     BuildModeDebug,
     BuildModeFastRelease,
     BuildModeSafeRelease,
+    // Debug as far as the program can tell, with the cheapest possible LLVM
+    // backend: no module verification and only the passes instruction selection needs
+    BuildModeFastDebug,
 };
 
 struct LinkLib {
@@ -1385,14 +1433,35 @@ struct CodeGen {
     // add -rpath [name] args to linker
     ZigList<Buf *> rpath_list;
 
+    // AST nodes of every parsed file; they live as long as the CodeGen
+    Arena ast_arena;
+    // instructions and basic blocks of both IR passes, with the ConstExprValue
+    // embedded in each instruction; released at the end of codegen_build
+    Arena ir_arena;
+    // the values of create_const_vals, made by IR generation and analysis; they
+    // live as long as the CodeGen
+    Arena analysis_arena;
+    // arrays which code generation passes to LLVM, which copies them; released
+    // when code generation finishes
+    Arena codegen_arena;
+    // Set when codegen_build releases ir_arena. Types and values made during
+    // analysis can still point at values in instructions, so nothing may read
+    // them after codegen_build; linking and the reports only read paths and names.
+    bool ir_released;
 
     // reminder: hash tables must be initialized before use
     HashMap<Buf *, ImportTableEntry *, buf_hash, buf_eql_buf> import_table;
-    HashMap<Buf *, BuiltinFnEntry *, buf_hash, buf_eql_buf> builtin_fn_table;
-    HashMap<Buf *, TypeTableEntry *, buf_hash, buf_eql_buf> primitive_type_table;
+    // @cImport blocks with the same C source share one namespace
+    HashMap<Buf *, ImportTableEntry *, buf_hash, buf_eql_buf> c_import_table;
+    HashMap<InternedStr *, BuiltinFnEntry *, interned_str_hash, interned_str_eql> builtin_fn_table;
+    // Identifiers with the same name share one InternedStr, see intern_str. This is
+    // source_cache_intern_table, so names parsed ahead of time by zig server are the
+    // same pointers as the ones of this CodeGen.
+    HashMap<Buf *, InternedStr *, buf_hash, buf_eql_buf> *intern_table;
+    HashMap<InternedStr *, TypeTableEntry *, interned_str_hash, interned_str_eql> primitive_type_table;
     HashMap<TypeId, TypeTableEntry *, type_id_hash, type_id_eql> type_table;
     HashMap<FnTypeId *, TypeTableEntry *, fn_type_id_hash, fn_type_id_eql> fn_type_table;
-    HashMap<Buf *, ErrorTableEntry *, buf_hash, buf_eql_buf> error_table;
+    HashMap<InternedStr *, ErrorTableEntry *, interned_str_hash, interned_str_eql> error_table;
     HashMap<GenericFnTypeId *, FnTableEntry *, generic_fn_type_id_hash, generic_fn_type_id_eql> generic_table;
     HashMap<Scope *, IrInstruction *, fn_eval_hash, fn_eval_eql> memoized_fn_eval_table;
     HashMap<ZigLLVMFnKey, LLVMValueRef, zig_llvm_fn_key_hash, zig_llvm_fn_key_eql> llvm_fn_table;
@@ -1452,6 +1521,8 @@ struct CodeGen {
     bool is_static;
     bool strip_debug_symbols;
     bool want_h_file;
+    // results of compile time calls are saved for later builds, see comptime_cache.hpp
+    bool want_comptime_cache;
     bool have_pub_main;
     bool have_c_main;
     bool have_winmain;
@@ -1509,6 +1580,8 @@ struct CodeGen {
     FnTableEntry *panic_fn;
     LLVMValueRef cur_ret_ptr;
     LLVMValueRef cur_fn_val;
+    // the blocks of cur_fn which the failing safety checks branch to
+    LLVMBasicBlockRef cur_fn_safety_crash_blocks[PanicMsgIdCount];
     bool c_want_stdint;
     bool c_want_stdbool;
     AstNode *root_export_decl;
@@ -1518,6 +1591,8 @@ struct CodeGen {
     bool verbose;
     bool verbose_link;
     bool verbose_ir;
+    // print whether each cached compile time call and @cImport was reused
+    bool verbose_cache;
     ErrColor err_color;
     ImportTableEntry *root_import;
     ImportTableEntry *bootstrap_import;
@@ -1571,6 +1646,32 @@ struct CodeGen {
     ZigList<AstNode *> tld_ref_source_node_stack;
 
     TypeTableEntry *align_amt_type;
+
+    // absolute paths of files read by @embedFile
+    ZigList<Buf *> embed_file_paths;
+    // objects and assembly files from the command line and headers read by
+    // @cImport, which codegen_write_dep_manifest lists besides the imports
+    ZigList<Buf *> dep_input_paths;
+    // number of LLVM modules optimized and emitted concurrently; 0 and 1 mean one module
+    size_t codegen_threads;
+    // number of threads generating the IR of function bodies; 0 and 1 mean no threads
+    size_t ir_gen_threads;
+    // null unless this CodeGen is being built by codegen_build
+    ComptimeCache *comptime_cache;
+    // created by the first C file that is translated
+    ParsecState *parsec_state;
+    // null unless the detailed time report was asked for
+    TimeReport *time_report;
+    // with an lto_mode other than none the objects are LLVM bitcode which the
+    // linker optimizes as a whole
+    ZigLLVMLTOMode lto_mode;
+    // set for compiler_rt and builtin, whose exported functions have to survive link
+    // time optimization because the code generator can emit calls to them
+    bool lto_keep_exports;
+    // the cpu and features of target_machine; the linker generates code for bitcode
+    // functions according to their attributes
+    const char *target_cpu;
+    const char *target_features;
 };
 
 enum VarLinkage {
@@ -1637,6 +1738,14 @@ struct Scope {
     Scope *parent;
 
     ZigLLVMDIScope *di_scope;
+
+    // The @setDebugSafety and @setFloatMode settings in effect in this scope.
+    // Codegen fills these in the first time it asks, once analysis can no
+    // longer change them.
+    bool safety_memoized;
+    bool want_safety;
+    bool fast_math_memoized;
+    bool want_fast_math;
 };
 
 // This scope comes from global declarations or from
@@ -1645,7 +1754,7 @@ struct Scope {
 struct ScopeDecls {
     Scope base;
 
-    HashMap<Buf *, Tld *, buf_hash, buf_eql_buf> decl_table;
+    HashMap<InternedStr *, Tld *, interned_str_hash, interned_str_eql> decl_table;
     bool safety_off;
     AstNode *safety_set_node;
     bool fast_math_off;
@@ -1668,19 +1777,21 @@ struct ScopeBlock {
 };
 
 // This scope is created from every defer expression.
-// It's the code following the defer statement.
+// It's the parent of the defer expression itself.
 // NodeTypeDefer
-struct ScopeDefer {
+struct ScopeDeferExpr {
     Scope base;
+
+    bool reported_err;
 };
 
 // This scope is created from every defer expression.
-// It's the parent of the defer expression itself.
+// It's the code following the defer statement.
 // NodeTypeDefer
-struct ScopeDeferExpr {
+struct ScopeDefer {
     Scope base;
 
-    bool reported_err;
+    ScopeDeferExpr *expr_scope;
 };
 
 // This scope is created for every variable declaration inside an IrExecutable
@@ -1738,6 +1849,28 @@ enum AtomicOrder {
     AtomicOrderSeqCst,
 };
 
+enum ReduceOp {
+    ReduceOpAdd,
+    ReduceOpMul,
+    ReduceOpAnd,
+    ReduceOpOr,
+    ReduceOpXor,
+    ReduceOpMin,
+    ReduceOpMax,
+};
+
+// synchronized with code in define_builtin_compile_vars
+enum AtomicRmwOp {
+    AtomicRmwOpXchg,
+    AtomicRmwOpAdd,
+    AtomicRmwOpSub,
+    AtomicRmwOpAnd,
+    AtomicRmwOpOr,
+    AtomicRmwOpXor,
+    AtomicRmwOpMin,
+    AtomicRmwOpMax,
+};
+
 // A basic block contains no branching. Branches send control flow
 // to another basic block.
 // Phi instructions must be first in a basic block.
@@ -1868,6 +2001,13 @@ enum IrInstructionId {
     IrInstructionIdAlignCast,
     IrInstructionIdOpaqueType,
     IrInstructionIdSetAlignStack,
+    IrInstructionIdVectorType,
+    IrInstructionIdSplat,
+    IrInstructionIdShuffle,
+    IrInstructionIdReduce,
+    IrInstructionIdAtomicRmw,
+    IrInstructionIdAtomicLoad,
+    IrInstructionIdAtomicStore,
 };
 
 struct IrInstruction {
@@ -2668,6 +2808,76 @@ struct IrInstructionSetAlignStack {
     IrInstruction *align_bytes;
 };
 
+struct IrInstructionVectorType {
+    IrInstruction base;
+
+    IrInstruction *len;
+    IrInstruction *elem_type;
+};
+
+struct IrInstructionSplat {
+    IrInstruction base;
+
+    IrInstruction *len;
+    IrInstruction *scalar;
+};
+
+struct IrInstructionShuffle {
+    IrInstruction base;
+
+    IrInstruction *a;
+    IrInstruction *b;
+    IrInstruction *mask;
+
+    // if this instruction gets to runtime then we know the mask:
+    // indexes into the elements of a followed by the elements of b
+    uint32_t *mask_indices;
+};
+
+struct IrInstructionReduce {
+    IrInstruction base;
+
+    IrInstruction *op_value;
+    IrInstruction *value;
+
+    // if this instruction gets to runtime then we know this value:
+    ReduceOp op;
+};
+
+struct IrInstructionAtomicRmw {
+    IrInstruction base;
+
+    IrInstruction *ptr;
+    IrInstruction *op_value;
+    IrInstruction *operand;
+    IrInstruction *order_value;
+
+    // if this instruction gets to runtime then we know these values:
+    AtomicRmwOp op;
+    AtomicOrder order;
+};
+
+struct IrInstructionAtomicLoad {
+    IrInstruction base;
+
+    IrInstruction *ptr;
+    IrInstruction *order_value;
+
+    // if this instruction gets to runtime then we know this value:
+    AtomicOrder order;
+};
+
+struct IrInstructionAtomicStore {
+    IrInstruction base;
+
+    IrInstruction *ptr;
+    IrInstruction *value;
+    IrInstruction *order_value;
+
+    // if this instruction gets to runtime then we know this value:
+    AtomicOrder order;
+};
+
 static const size_t slice_ptr_index = 0;
 static const size_t slice_len_index = 1;
 
@@ -14,8 +14,12 @@
 #include "os.hpp"
 #include "parser.hpp"
 #include "softfloat.hpp"
+#include "source_cache.hpp"
+#include "time_report.hpp"
 #include "zig_llvm.hpp"
 
+#include <atomic>
+#include <thread>
 
 static const size_t default_backward_branch_quota = 1000;
 
@@ -26,6 +30,13 @@ static void resolve_struct_zero_bits(CodeGen *g, TypeTableEntry *struct_type);
 static void resolve_enum_zero_bits(CodeGen *g, TypeTableEntry *enum_type);
 static void resolve_union_zero_bits(CodeGen *g, TypeTableEntry *union_type);
 
+// While the IR of function bodies is generated in parallel, the errors of each
+// function are collected here and added to g->errors in the order of g->fn_defs.
+static thread_local ZigList<ErrorMsg *> *fn_body_errors = nullptr;
+
+// The analysis_arena of the CodeGen being built, or the one of an IR gen worker.
+static thread_local Arena *const_val_arena = nullptr;
+
 ErrorMsg *add_node_error(CodeGen *g, AstNode *node, Buf *msg) {
     // if this assert fails, then parsec generated code that
     // failed semantic analysis, which isn't supposed to happen
@@ -34,7 +45,11 @@ ErrorMsg *add_node_error(CodeGen *g, AstNode *node, Buf *msg) {
     ErrorMsg *err = err_msg_create_with_line(node->owner->path, node->line, node->column,
             node->owner->source_code, node->owner->line_offsets, msg);
 
-    g->errors.append(err);
+    if (fn_body_errors != nullptr) {
+        fn_body_errors->append(err);
+    } else {
+        g->errors.append(err);
+    }
     return err;
 }
 
@@ -193,6 +208,7 @@ bool type_is_complete(TypeTableEntry *type_entry) {
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdPointer:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdNumLitFloat:
         case TypeTableEntryIdNumLitInt:
         case TypeTableEntryIdUndefLit:
@@ -230,6 +246,7 @@ bool type_has_zero_bits_known(TypeTableEntry *type_entry) {
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdPointer:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdNumLitFloat:
         case TypeTableEntryIdNumLitInt:
         case TypeTableEntryIdUndefLit:
@@ -603,6 +620,41 @@ TypeTableEntry *get_array_type(CodeGen *g, TypeTableEntry *child_type, uint64_t
     return entry;
 }
 
+TypeTableEntry *get_vector_type(CodeGen *g, TypeTableEntry *elem_type, uint32_t len) {
+    TypeId type_id = {};
+    type_id.id = TypeTableEntryIdVector;
+    type_id.data.vector.elem_type = elem_type;
+    type_id.data.vector.len = len;
+    auto existing_entry = g->type_table.maybe_get(type_id);
+    if (existing_entry) {
+        TypeTableEntry *entry = existing_entry->value;
+        return entry;
+    }
+
+    assert(len != 0);
+    assert(elem_type->id == TypeTableEntryIdInt || elem_type->id == TypeTableEntryIdFloat ||
+            elem_type->id == TypeTableEntryIdBool);
+
+    TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdVector);
+    entry->is_copyable = true;
+
+    buf_resize(&entry->name, 0);
+    buf_appendf(&entry->name, "@Vector(%" PRIu32 ", %s)", len, buf_ptr(&elem_type->name));
+
+    entry->type_ref = LLVMVectorType(elem_type->type_ref, len);
+
+    uint64_t debug_size_in_bits = 8*LLVMStoreSizeOfType(g->target_data_ref, entry->type_ref);
+    uint64_t debug_align_in_bits = 8*LLVMABIAlignmentOfType(g->target_data_ref, entry->type_ref);
+    entry->di_type = ZigLLVMCreateDebugVectorType(g->dbuilder, debug_size_in_bits,
+            debug_align_in_bits, elem_type->di_type, (int)len);
+
+    entry->data.vector.elem_type = elem_type;
+    entry->data.vector.len = len;
+
+    g->type_table.put(type_id, entry);
+    return entry;
+}
+
 static void slice_type_common_init(CodeGen *g, TypeTableEntry *pointer_type, TypeTableEntry *entry) {
     unsigned element_count = 2;
     entry->data.structure.layout = ContainerLayoutAuto;
@@ -1148,6 +1200,7 @@ static TypeTableEntry *analyze_fn_type(CodeGen *g, AstNode *proto_node, Scope *c
             case TypeTableEntryIdFloat:
             case TypeTableEntryIdPointer:
             case TypeTableEntryIdArray:
+            case TypeTableEntryIdVector:
             case TypeTableEntryIdStruct:
             case TypeTableEntryIdMaybe:
             case TypeTableEntryIdErrorUnion:
@@ -1212,6 +1265,7 @@ static TypeTableEntry *analyze_fn_type(CodeGen *g, AstNode *proto_node, Scope *c
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdPointer:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdStruct:
         case TypeTableEntryIdMaybe:
         case TypeTableEntryIdErrorUnion:
@@ -1484,6 +1538,7 @@ static bool type_allowed_in_packed_struct(TypeTableEntry *type_entry) {
         case TypeTableEntryIdBoundFn:
         case TypeTableEntryIdArgTuple:
         case TypeTableEntryIdOpaque:
+        case TypeTableEntryIdVector:
             return false;
         case TypeTableEntryIdVoid:
         case TypeTableEntryIdBool:
@@ -2139,7 +2194,7 @@ static void add_top_level_decl(CodeGen *g, ScopeDecls *decls_scope, Tld *tld) {
     }
 
     {
-        auto entry = decls_scope->decl_table.put_unique(tld->name, tld);
+        auto entry = decls_scope->decl_table.put_unique(intern_str(g->intern_table, tld->name), tld);
         if (entry) {
             Tld *other_tld = entry->value;
             ErrorMsg *msg = add_node_error(g, tld->source_node, buf_sprintf("redefinition of '%s'", buf_ptr(tld->name)));
@@ -2149,7 +2204,7 @@ static void add_top_level_decl(CodeGen *g, ScopeDecls *decls_scope, Tld *tld) {
     }
 
     {
-        auto entry = g->primitive_type_table.maybe_get(tld->name);
+        auto entry = g->primitive_type_table.maybe_get(intern_str(g->intern_table, tld->name));
         if (entry) {
             TypeTableEntry *type = entry->value;
             add_node_error(g, tld->source_node,
@@ -2190,7 +2245,8 @@ static void preview_error_value_decl(CodeGen *g, AstNode *node) {
     err->decl_node = node;
     buf_init_from_buf(&err->name, node->data.error_value_decl.name);
 
-    auto existing_entry = g->error_table.maybe_get(&err->name);
+    InternedStr *err_name = intern_str(g->intern_table, &err->name);
+    auto existing_entry = g->error_table.maybe_get(err_name);
     if (existing_entry) {
         // duplicate error definitions allowed and they get the same value
         err->value = existing_entry->value->value;
@@ -2199,7 +2255,7 @@ static void preview_error_value_decl(CodeGen *g, AstNode *node) {
         assert((uint32_t)error_value_count < (((uint32_t)1) << (uint32_t)g->err_tag_type->data.integral.bit_count));
         err->value = (uint32_t)error_value_count;
         g->error_decls.append(node);
-        g->error_table.put(&err->name, err);
+        g->error_table.put(err_name, err);
     }
 
     node->data.error_value_decl.err = err;
@@ -2226,7 +2282,7 @@ void init_tld(Tld *tld, TldId id, Buf *name, VisibMod visib_mod, AstNode *source
 }
 
 void update_compile_var(CodeGen *g, Buf *name, ConstExprValue *value) {
-    Tld *tld = g->compile_var_import->decls_scope->decl_table.get(name);
+    Tld *tld = g->compile_var_import->decls_scope->decl_table.get(intern_str(g->intern_table, name));
     resolve_top_level_decl(g, tld, false, tld->source_node);
     assert(tld->id == TldIdVar);
     TldVar *tld_var = (TldVar *)tld;
@@ -2380,6 +2436,7 @@ TypeTableEntry *validate_var_type(CodeGen *g, AstNode *source_node, TypeTableEnt
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdPointer:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdStruct:
         case TypeTableEntryIdMaybe:
         case TypeTableEntryIdErrorUnion:
@@ -2421,7 +2478,7 @@ VariableTableEntry *add_variable(CodeGen *g, AstNode *source_node, Scope *parent
             add_error_note(g, msg, existing_var->decl_node, buf_sprintf("previous declaration is here"));
             variable_entry->value->type = g->builtin_types.entry_invalid;
         } else {
-            auto primitive_table_entry = g->primitive_type_table.maybe_get(name);
+            auto primitive_table_entry = g->primitive_type_table.maybe_get(intern_str(g->intern_table, name));
             if (primitive_table_entry) {
                 TypeTableEntry *type = primitive_table_entry->value;
                 add_node_error(g, source_node,
@@ -2695,9 +2752,7 @@ bool types_match_const_cast_only(TypeTableEntry *expected_type, TypeTableEntry *
     return false;
 }
 
-Tld *find_decl(CodeGen *g, Scope *scope, Buf *name) {
-    // we must resolve all the use decls
-    ImportTableEntry *import = get_scope_import(scope);
+static void resolve_import_use_decls(CodeGen *g, ImportTableEntry *import) {
     for (size_t i = 0; i < import->use_decls.length; i += 1) {
         AstNode *use_decl_node = import->use_decls.at(i);
         if (use_decl_node->data.use.resolution == TldResolutionUnresolved) {
@@ -2705,11 +2760,19 @@ Tld *find_decl(CodeGen *g, Scope *scope, Buf *name) {
             resolve_use_decl(g, use_decl_node);
         }
     }
+}
 
+Tld *find_decl(CodeGen *g, Scope *scope, Buf *name) {
+    // we must resolve all the use decls
+    resolve_import_use_decls(g, get_scope_import(scope));
+
+    // hash the name once for all of the scopes
+    InternedStr *interned_name = intern_str(g->intern_table, name);
+    uint32_t name_hash = HashMap<InternedStr *, Tld *, interned_str_hash, interned_str_eql>::hash_key(interned_name);
     while (scope) {
         if (scope->id == ScopeIdDecls) {
             ScopeDecls *decls_scope = (ScopeDecls *)scope;
-            auto entry = decls_scope->decl_table.maybe_get(name);
+            auto entry = decls_scope->decl_table.maybe_get_hashed(interned_name, name_hash);
             if (entry)
                 return entry->value;
         }
@@ -2719,6 +2782,8 @@ Tld *find_decl(CodeGen *g, Scope *scope, Buf *name) {
 }
 
 VariableTableEntry *find_variable(CodeGen *g, Scope *scope, Buf *name) {
+    InternedStr *interned_name = intern_str(g->intern_table, name);
+    uint32_t name_hash = HashMap<InternedStr *, Tld *, interned_str_hash, interned_str_eql>::hash_key(interned_name);
     while (scope) {
         if (scope->id == ScopeIdVarDecl) {
             ScopeVarDecl *var_scope = (ScopeVarDecl *)scope;
@@ -2726,7 +2791,7 @@ VariableTableEntry *find_variable(CodeGen *g, Scope *scope, Buf *name) {
                 return var_scope->var;
         } else if (scope->id == ScopeIdDecls) {
             ScopeDecls *decls_scope = (ScopeDecls *)scope;
-            auto entry = decls_scope->decl_table.maybe_get(name);
+            auto entry = decls_scope->decl_table.maybe_get_hashed(interned_name, name_hash);
             if (entry) {
                 Tld *tld = entry->value;
                 if (tld->id == TldIdVar) {
@@ -2818,6 +2883,7 @@ static bool is_container(TypeTableEntry *type_entry) {
         case TypeTableEntryIdInt:
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdNumLitFloat:
         case TypeTableEntryIdNumLitInt:
         case TypeTableEntryIdUndefLit:
@@ -2866,6 +2932,7 @@ void resolve_container_type(CodeGen *g, TypeTableEntry *type_entry) {
         case TypeTableEntryIdInt:
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdNumLitFloat:
         case TypeTableEntryIdNumLitInt:
         case TypeTableEntryIdUndefLit:
@@ -2982,6 +3049,10 @@ void analyze_fn_ir(CodeGen *g, FnTableEntry *fn_table_entry, AstNode *return_typ
         return;
     }
 
+    if (g->build_mode == BuildModeSafeRelease) {
+        ir_elide_safety_checks(g, &fn_table_entry->analyzed_executable);
+    }
+
     if (g->verbose) {
         fprintf(stderr, "{ // (analyzed)\n");
         ir_print(g, stderr, &fn_table_entry->analyzed_executable, 4);
@@ -2991,16 +3062,14 @@ void analyze_fn_ir(CodeGen *g, FnTableEntry *fn_table_entry, AstNode *return_typ
     fn_table_entry->anal_state = FnAnalStateComplete;
 }
 
-static void analyze_fn_body(CodeGen *g, FnTableEntry *fn_table_entry) {
+// Returns false if the body does not need to be analyzed.
+static bool prepare_fn_body(CodeGen *g, FnTableEntry *fn_table_entry) {
     assert(fn_table_entry->anal_state != FnAnalStateProbing);
     if (fn_table_entry->anal_state != FnAnalStateReady)
-        return;
+        return false;
 
     fn_table_entry->anal_state = FnAnalStateProbing;
 
-    AstNode *return_type_node = (fn_table_entry->proto_node != nullptr) ?
-        fn_table_entry->proto_node->data.fn_proto.return_type : fn_table_entry->fndef_scope->base.source_node;
-
     assert(fn_table_entry->fndef_scope);
     if (!fn_table_entry->child_scope)
         fn_table_entry->child_scope = &fn_table_entry->fndef_scope->base;
@@ -3009,8 +3078,11 @@ static void analyze_fn_body(CodeGen *g, FnTableEntry *fn_table_entry) {
 
     TypeTableEntry *fn_type = fn_table_entry->type_entry;
     assert(!fn_type->data.fn.is_generic);
+    return true;
+}
 
-    ir_gen_fn(g, fn_table_entry);
+// Call after the IR of the body was generated.
+static void analyze_fn_body_ir(CodeGen *g, FnTableEntry *fn_table_entry) {
     if (fn_table_entry->ir_executable.invalid) {
         fn_table_entry->anal_state = FnAnalStateInvalid;
         return;
@@ -3023,9 +3095,127 @@ static void analyze_fn_body(CodeGen *g, FnTableEntry *fn_table_entry) {
         fprintf(stderr, "}\n");
     }
 
+    AstNode *return_type_node = (fn_table_entry->proto_node != nullptr) ?
+        fn_table_entry->proto_node->data.fn_proto.return_type : fn_table_entry->fndef_scope->base.source_node;
+
     analyze_fn_ir(g, fn_table_entry, return_type_node);
 }
 
+static void analyze_fn_body(CodeGen *g, FnTableEntry *fn_table_entry) {
+    if (!prepare_fn_body(g, fn_table_entry))
+        return;
+
+    if (g->time_report != nullptr) {
+        size_t event_index = time_report_begin(g, "ir gen", &fn_table_entry->symbol_name);
+        ir_gen_fn(g, fn_table_entry);
+        time_report_end(g, event_index);
+        event_index = time_report_begin(g, "analysis", &fn_table_entry->symbol_name);
+        analyze_fn_body_ir(g, fn_table_entry);
+        time_report_end(g, event_index);
+    } else {
+        ir_gen_fn(g, fn_table_entry);
+        analyze_fn_body_ir(g, fn_table_entry);
+    }
+}
+
+struct FnBodyJob {
+    FnTableEntry *fn_entry;
+    // the executable before IR generation, for bodies which have to be generated again
+    IrExecutable ir_executable;
+    ZigList<ErrorMsg *> errors;
+    size_t prepare_error_count;
+    bool needs_main_thread;
+};
+
+// below this many bodies starting threads costs more than it saves
+static const size_t min_parallel_fn_bodies = 16;
+
+static void gen_fn_bodies_on_worker(CodeGen *g, FnBodyJob *jobs, size_t job_count,
+        std::atomic<size_t> *next_job, IrGenWorker *worker)
+{
+    set_const_val_arena(&worker->analysis_arena);
+    for (;;) {
+        size_t i = next_job->fetch_add(1);
+        if (i >= job_count)
+            break;
+        FnBodyJob *job = &jobs[i];
+        if (job->needs_main_thread)
+            continue;
+        fn_body_errors = &job->errors;
+        ir_gen_fn_on_worker(g, job->fn_entry, worker);
+        job->needs_main_thread = worker->needs_main_thread;
+        fn_body_errors = nullptr;
+    }
+    set_const_val_arena(nullptr);
+}
+
+// Analyzes the bodies queued in g->fn_defs. Declarations and parameters are resolved
+// on this thread first, then the IR of all of the bodies is generated on
+// g->ir_gen_threads threads, and then the IR is analyzed here in queue order, since
+// analysis writes to the type tables and other state of g.
+// The order of the errors does not depend on how the workers were scheduled.
+static void gen_fn_bodies_parallel(CodeGen *g) {
+    ZigList<FnBodyJob> jobs = {0};
+    for (; g->fn_defs_index < g->fn_defs.length; g->fn_defs_index += 1) {
+        FnTableEntry *fn_entry = g->fn_defs.at(g->fn_defs_index);
+        FnBodyJob *job = jobs.add_one();
+        memset(job, 0, sizeof(FnBodyJob));
+        fn_body_errors = &job->errors;
+        bool ready = prepare_fn_body(g, fn_entry);
+        if (ready) {
+            // workers must not resolve declarations, see find_decl
+            resolve_import_use_decls(g, get_scope_import(fn_entry->child_scope));
+        }
+        fn_body_errors = nullptr;
+        if (!ready) {
+            jobs.pop();
+            continue;
+        }
+        job->fn_entry = fn_entry;
+        job->ir_executable = fn_entry->ir_executable;
+        job->prepare_error_count = job->errors.length;
+        // instances of a generic function share one body node, keep them on this thread
+        job->needs_main_thread = fn_entry->is_generic_instance;
+    }
+
+    if (jobs.length >= min_parallel_fn_bodies) {
+        size_t thread_count = min(g->ir_gen_threads, jobs.length);
+        IrGenWorker *workers = allocate<IrGenWorker>(thread_count);
+        std::atomic<size_t> next_job(0);
+        std::thread *threads = new std::thread[thread_count];
+        for (size_t i = 0; i < thread_count; i += 1) {
+            threads[i] = std::thread(gen_fn_bodies_on_worker, g, jobs.items, jobs.length, &next_job, &workers[i]);
+        }
+        for (size_t i = 0; i < thread_count; i += 1) {
+            threads[i].join();
+            arena_merge(&g->ir_arena, &workers[i].arena);
+            arena_merge(&g->analysis_arena, &workers[i].analysis_arena);
+        }
+        delete[] threads;
+        free(workers);
+    } else {
+        for (size_t i = 0; i < jobs.length; i += 1) {
+            jobs.at(i).needs_main_thread = true;
+        }
+    }
+
+    for (size_t i = 0; i < jobs.length; i += 1) {
+        FnBodyJob *job = &jobs.at(i);
+        if (job->needs_main_thread) {
+            job->errors.resize(job->prepare_error_count);
+            job->fn_entry->ir_executable = job->ir_executable;
+        }
+        for (size_t j = 0; j < job->errors.length; j += 1) {
+            g->errors.append(job->errors.at(j));
+        }
+        job->errors.deinit();
+        if (job->needs_main_thread)
+            ir_gen_fn(g, job->fn_entry);
+        analyze_fn_body_ir(g, job->fn_entry);
+    }
+    jobs.deinit();
+}
+
 static void add_symbols_from_import(CodeGen *g, AstNode *src_use_node, AstNode *dst_use_node) {
     if (src_use_node->data.use.resolution == TldResolutionUnresolved) {
         preview_use_decl(g, src_use_node);
@@ -3062,7 +3252,7 @@ static void add_symbols_from_import(CodeGen *g, AstNode *src_use_node, AstNode *
             continue;
         }
 
-        Buf *target_tld_name = entry->key;
+        InternedStr *target_tld_name = entry->key;
 
         auto existing_entry = dst_use_node->owner->decls_scope->decl_table.put_unique(target_tld_name, target_tld);
         if (existing_entry) {
@@ -3070,7 +3260,7 @@ static void add_symbols_from_import(CodeGen *g, AstNode *src_use_node, AstNode *
             if (existing_decl != target_tld) {
                 ErrorMsg *msg = add_node_error(g, dst_use_node,
                         buf_sprintf("import of '%s' overrides existing definition",
-                            buf_ptr(target_tld_name)));
+                            buf_ptr(&target_tld_name->buf)));
                 add_error_note(g, msg, existing_decl->source_node, buf_sprintf("previous definition here"));
                 add_error_note(g, msg, target_tld->source_node, buf_sprintf("imported definition here"));
             }
@@ -3124,15 +3314,33 @@ ImportTableEntry *add_source_file(CodeGen *g, PackageTableEntry *package, Buf *a
         fprintf(stderr, "---------\n");
     }
 
+    // files which came from the source cache are tokenized once per process
+    SourceFile *source_file = source_cache_get(abs_full_path, source_code);
+    if (source_file != nullptr) {
+        int err;
+        if ((err = source_cache_revalidate(source_file))) {
+            fprintf(stderr, "unable to read %s: %s\n", buf_ptr(abs_full_path), err_str(err));
+            exit(1);
+        }
+    }
     Tokenization tokenization = {0};
-    tokenize(source_code, &tokenization);
+    if (source_file != nullptr && source_file->tokenization != nullptr) {
+        tokenization = *source_file->tokenization;
+    } else {
+        tokenize(source_code, &tokenization);
 
-    if (tokenization.err) {
-        ErrorMsg *err = err_msg_create_with_line(abs_full_path, tokenization.err_line, tokenization.err_column,
-                source_code, tokenization.line_offsets, tokenization.err);
+        if (tokenization.err) {
+            ErrorMsg *err = err_msg_create_with_line(abs_full_path, tokenization.err_line, tokenization.err_column,
+                    source_code, tokenization.line_offsets, tokenization.err);
+
+            print_err_msg(err, g->err_color);
+            exit(1);
+        }
 
-        print_err_msg(err, g->err_color);
-        exit(1);
+        if (source_file != nullptr) {
+            source_file->tokenization = allocate<Tokenization>(1);
+            *source_file->tokenization = tokenization;
+        }
     }
 
     if (g->verbose) {
@@ -3142,13 +3350,20 @@ ImportTableEntry *add_source_file(CodeGen *g, PackageTableEntry *package, Buf *a
         fprintf(stderr, "------\n");
     }
 
-    ImportTableEntry *import_entry = allocate<ImportTableEntry>(1);
+    ImportTableEntry *import_entry;
+    if (source_file != nullptr && source_file->parsed_import != nullptr) {
+        // parsed ahead of time by zig server
+        import_entry = source_file->parsed_import;
+        source_file->parsed_import = nullptr;
+    } else {
+        import_entry = allocate<ImportTableEntry>(1);
+        import_entry->source_code = source_code;
+        import_entry->line_offsets = tokenization.line_offsets;
+        import_entry->root = ast_parse(source_code, tokenization.tokens, import_entry, g->err_color, &g->ast_arena,
+                g->intern_table);
+    }
     import_entry->package = package;
-    import_entry->source_code = source_code;
-    import_entry->line_offsets = tokenization.line_offsets;
     import_entry->path = abs_full_path;
-
-    import_entry->root = ast_parse(source_code, tokenization.tokens, import_entry, g->err_color);
     assert(import_entry->root);
     if (g->verbose) {
         ast_print(stderr, import_entry->root, 0);
@@ -3244,9 +3459,13 @@ void semantic_analyze(CodeGen *g) {
             resolve_top_level_decl(g, tld, pointer_only, nullptr);
         }
 
-        for (; g->fn_defs_index < g->fn_defs.length; g->fn_defs_index += 1) {
-            FnTableEntry *fn_entry = g->fn_defs.at(g->fn_defs_index);
-            analyze_fn_body(g, fn_entry);
+        if (g->ir_gen_threads > 1 && g->time_report == nullptr) {
+            gen_fn_bodies_parallel(g);
+        } else {
+            for (; g->fn_defs_index < g->fn_defs.length; g->fn_defs_index += 1) {
+                FnTableEntry *fn_entry = g->fn_defs.at(g->fn_defs_index);
+                analyze_fn_body(g, fn_entry);
+            }
         }
     }
 }
@@ -3334,6 +3553,7 @@ bool handle_is_ptr(TypeTableEntry *type_entry) {
         case TypeTableEntryIdPureError:
         case TypeTableEntryIdFn:
         case TypeTableEntryIdEnumTag:
+        case TypeTableEntryIdVector:
              return false;
         case TypeTableEntryIdArray:
         case TypeTableEntryIdStruct:
@@ -3445,10 +3665,11 @@ uint32_t fn_type_id_hash(FnTypeId *id) {
     result += id->is_var_args ? (uint32_t)1931444534 : 0;
     result += hash_ptr(id->return_type);
     result += id->alignment * 0xd3b3f3e2;
+    // a sum of the parameter types would be the same for every order of them
     for (size_t i = 0; i < id->param_count; i += 1) {
         FnTypeParamInfo *info = &id->param_info[i];
         result += info->is_noalias ? (uint32_t)892356923 : 0;
-        result += hash_ptr(info->type);
+        result = result * 31 + hash_ptr(info->type);
     }
     return result;
 }
@@ -3579,6 +3800,14 @@ static uint32_t hash_const_val(ConstExprValue *const_val) {
         case TypeTableEntryIdArray:
             // TODO better hashing algorithm
             return 1166190605;
+        case TypeTableEntryIdVector:
+            {
+                uint32_t result = 3116394226;
+                for (uint32_t i = 0; i < const_val->type->data.vector.len; i += 1) {
+                    result = result * 31 + hash_const_val(&const_val->data.x_array.s_none.elements[i]);
+                }
+                return result;
+            }
         case TypeTableEntryIdStruct:
             // TODO better hashing algorithm
             return 1532530855;
@@ -3721,6 +3950,7 @@ bool type_requires_comptime(TypeTableEntry *type_entry) {
         case TypeTableEntryIdArgTuple:
             return true;
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdStruct:
         case TypeTableEntryIdUnion:
         case TypeTableEntryIdMaybe:
@@ -3743,14 +3973,8 @@ bool type_requires_comptime(TypeTableEntry *type_entry) {
 void init_const_str_lit(CodeGen *g, ConstExprValue *const_val, Buf *str) {
     const_val->special = ConstValSpecialStatic;
     const_val->type = get_array_type(g, g->builtin_types.entry_u8, buf_len(str));
-    const_val->data.x_array.s_none.elements = create_const_vals(buf_len(str));
-
-    for (size_t i = 0; i < buf_len(str); i += 1) {
-        ConstExprValue *this_char = &const_val->data.x_array.s_none.elements[i];
-        this_char->special = ConstValSpecialStatic;
-        this_char->type = g->builtin_types.entry_u8;
-        bigint_init_unsigned(&this_char->data.x_bigint, (uint8_t)buf_ptr(str)[i]);
-    }
+    const_val->data.x_array.special = ConstArraySpecialBuf;
+    const_val->data.x_array.s_buf.bytes = buf_create_from_buf(str);
 }
 
 ConstExprValue *create_const_str_lit(CodeGen *g, Buf *str) {
@@ -3765,17 +3989,9 @@ void init_const_c_str_lit(CodeGen *g, ConstExprValue *const_val, Buf *str) {
     ConstExprValue *array_val = create_const_vals(1);
     array_val->special = ConstValSpecialStatic;
     array_val->type = get_array_type(g, g->builtin_types.entry_u8, len_with_null);
-    array_val->data.x_array.s_none.elements = create_const_vals(len_with_null);
-    for (size_t i = 0; i < buf_len(str); i += 1) {
-        ConstExprValue *this_char = &array_val->data.x_array.s_none.elements[i];
-        this_char->special = ConstValSpecialStatic;
-        this_char->type = g->builtin_types.entry_u8;
-        bigint_init_unsigned(&this_char->data.x_bigint, (uint8_t)buf_ptr(str)[i]);
-    }
-    ConstExprValue *null_char = &array_val->data.x_array.s_none.elements[len_with_null - 1];
-    null_char->special = ConstValSpecialStatic;
-    null_char->type = g->builtin_types.entry_u8;
-    bigint_init_unsigned(&null_char->data.x_bigint, 0);
+    array_val->data.x_array.special = ConstArraySpecialBuf;
+    array_val->data.x_array.s_buf.bytes = buf_create_from_buf(str);
+    buf_append_char(array_val->data.x_array.s_buf.bytes, 0);
 
     // then make the pointer point to it
     const_val->special = ConstValSpecialStatic;
@@ -4016,9 +4232,22 @@ void init_const_undefined(CodeGen *g, ConstExprValue *const_val) {
     }
 }
 
+Arena *set_const_val_arena(Arena *arena) {
+    Arena *prev = const_val_arena;
+    const_val_arena = arena;
+    return prev;
+}
+
 ConstExprValue *create_const_vals(size_t count) {
-    ConstGlobalRefs *global_refs = allocate<ConstGlobalRefs>(count);
-    ConstExprValue *vals = allocate<ConstExprValue>(count);
+    ConstGlobalRefs *global_refs;
+    ConstExprValue *vals;
+    if (const_val_arena != nullptr) {
+        global_refs = arena_allocate<ConstGlobalRefs>(const_val_arena, count);
+        vals = arena_allocate<ConstExprValue>(const_val_arena, count);
+    } else {
+        global_refs = allocate<ConstGlobalRefs>(count);
+        vals = allocate<ConstExprValue>(count);
+    }
     for (size_t i = 0; i < count; i += 1) {
         vals[i].global_refs = &global_refs[i];
     }
@@ -4149,6 +4378,14 @@ bool const_values_equal(ConstExprValue *a, ConstExprValue *b) {
             zig_unreachable();
         case TypeTableEntryIdArray:
             zig_panic("TODO");
+        case TypeTableEntryIdVector:
+            for (uint32_t i = 0; i < a->type->data.vector.len; i += 1) {
+                ConstExprValue *elem_a = &a->data.x_array.s_none.elements[i];
+                ConstExprValue *elem_b = &b->data.x_array.s_none.elements[i];
+                if (!const_values_equal(elem_a, elem_b))
+                    return false;
+            }
+            return true;
         case TypeTableEntryIdStruct:
             for (size_t i = 0; i < a->type->data.structure.src_field_count; i += 1) {
                 ConstExprValue *field_a = &a->data.x_struct.fields[i];
@@ -4358,6 +4595,21 @@ void render_const_value(CodeGen *g, Buf *buf, ConstExprValue *const_val) {
                     buf_append_str(buf, "undefined");
                     return;
                 }
+                if (const_val->data.x_array.special == ConstArraySpecialBuf) {
+                    Buf *bytes = const_val->data.x_array.s_buf.bytes;
+                    buf_append_char(buf, '"');
+                    for (size_t i = 0; i < buf_len(bytes); i += 1) {
+                        uint8_t c = (uint8_t)buf_ptr(bytes)[i];
+                        if (c == '"') {
+                            buf_append_str(buf, "\\\"");
+                        } else {
+                            buf_append_char(buf, c);
+                        }
+                    }
+                    buf_append_char(buf, '"');
+                    return;
+                }
+                expand_const_array(g, const_val);
 
                 // if it's []u8, assume UTF-8 and output a string
                 if (child_type->id == TypeTableEntryIdInt &&
@@ -4390,6 +4642,17 @@ void render_const_value(CodeGen *g, Buf *buf, ConstExprValue *const_val) {
                 buf_appendf(buf, "}");
                 return;
             }
+        case TypeTableEntryIdVector:
+            {
+                buf_appendf(buf, "%s{", buf_ptr(&type_entry->name));
+                for (uint32_t i = 0; i < type_entry->data.vector.len; i += 1) {
+                    if (i != 0)
+                        buf_appendf(buf, ",");
+                    render_const_value(g, buf, &const_val->data.x_array.s_none.elements[i]);
+                }
+                buf_appendf(buf, "}");
+                return;
+            }
         case TypeTableEntryIdNullLit:
             {
                 buf_appendf(buf, "null");
@@ -4537,6 +4800,9 @@ uint32_t type_id_hash(TypeId x) {
         case TypeTableEntryIdArray:
             return hash_ptr(x.data.array.child_type) +
                 ((uint32_t)x.data.array.size ^ (uint32_t)2122979968);
+        case TypeTableEntryIdVector:
+            return hash_ptr(x.data.vector.elem_type) +
+                ((uint32_t)x.data.vector.len ^ (uint32_t)3597355021);
         case TypeTableEntryIdInt:
             return (x.data.integer.is_signed ? (uint32_t)2652528194 : (uint32_t)163929201) +
                     (((uint32_t)x.data.integer.bit_count) ^ (uint32_t)2998081557);
@@ -4583,6 +4849,9 @@ bool type_id_eql(TypeId a, TypeId b) {
         case TypeTableEntryIdArray:
             return a.data.array.child_type == b.data.array.child_type &&
                 a.data.array.size == b.data.array.size;
+        case TypeTableEntryIdVector:
+            return a.data.vector.elem_type == b.data.vector.elem_type &&
+                a.data.vector.len == b.data.vector.len;
         case TypeTableEntryIdInt:
             return a.data.integer.is_signed == b.data.integer.is_signed &&
                 a.data.integer.bit_count == b.data.integer.bit_count;
@@ -4627,32 +4896,184 @@ bool zig_llvm_fn_key_eql(ZigLLVMFnKey a, ZigLLVMFnKey b) {
     zig_unreachable();
 }
 
-void expand_undef_array(CodeGen *g, ConstExprValue *const_val) {
+static uint64_t pack_int(TypeTableEntry *int_type, BigInt *bigint) {
+    if (int_type->data.integral.is_signed)
+        return (uint64_t)bigint_as_signed(bigint);
+    return bigint_as_unsigned(bigint);
+}
+
+static void unpack_int(TypeTableEntry *int_type, uint64_t value, BigInt *out) {
+    if (int_type->data.integral.is_signed) {
+        bigint_init_signed(out, (int64_t)value);
+    } else {
+        bigint_init_unsigned(out, value);
+    }
+}
+
+void expand_const_array(CodeGen *g, ConstExprValue *const_val) {
     assert(const_val->type->id == TypeTableEntryIdArray);
-    if (const_val->data.x_array.special == ConstArraySpecialUndef) {
-        const_val->data.x_array.special = ConstArraySpecialNone;
-        size_t elem_count = const_val->type->data.array.len;
-        const_val->data.x_array.s_none.elements = create_const_vals(elem_count);
-        for (size_t i = 0; i < elem_count; i += 1) {
-            ConstExprValue *element_val = &const_val->data.x_array.s_none.elements[i];
-            element_val->type = const_val->type->data.array.child_type;
-            init_const_undefined(g, element_val);
-            ConstParent *parent = get_const_val_parent(g, element_val);
-            if (parent != nullptr) {
-                parent->id = ConstParentIdArray;
-                parent->data.p_array.array_val = const_val;
-                parent->data.p_array.elem_index = i;
+    ConstArrayValue *array = &const_val->data.x_array;
+    if (array->special == ConstArraySpecialNone)
+        return;
+
+    size_t elem_count = const_val->type->data.array.len;
+    TypeTableEntry *child_type = const_val->type->data.array.child_type;
+    ConstExprValue *elements = create_const_vals(elem_count);
+    for (size_t i = 0; i < elem_count; i += 1) {
+        ConstExprValue *element_val = &elements[i];
+        switch (array->special) {
+            case ConstArraySpecialNone:
+                zig_unreachable();
+            case ConstArraySpecialUndef:
+                element_val->type = child_type;
+                init_const_undefined(g, element_val);
+                break;
+            case ConstArraySpecialRepeat:
+                {
+                    ConstGlobalRefs *global_refs = element_val->global_refs;
+                    *element_val = *array->s_repeat.elem;
+                    element_val->global_refs = global_refs;
+                    break;
+                }
+            case ConstArraySpecialBuf:
+                element_val->special = ConstValSpecialStatic;
+                element_val->type = child_type;
+                bigint_init_unsigned(&element_val->data.x_bigint, (uint8_t)buf_ptr(array->s_buf.bytes)[i]);
+                break;
+            case ConstArraySpecialInts:
+                element_val->special = ConstValSpecialStatic;
+                element_val->type = child_type;
+                unpack_int(child_type, array->s_ints.values[i], &element_val->data.x_bigint);
+                break;
+        }
+        ConstParent *parent = get_const_val_parent(g, element_val);
+        if (parent != nullptr) {
+            parent->id = ConstParentIdArray;
+            parent->data.p_array.array_val = const_val;
+            parent->data.p_array.elem_index = i;
+        }
+    }
+    array->special = ConstArraySpecialNone;
+    array->s_none.elements = elements;
+}
+
+bool read_compact_array_elem(ConstExprValue *array_val, size_t index, ConstExprValue *out_val) {
+    ConstArrayValue *array = &array_val->data.x_array;
+    assert(index < array_val->type->data.array.len);
+    switch (array->special) {
+        case ConstArraySpecialNone:
+        case ConstArraySpecialUndef:
+            return false;
+        case ConstArraySpecialRepeat:
+            {
+                ConstGlobalRefs *global_refs = out_val->global_refs;
+                *out_val = *array->s_repeat.elem;
+                out_val->global_refs = global_refs;
+                return true;
+            }
+        case ConstArraySpecialBuf:
+            out_val->special = ConstValSpecialStatic;
+            out_val->type = array_val->type->data.array.child_type;
+            bigint_init_unsigned(&out_val->data.x_bigint, (uint8_t)buf_ptr(array->s_buf.bytes)[index]);
+            return true;
+        case ConstArraySpecialInts:
+            out_val->special = ConstValSpecialStatic;
+            out_val->type = array_val->type->data.array.child_type;
+            unpack_int(out_val->type, array->s_ints.values[index], &out_val->data.x_bigint);
+            return true;
+    }
+    zig_unreachable();
+}
+
+bool read_const_array_bytes(ConstExprValue *array_val, size_t start, size_t end, Buf *out) {
+    ConstArrayValue *array = &array_val->data.x_array;
+    switch (array->special) {
+        case ConstArraySpecialUndef:
+            return false;
+        case ConstArraySpecialBuf:
+            buf_append_mem(out, buf_ptr(array->s_buf.bytes) + start, end - start);
+            return true;
+        case ConstArraySpecialInts:
+            zig_unreachable();
+        case ConstArraySpecialRepeat:
+        case ConstArraySpecialNone:
+            for (size_t i = start; i < end; i += 1) {
+                ConstExprValue *elem_val = (array->special == ConstArraySpecialRepeat) ?
+                    array->s_repeat.elem : &array->s_none.elements[i];
+                if (elem_val->special != ConstValSpecialStatic)
+                    return false;
+                buf_append_char(out, (char)bigint_as_unsigned(&elem_val->data.x_bigint));
+            }
+            return true;
+    }
+    zig_unreachable();
+}
+
+bool const_array_elem_is_packable(CodeGen *g, TypeTableEntry *child_type) {
+    // arrays of u8 use ConstArraySpecialBuf
+    return child_type->id == TypeTableEntryIdInt && child_type != g->builtin_types.entry_u8 &&
+        child_type->data.integral.bit_count > 0 && child_type->data.integral.bit_count <= 64;
+}
+
+bool read_const_array_ints(ConstExprValue *array_val, size_t start, size_t end, ZigList<uint64_t> *out) {
+    ConstArrayValue *array = &array_val->data.x_array;
+    TypeTableEntry *child_type = array_val->type->data.array.child_type;
+    switch (array->special) {
+        case ConstArraySpecialUndef:
+            return false;
+        case ConstArraySpecialBuf:
+            zig_unreachable();
+        case ConstArraySpecialInts:
+            for (size_t i = start; i < end; i += 1) {
+                out->append(array->s_ints.values[i]);
             }
+            return true;
+        case ConstArraySpecialRepeat:
+        case ConstArraySpecialNone:
+            for (size_t i = start; i < end; i += 1) {
+                ConstExprValue *elem_val = (array->special == ConstArraySpecialRepeat) ?
+                    array->s_repeat.elem : &array->s_none.elements[i];
+                if (elem_val->special != ConstValSpecialStatic)
+                    return false;
+                out->append(pack_int(child_type, &elem_val->data.x_bigint));
+            }
+            return true;
+    }
+    zig_unreachable();
+}
+
+bool write_packed_array_elem(CodeGen *g, ConstExprValue *array_val, size_t index, ConstExprValue *elem_val) {
+    ConstArrayValue *array = &array_val->data.x_array;
+    TypeTableEntry *child_type = array_val->type->data.array.child_type;
+    if (elem_val->type != child_type || elem_val->special != ConstValSpecialStatic ||
+        !const_array_elem_is_packable(g, child_type) || index >= array_val->type->data.array.len)
+    {
+        return false;
+    }
+    if (array->special == ConstArraySpecialRepeat) {
+        // a table initialized with `[]u32{0} ** n` and then filled in
+        if (array->s_repeat.elem->special != ConstValSpecialStatic)
+            return false;
+        uint64_t len = array_val->type->data.array.len;
+        uint64_t value = pack_int(child_type, &array->s_repeat.elem->data.x_bigint);
+        uint64_t *values = allocate_nonzero<uint64_t>(len);
+        for (uint64_t i = 0; i < len; i += 1) {
+            values[i] = value;
         }
+        array->special = ConstArraySpecialInts;
+        array->s_ints.values = values;
     }
+    if (array->special != ConstArraySpecialInts)
+        return false;
+    array->s_ints.values[index] = pack_int(child_type, &elem_val->data.x_bigint);
+    return true;
 }
 
 ConstParent *get_const_val_parent(CodeGen *g, ConstExprValue *value) {
     assert(value->type);
     TypeTableEntry *type_entry = value->type;
     if (type_entry->id == TypeTableEntryIdArray) {
-        expand_undef_array(g, value);
-        return &value->data.x_array.s_none.parent;
+        return &value->data.x_array.parent;
     } else if (type_entry->id == TypeTableEntryIdStruct) {
         return &value->data.x_struct.parent;
     }
@@ -4685,6 +5106,7 @@ static const TypeTableEntryId all_type_ids[] = {
     TypeTableEntryIdBoundFn,
     TypeTableEntryIdArgTuple,
     TypeTableEntryIdOpaque,
+    TypeTableEntryIdVector,
 };
 
 TypeTableEntryId type_id_at_index(size_t index) {
@@ -4751,6 +5173,8 @@ size_t type_id_index(TypeTableEntryId id) {
             return 23;
         case TypeTableEntryIdOpaque:
             return 24;
+        case TypeTableEntryIdVector:
+            return 25;
     }
     zig_unreachable();
 }
@@ -4810,6 +5234,8 @@ const char *type_id_name(TypeTableEntryId id) {
             return "ArgTuple";
         case TypeTableEntryIdOpaque:
             return "Opaque";
+        case TypeTableEntryIdVector:
+            return "Vector";
     }
     zig_unreachable();
 }
@@ -4853,6 +5279,10 @@ void add_link_lib_symbol(CodeGen *g, Buf *lib_name, Buf *symbol_name) {
     link_lib->symbols.append(symbol_name);
 }
 
+bool build_mode_is_debug(BuildMode build_mode) {
+    return build_mode == BuildModeDebug || build_mode == BuildModeFastDebug;
+}
+
 uint32_t get_abi_alignment(CodeGen *g, TypeTableEntry *type_entry) {
     type_ensure_zero_bits_known(g, type_entry);
     if (type_entry->zero_bits) return 0;
@@ -26,6 +26,7 @@ TypeTableEntry *get_c_int_type(CodeGen *g, CIntType c_int_type);
 TypeTableEntry *get_fn_type(CodeGen *g, FnTypeId *fn_type_id);
 TypeTableEntry *get_maybe_type(CodeGen *g, TypeTableEntry *child_type);
 TypeTableEntry *get_array_type(CodeGen *g, TypeTableEntry *child_type, uint64_t array_size);
+TypeTableEntry *get_vector_type(CodeGen *g, TypeTableEntry *elem_type, uint32_t len);
 TypeTableEntry *get_slice_type(CodeGen *g, TypeTableEntry *ptr_type);
 TypeTableEntry *get_partial_container_type(CodeGen *g, Scope *scope, ContainerKind kind,
         AstNode *decl_node, const char *name, ContainerLayout layout);
@@ -154,11 +155,29 @@ ConstExprValue *create_const_arg_tuple(CodeGen *g, size_t arg_index_start, size_
 void init_const_undefined(CodeGen *g, ConstExprValue *const_val);
 
 ConstExprValue *create_const_vals(size_t count);
+// Sets the arena create_const_vals allocates from on this thread, and returns the
+// previous one. With none, each call allocates from the heap.
+Arena *set_const_val_arena(Arena *arena);
 
 TypeTableEntry *make_int_type(CodeGen *g, bool is_signed, uint32_t size_in_bits);
 ConstParent *get_const_val_parent(CodeGen *g, ConstExprValue *value);
 TypeTableEntry *create_enum_tag_type(CodeGen *g, TypeTableEntry *enum_type, TypeTableEntry *int_type);
-void expand_undef_array(CodeGen *g, ConstExprValue *const_val);
+void expand_const_array(CodeGen *g, ConstExprValue *const_val);
+// Reads an element of an array in the repeated, byte buffer or packed integer form
+// without expanding it. Returns false if the array is in another form.
+bool read_compact_array_elem(ConstExprValue *array_val, size_t index, ConstExprValue *out_val);
+// Appends the elements [start, end) of an array of u8 to out. Returns false if
+// any of them is undefined.
+bool read_const_array_bytes(ConstExprValue *array_val, size_t start, size_t end, Buf *out);
+// Whether arrays of child_type can be in the ConstArraySpecialInts form.
+bool const_array_elem_is_packable(CodeGen *g, TypeTableEntry *child_type);
+// Appends the elements [start, end) of an array of a packable integer type to out.
+// Returns false if any of them is undefined.
+bool read_const_array_ints(ConstExprValue *array_val, size_t start, size_t end, ZigList<uint64_t> *out);
+// Stores elem_val in an array in the packed integer form, or in the repeated form
+// which is converted to it, without expanding the array. Returns false if the array
+// is in another form.
+bool write_packed_array_elem(CodeGen *g, ConstExprValue *array_val, size_t index, ConstExprValue *elem_val);
 void update_compile_var(CodeGen *g, Buf *name, ConstExprValue *value);
 
 const char *type_id_name(TypeTableEntryId id);
@@ -172,6 +191,8 @@ bool calling_convention_does_first_arg_return(CallingConvention cc);
 LinkLib *add_link_lib(CodeGen *codegen, Buf *lib);
 void add_link_lib_symbol(CodeGen *g, Buf *lib_name, Buf *symbol_name);
 
+bool build_mode_is_debug(BuildMode build_mode);
+
 uint32_t get_abi_alignment(CodeGen *g, TypeTableEntry *type_entry);
 TypeTableEntry *get_align_amt_type(CodeGen *g);
 
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "arena.hpp"
+
+#include <stdlib.h>
+
+struct ArenaChunk {
+    ArenaChunk *next;
+};
+
+static const size_t arena_chunk_size = 64 * 1024;
+
+static uint8_t *arena_add_chunk(Arena *arena, size_t size) {
+    // calloc gives us the zeroed memory we promise, and chunks are never reused
+    ArenaChunk *chunk = reinterpret_cast<ArenaChunk *>(calloc(1, sizeof(ArenaChunk) + size));
+    if (!chunk)
+        zig_panic("allocation failed");
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    return reinterpret_cast<uint8_t *>(chunk + 1);
+}
+
+void *arena_alloc_slow(Arena *arena, size_t size, size_t align) {
+    size_t padded_size = size + align - 1;
+    if (padded_size > arena_chunk_size / 4) {
+        // Large allocations get a chunk of their own so that the remainder of the
+        // current chunk is not wasted.
+        uintptr_t addr = (uintptr_t)arena_add_chunk(arena, padded_size);
+        return reinterpret_cast<void *>((addr + align - 1) & ~((uintptr_t)align - 1));
+    }
+
+    arena->ptr = arena_add_chunk(arena, arena_chunk_size);
+    arena->end = arena->ptr + arena_chunk_size;
+    return arena_alloc_bytes(arena, size, align);
+}
+
+void arena_deinit(Arena *arena) {
+    ArenaChunk *chunk = arena->chunks;
+    while (chunk != nullptr) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->chunks = nullptr;
+    arena->ptr = nullptr;
+    arena->end = nullptr;
+}
+
+void arena_merge(Arena *dest, Arena *src) {
+    if (src->chunks == nullptr)
+        return;
+    ArenaChunk *last = src->chunks;
+    while (last->next != nullptr)
+        last = last->next;
+    // the chunk list is only walked by arena_deinit, dest->ptr keeps pointing into
+    // the chunk it was allocating from
+    last->next = dest->chunks;
+    dest->chunks = src->chunks;
+    src->chunks = nullptr;
+    src->ptr = nullptr;
+    src->end = nullptr;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef ZIG_ARENA_HPP
+#define ZIG_ARENA_HPP
+
+#include "util.hpp"
+
+#include <stdint.h>
+
+struct ArenaChunk;
+
+// Bump pointer allocator for objects which live until the end of a compilation
+// phase. Memory is zeroed and can only be released all at once with arena_deinit.
+// A zero initialized Arena is ready to use.
+struct Arena {
+    ArenaChunk *chunks;
+    uint8_t *ptr;
+    uint8_t *end;
+};
+
+void *arena_alloc_slow(Arena *arena, size_t size, size_t align);
+void arena_deinit(Arena *arena);
+// Hands the memory of src over to dest, leaving src empty. Allocations made from
+// src stay valid until dest is deinitialized.
+void arena_merge(Arena *dest, Arena *src);
+
+static inline void *arena_alloc_bytes(Arena *arena, size_t size, size_t align) {
+    note_allocation();
+    uintptr_t addr = ((uintptr_t)arena->ptr + align - 1) & ~((uintptr_t)align - 1);
+    if (arena->ptr != nullptr && addr <= (uintptr_t)arena->end && size <= (uintptr_t)arena->end - addr) {
+        arena->ptr = reinterpret_cast<uint8_t *>(addr + size);
+        return reinterpret_cast<void *>(addr);
+    }
+    return arena_alloc_slow(arena, size, align);
+}
+
+template<typename T>
+ATTRIBUTE_RETURNS_NOALIAS static inline T *arena_allocate(Arena *arena, size_t count) {
+    return reinterpret_cast<T*>(arena_alloc_bytes(arena, count * sizeof(T), alignof(T)));
+}
+
+#endif
@@ -62,11 +62,18 @@ void buf_appendf(Buf *buf, const char *format, ...) {
 // these functions are not static inline so they can be better used as template parameters
 bool buf_eql_buf(Buf *buf, Buf *other) {
     assert(buf->list.length);
+    if (buf == other)
+        return true;
+    // the intern table has one InternedStr per contents
+    if (buf->interned && other->interned)
+        return buf->interned == other->interned;
     return buf_eql_mem(buf, buf_ptr(other), buf_len(other));
 }
 
 uint32_t buf_hash(Buf *buf) {
     assert(buf->list.length);
+    if (buf->interned)
+        return buf->interned->hash;
     // FNV 32-bit hash
     uint32_t h = 2166136261;
     for (size_t i = 0; i < buf_len(buf); i += 1) {
@@ -75,3 +82,11 @@ uint32_t buf_hash(Buf *buf) {
     }
     return h;
 }
+
+uint32_t interned_str_hash(InternedStr *str) {
+    return str->hash;
+}
+
+bool interned_str_eql(InternedStr *a, InternedStr *b) {
+    return a == b;
+}
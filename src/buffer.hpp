@@ -17,10 +17,24 @@
 
 #define BUF_INIT {{0}}
 
+struct InternedStr;
+
 // Note, you must call one of the alloc, init, or resize functions to have an
 // initialized buffer. The assertions should help with this.
 struct Buf {
     ZigList<char> list;
+    // Set on the Buf of an InternedStr and on by-value copies of it, which share its
+    // contents. Such a Buf must not be modified, which the functions that modify a
+    // Buf assert.
+    InternedStr *interned;
+};
+
+// The one copy of a name which every identifier with that name points to, made by
+// intern_str. Tables of names are keyed by the InternedStr, so that a lookup hashes
+// and compares a pointer rather than the contents.
+struct InternedStr {
+    Buf buf;
+    uint32_t hash;
 };
 
 Buf *buf_sprintf(const char *format, ...)
@@ -38,6 +52,7 @@ static inline char *buf_ptr(Buf *buf) {
 }
 
 static inline void buf_resize(Buf *buf, size_t new_len) {
+    assert(!buf->interned);
     buf->list.resize(new_len + 1);
     buf->list.at(buf_len(buf)) = 0;
 }
@@ -53,11 +68,13 @@ static inline Buf *buf_alloc(void) {
 }
 
 static inline void buf_deinit(Buf *buf) {
+    assert(!buf->interned);
     buf->list.deinit();
 }
 
 static inline void buf_init_from_mem(Buf *buf, const char *ptr, size_t len) {
     assert(len != SIZE_MAX);
+    buf->interned = nullptr;
     buf->list.resize(len + 1);
     safe_memcpy(buf_ptr(buf), ptr, len);
     buf->list.at(buf_len(buf)) = 0;
@@ -167,7 +184,11 @@ static inline bool buf_ends_with_str(Buf *buf, const char *str) {
 bool buf_eql_buf(Buf *buf, Buf *other);
 uint32_t buf_hash(Buf *buf);
 
+uint32_t interned_str_hash(InternedStr *str);
+bool interned_str_eql(InternedStr *a, InternedStr *b);
+
 static inline void buf_upcase(Buf *buf) {
+    assert(!buf->interned);
     for (size_t i = 0; i < buf_len(buf); i += 1) {
         buf_ptr(buf)[i] = (char)toupper(buf_ptr(buf)[i]);
     }
@@ -0,0 +1,622 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "c_import_cache.hpp"
+#include "bigfloat.hpp"
+#include "bigint.hpp"
+#include "cache_hash.hpp"
+#include "os.hpp"
+
+#include <stdio.h>
+
+// An entry is the AST written out depth first. Every item is followed by a space:
+//  * integers and bools are decimal numbers
+//  * strings are "<length>:<bytes>" or "-" for null
+//  * nodes are "-" for null, "@<index>" for a node which was written before, or
+//    "n<type>" followed by the fields of the node. Nodes are numbered in the
+//    order they are first written, so a node shared by several parents is shared
+//    again when it is read back.
+// Only the node types that parsec creates are supported.
+
+static const char *cache_entry_magic = "zig-c-import-cache 1\n";
+
+static uint32_t node_ptr_hash(AstNode *node) {
+    return ptr_hash(node);
+}
+
+static bool node_ptr_eql(AstNode *a, AstNode *b) {
+    return ptr_eq(a, b);
+}
+
+struct AstWriter {
+    Buf *out;
+    HashMap<AstNode *, size_t, node_ptr_hash, node_ptr_eql> node_index;
+    bool unsupported;
+};
+
+static void write_uint(AstWriter *w, uint64_t x) {
+    buf_appendf(w->out, "%" ZIG_PRI_u64 " ", x);
+}
+
+static void write_str(AstWriter *w, Buf *str) {
+    if (str == nullptr) {
+        buf_append_str(w->out, "- ");
+        return;
+    }
+    buf_appendf(w->out, "%" ZIG_PRI_usize ":", buf_len(str));
+    buf_append_buf(w->out, str);
+    buf_append_char(w->out, ' ');
+}
+
+static void write_bigint(AstWriter *w, BigInt *bigint) {
+    if (bigint == nullptr) {
+        buf_append_str(w->out, "- ");
+        return;
+    }
+    write_uint(w, bigint->is_negative);
+    write_uint(w, bigint->digit_count);
+    const uint64_t *digits = bigint_ptr(bigint);
+    for (size_t i = 0; i < bigint->digit_count; i += 1) {
+        write_uint(w, digits[i]);
+    }
+}
+
+static void write_bigfloat(AstWriter *w, BigFloat *bigfloat) {
+    // the bits of the f128 so that no precision is lost
+    uint64_t words[2];
+    static_assert(sizeof(words) == sizeof(bigfloat->value), "");
+    memcpy(words, &bigfloat->value, sizeof(words));
+    write_uint(w, words[0]);
+    write_uint(w, words[1]);
+}
+
+static void write_node(AstWriter *w, AstNode *node);
+
+static void write_node_list(AstWriter *w, ZigList<AstNode *> *list) {
+    write_uint(w, list->length);
+    for (size_t i = 0; i < list->length; i += 1) {
+        write_node(w, list->at(i));
+    }
+}
+
+static void write_node(AstWriter *w, AstNode *node) {
+    if (node == nullptr) {
+        buf_append_str(w->out, "- ");
+        return;
+    }
+    auto entry = w->node_index.maybe_get(node);
+    if (entry != nullptr) {
+        buf_appendf(w->out, "@%" ZIG_PRI_usize " ", entry->value);
+        return;
+    }
+    w->node_index.put(node, w->node_index.size());
+
+    buf_appendf(w->out, "n%d ", (int)node->type);
+    switch (node->type) {
+        case NodeTypeRoot:
+            write_node_list(w, &node->data.root.top_level_decls);
+            return;
+        case NodeTypeFnProto:
+            write_uint(w, node->data.fn_proto.visib_mod);
+            write_str(w, node->data.fn_proto.name);
+            write_node_list(w, &node->data.fn_proto.params);
+            write_node(w, node->data.fn_proto.return_type);
+            write_uint(w, node->data.fn_proto.is_var_args);
+            write_uint(w, node->data.fn_proto.is_extern);
+            write_uint(w, node->data.fn_proto.is_inline);
+            write_uint(w, node->data.fn_proto.cc);
+            write_node(w, node->data.fn_proto.fn_def_node);
+            write_str(w, node->data.fn_proto.lib_name);
+            write_node(w, node->data.fn_proto.align_expr);
+            return;
+        case NodeTypeFnDef:
+            write_node(w, node->data.fn_def.fn_proto);
+            write_node(w, node->data.fn_def.body);
+            return;
+        case NodeTypeParamDecl:
+            write_str(w, node->data.param_decl.name);
+            write_node(w, node->data.param_decl.type);
+            write_uint(w, node->data.param_decl.is_noalias);
+            write_uint(w, node->data.param_decl.is_inline);
+            write_uint(w, node->data.param_decl.is_var_args);
+            return;
+        case NodeTypeBlock:
+            write_node_list(w, &node->data.block.statements);
+            write_uint(w, node->data.block.last_statement_is_result_expression);
+            return;
+        case NodeTypeReturnExpr:
+            write_uint(w, node->data.return_expr.kind);
+            write_node(w, node->data.return_expr.expr);
+            return;
+        case NodeTypeVariableDeclaration:
+            write_uint(w, node->data.variable_declaration.visib_mod);
+            write_str(w, node->data.variable_declaration.symbol);
+            write_uint(w, node->data.variable_declaration.is_const);
+            write_uint(w, node->data.variable_declaration.is_inline);
+            write_uint(w, node->data.variable_declaration.is_extern);
+            write_node(w, node->data.variable_declaration.type);
+            write_node(w, node->data.variable_declaration.expr);
+            write_str(w, node->data.variable_declaration.lib_name);
+            write_node(w, node->data.variable_declaration.align_expr);
+            return;
+        case NodeTypeBinOpExpr:
+            write_node(w, node->data.bin_op_expr.op1);
+            write_uint(w, node->data.bin_op_expr.bin_op);
+            write_node(w, node->data.bin_op_expr.op2);
+            return;
+        case NodeTypeFloatLiteral:
+            write_bigfloat(w, node->data.float_literal.bigfloat);
+            write_uint(w, node->data.float_literal.overflow);
+            return;
+        case NodeTypeIntLiteral:
+            write_bigint(w, node->data.int_literal.bigint);
+            return;
+        case NodeTypeStringLiteral:
+            write_str(w, node->data.string_literal.buf);
+            write_uint(w, node->data.string_literal.c);
+            return;
+        case NodeTypeCharLiteral:
+            write_uint(w, node->data.char_literal.value);
+            return;
+        case NodeTypeSymbol:
+            write_str(w, node->data.symbol_expr.symbol);
+            return;
+        case NodeTypePrefixOpExpr:
+            write_uint(w, node->data.prefix_op_expr.prefix_op);
+            write_node(w, node->data.prefix_op_expr.primary_expr);
+            return;
+        case NodeTypeAddrOfExpr:
+            write_node(w, node->data.addr_of_expr.align_expr);
+            write_bigint(w, node->data.addr_of_expr.bit_offset_start);
+            write_bigint(w, node->data.addr_of_expr.bit_offset_end);
+            write_uint(w, node->data.addr_of_expr.is_const);
+            write_uint(w, node->data.addr_of_expr.is_volatile);
+            write_node(w, node->data.addr_of_expr.op_expr);
+            return;
+        case NodeTypeFnCallExpr:
+            write_node(w, node->data.fn_call_expr.fn_ref_expr);
+            write_node_list(w, &node->data.fn_call_expr.params);
+            write_uint(w, node->data.fn_call_expr.is_builtin);
+            return;
+        case NodeTypeArrayAccessExpr:
+            write_node(w, node->data.array_access_expr.array_ref_expr);
+            write_node(w, node->data.array_access_expr.subscript);
+            return;
+        case NodeTypeFieldAccessExpr:
+            write_node(w, node->data.field_access_expr.struct_expr);
+            write_str(w, node->data.field_access_expr.field_name);
+            return;
+        case NodeTypeBoolLiteral:
+            write_uint(w, node->data.bool_literal.value);
+            return;
+        case NodeTypeNullLiteral:
+        case NodeTypeUndefinedLiteral:
+            return;
+        case NodeTypeIfBoolExpr:
+            write_node(w, node->data.if_bool_expr.condition);
+            write_node(w, node->data.if_bool_expr.then_block);
+            write_node(w, node->data.if_bool_expr.else_node);
+            return;
+        case NodeTypeWhileExpr:
+            write_node(w, node->data.while_expr.condition);
+            write_str(w, node->data.while_expr.var_symbol);
+            write_uint(w, node->data.while_expr.var_is_ptr);
+            write_node(w, node->data.while_expr.continue_expr);
+            write_node(w, node->data.while_expr.body);
+            write_node(w, node->data.while_expr.else_node);
+            write_str(w, node->data.while_expr.err_symbol);
+            write_uint(w, node->data.while_expr.is_inline);
+            return;
+        case NodeTypeContainerDecl:
+            write_uint(w, node->data.container_decl.kind);
+            write_node_list(w, &node->data.container_decl.fields);
+            write_node_list(w, &node->data.container_decl.decls);
+            write_uint(w, node->data.container_decl.layout);
+            write_node(w, node->data.container_decl.init_arg_expr);
+            return;
+        case NodeTypeStructField:
+            write_uint(w, node->data.struct_field.visib_mod);
+            write_str(w, node->data.struct_field.name);
+            write_node(w, node->data.struct_field.type);
+            return;
+        case NodeTypeArrayType:
+            write_node(w, node->data.array_type.size);
+            write_node(w, node->data.array_type.child_type);
+            write_node(w, node->data.array_type.align_expr);
+            write_uint(w, node->data.array_type.is_const);
+            write_uint(w, node->data.array_type.is_volatile);
+            return;
+        default:
+            w->unsupported = true;
+            return;
+    }
+}
+
+struct AstReader {
+    const char *ptr;
+    const char *end;
+    ImportTableEntry *import;
+    ZigList<AstNode *> nodes;
+    bool invalid;
+};
+
+static bool read_item(AstReader *r, const char **out_start, size_t *out_len) {
+    if (r->invalid)
+        return false;
+    const char *space = reinterpret_cast<const char *>(memchr(r->ptr, ' ', r->end - r->ptr));
+    if (space == nullptr) {
+        r->invalid = true;
+        return false;
+    }
+    *out_start = r->ptr;
+    *out_len = space - r->ptr;
+    r->ptr = space + 1;
+    return true;
+}
+
+static uint64_t read_uint(AstReader *r) {
+    const char *start;
+    size_t len;
+    if (!read_item(r, &start, &len))
+        return 0;
+    uint64_t x = 0;
+    for (size_t i = 0; i < len; i += 1) {
+        if (start[i] < '0' || start[i] > '9') {
+            r->invalid = true;
+            return 0;
+        }
+        x = x * 10 + (start[i] - '0');
+    }
+    if (len == 0)
+        r->invalid = true;
+    return x;
+}
+
+static bool read_bool(AstReader *r) {
+    return read_uint(r) != 0;
+}
+
+static Buf *read_str(AstReader *r) {
+    if (r->invalid || r->ptr == r->end) {
+        r->invalid = true;
+        return nullptr;
+    }
+    if (*r->ptr == '-') {
+        const char *start;
+        size_t len;
+        read_item(r, &start, &len);
+        return nullptr;
+    }
+    const char *colon = reinterpret_cast<const char *>(memchr(r->ptr, ':', r->end - r->ptr));
+    if (colon == nullptr) {
+        r->invalid = true;
+        return nullptr;
+    }
+    size_t len = 0;
+    for (const char *c = r->ptr; c < colon; c += 1) {
+        if (*c < '0' || *c > '9') {
+            r->invalid = true;
+            return nullptr;
+        }
+        len = len * 10 + (*c - '0');
+    }
+    const char *bytes = colon + 1;
+    if ((size_t)(r->end - bytes) < len + 1 || bytes[len] != ' ') {
+        r->invalid = true;
+        return nullptr;
+    }
+    r->ptr = bytes + len + 1;
+    return buf_create_from_mem(bytes, len);
+}
+
+static BigInt *read_bigint(AstReader *r) {
+    if (r->ptr != r->end && *r->ptr == '-') {
+        const char *start;
+        size_t len;
+        read_item(r, &start, &len);
+        return nullptr;
+    }
+    bool is_negative = read_bool(r);
+    uint64_t digit_count = read_uint(r);
+    if (r->invalid || digit_count > (uint64_t)(r->end - r->ptr)) {
+        r->invalid = true;
+        return nullptr;
+    }
+    uint64_t *digits = allocate<uint64_t>(max(digit_count, (uint64_t)1));
+    for (size_t i = 0; i < digit_count; i += 1) {
+        digits[i] = read_uint(r);
+    }
+    BigInt *bigint = allocate<BigInt>(1);
+    bigint_init_data(bigint, digits, digit_count, is_negative);
+    free(digits);
+    return bigint;
+}
+
+static BigFloat *read_bigfloat(AstReader *r) {
+    uint64_t words[2];
+    words[0] = read_uint(r);
+    words[1] = read_uint(r);
+    BigFloat *bigfloat = allocate<BigFloat>(1);
+    memcpy(&bigfloat->value, words, sizeof(words));
+    return bigfloat;
+}
+
+static AstNode *read_node(AstReader *r);
+
+static void read_node_list(AstReader *r, ZigList<AstNode *> *list) {
+    uint64_t count = read_uint(r);
+    if (r->invalid || count > (uint64_t)(r->end - r->ptr)) {
+        r->invalid = true;
+        return;
+    }
+    for (size_t i = 0; i < count; i += 1) {
+        list->append(read_node(r));
+    }
+}
+
+static AstNode *read_node(AstReader *r) {
+    const char *start;
+    size_t len;
+    if (!read_item(r, &start, &len) || len == 0)
+        goto invalid;
+    if (len == 1 && start[0] == '-')
+        return nullptr;
+    if (start[0] == '@') {
+        uint64_t index = 0;
+        for (size_t i = 1; i < len; i += 1) {
+            if (start[i] < '0' || start[i] > '9')
+                goto invalid;
+            index = index * 10 + (start[i] - '0');
+        }
+        if (len == 1 || index >= r->nodes.length)
+            goto invalid;
+        return r->nodes.at(index);
+    }
+    if (start[0] != 'n')
+        goto invalid;
+
+    {
+        int type = 0;
+        for (size_t i = 1; i < len; i += 1) {
+            if (start[i] < '0' || start[i] > '9')
+                goto invalid;
+            type = type * 10 + (start[i] - '0');
+        }
+        if (len == 1 || type > NodeTypeTestExpr)
+            goto invalid;
+
+        AstNode *node = allocate<AstNode>(1);
+        node->type = (NodeType)type;
+        node->owner = r->import;
+        r->nodes.append(node);
+
+        switch (node->type) {
+            case NodeTypeRoot:
+                read_node_list(r, &node->data.root.top_level_decls);
+                break;
+            case NodeTypeFnProto:
+                node->data.fn_proto.visib_mod = (VisibMod)read_uint(r);
+                node->data.fn_proto.name = read_str(r);
+                read_node_list(r, &node->data.fn_proto.params);
+                node->data.fn_proto.return_type = read_node(r);
+                node->data.fn_proto.is_var_args = read_bool(r);
+                node->data.fn_proto.is_extern = read_bool(r);
+                node->data.fn_proto.is_inline = read_bool(r);
+                node->data.fn_proto.cc = (CallingConvention)read_uint(r);
+                node->data.fn_proto.fn_def_node = read_node(r);
+                node->data.fn_proto.lib_name = read_str(r);
+                node->data.fn_proto.align_expr = read_node(r);
+                break;
+            case NodeTypeFnDef:
+                node->data.fn_def.fn_proto = read_node(r);
+                node->data.fn_def.body = read_node(r);
+                break;
+            case NodeTypeParamDecl:
+                node->data.param_decl.name = read_str(r);
+                node->data.param_decl.type = read_node(r);
+                node->data.param_decl.is_noalias = read_bool(r);
+                node->data.param_decl.is_inline = read_bool(r);
+                node->data.param_decl.is_var_args = read_bool(r);
+                break;
+            case NodeTypeBlock:
+                read_node_list(r, &node->data.block.statements);
+                node->data.block.last_statement_is_result_expression = read_bool(r);
+                break;
+            case NodeTypeReturnExpr:
+                node->data.return_expr.kind = (ReturnKind)read_uint(r);
+                node->data.return_expr.expr = read_node(r);
+                break;
+            case NodeTypeVariableDeclaration:
+                node->data.variable_declaration.visib_mod = (VisibMod)read_uint(r);
+                node->data.variable_declaration.symbol = read_str(r);
+                node->data.variable_declaration.is_const = read_bool(r);
+                node->data.variable_declaration.is_inline = read_bool(r);
+                node->data.variable_declaration.is_extern = read_bool(r);
+                node->data.variable_declaration.type = read_node(r);
+                node->data.variable_declaration.expr = read_node(r);
+                node->data.variable_declaration.lib_name = read_str(r);
+                node->data.variable_declaration.align_expr = read_node(r);
+                break;
+            case NodeTypeBinOpExpr:
+                node->data.bin_op_expr.op1 = read_node(r);
+                node->data.bin_op_expr.bin_op = (BinOpType)read_uint(r);
+                node->data.bin_op_expr.op2 = read_node(r);
+                break;
+            case NodeTypeFloatLiteral:
+                node->data.float_literal.bigfloat = read_bigfloat(r);
+                node->data.float_literal.overflow = read_bool(r);
+                break;
+            case NodeTypeIntLiteral:
+                node->data.int_literal.bigint = read_bigint(r);
+                if (node->data.int_literal.bigint == nullptr)
+                    goto invalid;
+                break;
+            case NodeTypeStringLiteral:
+                node->data.string_literal.buf = read_str(r);
+                node->data.string_literal.c = read_bool(r);
+                break;
+            case NodeTypeCharLiteral:
+                node->data.char_literal.value = (uint8_t)read_uint(r);
+                break;
+            case NodeTypeSymbol:
+                node->data.symbol_expr.symbol = read_str(r);
+                break;
+            case NodeTypePrefixOpExpr:
+                node->data.prefix_op_expr.prefix_op = (PrefixOp)read_uint(r);
+                node->data.prefix_op_expr.primary_expr = read_node(r);
+                break;
+            case NodeTypeAddrOfExpr:
+                node->data.addr_of_expr.align_expr = read_node(r);
+                node->data.addr_of_expr.bit_offset_start = read_bigint(r);
+                node->data.addr_of_expr.bit_offset_end = read_bigint(r);
+                node->data.addr_of_expr.is_const = read_bool(r);
+                node->data.addr_of_expr.is_volatile = read_bool(r);
+                node->data.addr_of_expr.op_expr = read_node(r);
+                break;
+            case NodeTypeFnCallExpr:
+                node->data.fn_call_expr.fn_ref_expr = read_node(r);
+                read_node_list(r, &node->data.fn_call_expr.params);
+                node->data.fn_call_expr.is_builtin = read_bool(r);
+                break;
+            case NodeTypeArrayAccessExpr:
+                node->data.array_access_expr.array_ref_expr = read_node(r);
+                node->data.array_access_expr.subscript = read_node(r);
+                break;
+            case NodeTypeFieldAccessExpr:
+                node->data.field_access_expr.struct_expr = read_node(r);
+                node->data.field_access_expr.field_name = read_str(r);
+                break;
+            case NodeTypeBoolLiteral:
+                node->data.bool_literal.value = read_bool(r);
+                break;
+            case NodeTypeNullLiteral:
+            case NodeTypeUndefinedLiteral:
+                break;
+            case NodeTypeIfBoolExpr:
+                node->data.if_bool_expr.condition = read_node(r);
+                node->data.if_bool_expr.then_block = read_node(r);
+                node->data.if_bool_expr.else_node = read_node(r);
+                break;
+            case NodeTypeWhileExpr:
+                node->data.while_expr.condition = read_node(r);
+                node->data.while_expr.var_symbol = read_str(r);
+                node->data.while_expr.var_is_ptr = read_bool(r);
+                node->data.while_expr.continue_expr = read_node(r);
+                node->data.while_expr.body = read_node(r);
+                node->data.while_expr.else_node = read_node(r);
+                node->data.while_expr.err_symbol = read_str(r);
+                node->data.while_expr.is_inline = read_bool(r);
+                break;
+            case NodeTypeContainerDecl:
+                node->data.container_decl.kind = (ContainerKind)read_uint(r);
+                read_node_list(r, &node->data.container_decl.fields);
+                read_node_list(r, &node->data.container_decl.decls);
+                node->data.container_decl.layout = (ContainerLayout)read_uint(r);
+                node->data.container_decl.init_arg_expr = read_node(r);
+                break;
+            case NodeTypeStructField:
+                node->data.struct_field.visib_mod = (VisibMod)read_uint(r);
+                node->data.struct_field.name = read_str(r);
+                node->data.struct_field.type = read_node(r);
+                break;
+            case NodeTypeArrayType:
+                node->data.array_type.size = read_node(r);
+                node->data.array_type.child_type = read_node(r);
+                node->data.array_type.align_expr = read_node(r);
+                node->data.array_type.is_const = read_bool(r);
+                node->data.array_type.is_volatile = read_bool(r);
+                break;
+            default:
+                goto invalid;
+        }
+        return node;
+    }
+
+invalid:
+    r->invalid = true;
+    return nullptr;
+}
+
+static void get_entry_paths(CodeGen *g, Buf *key, Buf *out_entry_path, Buf *out_manifest_path) {
+    Buf *dir = buf_alloc();
+    os_path_join(g->cache_dir, buf_create_from_str("c_import"), dir);
+    os_path_join(dir, buf_sprintf("%s.ast", buf_ptr(key)), out_entry_path);
+    os_path_join(dir, buf_sprintf("%s.manifest", buf_ptr(key)), out_manifest_path);
+}
+
+void c_import_cache_key(CodeGen *g, Buf *c_source, ZigList<const char *> *clang_argv, Buf *out_key) {
+    CacheHash ch;
+    cache_hash_init(&ch);
+    cache_hash_add_compiler(&ch);
+    cache_hash_add_buf(&ch, &g->triple_str);
+    cache_hash_add_buf(&ch, c_source);
+    for (size_t i = 0; i < clang_argv->length; i += 1) {
+        cache_hash_add_str(&ch, clang_argv->at(i));
+    }
+    buf_resize(out_key, 0);
+    cache_hash_final(&ch, out_key);
+}
+
+bool c_import_cache_get(CodeGen *g, Buf *key, ImportTableEntry *import, ZigList<Buf *> *out_header_paths) {
+    if (g->cache_dir == nullptr)
+        return false;
+    Buf entry_path = BUF_INIT;
+    Buf manifest_path = BUF_INIT;
+    get_entry_paths(g, key, &entry_path, &manifest_path);
+    ZigList<Buf *> header_paths = {0};
+    if (!cache_manifest_check(&manifest_path, &header_paths))
+        return false;
+
+    Buf contents = BUF_INIT;
+    if (os_fetch_file_path(&entry_path, &contents))
+        return false;
+    size_t magic_len = strlen(cache_entry_magic);
+    if (buf_len(&contents) < magic_len || memcmp(buf_ptr(&contents), cache_entry_magic, magic_len) != 0)
+        return false;
+
+    AstReader reader = {0};
+    reader.ptr = buf_ptr(&contents) + magic_len;
+    reader.end = buf_ptr(&contents) + buf_len(&contents);
+    reader.import = import;
+    AstNode *root = read_node(&reader);
+    bool ok = !reader.invalid && reader.ptr == reader.end && root != nullptr && root->type == NodeTypeRoot;
+    reader.nodes.deinit();
+    buf_deinit(&contents);
+    if (!ok)
+        return false;
+    import->root = root;
+    for (size_t i = 0; i < header_paths.length; i += 1) {
+        out_header_paths->append(header_paths.at(i));
+    }
+    header_paths.deinit();
+    return true;
+}
+
+void c_import_cache_put(CodeGen *g, Buf *key, ImportTableEntry *import, ZigList<Buf *> *header_paths) {
+    if (g->cache_dir == nullptr || header_paths->length == 0)
+        return;
+
+    AstWriter writer = {0};
+    writer.out = buf_create_from_str(cache_entry_magic);
+    writer.node_index.init(256);
+    write_node(&writer, import->root);
+    writer.node_index.deinit();
+    if (writer.unsupported)
+        return;
+
+    Buf entry_path = BUF_INIT;
+    Buf manifest_path = BUF_INIT;
+    get_entry_paths(g, key, &entry_path, &manifest_path);
+    Buf entry_dir = BUF_INIT;
+    os_path_dirname(&entry_path, &entry_dir);
+    if (os_make_path(&entry_dir))
+        return;
+
+    // the manifest goes last so that a half written entry is never used
+    os_write_file(&entry_path, writer.out);
+    cache_manifest_write(&manifest_path, header_paths);
+}
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef ZIG_C_IMPORT_CACHE_HPP
+#define ZIG_C_IMPORT_CACHE_HPP
+
+#include "all_types.hpp"
+
+// The AST which parsec translates from an @cImport block is saved in the c_import
+// directory of the cache dir. An entry is keyed by the C source of the block and
+// the clang arguments, and is reused while every file clang read for the
+// translation still has the same contents.
+
+void c_import_cache_key(CodeGen *g, Buf *c_source, ZigList<const char *> *clang_argv, Buf *out_key);
+
+// Returns true if import->root was set to the AST of a previous translation, in
+// which case the files that translation depended on are appended to out_header_paths.
+bool c_import_cache_get(CodeGen *g, Buf *key, ImportTableEntry *import, ZigList<Buf *> *out_header_paths);
+// header_paths are the files the translation depends on.
+void c_import_cache_put(CodeGen *g, Buf *key, ImportTableEntry *import, ZigList<Buf *> *header_paths);
+
+#endif
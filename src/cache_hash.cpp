@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "cache_hash.hpp"
+#include "config.h"
+#include "os.hpp"
+
+#include <stdio.h>
+
+static const uint64_t fnv_offset_basis = 14695981039346656037ULL;
+static const uint64_t fnv_prime = 1099511628211ULL;
+
+void cache_hash_init(CacheHash *ch) {
+    ch->value = fnv_offset_basis;
+}
+
+void cache_hash_add_mem(CacheHash *ch, const void *ptr, size_t len) {
+    const uint8_t *bytes = (const uint8_t *)ptr;
+    uint64_t h = ch->value;
+    for (size_t i = 0; i < len; i += 1) {
+        h = h ^ bytes[i];
+        h = h * fnv_prime;
+    }
+    ch->value = h;
+}
+
+void cache_hash_add_str(CacheHash *ch, const char *str) {
+    // include the terminator so that adjacent strings cannot run together
+    cache_hash_add_mem(ch, str, strlen(str) + 1);
+}
+
+void cache_hash_add_buf(CacheHash *ch, Buf *buf) {
+    cache_hash_add_mem(ch, buf_ptr(buf), buf_len(buf) + 1);
+}
+
+void cache_hash_add_int(CacheHash *ch, uint64_t x) {
+    uint8_t bytes[8];
+    for (size_t i = 0; i < 8; i += 1) {
+        bytes[i] = (uint8_t)(x >> (i * 8));
+    }
+    cache_hash_add_mem(ch, bytes, 8);
+}
+
+void cache_hash_add_bool(CacheHash *ch, bool b) {
+    uint8_t byte = b ? 1 : 0;
+    cache_hash_add_mem(ch, &byte, 1);
+}
+
+void cache_hash_final(CacheHash *ch, Buf *out_hex) {
+    buf_appendf(out_hex, "%016" ZIG_PRI_x64, ch->value);
+}
+
+uint64_t cache_hash_buf(Buf *contents) {
+    CacheHash ch;
+    cache_hash_init(&ch);
+    cache_hash_add_mem(&ch, buf_ptr(contents), buf_len(contents));
+    return ch.value;
+}
+
+struct CompilerId {
+    Buf *path;
+    uint64_t hash;
+    bool known;
+};
+
+static CompilerId get_compiler_id(void) {
+    CompilerId id = {};
+    id.path = buf_alloc();
+    Buf contents = BUF_INIT;
+    if (os_self_exe_path(id.path) == 0 && os_fetch_file_path(id.path, &contents) == 0) {
+        id.hash = cache_hash_buf(&contents);
+        id.known = true;
+    }
+    buf_deinit(&contents);
+    return id;
+}
+
+bool cache_compiler_hash(Buf **out_path, uint64_t *out_hash) {
+    // initialized once even when several threads get here first
+    static const CompilerId id = get_compiler_id();
+    *out_path = id.path;
+    *out_hash = id.hash;
+    return id.known;
+}
+
+void cache_hash_add_compiler(CacheHash *ch) {
+    cache_hash_add_str(ch, ZIG_VERSION_STRING);
+    Buf *path;
+    uint64_t hash;
+    if (cache_compiler_hash(&path, &hash)) {
+        cache_hash_add_int(ch, hash);
+    } else {
+        static const double start_time = os_get_time();
+        cache_hash_add_mem(ch, &start_time, sizeof(start_time));
+    }
+}
+
+bool cache_manifest_check(Buf *manifest_path, ZigList<Buf *> *out_input_paths) {
+    Buf manifest = BUF_INIT;
+    if (os_fetch_file_path(manifest_path, &manifest))
+        return false;
+
+    Buf contents = BUF_INIT;
+    Buf file_path = BUF_INIT;
+    size_t line_start = 0;
+    size_t entry_count = 0;
+    while (line_start < buf_len(&manifest)) {
+        const char *line = buf_ptr(&manifest) + line_start;
+        const char *newline = strchr(line, '\n');
+        if (newline == nullptr)
+            return false;
+        size_t line_len = newline - line;
+        line_start += line_len + 1;
+
+        // 16 hex digits, a space, and at least one byte of path
+        if (line_len < 18 || line[16] != ' ')
+            return false;
+
+        char *hex_end;
+        uint64_t expected_hash = strtoull(line, &hex_end, 16);
+        if (hex_end != line + 16)
+            return false;
+
+        buf_init_from_mem(&file_path, line + 17, line_len - 17);
+        if (os_fetch_file_path(&file_path, &contents))
+            return false;
+        if (cache_hash_buf(&contents) != expected_hash)
+            return false;
+
+        entry_count += 1;
+    }
+    if (entry_count == 0)
+        return false;
+
+    if (out_input_paths != nullptr) {
+        line_start = 0;
+        while (line_start < buf_len(&manifest)) {
+            const char *line = buf_ptr(&manifest) + line_start;
+            size_t line_len = strchr(line, '\n') - line;
+            line_start += line_len + 1;
+            out_input_paths->append(buf_create_from_mem(line + 17, line_len - 17));
+        }
+    }
+    return true;
+}
+
+int cache_manifest_write(Buf *manifest_path, ZigList<Buf *> *input_paths) {
+    Buf *manifest = buf_alloc();
+    Buf contents = BUF_INIT;
+    int err;
+    for (size_t i = 0; i < input_paths->length; i += 1) {
+        Buf *input_path = input_paths->at(i);
+        if ((err = os_fetch_file_path(input_path, &contents)))
+            return err;
+        buf_appendf(manifest, "%016" ZIG_PRI_x64 " %s\n", cache_hash_buf(&contents), buf_ptr(input_path));
+    }
+    return os_write_file_atomic(manifest_path, manifest);
+}
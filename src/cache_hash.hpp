@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef ZIG_CACHE_HASH_HPP
+#define ZIG_CACHE_HASH_HPP
+
+#include "buffer.hpp"
+#include "list.hpp"
+
+#include <stdint.h>
+
+// Incremental FNV-1a 64-bit hash used to compute keys for on-disk build artifacts.
+// This is not a cryptographic hash; cache entries are additionally validated by
+// comparing the content hashes of their input files.
+struct CacheHash {
+    uint64_t value;
+};
+
+void cache_hash_init(CacheHash *ch);
+void cache_hash_add_mem(CacheHash *ch, const void *ptr, size_t len);
+void cache_hash_add_str(CacheHash *ch, const char *str);
+void cache_hash_add_buf(CacheHash *ch, Buf *buf);
+void cache_hash_add_int(CacheHash *ch, uint64_t x);
+void cache_hash_add_bool(CacheHash *ch, bool b);
+// appends the hash as 16 lowercase hex digits
+void cache_hash_final(CacheHash *ch, Buf *out_hex);
+
+uint64_t cache_hash_buf(Buf *contents);
+
+// Sets out_path to the running compiler binary and out_hash to the hash of its
+// contents. Returns false if the binary can not be found or read. The binary is
+// read at most once per process.
+bool cache_compiler_hash(Buf **out_path, uint64_t *out_hash);
+// Adds ZIG_VERSION_STRING and the hash of the compiler binary; the version alone
+// stays the same when the compiler is rebuilt. If the binary can not be read a
+// value unique to this process is added, so that nothing it caches is reused.
+void cache_hash_add_compiler(CacheHash *ch);
+
+// A manifest is a text file with one "<hash> <path>" line per input file.
+// Returns true only if the manifest exists and every listed file still has
+// the recorded content hash. If out_input_paths is not null the listed paths
+// are appended to it when the check passes.
+bool cache_manifest_check(Buf *manifest_path, ZigList<Buf *> *out_input_paths);
+int cache_manifest_write(Buf *manifest_path, ZigList<Buf *> *input_paths);
+
+#endif
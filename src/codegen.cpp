@@ -7,7 +7,9 @@
 
 #include "analyze.hpp"
 #include "ast_render.hpp"
+#include "cache_hash.hpp"
 #include "codegen.hpp"
+#include "comptime_cache.hpp"
 #include "config.h"
 #include "errmsg.hpp"
 #include "error.hpp"
@@ -16,7 +18,9 @@
 #include "link.hpp"
 #include "os.hpp"
 #include "parsec.hpp"
+#include "source_cache.hpp"
 #include "target.hpp"
+#include "time_report.hpp"
 #include "zig_llvm.hpp"
 
 #include <stdio.h>
@@ -73,7 +77,9 @@ CodeGen *codegen_create(Buf *root_src_path, const ZigTarget *target, OutType out
     g->build_mode = build_mode;
     g->out_type = out_type;
     g->import_table.init(32);
-    g->builtin_fn_table.init(32);
+    g->c_import_table.init(8);
+    g->builtin_fn_table.init(128);
+    g->intern_table = source_cache_intern_table();
     g->primitive_type_table.init(32);
     g->type_table.init(32);
     g->fn_type_table.init(32);
@@ -85,6 +91,7 @@ CodeGen *codegen_create(Buf *root_src_path, const ZigTarget *target, OutType out
     g->external_prototypes.init(8);
     g->is_test_build = false;
     g->want_h_file = (out_type == OutTypeObj || out_type == OutTypeLib);
+    g->want_comptime_cache = true;
 
     buf_resize(&g->global_asm, 0);
 
@@ -158,6 +165,10 @@ CodeGen *codegen_create(Buf *root_src_path, const ZigTarget *target, OutType out
 
 void codegen_destroy(CodeGen *codegen) {
     LLVMDisposeTargetMachine(codegen->target_machine);
+    arena_deinit(&codegen->codegen_arena);
+    arena_deinit(&codegen->ir_arena);
+    arena_deinit(&codegen->analysis_arena);
+    arena_deinit(&codegen->ast_arena);
 }
 
 void codegen_set_output_h_path(CodeGen *g, Buf *h_path) {
@@ -200,6 +211,22 @@ void codegen_set_verbose(CodeGen *g, bool verbose) {
     g->verbose = verbose;
 }
 
+void codegen_set_time_report(CodeGen *g, Buf *trace_path) {
+    g->time_report = time_report_create(trace_path);
+}
+
+void codegen_set_codegen_threads(CodeGen *g, size_t thread_count) {
+    g->codegen_threads = thread_count;
+}
+
+void codegen_set_lto(CodeGen *g, ZigLLVMLTOMode lto_mode) {
+    g->lto_mode = lto_mode;
+}
+
+void codegen_set_ir_gen_threads(CodeGen *g, size_t thread_count) {
+    g->ir_gen_threads = thread_count;
+}
+
 void codegen_set_each_lib_rpath(CodeGen *g, bool each_lib_rpath) {
     g->each_lib_rpath = each_lib_rpath;
 }
@@ -394,6 +421,17 @@ static void add_uwtable_attr(CodeGen *g, LLVMValueRef fn_val) {
     }
 }
 
+// The linker generates code for bitcode functions, so it needs to know what
+// CPU they were compiled for.
+static void add_lto_target_attrs(CodeGen *g, LLVMValueRef fn_val) {
+    if (g->lto_mode == ZigLLVMLTOModeNone)
+        return;
+    if (g->target_cpu[0] != 0)
+        addLLVMFnAttrStr(fn_val, "target-cpu", g->target_cpu);
+    if (g->target_features[0] != 0)
+        addLLVMFnAttrStr(fn_val, "target-features", g->target_features);
+}
+
 static LLVMValueRef fn_llvm_value(CodeGen *g, FnTableEntry *fn_table_entry) {
     if (fn_table_entry->llvm_value)
         return fn_table_entry->llvm_value;
@@ -467,6 +505,10 @@ static LLVMValueRef fn_llvm_value(CodeGen *g, FnTableEntry *fn_table_entry) {
         addLLVMFnAttr(fn_table_entry->llvm_value, "noreturn");
     }
 
+    if (fn_table_entry == g->panic_fn) {
+        addLLVMFnAttr(fn_table_entry->llvm_value, "cold");
+    }
+
     if (fn_table_entry->body_node != nullptr) {
         bool want_fn_safety = g->build_mode != BuildModeFastRelease && !fn_table_entry->def_scope->safety_off;
         if (want_fn_safety) {
@@ -484,7 +526,8 @@ static LLVMValueRef fn_llvm_value(CodeGen *g, FnTableEntry *fn_table_entry) {
     addLLVMFnAttr(fn_table_entry->llvm_value, "nounwind");
     add_uwtable_attr(g, fn_table_entry->llvm_value);
     addLLVMFnAttr(fn_table_entry->llvm_value, "nobuiltin");
-    if (g->build_mode == BuildModeDebug && fn_table_entry->fn_inline != FnInlineAlways) {
+    add_lto_target_attrs(g, fn_table_entry->llvm_value);
+    if (build_mode_is_debug(g->build_mode) && fn_table_entry->fn_inline != FnInlineAlways) {
         ZigLLVMAddFunctionAttr(fn_table_entry->llvm_value, "no-frame-pointer-elim", "true");
         ZigLLVMAddFunctionAttr(fn_table_entry->llvm_value, "no-frame-pointer-elim-non-leaf", nullptr);
     }
@@ -523,7 +566,7 @@ static ZigLLVMDIScope *get_di_scope(CodeGen *g, Scope *scope) {
             unsigned scope_line = line_number;
             bool is_definition = fn_table_entry->body_node != nullptr;
             unsigned flags = 0;
-            bool is_optimized = g->build_mode != BuildModeDebug;
+            bool is_optimized = !build_mode_is_debug(g->build_mode);
             bool is_internal_linkage = (fn_table_entry->linkage == GlobalLinkageIdInternal);
             ZigLLVMDISubprogram *subprogram = ZigLLVMCreateFunction(g->dbuilder,
                 get_di_scope(g, scope->parent), buf_ptr(&fn_table_entry->symbol_name), "",
@@ -702,43 +745,64 @@ static LLVMValueRef get_handle_value(CodeGen *g, LLVMValueRef ptr, TypeTableEntr
     }
 }
 
+// Walks up to the nearest scope which sets the float mode or already knows it,
+// then memoizes the result in every scope on the way, so that the blocks of a
+// deeply nested function are each walked once.
+static bool scope_want_fast_math(Scope *scope) {
+    bool want_fast_math = true;
+    Scope *found = scope;
+    for (; found != nullptr; found = found->parent) {
+        if (found->fast_math_memoized) {
+            want_fast_math = found->want_fast_math;
+            break;
+        } else if (found->id == ScopeIdBlock && ((ScopeBlock *)found)->fast_math_set_node) {
+            want_fast_math = !((ScopeBlock *)found)->fast_math_off;
+            break;
+        } else if (found->id == ScopeIdDecls && ((ScopeDecls *)found)->fast_math_set_node) {
+            want_fast_math = !((ScopeDecls *)found)->fast_math_off;
+            break;
+        }
+    }
+    Scope *stop = (found != nullptr) ? found->parent : nullptr;
+    for (Scope *it = scope; it != stop; it = it->parent) {
+        it->fast_math_memoized = true;
+        it->want_fast_math = want_fast_math;
+    }
+    return want_fast_math;
+}
+
 static bool ir_want_fast_math(CodeGen *g, IrInstruction *instruction) {
-    // TODO memoize
-    Scope *scope = instruction->scope;
-    while (scope) {
-        if (scope->id == ScopeIdBlock) {
-            ScopeBlock *block_scope = (ScopeBlock *)scope;
-            if (block_scope->fast_math_set_node)
-                return !block_scope->fast_math_off;
-        } else if (scope->id == ScopeIdDecls) {
-            ScopeDecls *decls_scope = (ScopeDecls *)scope;
-            if (decls_scope->fast_math_set_node)
-                return !decls_scope->fast_math_off;
+    return scope_want_fast_math(instruction->scope);
+}
+
+// Like scope_want_fast_math, for @setDebugSafety.
+static bool scope_want_debug_safety(Scope *scope) {
+    bool want_safety = true;
+    Scope *found = scope;
+    for (; found != nullptr; found = found->parent) {
+        if (found->safety_memoized) {
+            want_safety = found->want_safety;
+            break;
+        } else if (found->id == ScopeIdBlock && ((ScopeBlock *)found)->safety_set_node) {
+            want_safety = !((ScopeBlock *)found)->safety_off;
+            break;
+        } else if (found->id == ScopeIdDecls && ((ScopeDecls *)found)->safety_set_node) {
+            want_safety = !((ScopeDecls *)found)->safety_off;
+            break;
         }
-        scope = scope->parent;
     }
-    return true;
+    Scope *stop = (found != nullptr) ? found->parent : nullptr;
+    for (Scope *it = scope; it != stop; it = it->parent) {
+        it->safety_memoized = true;
+        it->want_safety = want_safety;
+    }
+    return want_safety;
 }
 
 static bool ir_want_debug_safety(CodeGen *g, IrInstruction *instruction) {
     if (g->build_mode == BuildModeFastRelease)
         return false;
-
-    // TODO memoize
-    Scope *scope = instruction->scope;
-    while (scope) {
-        if (scope->id == ScopeIdBlock) {
-            ScopeBlock *block_scope = (ScopeBlock *)scope;
-            if (block_scope->safety_set_node)
-                return !block_scope->safety_off;
-        } else if (scope->id == ScopeIdDecls) {
-            ScopeDecls *decls_scope = (ScopeDecls *)scope;
-            if (decls_scope->safety_set_node)
-                return !decls_scope->safety_off;
-        }
-        scope = scope->parent;
-    }
-    return true;
+    return scope_want_debug_safety(instruction->scope);
 }
 
 static Buf *panic_msg_buf(PanicMsgId msg_id) {
@@ -808,6 +872,45 @@ static void gen_debug_safety_crash(CodeGen *g, PanicMsgId msg_id) {
     gen_panic(g, get_panic_msg_ptr_val(g, msg_id));
 }
 
+// Returns a block which crashes with msg_id. In debug builds every check gets its own block,
+// so that the stack trace points at the check which failed. Otherwise the checks of a
+// function which fail with the same message share one block.
+static LLVMBasicBlockRef get_safety_crash_block(CodeGen *g, PanicMsgId msg_id) {
+    bool shared = !build_mode_is_debug(g->build_mode);
+    if (shared && g->cur_fn_safety_crash_blocks[msg_id] != nullptr)
+        return g->cur_fn_safety_crash_blocks[msg_id];
+
+    LLVMBasicBlockRef prev_block = LLVMGetInsertBlock(g->builder);
+    LLVMValueRef prev_debug_location = LLVMGetCurrentDebugLocation(g->builder);
+    LLVMBasicBlockRef crash_block = LLVMAppendBasicBlock(g->cur_fn_val, "SafetyCheckFail");
+    LLVMPositionBuilderAtEnd(g->builder, crash_block);
+    if (shared) {
+        // line 0 because the block does not belong to any one check
+        ZigLLVMSetCurrentDebugLocation(g->builder, 0, 0, get_di_scope(g, &g->cur_fn->fndef_scope->base));
+        g->cur_fn_safety_crash_blocks[msg_id] = crash_block;
+    }
+    gen_debug_safety_crash(g, msg_id);
+
+    LLVMPositionBuilderAtEnd(g->builder, prev_block);
+    LLVMSetCurrentDebugLocation(g->builder, prev_debug_location);
+    return crash_block;
+}
+
+// Safety checks are expected to pass; the branch weights, which are the ones clang uses for
+// __builtin_expect, move the crash code out of the hot path.
+static void gen_safety_cond_br(CodeGen *g, LLVMValueRef ok_bit, LLVMBasicBlockRef ok_block,
+        LLVMBasicBlockRef fail_block)
+{
+    ZigLLVMBuildCondBrWeighted(g->builder, ok_bit, ok_block, fail_block, 2000, 1);
+}
+
+// Crashes with msg_id unless ok_bit is true and continues in a new block named ok_name.
+static void add_safety_check(CodeGen *g, LLVMValueRef ok_bit, PanicMsgId msg_id, const char *ok_name) {
+    LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, ok_name);
+    gen_safety_cond_br(g, ok_bit, ok_block, get_safety_crash_block(g, msg_id));
+    LLVMPositionBuilderAtEnd(g->builder, ok_block);
+}
+
 static LLVMValueRef get_memcpy_fn_val(CodeGen *g) {
     if (g->memcpy_fn_val)
         return g->memcpy_fn_val;
@@ -839,7 +942,7 @@ static LLVMValueRef get_safety_crash_err_fn(CodeGen *g) {
 
     size_t unwrap_err_msg_text_len = strlen(unwrap_err_msg_text);
     size_t err_buf_len = strlen(unwrap_err_msg_text) + g->largest_err_name_len;
-    LLVMValueRef *err_buf_vals = allocate<LLVMValueRef>(err_buf_len);
+    LLVMValueRef *err_buf_vals = arena_allocate<LLVMValueRef>(&g->codegen_arena, err_buf_len);
     size_t i = 0;
     for (; i < unwrap_err_msg_text_len; i += 1) {
         err_buf_vals[i] = LLVMConstInt(LLVMInt8Type(), unwrap_err_msg_text[i], false);
@@ -893,7 +996,8 @@ static LLVMValueRef get_safety_crash_err_fn(CodeGen *g) {
     LLVMSetFunctionCallConv(fn_val, get_llvm_cc(g, CallingConventionUnspecified));
     addLLVMFnAttr(fn_val, "nounwind");
     add_uwtable_attr(g, fn_val);
-    if (g->build_mode == BuildModeDebug) {
+    add_lto_target_attrs(g, fn_val);
+    if (build_mode_is_debug(g->build_mode)) {
         ZigLLVMAddFunctionAttr(fn_val, "no-frame-pointer-elim", "true");
         ZigLLVMAddFunctionAttr(fn_val, "no-frame-pointer-elim-non-leaf", nullptr);
     }
@@ -966,21 +1070,18 @@ static void add_bounds_check(CodeGen *g, LLVMValueRef target_val,
         upper_value = nullptr;
     }
 
-    LLVMBasicBlockRef bounds_check_fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "BoundsCheckFail");
+    LLVMBasicBlockRef bounds_check_fail_block = get_safety_crash_block(g, PanicMsgIdBoundsCheckFailure);
     LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "BoundsCheckOk");
     LLVMBasicBlockRef lower_ok_block = upper_value ?
         LLVMAppendBasicBlock(g->cur_fn_val, "FirstBoundsCheckOk") : ok_block;
 
     LLVMValueRef lower_ok_val = LLVMBuildICmp(g->builder, lower_pred, target_val, lower_value, "");
-    LLVMBuildCondBr(g->builder, lower_ok_val, lower_ok_block, bounds_check_fail_block);
-
-    LLVMPositionBuilderAtEnd(g->builder, bounds_check_fail_block);
-    gen_debug_safety_crash(g, PanicMsgIdBoundsCheckFailure);
+    gen_safety_cond_br(g, lower_ok_val, lower_ok_block, bounds_check_fail_block);
 
     if (upper_value) {
         LLVMPositionBuilderAtEnd(g->builder, lower_ok_block);
         LLVMValueRef upper_ok_val = LLVMBuildICmp(g->builder, upper_pred, target_val, upper_value, "");
-        LLVMBuildCondBr(g->builder, upper_ok_val, ok_block, bounds_check_fail_block);
+        gen_safety_cond_br(g, upper_ok_val, ok_block, bounds_check_fail_block);
     }
 
     LLVMPositionBuilderAtEnd(g->builder, ok_block);
@@ -1009,15 +1110,7 @@ static LLVMValueRef gen_widen_or_shorten(CodeGen *g, bool want_debug_safety, Typ
     {
         LLVMValueRef zero = LLVMConstNull(actual_type->type_ref);
         LLVMValueRef ok_bit = LLVMBuildICmp(g->builder, LLVMIntSGE, expr_val, zero, "");
-
-        LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "SignCastOk");
-        LLVMBasicBlockRef fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "SignCastFail");
-        LLVMBuildCondBr(g->builder, ok_bit, ok_block, fail_block);
-
-        LLVMPositionBuilderAtEnd(g->builder, fail_block);
-        gen_debug_safety_crash(g, PanicMsgIdCastNegativeToUnsigned);
-
-        LLVMPositionBuilderAtEnd(g->builder, ok_block);
+        add_safety_check(g, ok_bit, PanicMsgIdCastNegativeToUnsigned, "SignCastOk");
     }
 
     if (actual_bits == wanted_bits) {
@@ -1049,14 +1142,7 @@ static LLVMValueRef gen_widen_or_shorten(CodeGen *g, bool want_debug_safety, Typ
                 orig_val = LLVMBuildZExt(g->builder, trunc_val, actual_type->type_ref, "");
             }
             LLVMValueRef ok_bit = LLVMBuildICmp(g->builder, LLVMIntEQ, expr_val, orig_val, "");
-            LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "CastShortenOk");
-            LLVMBasicBlockRef fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "CastShortenFail");
-            LLVMBuildCondBr(g->builder, ok_bit, ok_block, fail_block);
-
-            LLVMPositionBuilderAtEnd(g->builder, fail_block);
-            gen_debug_safety_crash(g, PanicMsgIdCastTruncatedData);
-
-            LLVMPositionBuilderAtEnd(g->builder, ok_block);
+            add_safety_check(g, ok_bit, PanicMsgIdCastTruncatedData, "CastShortenOk");
             return trunc_val;
         } else {
             zig_unreachable();
@@ -1077,14 +1163,8 @@ static LLVMValueRef gen_overflow_op(CodeGen *g, TypeTableEntry *type_entry, AddS
     LLVMValueRef result_struct = LLVMBuildCall(g->builder, fn_val, params, 2, "");
     LLVMValueRef result = LLVMBuildExtractValue(g->builder, result_struct, 0, "");
     LLVMValueRef overflow_bit = LLVMBuildExtractValue(g->builder, result_struct, 1, "");
-    LLVMBasicBlockRef fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "OverflowFail");
-    LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "OverflowOk");
-    LLVMBuildCondBr(g->builder, overflow_bit, fail_block, ok_block);
-
-    LLVMPositionBuilderAtEnd(g->builder, fail_block);
-    gen_debug_safety_crash(g, PanicMsgIdIntegerOverflow);
-
-    LLVMPositionBuilderAtEnd(g->builder, ok_block);
+    LLVMValueRef ok_bit = LLVMBuildNot(g->builder, overflow_bit, "");
+    add_safety_check(g, ok_bit, PanicMsgIdIntegerOverflow, "OverflowOk");
     return result;
 }
 
@@ -1259,15 +1339,7 @@ static LLVMValueRef gen_overflow_shl_op(CodeGen *g, TypeTableEntry *type_entry,
         orig_val = LLVMBuildLShr(g->builder, result, val2, "");
     }
     LLVMValueRef ok_bit = LLVMBuildICmp(g->builder, LLVMIntEQ, val1, orig_val, "");
-
-    LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "OverflowOk");
-    LLVMBasicBlockRef fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "OverflowFail");
-    LLVMBuildCondBr(g->builder, ok_bit, ok_block, fail_block);
-
-    LLVMPositionBuilderAtEnd(g->builder, fail_block);
-    gen_debug_safety_crash(g, PanicMsgIdShlOverflowedBits);
-
-    LLVMPositionBuilderAtEnd(g->builder, ok_block);
+    add_safety_check(g, ok_bit, PanicMsgIdShlOverflowedBits, "OverflowOk");
     return result;
 }
 
@@ -1284,15 +1356,7 @@ static LLVMValueRef gen_overflow_shr_op(CodeGen *g, TypeTableEntry *type_entry,
     }
     LLVMValueRef orig_val = LLVMBuildShl(g->builder, result, val2, "");
     LLVMValueRef ok_bit = LLVMBuildICmp(g->builder, LLVMIntEQ, val1, orig_val, "");
-
-    LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "OverflowOk");
-    LLVMBasicBlockRef fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "OverflowFail");
-    LLVMBuildCondBr(g->builder, ok_bit, ok_block, fail_block);
-
-    LLVMPositionBuilderAtEnd(g->builder, fail_block);
-    gen_debug_safety_crash(g, PanicMsgIdShrOverflowedBits);
-
-    LLVMPositionBuilderAtEnd(g->builder, ok_block);
+    add_safety_check(g, ok_bit, PanicMsgIdShrOverflowedBits, "OverflowOk");
     return result;
 }
 
@@ -1340,39 +1404,25 @@ static LLVMValueRef gen_div(CodeGen *g, bool want_debug_safety, bool want_fast_m
 
     LLVMValueRef zero = LLVMConstNull(type_entry->type_ref);
     if (want_debug_safety && (want_fast_math || type_entry->id != TypeTableEntryIdFloat)) {
-        LLVMValueRef is_zero_bit;
+        LLVMValueRef non_zero_bit;
         if (type_entry->id == TypeTableEntryIdInt) {
-            is_zero_bit = LLVMBuildICmp(g->builder, LLVMIntEQ, val2, zero, "");
+            non_zero_bit = LLVMBuildICmp(g->builder, LLVMIntNE, val2, zero, "");
         } else if (type_entry->id == TypeTableEntryIdFloat) {
-            is_zero_bit = LLVMBuildFCmp(g->builder, LLVMRealOEQ, val2, zero, "");
+            non_zero_bit = LLVMBuildFCmp(g->builder, LLVMRealUNE, val2, zero, "");
         } else {
             zig_unreachable();
         }
-        LLVMBasicBlockRef div_zero_ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "DivZeroOk");
-        LLVMBasicBlockRef div_zero_fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "DivZeroFail");
-        LLVMBuildCondBr(g->builder, is_zero_bit, div_zero_fail_block, div_zero_ok_block);
-
-        LLVMPositionBuilderAtEnd(g->builder, div_zero_fail_block);
-        gen_debug_safety_crash(g, PanicMsgIdDivisionByZero);
-
-        LLVMPositionBuilderAtEnd(g->builder, div_zero_ok_block);
+        add_safety_check(g, non_zero_bit, PanicMsgIdDivisionByZero, "DivZeroOk");
 
         if (type_entry->id == TypeTableEntryIdInt && type_entry->data.integral.is_signed) {
             LLVMValueRef neg_1_value = LLVMConstInt(type_entry->type_ref, -1, true);
             BigInt int_min_bi = {0};
             eval_min_max_value_int(g, type_entry, &int_min_bi, false);
             LLVMValueRef int_min_value = bigint_to_llvm_const(type_entry->type_ref, &int_min_bi);
-            LLVMBasicBlockRef overflow_ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "DivOverflowOk");
-            LLVMBasicBlockRef overflow_fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "DivOverflowFail");
-            LLVMValueRef num_is_int_min = LLVMBuildICmp(g->builder, LLVMIntEQ, val1, int_min_value, "");
-            LLVMValueRef den_is_neg_1 = LLVMBuildICmp(g->builder, LLVMIntEQ, val2, neg_1_value, "");
-            LLVMValueRef overflow_fail_bit = LLVMBuildAnd(g->builder, num_is_int_min, den_is_neg_1, "");
-            LLVMBuildCondBr(g->builder, overflow_fail_bit, overflow_fail_block, overflow_ok_block);
-
-            LLVMPositionBuilderAtEnd(g->builder, overflow_fail_block);
-            gen_debug_safety_crash(g, PanicMsgIdIntegerOverflow);
-
-            LLVMPositionBuilderAtEnd(g->builder, overflow_ok_block);
+            LLVMValueRef num_not_int_min = LLVMBuildICmp(g->builder, LLVMIntNE, val1, int_min_value, "");
+            LLVMValueRef den_not_neg_1 = LLVMBuildICmp(g->builder, LLVMIntNE, val2, neg_1_value, "");
+            LLVMValueRef ok_bit = LLVMBuildOr(g->builder, num_not_int_min, den_not_neg_1, "");
+            add_safety_check(g, ok_bit, PanicMsgIdIntegerOverflow, "DivOverflowOk");
         }
     }
 
@@ -1384,16 +1434,8 @@ static LLVMValueRef gen_div(CodeGen *g, bool want_debug_safety, bool want_fast_m
             case DivKindExact:
                 if (want_debug_safety) {
                     LLVMValueRef floored = gen_floor(g, result, type_entry);
-                    LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "DivExactOk");
-                    LLVMBasicBlockRef fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "DivExactFail");
                     LLVMValueRef ok_bit = LLVMBuildFCmp(g->builder, LLVMRealOEQ, floored, result, "");
-
-                    LLVMBuildCondBr(g->builder, ok_bit, ok_block, fail_block);
-
-                    LLVMPositionBuilderAtEnd(g->builder, fail_block);
-                    gen_debug_safety_crash(g, PanicMsgIdExactDivisionRemainder);
-
-                    LLVMPositionBuilderAtEnd(g->builder, ok_block);
+                    add_safety_check(g, ok_bit, PanicMsgIdExactDivisionRemainder, "DivExactOk");
                 }
                 return result;
             case DivKindTrunc:
@@ -1447,15 +1489,7 @@ static LLVMValueRef gen_div(CodeGen *g, bool want_debug_safety, bool want_fast_m
                     remainder_val = LLVMBuildURem(g->builder, val1, val2, "");
                 }
                 LLVMValueRef ok_bit = LLVMBuildICmp(g->builder, LLVMIntEQ, remainder_val, zero, "");
-
-                LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "DivExactOk");
-                LLVMBasicBlockRef fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "DivExactFail");
-                LLVMBuildCondBr(g->builder, ok_bit, ok_block, fail_block);
-
-                LLVMPositionBuilderAtEnd(g->builder, fail_block);
-                gen_debug_safety_crash(g, PanicMsgIdExactDivisionRemainder);
-
-                LLVMPositionBuilderAtEnd(g->builder, ok_block);
+                add_safety_check(g, ok_bit, PanicMsgIdExactDivisionRemainder, "DivExactOk");
             }
             if (type_entry->data.integral.is_signed) {
                 return LLVMBuildExactSDiv(g->builder, val1, val2, "");
@@ -1499,23 +1533,16 @@ static LLVMValueRef gen_rem(CodeGen *g, bool want_debug_safety, bool want_fast_m
 
     LLVMValueRef zero = LLVMConstNull(type_entry->type_ref);
     if (want_debug_safety) {
-        LLVMValueRef is_zero_bit;
+        LLVMValueRef ok_bit;
         if (type_entry->id == TypeTableEntryIdInt) {
-            LLVMIntPredicate pred = type_entry->data.integral.is_signed ? LLVMIntSLE : LLVMIntEQ;
-            is_zero_bit = LLVMBuildICmp(g->builder, pred, val2, zero, "");
+            LLVMIntPredicate pred = type_entry->data.integral.is_signed ? LLVMIntSGT : LLVMIntNE;
+            ok_bit = LLVMBuildICmp(g->builder, pred, val2, zero, "");
         } else if (type_entry->id == TypeTableEntryIdFloat) {
-            is_zero_bit = LLVMBuildFCmp(g->builder, LLVMRealOEQ, val2, zero, "");
+            ok_bit = LLVMBuildFCmp(g->builder, LLVMRealUNE, val2, zero, "");
         } else {
             zig_unreachable();
         }
-        LLVMBasicBlockRef rem_zero_ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "RemZeroOk");
-        LLVMBasicBlockRef rem_zero_fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "RemZeroFail");
-        LLVMBuildCondBr(g->builder, is_zero_bit, rem_zero_fail_block, rem_zero_ok_block);
-
-        LLVMPositionBuilderAtEnd(g->builder, rem_zero_fail_block);
-        gen_debug_safety_crash(g, PanicMsgIdRemainderDivisionByZero);
-
-        LLVMPositionBuilderAtEnd(g->builder, rem_zero_ok_block);
+        add_safety_check(g, ok_bit, PanicMsgIdRemainderDivisionByZero, "RemZeroOk");
     }
 
     if (type_entry->id == TypeTableEntryIdFloat) {
@@ -1547,6 +1574,140 @@ static LLVMValueRef gen_rem(CodeGen *g, bool want_debug_safety, bool want_fast_m
 
 }
 
+// Analysis only lets through vector operations which map to a single LLVM instruction.
+// Integer vector arithmetic wraps.
+// The with.overflow intrinsics of LLVM 5 do not take vectors, so this computes the
+// elements in twice their width and checks that the results survive truncation.
+static LLVMValueRef gen_vector_overflow_op(CodeGen *g, TypeTableEntry *vector_type, AddSubMul op,
+        LLVMValueRef val1, LLVMValueRef val2)
+{
+    TypeTableEntry *elem_type = vector_type->data.vector.elem_type;
+    uint32_t len = vector_type->data.vector.len;
+    bool is_signed = elem_type->data.integral.is_signed;
+    LLVMTypeRef wide_type = LLVMVectorType(LLVMIntType(elem_type->data.integral.bit_count * 2), len);
+
+    LLVMValueRef wide1 = is_signed ?
+        LLVMBuildSExt(g->builder, val1, wide_type, "") : LLVMBuildZExt(g->builder, val1, wide_type, "");
+    LLVMValueRef wide2 = is_signed ?
+        LLVMBuildSExt(g->builder, val2, wide_type, "") : LLVMBuildZExt(g->builder, val2, wide_type, "");
+    LLVMValueRef wide_result;
+    switch (op) {
+        case AddSubMulAdd:
+            wide_result = LLVMBuildAdd(g->builder, wide1, wide2, "");
+            break;
+        case AddSubMulSub:
+            wide_result = LLVMBuildSub(g->builder, wide1, wide2, "");
+            break;
+        case AddSubMulMul:
+            wide_result = LLVMBuildMul(g->builder, wide1, wide2, "");
+            break;
+    }
+    LLVMValueRef result = LLVMBuildTrunc(g->builder, wide_result, vector_type->type_ref, "");
+    LLVMValueRef extended = is_signed ?
+        LLVMBuildSExt(g->builder, result, wide_type, "") : LLVMBuildZExt(g->builder, result, wide_type, "");
+    LLVMValueRef overflow_bits = LLVMBuildICmp(g->builder, LLVMIntNE, wide_result, extended, "");
+
+    // or-reduce the overflow bits
+    LLVMTypeRef mask_type = LLVMIntType(len);
+    LLVMValueRef overflow_mask = LLVMBuildBitCast(g->builder, overflow_bits, mask_type, "");
+    LLVMValueRef ok_bit = LLVMBuildICmp(g->builder, LLVMIntEQ, overflow_mask, LLVMConstNull(mask_type), "");
+    add_safety_check(g, ok_bit, PanicMsgIdIntegerOverflow, "OverflowOk");
+    return result;
+}
+
+static LLVMValueRef gen_vector_int_op(CodeGen *g, TypeTableEntry *vector_type, AddSubMul op,
+        bool want_debug_safety, LLVMValueRef val1, LLVMValueRef val2)
+{
+    if (want_debug_safety)
+        return gen_vector_overflow_op(g, vector_type, op, val1, val2);
+
+    bool is_signed = vector_type->data.vector.elem_type->data.integral.is_signed;
+    switch (op) {
+        case AddSubMulAdd:
+            return is_signed ?
+                LLVMBuildNSWAdd(g->builder, val1, val2, "") : LLVMBuildNUWAdd(g->builder, val1, val2, "");
+        case AddSubMulSub:
+            return is_signed ?
+                LLVMBuildNSWSub(g->builder, val1, val2, "") : LLVMBuildNUWSub(g->builder, val1, val2, "");
+        case AddSubMulMul:
+            return is_signed ?
+                LLVMBuildNSWMul(g->builder, val1, val2, "") : LLVMBuildNUWMul(g->builder, val1, val2, "");
+    }
+    zig_unreachable();
+}
+
+static LLVMValueRef gen_vector_bin_op(CodeGen *g, IrInstructionBinOp *bin_op_instruction,
+        bool want_debug_safety, LLVMValueRef op1_value, LLVMValueRef op2_value)
+{
+    TypeTableEntry *vector_type = bin_op_instruction->op1->value.type;
+    TypeTableEntry *elem_type = vector_type->data.vector.elem_type;
+    bool is_float = (elem_type->id == TypeTableEntryIdFloat);
+    if (is_float)
+        ZigLLVMSetFastMath(g->builder, ir_want_fast_math(g, &bin_op_instruction->base));
+
+    IrBinOp op_id = bin_op_instruction->op_id;
+    switch (op_id) {
+        case IrBinOpCmpEq:
+        case IrBinOpCmpNotEq:
+        case IrBinOpCmpLessThan:
+        case IrBinOpCmpGreaterThan:
+        case IrBinOpCmpLessOrEq:
+        case IrBinOpCmpGreaterOrEq:
+            if (is_float) {
+                LLVMRealPredicate pred = cmp_op_to_real_predicate(op_id);
+                return LLVMBuildFCmp(g->builder, pred, op1_value, op2_value, "");
+            } else {
+                bool is_signed = (elem_type->id == TypeTableEntryIdInt && elem_type->data.integral.is_signed);
+                LLVMIntPredicate pred = cmp_op_to_int_predicate(op_id, is_signed);
+                return LLVMBuildICmp(g->builder, pred, op1_value, op2_value, "");
+            }
+        case IrBinOpAdd:
+            if (is_float)
+                return LLVMBuildFAdd(g->builder, op1_value, op2_value, "");
+            return gen_vector_int_op(g, vector_type, AddSubMulAdd, want_debug_safety, op1_value, op2_value);
+        case IrBinOpAddWrap:
+            return LLVMBuildAdd(g->builder, op1_value, op2_value, "");
+        case IrBinOpSub:
+            if (is_float)
+                return LLVMBuildFSub(g->builder, op1_value, op2_value, "");
+            return gen_vector_int_op(g, vector_type, AddSubMulSub, want_debug_safety, op1_value, op2_value);
+        case IrBinOpSubWrap:
+            return LLVMBuildSub(g->builder, op1_value, op2_value, "");
+        case IrBinOpMult:
+            if (is_float)
+                return LLVMBuildFMul(g->builder, op1_value, op2_value, "");
+            return gen_vector_int_op(g, vector_type, AddSubMulMul, want_debug_safety, op1_value, op2_value);
+        case IrBinOpMultWrap:
+            return LLVMBuildMul(g->builder, op1_value, op2_value, "");
+        case IrBinOpDivUnspecified:
+            assert(is_float);
+            return LLVMBuildFDiv(g->builder, op1_value, op2_value, "");
+        case IrBinOpBinOr:
+            return LLVMBuildOr(g->builder, op1_value, op2_value, "");
+        case IrBinOpBinXor:
+            return LLVMBuildXor(g->builder, op1_value, op2_value, "");
+        case IrBinOpBinAnd:
+            return LLVMBuildAnd(g->builder, op1_value, op2_value, "");
+        case IrBinOpInvalid:
+        case IrBinOpBoolOr:
+        case IrBinOpBoolAnd:
+        case IrBinOpBitShiftLeftLossy:
+        case IrBinOpBitShiftLeftExact:
+        case IrBinOpBitShiftRightLossy:
+        case IrBinOpBitShiftRightExact:
+        case IrBinOpDivExact:
+        case IrBinOpDivTrunc:
+        case IrBinOpDivFloor:
+        case IrBinOpRemUnspecified:
+        case IrBinOpRemRem:
+        case IrBinOpRemMod:
+        case IrBinOpArrayCat:
+        case IrBinOpArrayMult:
+            zig_unreachable();
+    }
+    zig_unreachable();
+}
+
 static LLVMValueRef ir_render_bin_op(CodeGen *g, IrExecutable *executable,
         IrInstructionBinOp *bin_op_instruction)
 {
@@ -1564,6 +1725,9 @@ static LLVMValueRef ir_render_bin_op(CodeGen *g, IrExecutable *executable,
 
     LLVMValueRef op1_value = ir_llvm_value(g, op1);
     LLVMValueRef op2_value = ir_llvm_value(g, op2);
+    if (type_entry->id == TypeTableEntryIdVector)
+        return gen_vector_bin_op(g, bin_op_instruction, want_debug_safety, op1_value, op2_value);
+
     switch (op_id) {
         case IrBinOpInvalid:
         case IrBinOpArrayCat:
@@ -1726,6 +1890,23 @@ static LLVMValueRef ir_render_bin_op(CodeGen *g, IrExecutable *executable,
     zig_unreachable();
 }
 
+// True if a vector of elem_type is stored in memory just like an array of it, so that
+// converting between the two is a single load or store.
+static bool vector_matches_array_layout(CodeGen *g, TypeTableEntry *elem_type) {
+    if (elem_type->id == TypeTableEntryIdBool)
+        return false;
+    return 8 * LLVMABISizeOfType(g->target_data_ref, elem_type->type_ref) ==
+        LLVMSizeOfTypeInBits(g->target_data_ref, elem_type->type_ref);
+}
+
+static LLVMValueRef gen_array_elem_ptr(CodeGen *g, LLVMValueRef array_ptr, uint32_t index) {
+    LLVMValueRef indices[] = {
+        LLVMConstNull(g->builtin_types.entry_usize->type_ref),
+        LLVMConstInt(g->builtin_types.entry_usize->type_ref, index, false),
+    };
+    return LLVMBuildInBoundsGEP(g->builder, array_ptr, indices, 2, "");
+}
+
 static LLVMValueRef ir_render_cast(CodeGen *g, IrExecutable *executable,
         IrInstructionCast *cast_instruction)
 {
@@ -1782,14 +1963,7 @@ static LLVMValueRef ir_render_cast(CodeGen *g, IrExecutable *executable,
                         LLVMValueRef remainder_val = LLVMBuildURem(g->builder, src_len, dest_size_val, "");
                         LLVMValueRef zero = LLVMConstNull(g->builtin_types.entry_usize->type_ref);
                         LLVMValueRef ok_bit = LLVMBuildICmp(g->builder, LLVMIntEQ, remainder_val, zero, "");
-                        LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "SliceWidenOk");
-                        LLVMBasicBlockRef fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "SliceWidenFail");
-                        LLVMBuildCondBr(g->builder, ok_bit, ok_block, fail_block);
-
-                        LLVMPositionBuilderAtEnd(g->builder, fail_block);
-                        gen_debug_safety_crash(g, PanicMsgIdSliceWidenRemainder);
-
-                        LLVMPositionBuilderAtEnd(g->builder, ok_block);
+                        add_safety_check(g, ok_bit, PanicMsgIdSliceWidenRemainder, "SliceWidenOk");
                     }
                     new_len = LLVMBuildExactUDiv(g->builder, src_len, dest_size_val, "");
                 } else {
@@ -1849,6 +2023,51 @@ static LLVMValueRef ir_render_cast(CodeGen *g, IrExecutable *executable,
             assert(wanted_type->id == TypeTableEntryIdInt);
             assert(actual_type->id == TypeTableEntryIdBool);
             return LLVMBuildZExt(g->builder, expr_val, wanted_type->type_ref, "");
+        case CastOpArrayToVector:
+            {
+                assert(actual_type->id == TypeTableEntryIdArray);
+                assert(wanted_type->id == TypeTableEntryIdVector);
+                TypeTableEntry *elem_type = wanted_type->data.vector.elem_type;
+                uint32_t elem_align = get_abi_alignment(g, elem_type);
+
+                if (vector_matches_array_layout(g, elem_type)) {
+                    LLVMValueRef vector_ptr = LLVMBuildBitCast(g->builder, expr_val,
+                            LLVMPointerType(wanted_type->type_ref, 0), "");
+                    return gen_load_untyped(g, vector_ptr, elem_align, false, "");
+                }
+
+                LLVMValueRef vector = LLVMGetUndef(wanted_type->type_ref);
+                for (uint32_t i = 0; i < wanted_type->data.vector.len; i += 1) {
+                    LLVMValueRef elem_ptr = gen_array_elem_ptr(g, expr_val, i);
+                    LLVMValueRef elem = gen_load_untyped(g, elem_ptr, elem_align, false, "");
+                    vector = LLVMBuildInsertElement(g->builder, vector, elem,
+                            LLVMConstInt(LLVMInt32Type(), i, false), "");
+                }
+                return vector;
+            }
+        case CastOpVectorToArray:
+            {
+                assert(cast_instruction->tmp_ptr);
+                assert(actual_type->id == TypeTableEntryIdVector);
+                assert(wanted_type->id == TypeTableEntryIdArray);
+                TypeTableEntry *elem_type = actual_type->data.vector.elem_type;
+                uint32_t elem_align = get_abi_alignment(g, elem_type);
+
+                if (vector_matches_array_layout(g, elem_type)) {
+                    LLVMValueRef vector_ptr = LLVMBuildBitCast(g->builder, cast_instruction->tmp_ptr,
+                            LLVMPointerType(actual_type->type_ref, 0), "");
+                    gen_store_untyped(g, expr_val, vector_ptr, elem_align, false);
+                    return cast_instruction->tmp_ptr;
+                }
+
+                for (uint32_t i = 0; i < actual_type->data.vector.len; i += 1) {
+                    LLVMValueRef elem = LLVMBuildExtractElement(g->builder, expr_val,
+                            LLVMConstInt(LLVMInt32Type(), i, false), "");
+                    LLVMValueRef elem_ptr = gen_array_elem_ptr(g, cast_instruction->tmp_ptr, i);
+                    gen_store_untyped(g, elem, elem_ptr, elem_align, false);
+                }
+                return cast_instruction->tmp_ptr;
+            }
     }
     zig_unreachable();
 }
@@ -1946,15 +2165,7 @@ static LLVMValueRef ir_render_int_to_err(CodeGen *g, IrExecutable *executable, I
             ok_bit = LLVMBuildAnd(g->builder, neq_zero_bit, in_bounds_bit, "");
         }
 
-        LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "IntToErrOk");
-        LLVMBasicBlockRef fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "IntToErrFail");
-
-        LLVMBuildCondBr(g->builder, ok_bit, ok_block, fail_block);
-
-        LLVMPositionBuilderAtEnd(g->builder, fail_block);
-        gen_debug_safety_crash(g, PanicMsgIdInvalidErrorCode);
-
-        LLVMPositionBuilderAtEnd(g->builder, ok_block);
+        add_safety_check(g, ok_bit, PanicMsgIdInvalidErrorCode, "IntToErrOk");
     }
 
     return gen_widen_or_shorten(g, false, actual_type, g->err_tag_type, target_val);
@@ -1987,7 +2198,7 @@ static LLVMValueRef ir_render_unreachable(CodeGen *g, IrExecutable *executable,
         IrInstructionUnreachable *unreachable_instruction)
 {
     if (ir_want_debug_safety(g, &unreachable_instruction->base)) {
-        gen_debug_safety_crash(g, PanicMsgIdUnreachable);
+        LLVMBuildBr(g->builder, get_safety_crash_block(g, PanicMsgIdUnreachable));
     } else {
         LLVMBuildUnreachable(g->builder);
     }
@@ -2081,7 +2292,7 @@ static LLVMValueRef ir_render_decl_var(CodeGen *g, IrExecutable *executable,
     if (!type_has_bits(var->value->type))
         return nullptr;
 
-    if (var->ref_count == 0 && g->build_mode != BuildModeDebug)
+    if (var->ref_count == 0 && !build_mode_is_debug(g->build_mode))
         return nullptr;
 
     IrInstruction *init_value = decl_var_instruction->init_value;
@@ -2270,7 +2481,7 @@ static LLVMValueRef ir_render_call(CodeGen *g, IrExecutable *executable, IrInstr
     bool first_arg_ret = ret_has_bits && handle_is_ptr(src_return_type);
     size_t actual_param_count = instruction->arg_count + (first_arg_ret ? 1 : 0);
     bool is_var_args = fn_type_id->is_var_args;
-    LLVMValueRef *gen_param_values = allocate<LLVMValueRef>(actual_param_count);
+    LLVMValueRef *gen_param_values = arena_allocate<LLVMValueRef>(&g->codegen_arena, actual_param_count);
     size_t gen_param_index = 0;
     if (first_arg_ret) {
         gen_param_values[gen_param_index] = instruction->tmp_ptr;
@@ -2427,8 +2638,8 @@ static LLVMValueRef ir_render_asm(CodeGen *g, IrExecutable *executable, IrInstru
                                  instruction->return_count;
     size_t total_index = 0;
     size_t param_index = 0;
-    LLVMTypeRef *param_types = allocate<LLVMTypeRef>(input_and_output_count);
-    LLVMValueRef *param_values = allocate<LLVMValueRef>(input_and_output_count);
+    LLVMTypeRef *param_types = arena_allocate<LLVMTypeRef>(&g->codegen_arena, input_and_output_count);
+    LLVMValueRef *param_values = arena_allocate<LLVMValueRef>(&g->codegen_arena, input_and_output_count);
     for (size_t i = 0; i < asm_expr->output_list.length; i += 1, total_index += 1) {
         AsmOutput *asm_output = asm_expr->output_list.at(i);
         bool is_return = (asm_output->return_type != nullptr);
@@ -2518,14 +2729,7 @@ static LLVMValueRef ir_render_unwrap_maybe(CodeGen *g, IrExecutable *executable,
     LLVMValueRef maybe_handle = get_handle_value(g, maybe_ptr, maybe_type, ptr_type);
     if (ir_want_debug_safety(g, &instruction->base) && instruction->safety_check_on) {
         LLVMValueRef non_null_bit = gen_non_null_bit(g, maybe_type, maybe_handle);
-        LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "UnwrapMaybeOk");
-        LLVMBasicBlockRef fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "UnwrapMaybeFail");
-        LLVMBuildCondBr(g->builder, non_null_bit, ok_block, fail_block);
-
-        LLVMPositionBuilderAtEnd(g->builder, fail_block);
-        gen_debug_safety_crash(g, PanicMsgIdUnwrapMaybeFail);
-
-        LLVMPositionBuilderAtEnd(g->builder, ok_block);
+        add_safety_check(g, non_null_bit, PanicMsgIdUnwrapMaybeFail, "UnwrapMaybeOk");
     }
     if (child_type->zero_bits) {
         return nullptr;
@@ -2620,8 +2824,9 @@ static LLVMValueRef ir_render_phi(CodeGen *g, IrExecutable *executable, IrInstru
     }
 
     LLVMValueRef phi = LLVMBuildPhi(g->builder, phi_type, "");
-    LLVMValueRef *incoming_values = allocate<LLVMValueRef>(instruction->incoming_count);
-    LLVMBasicBlockRef *incoming_blocks = allocate<LLVMBasicBlockRef>(instruction->incoming_count);
+    LLVMValueRef *incoming_values = arena_allocate<LLVMValueRef>(&g->codegen_arena, instruction->incoming_count);
+    LLVMBasicBlockRef *incoming_blocks = arena_allocate<LLVMBasicBlockRef>(&g->codegen_arena,
+            instruction->incoming_count);
     for (size_t i = 0; i < instruction->incoming_count; i += 1) {
         incoming_values[i] = ir_llvm_value(g, instruction->incoming_values[i]);
         incoming_blocks[i] = instruction->incoming_blocks[i]->llvm_exit_block;
@@ -2714,6 +2919,103 @@ static LLVMValueRef ir_render_field_parent_ptr(CodeGen *g, IrExecutable *executa
     }
 }
 
+static LLVMValueRef ir_render_splat(CodeGen *g, IrExecutable *executable, IrInstructionSplat *instruction) {
+    TypeTableEntry *vector_type = instruction->base.value.type;
+    LLVMValueRef scalar = ir_llvm_value(g, instruction->scalar);
+
+    LLVMValueRef undef_vector = LLVMGetUndef(vector_type->type_ref);
+    LLVMValueRef first = LLVMBuildInsertElement(g->builder, undef_vector, scalar,
+            LLVMConstNull(LLVMInt32Type()), "");
+    LLVMValueRef zero_mask = LLVMConstNull(LLVMVectorType(LLVMInt32Type(), vector_type->data.vector.len));
+    return LLVMBuildShuffleVector(g->builder, first, undef_vector, zero_mask, "");
+}
+
+static LLVMValueRef ir_render_shuffle(CodeGen *g, IrExecutable *executable, IrInstructionShuffle *instruction) {
+    uint32_t len = instruction->base.value.type->data.vector.len;
+    LLVMValueRef *mask_values = allocate<LLVMValueRef>(len);
+    for (uint32_t i = 0; i < len; i += 1) {
+        mask_values[i] = LLVMConstInt(LLVMInt32Type(), instruction->mask_indices[i], false);
+    }
+    LLVMValueRef mask = LLVMConstVector(mask_values, len);
+    free(mask_values);
+
+    return LLVMBuildShuffleVector(g->builder, ir_llvm_value(g, instruction->a), ir_llvm_value(g, instruction->b),
+            mask, "");
+}
+
+// Combines two scalars, or two vectors element by element.
+static LLVMValueRef gen_reduce_op(CodeGen *g, ReduceOp op, TypeTableEntry *elem_type,
+        LLVMValueRef a, LLVMValueRef b)
+{
+    bool is_float = (elem_type->id == TypeTableEntryIdFloat);
+    switch (op) {
+        case ReduceOpAdd:
+            return is_float ? LLVMBuildFAdd(g->builder, a, b, "") : LLVMBuildAdd(g->builder, a, b, "");
+        case ReduceOpMul:
+            return is_float ? LLVMBuildFMul(g->builder, a, b, "") : LLVMBuildMul(g->builder, a, b, "");
+        case ReduceOpAnd:
+            return LLVMBuildAnd(g->builder, a, b, "");
+        case ReduceOpOr:
+            return LLVMBuildOr(g->builder, a, b, "");
+        case ReduceOpXor:
+            return LLVMBuildXor(g->builder, a, b, "");
+        case ReduceOpMin:
+        case ReduceOpMax:
+            {
+                IrBinOp cmp_op = (op == ReduceOpMin) ? IrBinOpCmpLessOrEq : IrBinOpCmpGreaterOrEq;
+                LLVMValueRef pick_a;
+                if (is_float) {
+                    pick_a = LLVMBuildFCmp(g->builder, cmp_op_to_real_predicate(cmp_op), a, b, "");
+                } else {
+                    LLVMIntPredicate pred = cmp_op_to_int_predicate(cmp_op, elem_type->data.integral.is_signed);
+                    pick_a = LLVMBuildICmp(g->builder, pred, a, b, "");
+                }
+                return LLVMBuildSelect(g->builder, pick_a, a, b, "");
+            }
+    }
+    zig_unreachable();
+}
+
+static LLVMValueRef ir_render_reduce(CodeGen *g, IrExecutable *executable, IrInstructionReduce *instruction) {
+    TypeTableEntry *vector_type = instruction->value->value.type;
+    TypeTableEntry *elem_type = vector_type->data.vector.elem_type;
+    uint32_t len = vector_type->data.vector.len;
+    LLVMValueRef vector = ir_llvm_value(g, instruction->value);
+
+    bool want_fast_math = ir_want_fast_math(g, &instruction->base);
+    bool is_float = (elem_type->id == TypeTableEntryIdFloat);
+    if (is_float)
+        ZigLLVMSetFastMath(g->builder, want_fast_math);
+
+    // A power of two length is reduced in log2(len) steps, each combining the upper half of
+    // the vector with the lower half. That changes the order of a float sum or product, so
+    // those only do it in Optimized float mode; otherwise the elements are combined in order,
+    // as at compile time.
+    bool in_order = (is_float && !want_fast_math && (instruction->op == ReduceOpAdd || instruction->op == ReduceOpMul));
+    if (!in_order && (len & (len - 1)) == 0) {
+        LLVMValueRef *mask_values = allocate<LLVMValueRef>(len);
+        LLVMValueRef undef_vector = LLVMGetUndef(vector_type->type_ref);
+        for (uint32_t half = len / 2; half != 0; half /= 2) {
+            for (uint32_t i = 0; i < len; i += 1) {
+                mask_values[i] = (i < half) ?
+                    LLVMConstInt(LLVMInt32Type(), i + half, false) : LLVMGetUndef(LLVMInt32Type());
+            }
+            LLVMValueRef upper = LLVMBuildShuffleVector(g->builder, vector, undef_vector,
+                    LLVMConstVector(mask_values, len), "");
+            vector = gen_reduce_op(g, instruction->op, elem_type, vector, upper);
+        }
+        free(mask_values);
+        return LLVMBuildExtractElement(g->builder, vector, LLVMConstNull(LLVMInt32Type()), "");
+    }
+
+    LLVMValueRef result = LLVMBuildExtractElement(g->builder, vector, LLVMConstNull(LLVMInt32Type()), "");
+    for (uint32_t i = 1; i < len; i += 1) {
+        LLVMValueRef elem = LLVMBuildExtractElement(g->builder, vector, LLVMConstInt(LLVMInt32Type(), i, false), "");
+        result = gen_reduce_op(g, instruction->op, elem_type, result, elem);
+    }
+    return result;
+}
+
 static LLVMValueRef ir_render_align_cast(CodeGen *g, IrExecutable *executable, IrInstructionAlignCast *instruction) {
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
     assert(target_val);
@@ -2761,16 +3063,7 @@ static LLVMValueRef ir_render_align_cast(CodeGen *g, IrExecutable *executable, I
     LLVMValueRef alignment_minus_1 = LLVMConstInt(usize->type_ref, align_bytes - 1, false);
     LLVMValueRef anded_val = LLVMBuildAnd(g->builder, ptr_as_int_val, alignment_minus_1, "");
     LLVMValueRef ok_bit = LLVMBuildICmp(g->builder, LLVMIntEQ, anded_val, LLVMConstNull(usize->type_ref), "");
-
-    LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "AlignCastOk");
-    LLVMBasicBlockRef fail_block = LLVMAppendBasicBlock(g->cur_fn_val, "AlignCastFail");
-
-    LLVMBuildCondBr(g->builder, ok_bit, ok_block, fail_block);
-
-    LLVMPositionBuilderAtEnd(g->builder, fail_block);
-    gen_debug_safety_crash(g, PanicMsgIdIncorrectAlignment);
-
-    LLVMPositionBuilderAtEnd(g->builder, ok_block);
+    add_safety_check(g, ok_bit, PanicMsgIdIncorrectAlignment, "AlignCastOk");
 
     return target_val;
 }
@@ -2807,6 +3100,60 @@ static LLVMValueRef ir_render_fence(CodeGen *g, IrExecutable *executable, IrInst
     return nullptr;
 }
 
+static LLVMAtomicRMWBinOp to_LLVMAtomicRMWBinOp(AtomicRmwOp op, bool is_signed) {
+    switch (op) {
+        case AtomicRmwOpXchg: return LLVMAtomicRMWBinOpXchg;
+        case AtomicRmwOpAdd: return LLVMAtomicRMWBinOpAdd;
+        case AtomicRmwOpSub: return LLVMAtomicRMWBinOpSub;
+        case AtomicRmwOpAnd: return LLVMAtomicRMWBinOpAnd;
+        case AtomicRmwOpOr: return LLVMAtomicRMWBinOpOr;
+        case AtomicRmwOpXor: return LLVMAtomicRMWBinOpXor;
+        case AtomicRmwOpMin: return is_signed ? LLVMAtomicRMWBinOpMin : LLVMAtomicRMWBinOpUMin;
+        case AtomicRmwOpMax: return is_signed ? LLVMAtomicRMWBinOpMax : LLVMAtomicRMWBinOpUMax;
+    }
+    zig_unreachable();
+}
+
+static LLVMValueRef ir_render_atomic_rmw(CodeGen *g, IrExecutable *executable,
+        IrInstructionAtomicRmw *instruction)
+{
+    LLVMValueRef ptr_val = ir_llvm_value(g, instruction->ptr);
+    LLVMValueRef operand_val = ir_llvm_value(g, instruction->operand);
+
+    TypeTableEntry *operand_type = instruction->operand->value.type;
+    assert(operand_type->id == TypeTableEntryIdInt);
+    LLVMAtomicRMWBinOp op = to_LLVMAtomicRMWBinOp(instruction->op, operand_type->data.integral.is_signed);
+    LLVMAtomicOrdering atomic_order = to_LLVMAtomicOrdering(instruction->order);
+
+    LLVMValueRef result_val = LLVMBuildAtomicRMW(g->builder, op, ptr_val, operand_val, atomic_order, false);
+    if (instruction->ptr->value.type->data.pointer.is_volatile)
+        LLVMSetVolatile(result_val, true);
+    return result_val;
+}
+
+static LLVMValueRef ir_render_atomic_load(CodeGen *g, IrExecutable *executable,
+        IrInstructionAtomicLoad *instruction)
+{
+    LLVMValueRef ptr_val = ir_llvm_value(g, instruction->ptr);
+    TypeTableEntry *ptr_type = instruction->ptr->value.type;
+
+    LLVMValueRef result_val = gen_load(g, ptr_val, ptr_type, "");
+    LLVMSetOrdering(result_val, to_LLVMAtomicOrdering(instruction->order));
+    return result_val;
+}
+
+static LLVMValueRef ir_render_atomic_store(CodeGen *g, IrExecutable *executable,
+        IrInstructionAtomicStore *instruction)
+{
+    LLVMValueRef ptr_val = ir_llvm_value(g, instruction->ptr);
+    LLVMValueRef value = ir_llvm_value(g, instruction->value);
+    TypeTableEntry *ptr_type = instruction->ptr->value.type;
+
+    LLVMValueRef store_instruction = gen_store(g, value, ptr_val, ptr_type);
+    LLVMSetOrdering(store_instruction, to_LLVMAtomicOrdering(instruction->order));
+    return nullptr;
+}
+
 static LLVMValueRef ir_render_truncate(CodeGen *g, IrExecutable *executable, IrInstructionTruncate *instruction) {
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
     TypeTableEntry *dest_type = instruction->base.value.type;
@@ -3169,7 +3516,7 @@ static LLVMValueRef ir_render_unwrap_err_payload(CodeGen *g, IrExecutable *execu
         LLVMValueRef cond_val = LLVMBuildICmp(g->builder, LLVMIntEQ, err_val, zero, "");
         LLVMBasicBlockRef err_block = LLVMAppendBasicBlock(g->cur_fn_val, "UnwrapErrError");
         LLVMBasicBlockRef ok_block = LLVMAppendBasicBlock(g->cur_fn_val, "UnwrapErrOk");
-        LLVMBuildCondBr(g->builder, cond_val, ok_block, err_block);
+        gen_safety_cond_br(g, cond_val, ok_block, err_block);
 
         LLVMPositionBuilderAtEnd(g->builder, err_block);
         gen_debug_safety_crash_for_err(g, err_val);
@@ -3408,6 +3755,7 @@ static LLVMValueRef ir_render_instruction(CodeGen *g, IrExecutable *executable,
         case IrInstructionIdPtrTypeOf:
         case IrInstructionIdOpaqueType:
         case IrInstructionIdSetAlignStack:
+        case IrInstructionIdVectorType:
             zig_unreachable();
         case IrInstructionIdReturn:
             return ir_render_return(g, executable, (IrInstructionReturn *)instruction);
@@ -3523,6 +3871,18 @@ static LLVMValueRef ir_render_instruction(CodeGen *g, IrExecutable *executable,
             return ir_render_field_parent_ptr(g, executable, (IrInstructionFieldParentPtr *)instruction);
         case IrInstructionIdAlignCast:
             return ir_render_align_cast(g, executable, (IrInstructionAlignCast *)instruction);
+        case IrInstructionIdSplat:
+            return ir_render_splat(g, executable, (IrInstructionSplat *)instruction);
+        case IrInstructionIdShuffle:
+            return ir_render_shuffle(g, executable, (IrInstructionShuffle *)instruction);
+        case IrInstructionIdReduce:
+            return ir_render_reduce(g, executable, (IrInstructionReduce *)instruction);
+        case IrInstructionIdAtomicRmw:
+            return ir_render_atomic_rmw(g, executable, (IrInstructionAtomicRmw *)instruction);
+        case IrInstructionIdAtomicLoad:
+            return ir_render_atomic_load(g, executable, (IrInstructionAtomicLoad *)instruction);
+        case IrInstructionIdAtomicStore:
+            return ir_render_atomic_store(g, executable, (IrInstructionAtomicStore *)instruction);
     }
     zig_unreachable();
 }
@@ -3566,8 +3926,7 @@ static LLVMValueRef gen_parent_ptr(CodeGen *g, ConstExprValue *val, ConstParent
 }
 
 static LLVMValueRef gen_const_ptr_array_recursive(CodeGen *g, ConstExprValue *array_const_val, size_t index) {
-    expand_undef_array(g, array_const_val);
-    ConstParent *parent = &array_const_val->data.x_array.s_none.parent;
+    ConstParent *parent = &array_const_val->data.x_array.parent;
     LLVMValueRef base_ptr = gen_parent_ptr(g, array_const_val, parent);
 
     TypeTableEntry *usize = g->builtin_types.entry_usize;
@@ -3621,6 +3980,7 @@ static LLVMValueRef pack_const_int(CodeGen *g, LLVMTypeRef big_int_type_ref, Con
         case TypeTableEntryIdArgTuple:
         case TypeTableEntryIdVoid:
         case TypeTableEntryIdOpaque:
+        case TypeTableEntryIdVector:
             zig_unreachable();
         case TypeTableEntryIdBool:
             return LLVMConstInt(big_int_type_ref, const_val->data.x_bool ? 1 : 0, false);
@@ -3746,7 +4106,8 @@ static LLVMValueRef gen_const_val(CodeGen *g, ConstExprValue *const_val) {
             }
         case TypeTableEntryIdStruct:
             {
-                LLVMValueRef *fields = allocate<LLVMValueRef>(type_entry->data.structure.gen_field_count);
+                LLVMValueRef *fields = arena_allocate<LLVMValueRef>(&g->codegen_arena,
+                        type_entry->data.structure.gen_field_count);
                 size_t src_field_count = type_entry->data.structure.src_field_count;
                 if (type_entry->data.structure.layout == ContainerLayoutPacked) {
                     size_t src_field_index = 0;
@@ -3807,17 +4168,41 @@ static LLVMValueRef gen_const_val(CodeGen *g, ConstExprValue *const_val) {
         case TypeTableEntryIdArray:
             {
                 uint64_t len = type_entry->data.array.len;
-                if (const_val->data.x_array.special == ConstArraySpecialUndef) {
+                ConstArrayValue *array = &const_val->data.x_array;
+                if (array->special == ConstArraySpecialUndef) {
                     return LLVMGetUndef(type_entry->type_ref);
+                } else if (array->special == ConstArraySpecialBuf) {
+                    return LLVMConstString(buf_ptr(array->s_buf.bytes), (unsigned)buf_len(array->s_buf.bytes), true);
                 }
 
-                LLVMValueRef *values = allocate<LLVMValueRef>(len);
-                for (uint64_t i = 0; i < len; i += 1) {
-                    ConstExprValue *elem_value = &const_val->data.x_array.s_none.elements[i];
-                    values[i] = gen_const_val(g, elem_value);
+                LLVMValueRef *values = arena_allocate<LLVMValueRef>(&g->codegen_arena, len);
+                if (array->special == ConstArraySpecialRepeat) {
+                    LLVMValueRef elem_value = gen_const_val(g, array->s_repeat.elem);
+                    for (uint64_t i = 0; i < len; i += 1) {
+                        values[i] = elem_value;
+                    }
+                } else if (array->special == ConstArraySpecialInts) {
+                    LLVMTypeRef elem_type_ref = type_entry->data.array.child_type->type_ref;
+                    for (uint64_t i = 0; i < len; i += 1) {
+                        values[i] = LLVMConstInt(elem_type_ref, array->s_ints.values[i], false);
+                    }
+                } else {
+                    for (uint64_t i = 0; i < len; i += 1) {
+                        ConstExprValue *elem_value = &array->s_none.elements[i];
+                        values[i] = gen_const_val(g, elem_value);
+                    }
                 }
                 return LLVMConstArray(LLVMTypeOf(values[0]), values, (unsigned)len);
             }
+        case TypeTableEntryIdVector:
+            {
+                uint32_t len = type_entry->data.vector.len;
+                LLVMValueRef *values = arena_allocate<LLVMValueRef>(&g->codegen_arena, len);
+                for (uint32_t i = 0; i < len; i += 1) {
+                    values[i] = gen_const_val(g, &const_val->data.x_array.s_none.elements[i]);
+                }
+                return LLVMConstVector(values, len);
+            }
         case TypeTableEntryIdEnum:
             {
                 LLVMTypeRef tag_type_ref = type_entry->data.enumeration.tag_type->type_ref;
@@ -4010,7 +4395,7 @@ static void generate_error_name_table(CodeGen *g) {
     TypeTableEntry *u8_ptr_type = get_pointer_to_type(g, g->builtin_types.entry_u8, true);
     TypeTableEntry *str_type = get_slice_type(g, u8_ptr_type);
 
-    LLVMValueRef *values = allocate<LLVMValueRef>(g->error_decls.length);
+    LLVMValueRef *values = arena_allocate<LLVMValueRef>(&g->codegen_arena, g->error_decls.length);
     values[0] = LLVMGetUndef(str_type->type_ref);
     for (size_t i = 1; i < g->error_decls.length; i += 1) {
         AstNode *error_decl_node = g->error_decls.at(i);
@@ -4062,7 +4447,7 @@ static void generate_enum_name_tables(CodeGen *g) {
         TypeTableEntry *enum_type = enum_tag_type->data.enum_tag.enum_type;
 
         size_t field_count = enum_type->data.enumeration.src_field_count;
-        LLVMValueRef *values = allocate<LLVMValueRef>(field_count);
+        LLVMValueRef *values = arena_allocate<LLVMValueRef>(&g->codegen_arena, field_count);
         for (size_t field_i = 0; field_i < field_count; field_i += 1) {
             Buf *name = enum_type->data.enumeration.fields[field_i].name;
 
@@ -4162,6 +4547,29 @@ static void validate_inline_fns(CodeGen *g) {
     report_errors_and_maybe_exit(g);
 }
 
+// Link time optimization internalizes the functions nothing refers to yet and
+// deletes them, before the code generator introduces calls to memcpy or __udivti3.
+// Functions listed in llvm.used are kept, and can still be inlined.
+static void gen_lto_used_fns(CodeGen *g) {
+    LLVMTypeRef ptr_type = LLVMPointerType(LLVMInt8Type(), 0);
+    ZigList<LLVMValueRef> used_fns = {0};
+    for (size_t i = 0; i < g->fn_defs.length; i += 1) {
+        FnTableEntry *fn_table_entry = g->fn_defs.at(i);
+        if (fn_table_entry->linkage == GlobalLinkageIdInternal)
+            continue;
+        used_fns.append(LLVMConstBitCast(fn_table_entry->llvm_value, ptr_type));
+    }
+    if (used_fns.length == 0)
+        return;
+
+    LLVMValueRef used_array = LLVMConstArray(ptr_type, used_fns.items, (unsigned)used_fns.length);
+    LLVMValueRef global_value = LLVMAddGlobal(g->module, LLVMTypeOf(used_array), "llvm.used");
+    LLVMSetInitializer(global_value, used_array);
+    LLVMSetLinkage(global_value, LLVMAppendingLinkage);
+    LLVMSetSection(global_value, "llvm.metadata");
+    used_fns.deinit();
+}
+
 static void do_code_gen(CodeGen *g) {
     if (g->verbose) {
         fprintf(stderr, "\nCode Generation:\n");
@@ -4302,9 +4710,16 @@ static void do_code_gen(CodeGen *g) {
     for (size_t fn_i = 0; fn_i < g->fn_defs.length; fn_i += 1) {
         FnTableEntry *fn_table_entry = g->fn_defs.at(fn_i);
 
+        size_t time_report_event = 0;
+        if (g->time_report != nullptr)
+            time_report_event = time_report_begin(g, "llvm ir", &fn_table_entry->symbol_name);
+
         LLVMValueRef fn = fn_llvm_value(g, fn_table_entry);
         g->cur_fn = fn_table_entry;
         g->cur_fn_val = fn;
+        for (size_t i = 0; i < PanicMsgIdCount; i += 1) {
+            g->cur_fn_safety_crash_blocks[i] = nullptr;
+        }
         if (handle_is_ptr(fn_table_entry->type_entry->data.fn.fn_type_id.return_type)) {
             g->cur_ret_ptr = LLVMGetParam(fn, 0);
         } else {
@@ -4434,6 +4849,8 @@ static void do_code_gen(CodeGen *g) {
 
         ir_render(g, fn_table_entry);
 
+        if (g->time_report != nullptr)
+            time_report_end(g, time_report_event);
     }
     assert(!g->errors.length);
 
@@ -4441,6 +4858,9 @@ static void do_code_gen(CodeGen *g) {
         LLVMSetModuleInlineAsm(g->module, buf_ptr(&g->global_asm));
     }
 
+    if (g->lto_keep_exports && g->lto_mode != ZigLLVMLTOModeNone)
+        gen_lto_used_fns(g);
+
     ZigLLVMDIBuilderFinalize(g->dbuilder);
 
     if (g->verbose || g->verbose_ir) {
@@ -4450,27 +4870,64 @@ static void do_code_gen(CodeGen *g) {
     // in release mode, we're sooooo confident that we've generated correct ir,
     // that we skip the verify module step in order to get better performance.
 #ifndef NDEBUG
-    char *error = nullptr;
-    LLVMVerifyModule(g->module, LLVMAbortProcessAction, &error);
+    if (g->build_mode != BuildModeFastDebug) {
+        char *error = nullptr;
+        LLVMVerifyModule(g->module, LLVMAbortProcessAction, &error);
+    }
 #endif
 
     codegen_add_time_event(g, "LLVM Emit Object");
 
     char *err_msg = nullptr;
-    Buf *o_basename = buf_create_from_buf(g->root_out_name);
     const char *o_ext = target_o_file_ext(&g->zig_target);
+    ensure_cache_dir(g);
+
+    // an object build has to produce exactly one file, and so does link time
+    // optimization, which the linker parallelizes instead
+    if (g->codegen_threads > 1 && g->out_type != OutTypeObj && g->time_report == nullptr &&
+        g->lto_mode == ZigLLVMLTOModeNone)
+    {
+        ZigList<Buf *> output_paths = {0};
+        ZigList<const char *> output_path_ptrs = {0};
+        for (size_t i = 0; i < g->codegen_threads; i += 1) {
+            Buf *o_basename = buf_sprintf("%s.%" ZIG_PRI_usize "%s", buf_ptr(g->root_out_name), i, o_ext);
+            Buf *output_path = buf_alloc();
+            os_path_join(g->cache_dir, o_basename, output_path);
+            output_paths.append(output_path);
+            output_path_ptrs.append(buf_ptr(output_path));
+        }
+        if (ZigLLVMTargetMachineEmitToFiles(g->target_machine, g->module, output_path_ptrs.items,
+                    output_path_ptrs.length, &err_msg, build_mode_is_debug(g->build_mode),
+                    g->build_mode == BuildModeFastDebug))
+        {
+            zig_panic("unable to write object files to %s: %s", buf_ptr(g->cache_dir), err_msg);
+        }
+
+        validate_inline_fns(g);
+
+        for (size_t i = 0; i < output_paths.length; i += 1) {
+            g->link_objects.append(output_paths.at(i));
+        }
+        return;
+    }
+
+    Buf *o_basename = buf_create_from_buf(g->root_out_name);
     buf_append_str(o_basename, o_ext);
     Buf *output_path = buf_alloc();
     os_path_join(g->cache_dir, o_basename, output_path);
-    ensure_cache_dir(g);
     if (ZigLLVMTargetMachineEmitToFile(g->target_machine, g->module, buf_ptr(output_path),
-                LLVMObjectFile, &err_msg, g->build_mode == BuildModeDebug))
+                LLVMObjectFile, &err_msg, build_mode_is_debug(g->build_mode),
+                g->build_mode == BuildModeFastDebug, g->lto_mode))
     {
         zig_panic("unable to write object file %s: %s", buf_ptr(output_path), err_msg);
     }
 
     validate_inline_fns(g);
 
+    // the detailed time report turns on -time-passes
+    if (g->time_report != nullptr)
+        ZigLLVMPrintTimers();
+
     g->link_objects.append(output_path);
 }
 
@@ -4579,7 +5036,7 @@ static void define_builtin_types(CodeGen *g) {
         for (size_t is_sign_i = 0; is_sign_i < array_length(is_signed_list); is_sign_i += 1) {
             bool is_signed = is_signed_list[is_sign_i];
             TypeTableEntry *entry = make_int_type(g, is_signed, size_in_bits);
-            g->primitive_type_table.put(&entry->name, entry);
+            g->primitive_type_table.put(intern_str(g->intern_table, &entry->name), entry);
             get_int_type_ptr(g, is_signed, size_in_bits)[0] = entry;
         }
     }
@@ -4600,7 +5057,7 @@ static void define_builtin_types(CodeGen *g) {
                 is_signed ? ZigLLVMEncoding_DW_ATE_signed() : ZigLLVMEncoding_DW_ATE_unsigned());
         entry->data.integral.is_signed = is_signed;
         entry->data.integral.bit_count = size_in_bits;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_str(g->intern_table, &entry->name), entry);
 
         get_c_int_type_ptr(g, info->id)[0] = entry;
     }
@@ -4614,7 +5071,7 @@ static void define_builtin_types(CodeGen *g) {
                 debug_size_in_bits,
                 ZigLLVMEncoding_DW_ATE_boolean());
         g->builtin_types.entry_bool = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_str(g->intern_table, &entry->name), entry);
     }
 
     for (size_t sign_i = 0; sign_i < array_length(is_signed_list); sign_i += 1) {
@@ -4634,7 +5091,7 @@ static void define_builtin_types(CodeGen *g) {
         entry->di_type = ZigLLVMCreateDebugBasicType(g->dbuilder, buf_ptr(&entry->name),
                 debug_size_in_bits,
                 is_signed ? ZigLLVMEncoding_DW_ATE_signed() : ZigLLVMEncoding_DW_ATE_unsigned());
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_str(g->intern_table, &entry->name), entry);
 
         if (is_signed) {
             g->builtin_types.entry_isize = entry;
@@ -4653,7 +5110,7 @@ static void define_builtin_types(CodeGen *g) {
                 debug_size_in_bits,
                 ZigLLVMEncoding_DW_ATE_float());
         g->builtin_types.entry_f32 = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_str(g->intern_table, &entry->name), entry);
     }
     {
         TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdFloat);
@@ -4666,7 +5123,7 @@ static void define_builtin_types(CodeGen *g) {
                 debug_size_in_bits,
                 ZigLLVMEncoding_DW_ATE_float());
         g->builtin_types.entry_f64 = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_str(g->intern_table, &entry->name), entry);
     }
     {
         TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdFloat);
@@ -4679,7 +5136,7 @@ static void define_builtin_types(CodeGen *g) {
                 debug_size_in_bits,
                 ZigLLVMEncoding_DW_ATE_float());
         g->builtin_types.entry_f128 = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_str(g->intern_table, &entry->name), entry);
     }
     {
         TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdFloat);
@@ -4692,7 +5149,7 @@ static void define_builtin_types(CodeGen *g) {
                 debug_size_in_bits,
                 ZigLLVMEncoding_DW_ATE_float());
         g->builtin_types.entry_c_longdouble = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_str(g->intern_table, &entry->name), entry);
     }
     {
         TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdVoid);
@@ -4703,7 +5160,7 @@ static void define_builtin_types(CodeGen *g) {
                 0,
                 ZigLLVMEncoding_DW_ATE_unsigned());
         g->builtin_types.entry_void = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_str(g->intern_table, &entry->name), entry);
     }
     {
         TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdUnreachable);
@@ -4712,14 +5169,14 @@ static void define_builtin_types(CodeGen *g) {
         buf_init_from_str(&entry->name, "noreturn");
         entry->di_type = g->builtin_types.entry_void->di_type;
         g->builtin_types.entry_unreachable = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_str(g->intern_table, &entry->name), entry);
     }
     {
         TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdMetaType);
         buf_init_from_str(&entry->name, "type");
         entry->zero_bits = true;
         g->builtin_types.entry_type = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_str(g->intern_table, &entry->name), entry);
     }
 
     g->builtin_types.entry_u8 = get_int_type(g, false, 8);
@@ -4735,7 +5192,8 @@ static void define_builtin_types(CodeGen *g) {
 
     {
         g->builtin_types.entry_c_void = get_opaque_type(g, nullptr, nullptr, "c_void");
-        g->primitive_type_table.put(&g->builtin_types.entry_c_void->name, g->builtin_types.entry_c_void);
+        g->primitive_type_table.put(intern_str(g->intern_table, &g->builtin_types.entry_c_void->name),
+                g->builtin_types.entry_c_void);
     }
 
     {
@@ -4750,7 +5208,7 @@ static void define_builtin_types(CodeGen *g) {
         entry->type_ref = g->err_tag_type->type_ref;
         entry->di_type = g->err_tag_type->di_type;
 
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_str(g->intern_table, &entry->name), entry);
     }
 
 }
@@ -4761,7 +5219,7 @@ static BuiltinFnEntry *create_builtin_fn(CodeGen *g, BuiltinFnId id, const char
     buf_init_from_str(&builtin_fn->name, name);
     builtin_fn->id = id;
     builtin_fn->param_count = count;
-    g->builtin_fn_table.put(&builtin_fn->name, builtin_fn);
+    g->builtin_fn_table.put(intern_str(g->intern_table, &builtin_fn->name), builtin_fn);
     return builtin_fn;
 }
 
@@ -4823,6 +5281,13 @@ static void define_builtin_fns(CodeGen *g) {
     create_builtin_fn(g, BuiltinFnIdAlignCast, "alignCast", 2);
     create_builtin_fn(g, BuiltinFnIdOpaqueType, "OpaqueType", 0);
     create_builtin_fn(g, BuiltinFnIdSetAlignStack, "setAlignStack", 1);
+    create_builtin_fn(g, BuiltinFnIdVectorType, "Vector", 2);
+    create_builtin_fn(g, BuiltinFnIdSplat, "splat", 2);
+    create_builtin_fn(g, BuiltinFnIdShuffle, "shuffle", 3);
+    create_builtin_fn(g, BuiltinFnIdReduce, "reduce", 2);
+    create_builtin_fn(g, BuiltinFnIdAtomicRmw, "atomicRmw", 4);
+    create_builtin_fn(g, BuiltinFnIdAtomicLoad, "atomicLoad", 2);
+    create_builtin_fn(g, BuiltinFnIdAtomicStore, "atomicStore", 3);
 }
 
 static const char *bool_to_str(bool b) {
@@ -4831,7 +5296,9 @@ static const char *bool_to_str(bool b) {
 
 static const char *build_mode_to_str(BuildMode build_mode) {
     switch (build_mode) {
-        case BuildModeDebug: return "Mode.Debug";
+        case BuildModeDebug:
+        case BuildModeFastDebug:
+            return "Mode.Debug";
         case BuildModeSafeRelease: return "Mode.ReleaseSafe";
         case BuildModeFastRelease: return "Mode.ReleaseFast";
     }
@@ -4972,6 +5439,35 @@ static void define_builtin_compile_vars(CodeGen *g) {
         assert(FloatModeOptimized == 0);
         assert(FloatModeStrict == 1);
     }
+    {
+        buf_appendf(contents,
+            "pub const ReduceOp = enum {\n"
+            "    Add,\n"
+            "    Mul,\n"
+            "    And,\n"
+            "    Or,\n"
+            "    Xor,\n"
+            "    Min,\n"
+            "    Max,\n"
+            "};\n\n");
+        assert(ReduceOpAdd == 0);
+        assert(ReduceOpMax == 6);
+    }
+    {
+        buf_appendf(contents,
+            "pub const AtomicRmwOp = enum {\n"
+            "    Xchg,\n"
+            "    Add,\n"
+            "    Sub,\n"
+            "    And,\n"
+            "    Or,\n"
+            "    Xor,\n"
+            "    Min,\n"
+            "    Max,\n"
+            "};\n\n");
+        assert(AtomicRmwOpXchg == 0);
+        assert(AtomicRmwOpMax == 7);
+    }
     buf_appendf(contents, "pub const is_big_endian = %s;\n", bool_to_str(g->is_big_endian));
     buf_appendf(contents, "pub const is_test = %s;\n", bool_to_str(g->is_test_build));
     buf_appendf(contents, "pub const os = Os.%s;\n", cur_os);
@@ -5039,7 +5535,7 @@ static void init(CodeGen *g) {
         zig_panic("unable to create target based on: %s", buf_ptr(&g->triple_str));
     }
 
-    bool is_optimized = g->build_mode != BuildModeDebug;
+    bool is_optimized = !build_mode_is_debug(g->build_mode);
     LLVMCodeGenOptLevel opt_level = is_optimized ? LLVMCodeGenLevelAggressive : LLVMCodeGenLevelNone;
 
     LLVMRelocMode reloc_mode = g->is_static ? LLVMRelocStatic : LLVMRelocPIC;
@@ -5064,6 +5560,8 @@ static void init(CodeGen *g) {
 
     g->target_machine = LLVMCreateTargetMachine(target_ref, buf_ptr(&g->triple_str),
             target_specific_cpu_args, target_specific_features, opt_level, reloc_mode, LLVMCodeModelDefault);
+    g->target_cpu = target_specific_cpu_args;
+    g->target_features = target_specific_features;
 
     g->target_data_ref = LLVMCreateTargetDataLayout(g->target_machine);
 
@@ -5152,12 +5650,12 @@ static ImportTableEntry *add_special_code(CodeGen *g, PackageTableEntry *package
     if ((err = os_path_real(&path_to_code_src, abs_full_path))) {
         zig_panic("unable to open '%s': %s", buf_ptr(&path_to_code_src), err_str(err));
     }
-    Buf *import_code = buf_alloc();
-    if ((err = os_fetch_file_path(abs_full_path, import_code))) {
+    SourceFile *source_file;
+    if ((err = source_cache_fetch(abs_full_path, &source_file))) {
         zig_panic("unable to open '%s': %s", buf_ptr(&path_to_code_src), err_str(err));
     }
 
-    return add_source_file(g, package, abs_full_path, import_code);
+    return add_source_file(g, package, abs_full_path, source_file->contents);
 }
 
 static PackageTableEntry *create_bootstrap_pkg(CodeGen *g, PackageTableEntry *pkg_with_main) {
@@ -5238,12 +5736,12 @@ static void gen_root_source(CodeGen *g) {
         zig_panic("unable to open '%s': %s", buf_ptr(rel_full_path), err_str(err));
     }
 
-    Buf *source_code = buf_alloc();
-    if ((err = os_fetch_file_path(rel_full_path, source_code))) {
+    SourceFile *source_file;
+    if ((err = source_cache_fetch(abs_full_path, &source_file))) {
         zig_panic("unable to open '%s': %s", buf_ptr(rel_full_path), err_str(err));
     }
 
-    g->root_import = add_source_file(g, g->root_package, abs_full_path, source_code);
+    g->root_import = add_source_file(g, g->root_package, abs_full_path, source_file->contents);
 
     assert(g->root_out_name);
     assert(g->out_type != OutTypeUnknown);
@@ -5297,6 +5795,7 @@ static void gen_root_source(CodeGen *g) {
 
 void codegen_add_assembly(CodeGen *g, Buf *path) {
     g->assembly_files.append(path);
+    g->dep_input_paths.append(path);
 }
 
 static void gen_global_asm(CodeGen *g) {
@@ -5313,6 +5812,7 @@ static void gen_global_asm(CodeGen *g) {
 
 void codegen_add_object(CodeGen *g, Buf *object_path) {
     g->link_objects.append(object_path);
+    g->dep_input_paths.append(object_path);
 }
 
 // Must be coordinated with with CIntType enum
@@ -5424,6 +5924,7 @@ static void get_c_type(CodeGen *g, TypeTableEntry *type_entry, Buf *out_buf) {
                 return;
             }
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdErrorUnion:
         case TypeTableEntryIdPureError:
         case TypeTableEntryIdEnum:
@@ -5590,6 +6091,70 @@ void codegen_print_timing_report(CodeGen *g, FILE *f) {
                 (next_te->time - te->time) / total);
     }
     fprintf(f, "%20s%12.4f%12.4f%12.4f%12.4f\n", "Total", 0.0, total, total, 1.0);
+
+    if (g->time_report != nullptr)
+        time_report_finish(g, f);
+}
+
+static void append_dep_manifest_entry(Buf *manifest, Buf *path,
+        HashMap<Buf *, bool, buf_hash, buf_eql_buf> *seen_paths)
+{
+    if (seen_paths->put_unique(path, true))
+        return;
+    // a file which cannot be read gets a hash that never matches, so the
+    // next build does not skip this compilation
+    Buf contents = BUF_INIT;
+    uint64_t hash = os_fetch_file_path(path, &contents) ? 0 : cache_hash_buf(&contents);
+    buf_appendf(manifest, "%016" ZIG_PRI_x64 " %s\n", hash, buf_ptr(path));
+    buf_deinit(&contents);
+}
+
+void codegen_write_dep_manifest(CodeGen *g, Buf *manifest_path, uint64_t args_hash) {
+    Buf *manifest = buf_alloc();
+    buf_appendf(manifest, "zig-dep-manifest 2\n");
+
+    // A different compiler can produce different output from the same inputs. If
+    // the path of this one is unknown, the entry is one that never matches.
+    Buf *self_exe_path;
+    uint64_t self_exe_hash;
+    if (cache_compiler_hash(&self_exe_path, &self_exe_hash)) {
+        buf_appendf(manifest, "compiler %s %016" ZIG_PRI_x64 " %s\n", ZIG_VERSION_STRING, self_exe_hash,
+                buf_ptr(self_exe_path));
+    } else {
+        buf_appendf(manifest, "compiler %s %016" ZIG_PRI_x64 " \n", ZIG_VERSION_STRING, (uint64_t)0);
+    }
+
+    buf_appendf(manifest, "args %016" ZIG_PRI_x64 "\n", args_hash);
+
+    HashMap<Buf *, bool, buf_hash, buf_eql_buf> seen_paths = {};
+    seen_paths.init(64);
+
+    auto it = g->import_table.entry_iterator();
+    for (;;) {
+        auto *entry = it.next();
+        if (!entry)
+            break;
+        ImportTableEntry *import = entry->value;
+        // builtin.zig is generated from the options, which the args hash covers
+        if (import == g->compile_var_import || import->path == nullptr)
+            continue;
+        append_dep_manifest_entry(manifest, import->path, &seen_paths);
+    }
+    for (size_t i = 0; i < g->embed_file_paths.length; i += 1) {
+        append_dep_manifest_entry(manifest, g->embed_file_paths.at(i), &seen_paths);
+    }
+    for (size_t i = 0; i < g->dep_input_paths.length; i += 1) {
+        append_dep_manifest_entry(manifest, g->dep_input_paths.at(i), &seen_paths);
+    }
+    // libraries given by path are usually built by another step of the same build
+    for (size_t i = 0; i < g->link_libs_list.length; i += 1) {
+        Buf *lib_name = g->link_libs_list.at(i)->name;
+        if (os_path_is_absolute(lib_name))
+            append_dep_manifest_entry(manifest, lib_name, &seen_paths);
+    }
+    seen_paths.deinit();
+
+    os_write_file(manifest_path, manifest);
 }
 
 void codegen_add_time_event(CodeGen *g, const char *name) {
@@ -5598,12 +6163,24 @@ void codegen_add_time_event(CodeGen *g, const char *name) {
 
 void codegen_build(CodeGen *g) {
     assert(g->out_type != OutTypeUnknown);
+    assert(!g->ir_released);
     init(g);
+    Arena *prev_const_val_arena = set_const_val_arena(&g->analysis_arena);
 
     gen_global_asm(g);
+    if (g->want_comptime_cache)
+        comptime_cache_init(g);
     gen_root_source(g);
+    if (g->comptime_cache != nullptr && g->errors.length == 0)
+        comptime_cache_save(g);
     do_code_gen(g);
+    arena_deinit(&g->codegen_arena);
     gen_h_file(g);
+
+    set_const_val_arena(prev_const_val_arena);
+    // see ir_released
+    arena_deinit(&g->ir_arena);
+    g->ir_released = true;
 }
 
 PackageTableEntry *codegen_create_package(CodeGen *g, const char *root_src_dir, const char *root_src_path) {
@@ -26,6 +26,11 @@ void codegen_set_each_lib_rpath(CodeGen *codegen, bool each_lib_rpath);
 void codegen_set_is_static(CodeGen *codegen, bool is_static);
 void codegen_set_strip(CodeGen *codegen, bool strip);
 void codegen_set_verbose(CodeGen *codegen, bool verbose);
+// Writes a Chrome trace of the detailed time report to trace_path, see time_report.hpp.
+void codegen_set_time_report(CodeGen *codegen, Buf *trace_path);
+void codegen_set_codegen_threads(CodeGen *codegen, size_t thread_count);
+void codegen_set_lto(CodeGen *codegen, ZigLLVMLTOMode lto_mode);
+void codegen_set_ir_gen_threads(CodeGen *codegen, size_t thread_count);
 void codegen_set_errmsg_color(CodeGen *codegen, ErrColor err_color);
 void codegen_set_out_name(CodeGen *codegen, Buf *out_name);
 void codegen_set_libc_lib_dir(CodeGen *codegen, Buf *libc_lib_dir);
@@ -51,6 +56,9 @@ void codegen_set_cache_dir(CodeGen *g, Buf *cache_dir);
 void codegen_set_output_h_path(CodeGen *g, Buf *h_path);
 void codegen_add_time_event(CodeGen *g, const char *name);
 void codegen_print_timing_report(CodeGen *g, FILE *f);
+// Lists every file the compilation read with the hash of its contents, after a
+// line with args_hash, the hash of the command line.
+void codegen_write_dep_manifest(CodeGen *g, Buf *manifest_path, uint64_t args_hash);
 void codegen_build(CodeGen *g);
 
 PackageTableEntry *codegen_create_package(CodeGen *g, const char *root_src_dir, const char *root_src_path);
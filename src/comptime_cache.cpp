@@ -0,0 +1,1395 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "comptime_cache.hpp"
+#include "analyze.hpp"
+#include "cache_hash.hpp"
+#include "os.hpp"
+#include "parser.hpp"
+#include "source_cache.hpp"
+
+#include <stdio.h>
+
+enum ComptimeCacheDeclId {
+    // The hash of a declaration covers its tokens from where it starts to where the
+    // next declaration or field of its container starts, so edits elsewhere in the
+    // file, and changes of whitespace and comments, do not affect it.
+    ComptimeCacheDeclIdNode,
+    // all of a loaded file, which depends on each of its declarations
+    ComptimeCacheDeclIdLoadedFile,
+    // Only the files which are loaded have an AST, so a file which is not loaded yet
+    // is hashed as a whole, and depends on the files it imports.
+    ComptimeCacheDeclIdUnloadedFile,
+};
+
+// A declaration which a cached function can reach.
+struct ComptimeCacheDecl {
+    ComptimeCacheDeclId id;
+    AstNode *node;
+    // the containers the declaration is in, starting with the root of its file
+    AstNode **containers;
+    size_t container_count;
+    // the file which is not loaded, and its package
+    Buf *path;
+    PackageTableEntry *package;
+
+    bool walked;
+    bool uncacheable;
+    uint64_t hash;
+    ZigList<ComptimeCacheDecl *> deps;
+    // the paths and content hashes of @embedFile files
+    ZigList<Buf *> inputs;
+    size_t added_by_walk;
+    size_t visit_epoch;
+};
+
+struct ComptimeCacheResult {
+    // backward branches the evaluation took, which a hit charges to the caller
+    size_t branch_count;
+    Buf *value;
+};
+
+static uint32_t node_ptr_hash(AstNode *node) {
+    return ptr_hash(node);
+}
+
+static bool node_ptr_eql(AstNode *a, AstNode *b) {
+    return ptr_eq(a, b);
+}
+
+struct ComptimeCache {
+    Buf *cache_path;
+    Buf options_hash;
+
+    // state of the previous build
+    bool have_prev_state;
+    HashMap<Buf *, ComptimeCacheResult, buf_hash, buf_eql_buf> prev_results;
+
+    // state of this build
+    // Whether an import is loaded decides how it is hashed, so these are only
+    // valid while decls_import_count files are loaded.
+    HashMap<AstNode *, ComptimeCacheDecl *, node_ptr_hash, node_ptr_eql> decls;
+    HashMap<Buf *, ComptimeCacheDecl *, buf_hash, buf_eql_buf> unloaded_files;
+    HashMap<AstNode *, Buf *, node_ptr_hash, node_ptr_eql> closure_hashes;
+    size_t decls_import_count;
+    size_t walk_count;
+    size_t visit_epoch;
+    ZigList<Buf *> result_keys;
+    HashMap<Buf *, ComptimeCacheResult, buf_hash, buf_eql_buf> results;
+};
+
+static const char *cache_file_magic = "zig-comptime-cache 3";
+
+static void hash_options(CodeGen *g, Buf *out_hex) {
+    CacheHash ch;
+    cache_hash_init(&ch);
+    cache_hash_add_compiler(&ch);
+    cache_hash_add_buf(&ch, &g->triple_str);
+    cache_hash_add_int(&ch, g->build_mode);
+    cache_hash_add_bool(&ch, g->is_test_build);
+
+    buf_resize(out_hex, 0);
+    cache_hash_final(&ch, out_hex);
+}
+
+static bool parse_hex_digit(char c, uint8_t *out) {
+    if (c >= '0' && c <= '9') {
+        *out = c - '0';
+        return true;
+    } else if (c >= 'a' && c <= 'f') {
+        *out = c - 'a' + 10;
+        return true;
+    }
+    return false;
+}
+
+static void append_hex(Buf *out, Buf *bytes) {
+    static const char hex_digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < buf_len(bytes); i += 1) {
+        uint8_t byte = (uint8_t)buf_ptr(bytes)[i];
+        buf_append_char(out, hex_digits[byte >> 4]);
+        buf_append_char(out, hex_digits[byte & 0xf]);
+    }
+}
+
+static Buf *parse_hex(const char *ptr, const char *end) {
+    if ((end - ptr) % 2 != 0)
+        return nullptr;
+    Buf *bytes = buf_alloc();
+    for (; ptr != end; ptr += 2) {
+        uint8_t hi, lo;
+        if (!parse_hex_digit(ptr[0], &hi) || !parse_hex_digit(ptr[1], &lo))
+            return nullptr;
+        buf_append_char(bytes, (char)((hi << 4) | lo));
+    }
+    return bytes;
+}
+
+static void load_prev_state(ComptimeCache *cache) {
+    Buf *contents = buf_alloc();
+    if (os_fetch_file_path(cache->cache_path, contents))
+        return;
+
+    bool saw_magic = false;
+    Buf prev_options_hash = BUF_INIT;
+    buf_resize(&prev_options_hash, 0);
+    size_t line_start = 0;
+    while (line_start < buf_len(contents)) {
+        const char *line = buf_ptr(contents) + line_start;
+        const char *newline = strchr(line, '\n');
+        if (newline == nullptr)
+            return;
+        size_t line_len = newline - line;
+        line_start += line_len + 1;
+
+        if (!saw_magic) {
+            if (!mem_eql_str(line, line_len, cache_file_magic))
+                return;
+            saw_magic = true;
+        } else if (line_len > 8 && memcmp(line, "options ", 8) == 0) {
+            buf_init_from_mem(&prev_options_hash, line + 8, line_len - 8);
+        } else if (line_len > 7 && memcmp(line, "result ", 7) == 0) {
+            // result <branch count> <key in hex> <value>
+            ComptimeCacheResult result;
+            char *branch_count_end;
+            result.branch_count = strtoull(line + 7, &branch_count_end, 10);
+            if (*branch_count_end != ' ')
+                return;
+            const char *key_start = branch_count_end + 1;
+            const char *key_end = (const char *)memchr(key_start, ' ', newline - key_start);
+            if (key_end == nullptr)
+                return;
+            Buf *key = parse_hex(key_start, key_end);
+            if (key == nullptr)
+                return;
+            result.value = buf_create_from_mem(key_end + 1, newline - (key_end + 1));
+            cache->prev_results.put(key, result);
+        } else {
+            return;
+        }
+    }
+    cache->have_prev_state = saw_magic && buf_eql_buf(&prev_options_hash, &cache->options_hash);
+}
+
+void comptime_cache_init(CodeGen *g) {
+    ComptimeCache *cache = allocate<ComptimeCache>(1);
+    cache->prev_results.init(64);
+    cache->decls.init(64);
+    cache->unloaded_files.init(16);
+    cache->closure_hashes.init(16);
+    cache->results.init(64);
+
+    buf_resize(&cache->options_hash, 0);
+    hash_options(g, &cache->options_hash);
+
+    // The name is not derived from root_out_name because the builds of builtin and
+    // compiler_rt get a different scratch name every time, see build_o_raw.
+    CacheHash ch;
+    cache_hash_init(&ch);
+    cache_hash_add_buf(&ch, &cache->options_hash);
+    cache_hash_add_int(&ch, g->out_type);
+    if (g->root_package != nullptr) {
+        cache_hash_add_buf(&ch, &g->root_package->root_src_dir);
+        cache_hash_add_buf(&ch, &g->root_package->root_src_path);
+    }
+    Buf *cache_name = buf_create_from_str("comptime-");
+    cache_hash_final(&ch, cache_name);
+    cache->cache_path = buf_alloc();
+    os_path_join(g->cache_dir, cache_name, cache->cache_path);
+
+    load_prev_state(cache);
+
+    g->comptime_cache = cache;
+}
+
+static size_t node_offset(AstNode *node) {
+    return node->owner->line_offsets->at(node->line) + node->column;
+}
+
+static Buf *decl_name(AstNode *node) {
+    switch (node->type) {
+        case NodeTypeVariableDeclaration:
+            return node->data.variable_declaration.symbol;
+        case NodeTypeFnDef:
+            return node->data.fn_def.fn_proto->data.fn_proto.name;
+        case NodeTypeFnProto:
+            return node->data.fn_proto.name;
+        default:
+            return nullptr;
+    }
+}
+
+static ZigList<AstNode *> *container_decls(AstNode *container) {
+    if (container->type == NodeTypeRoot)
+        return &container->data.root.top_level_decls;
+    assert(container->type == NodeTypeContainerDecl);
+    return &container->data.container_decl.decls;
+}
+
+static AstNode *find_container_decl(AstNode *container, Buf *name) {
+    ZigList<AstNode *> *decls = container_decls(container);
+    for (size_t i = 0; i < decls->length; i += 1) {
+        Buf *other_name = decl_name(decls->at(i));
+        if (other_name != nullptr && buf_eql_buf(other_name, name))
+            return decls->at(i);
+    }
+    return nullptr;
+}
+
+static uint64_t hash_tokens(Buf *text, ZigList<Token> *tokens) {
+    CacheHash ch;
+    cache_hash_init(&ch);
+    for (size_t i = 0; i < tokens->length; i += 1) {
+        Token *token = &tokens->at(i);
+        cache_hash_add_int(&ch, token->id);
+        cache_hash_add_int(&ch, token->end_pos - token->start_pos);
+        cache_hash_add_mem(&ch, buf_ptr(text) + token->start_pos, token->end_pos - token->start_pos);
+    }
+    return ch.value;
+}
+
+static void hash_decl_tokens(ComptimeCacheDecl *decl) {
+    AstNode *node = decl->node;
+    size_t start = node_offset(node);
+    size_t end = buf_len(node->owner->source_code);
+    for (size_t i = 0; i < decl->container_count; i += 1) {
+        AstNode *container = decl->containers[i];
+        ZigList<AstNode *> *decls = container_decls(container);
+        for (size_t j = 0; j < decls->length; j += 1) {
+            size_t offset = node_offset(decls->at(j));
+            if (offset > start && offset < end)
+                end = offset;
+        }
+        if (container->type != NodeTypeContainerDecl)
+            continue;
+        ZigList<AstNode *> *fields = &container->data.container_decl.fields;
+        for (size_t j = 0; j < fields->length; j += 1) {
+            size_t offset = node_offset(fields->at(j));
+            if (offset > start && offset < end)
+                end = offset;
+        }
+    }
+
+    Buf text = BUF_INIT;
+    buf_init_from_mem(&text, buf_ptr(node->owner->source_code) + start, end - start);
+    Tokenization tokenization = {0};
+    tokenize(&text, &tokenization);
+    if (tokenization.err) {
+        decl->uncacheable = true;
+    } else {
+        decl->hash = hash_tokens(&text, tokenization.tokens);
+    }
+    tokenization.tokens->deinit();
+    tokenization.line_offsets->deinit();
+    buf_deinit(&text);
+}
+
+static ComptimeCacheDecl *get_decl(ComptimeCache *cache, AstNode *node, AstNode **containers,
+        size_t container_count)
+{
+    bool found_existing;
+    auto entry = cache->decls.get_or_put(node, &found_existing);
+    if (found_existing)
+        return entry->value;
+    ComptimeCacheDecl *decl = allocate<ComptimeCacheDecl>(1);
+    decl->id = ComptimeCacheDeclIdNode;
+    decl->node = node;
+    decl->containers = allocate<AstNode *>(container_count);
+    memcpy(decl->containers, containers, container_count * sizeof(AstNode *));
+    decl->container_count = container_count;
+    entry->value = decl;
+    return decl;
+}
+
+// Returns the loaded file which @import(target) in a file of package from_package
+// at from_path refers to. Otherwise sets out_path to the file, or leaves it empty
+// if there is none.
+static ImportTableEntry *resolve_import(CodeGen *g, PackageTableEntry *from_package, Buf *from_path,
+        Buf *target, Buf *out_path, PackageTableEntry **out_package)
+{
+    Buf *target_path;
+    Buf search_dir = BUF_INIT;
+    auto package_entry = from_package->package_table.maybe_get(target);
+    if (package_entry != nullptr) {
+        *out_package = package_entry->value;
+        target_path = &package_entry->value->root_src_path;
+        buf_init_from_buf(&search_dir, &package_entry->value->root_src_dir);
+    } else {
+        *out_package = from_package;
+        target_path = target;
+        os_path_dirname(from_path, &search_dir);
+    }
+    Buf full_path = BUF_INIT;
+    os_path_join(&search_dir, target_path, &full_path);
+    buf_resize(out_path, 0);
+    if (os_path_real(&full_path, out_path)) {
+        buf_resize(out_path, 0);
+        return nullptr;
+    }
+    auto import_entry = g->import_table.maybe_get(out_path);
+    return (import_entry != nullptr) ? import_entry->value : nullptr;
+}
+
+static void add_embed_input(ComptimeCacheDecl *decl, Buf *from_path, Buf *target) {
+    Buf dir = BUF_INIT;
+    os_path_dirname(from_path, &dir);
+    Buf path = BUF_INIT;
+    os_path_resolve(&dir, target, &path);
+    Buf contents = BUF_INIT;
+    uint64_t hash = os_fetch_file_path(&path, &contents) ? 0 : cache_hash_buf(&contents);
+    decl->inputs.append(buf_sprintf("%s %016" ZIG_PRI_x64, buf_ptr(&path), hash));
+}
+
+// A file which is not loaded has no AST, so all of it is a dependency, along with
+// the files it imports. They are found from the tokens.
+static ComptimeCacheDecl *get_unloaded_file(CodeGen *g, Buf *path, PackageTableEntry *package) {
+    ComptimeCache *cache = g->comptime_cache;
+    bool found_existing;
+    auto entry = cache->unloaded_files.get_or_put(path, &found_existing);
+    if (found_existing)
+        return entry->value;
+    ComptimeCacheDecl *decl = allocate<ComptimeCacheDecl>(1);
+    decl->id = ComptimeCacheDeclIdUnloadedFile;
+    decl->path = buf_create_from_buf(path);
+    decl->package = package;
+    entry->key = decl->path;
+    entry->value = decl;
+    return decl;
+}
+
+// The dependency on all of a file. A loaded file depends on each of its declarations.
+static ComptimeCacheDecl *get_import_dep(CodeGen *g, ImportTableEntry *import, Buf *path,
+        PackageTableEntry *package)
+{
+    ComptimeCache *cache = g->comptime_cache;
+    if (import == nullptr)
+        return (buf_len(path) == 0) ? nullptr : get_unloaded_file(g, path, package);
+
+    auto entry = cache->decls.maybe_get(import->root);
+    if (entry != nullptr)
+        return entry->value;
+    ComptimeCacheDecl *decl = allocate<ComptimeCacheDecl>(1);
+    decl->id = ComptimeCacheDeclIdLoadedFile;
+    decl->walked = true;
+    ZigList<AstNode *> *decls = &import->root->data.root.top_level_decls;
+    for (size_t i = 0; i < decls->length; i += 1) {
+        decl->deps.append(get_decl(cache, decls->at(i), &import->root, 1));
+    }
+    cache->decls.put(import->root, decl);
+    return decl;
+}
+
+static void walk_unloaded_tokens(CodeGen *g, ComptimeCacheDecl *decl, Buf *contents, ZigList<Token> *tokens) {
+    decl->hash = hash_tokens(contents, tokens);
+
+    Buf target = BUF_INIT;
+    Buf target_path = BUF_INIT;
+    for (size_t i = 0; i + 1 < tokens->length; i += 1) {
+        if (tokens->at(i).id != TokenIdAtSign || tokens->at(i + 1).id != TokenIdSymbol)
+            continue;
+        Token *name = &tokens->at(i + 1);
+        const char *name_ptr = buf_ptr(contents) + name->start_pos;
+        size_t name_len = name->end_pos - name->start_pos;
+        bool is_import = mem_eql_str(name_ptr, name_len, "import");
+        bool is_embed = mem_eql_str(name_ptr, name_len, "embedFile");
+        if (mem_eql_str(name_ptr, name_len, "cImport")) {
+            decl->uncacheable = true;
+            return;
+        }
+        if (!is_import && !is_embed)
+            continue;
+        if (i + 4 >= tokens->length || tokens->at(i + 2).id != TokenIdLParen ||
+            tokens->at(i + 3).id != TokenIdStringLiteral || tokens->at(i + 4).id != TokenIdRParen)
+        {
+            decl->uncacheable = true;
+            return;
+        }
+        bool is_c_str;
+        token_str_lit(contents, &tokens->at(i + 3), &target, &is_c_str);
+        if (is_embed) {
+            add_embed_input(decl, decl->path, &target);
+            continue;
+        }
+        PackageTableEntry *target_package;
+        ImportTableEntry *import = resolve_import(g, decl->package, decl->path, &target, &target_path,
+                &target_package);
+        ComptimeCacheDecl *dep = get_import_dep(g, import, &target_path, target_package);
+        if (dep == nullptr) {
+            decl->uncacheable = true;
+            return;
+        }
+        decl->deps.append(dep);
+    }
+}
+
+static void walk_unloaded_file(CodeGen *g, ComptimeCacheDecl *decl) {
+    SourceFile *source_file;
+    if (source_cache_fetch(decl->path, &source_file) || source_cache_revalidate(source_file)) {
+        decl->uncacheable = true;
+        return;
+    }
+    Tokenization tokenization = {0};
+    tokenize(source_file->contents, &tokenization);
+    if (tokenization.err) {
+        decl->uncacheable = true;
+    } else {
+        walk_unloaded_tokens(g, decl, source_file->contents, tokenization.tokens);
+    }
+    tokenization.tokens->deinit();
+    tokenization.line_offsets->deinit();
+}
+
+struct DeclWalk {
+    CodeGen *g;
+    ComptimeCacheDecl *decl;
+    size_t walk_id;
+    // containers entered inside the declaration, whose declarations are part of its tokens
+    ZigList<AstNode *> inner;
+};
+
+static void append_dep(DeclWalk *w, ComptimeCacheDecl *dep) {
+    if (dep == w->decl || dep->added_by_walk == w->walk_id)
+        return;
+    dep->added_by_walk = w->walk_id;
+    w->decl->deps.append(dep);
+}
+
+static void add_dep(DeclWalk *w, AstNode *node, AstNode **containers, size_t container_count) {
+    append_dep(w, get_decl(w->g->comptime_cache, node, containers, container_count));
+}
+
+static ComptimeCacheDecl *get_import_dep(CodeGen *g, ImportTableEntry *import, Buf *path,
+        PackageTableEntry *package);
+
+// Every declaration of a loaded file, for a use of the file which does not name
+// one of them.
+static void add_whole_file(DeclWalk *w, ImportTableEntry *import) {
+    append_dep(w, get_import_dep(w->g, import, nullptr, nullptr));
+}
+
+// An @import which evaluated to import, or to the file at path which is not loaded.
+struct StaticImport {
+    ImportTableEntry *import;
+    Buf path;
+    PackageTableEntry *package;
+};
+
+static void add_import(DeclWalk *w, StaticImport *si) {
+    if (si->import != nullptr) {
+        add_whole_file(w, si->import);
+        return;
+    }
+    ComptimeCacheDecl *dep = get_import_dep(w->g, nullptr, &si->path, si->package);
+    if (dep == nullptr) {
+        w->decl->uncacheable = true;
+    } else {
+        append_dep(w, dep);
+    }
+}
+
+static bool find_symbol(DeclWalk *w, Buf *name, AstNode **containers, size_t container_count,
+        AstNode **out_decl, size_t *out_container_count);
+static bool static_import_of_decl(DeclWalk *w, AstNode *node, AstNode **containers, size_t container_count,
+        size_t depth, StaticImport *out);
+
+static bool static_import_call(DeclWalk *w, AstNode *node, StaticImport *out) {
+    if (node->type != NodeTypeFnCallExpr || !node->data.fn_call_expr.is_builtin ||
+        !buf_eql_str(node->data.fn_call_expr.fn_ref_expr->data.symbol_expr.symbol, "import"))
+    {
+        return false;
+    }
+    ZigList<AstNode *> *params = &node->data.fn_call_expr.params;
+    if (params->length != 1 || params->at(0)->type != NodeTypeStringLiteral)
+        return false;
+    ImportTableEntry *owner = node->owner;
+    buf_resize(&out->path, 0);
+    out->import = resolve_import(w->g, owner->package, owner->path, params->at(0)->data.string_literal.buf,
+            &out->path, &out->package);
+    return true;
+}
+
+// Finds the file an expression refers to without analyzing it. Only @import, and
+// constants which are initialized with an @import or with a member of a file which
+// is one, are followed.
+static bool static_import_expr(DeclWalk *w, AstNode *node, AstNode **containers, size_t container_count,
+        size_t depth, StaticImport *out)
+{
+    if (depth > 16)
+        return false;
+    switch (node->type) {
+        case NodeTypeFnCallExpr:
+            return static_import_call(w, node, out);
+        case NodeTypeSymbol:
+            {
+                AstNode *decl_node;
+                size_t decl_container_count;
+                if (!find_symbol(w, node->data.symbol_expr.symbol, containers, container_count,
+                            &decl_node, &decl_container_count))
+                {
+                    return false;
+                }
+                return static_import_of_decl(w, decl_node, containers, decl_container_count, depth + 1, out);
+            }
+        case NodeTypeFieldAccessExpr:
+            {
+                StaticImport lhs = {};
+                if (!static_import_expr(w, node->data.field_access_expr.struct_expr, containers,
+                            container_count, depth + 1, &lhs) || lhs.import == nullptr)
+                {
+                    return false;
+                }
+                AstNode *root = lhs.import->root;
+                AstNode *member = find_container_decl(root, node->data.field_access_expr.field_name);
+                if (member == nullptr)
+                    return false;
+                add_dep(w, member, &root, 1);
+                return static_import_of_decl(w, member, &root, 1, depth + 1, out);
+            }
+        default:
+            return false;
+    }
+}
+
+static bool static_import_of_decl(DeclWalk *w, AstNode *node, AstNode **containers, size_t container_count,
+        size_t depth, StaticImport *out)
+{
+    if (node->type != NodeTypeVariableDeclaration || !node->data.variable_declaration.is_const ||
+        node->data.variable_declaration.expr == nullptr)
+    {
+        return false;
+    }
+    return static_import_expr(w, node->data.variable_declaration.expr, containers, container_count, depth, out);
+}
+
+// Looks name up in containers, innermost first, and adds the declaration it finds
+// as a dependency. A name which is not declared in a container can come from its
+// use declarations, which become dependencies as well.
+static bool find_symbol(DeclWalk *w, Buf *name, AstNode **containers, size_t container_count,
+        AstNode **out_decl, size_t *out_container_count)
+{
+    for (size_t i = container_count; i > 0; i -= 1) {
+        AstNode *decl_node = find_container_decl(containers[i - 1], name);
+        if (decl_node != nullptr) {
+            add_dep(w, decl_node, containers, i);
+            *out_decl = decl_node;
+            *out_container_count = i;
+            return true;
+        }
+        ZigList<AstNode *> *decls = container_decls(containers[i - 1]);
+        for (size_t j = 0; j < decls->length; j += 1) {
+            AstNode *use_node = decls->at(j);
+            if (use_node->type != NodeTypeUse)
+                continue;
+            add_dep(w, use_node, containers, i);
+        }
+    }
+    return false;
+}
+
+static bool is_inner_symbol(DeclWalk *w, AstNode *node) {
+    if (node->type != NodeTypeSymbol)
+        return false;
+    for (size_t i = 0; i < w->inner.length; i += 1) {
+        if (find_container_decl(w->inner.at(i), node->data.symbol_expr.symbol) != nullptr)
+            return true;
+    }
+    return false;
+}
+
+static void walk_node(DeclWalk *w, AstNode *node);
+
+static void walk_visit(AstNode **node, void *context) {
+    walk_node(reinterpret_cast<DeclWalk *>(context), *node);
+}
+
+static void walk_node(DeclWalk *w, AstNode *node) {
+    ComptimeCacheDecl *decl = w->decl;
+    switch (node->type) {
+        case NodeTypeSymbol:
+            {
+                if (is_inner_symbol(w, node))
+                    return;
+                AstNode *decl_node;
+                size_t decl_container_count;
+                if (!find_symbol(w, node->data.symbol_expr.symbol, decl->containers, decl->container_count,
+                            &decl_node, &decl_container_count))
+                {
+                    return;
+                }
+                // a file used as a value can have any of its declarations looked up
+                StaticImport si = {};
+                if (static_import_of_decl(w, decl_node, decl->containers, decl_container_count, 0, &si))
+                    add_import(w, &si);
+                return;
+            }
+        case NodeTypeFieldAccessExpr:
+            {
+                AstNode *lhs = node->data.field_access_expr.struct_expr;
+                StaticImport si = {};
+                if (is_inner_symbol(w, lhs) ||
+                    !static_import_expr(w, lhs, decl->containers, decl->container_count, 0, &si))
+                {
+                    break;
+                }
+                if (si.import == nullptr) {
+                    add_import(w, &si);
+                    return;
+                }
+                AstNode *root = si.import->root;
+                AstNode *member = find_container_decl(root, node->data.field_access_expr.field_name);
+                if (member == nullptr) {
+                    add_whole_file(w, si.import);
+                    return;
+                }
+                add_dep(w, member, &root, 1);
+                StaticImport member_si = {};
+                if (static_import_of_decl(w, member, &root, 1, 0, &member_si))
+                    add_import(w, &member_si);
+                return;
+            }
+        case NodeTypeFnCallExpr:
+            {
+                if (!node->data.fn_call_expr.is_builtin)
+                    break;
+                Buf *name = node->data.fn_call_expr.fn_ref_expr->data.symbol_expr.symbol;
+                ZigList<AstNode *> *params = &node->data.fn_call_expr.params;
+                if (buf_eql_str(name, "cImport")) {
+                    // translated C code does not keep track of the headers it came from
+                    decl->uncacheable = true;
+                    return;
+                } else if (buf_eql_str(name, "import")) {
+                    StaticImport si = {};
+                    if (!static_import_call(w, node, &si)) {
+                        decl->uncacheable = true;
+                        return;
+                    }
+                    // The file that a constant names is a dependency where its members are used.
+                    if (decl->node->type == NodeTypeVariableDeclaration &&
+                        decl->node->data.variable_declaration.is_const &&
+                        decl->node->data.variable_declaration.expr == node && si.import != nullptr)
+                    {
+                        return;
+                    }
+                    add_import(w, &si);
+                    return;
+                } else if (buf_eql_str(name, "embedFile")) {
+                    if (params->length != 1 || params->at(0)->type != NodeTypeStringLiteral) {
+                        decl->uncacheable = true;
+                        return;
+                    }
+                    add_embed_input(decl, node->owner->path, params->at(0)->data.string_literal.buf);
+                    return;
+                }
+                for (size_t i = 0; i < params->length; i += 1) {
+                    walk_node(w, params->at(i));
+                }
+                return;
+            }
+        case NodeTypeThisLiteral:
+            // the rest of the container is not part of the tokens of the declaration
+            if (w->inner.length == 0) {
+                AstNode *container = decl->containers[decl->container_count - 1];
+                if (container->type == NodeTypeRoot) {
+                    add_whole_file(w, decl->node->owner);
+                    return;
+                }
+                ZigList<AstNode *> *fields = &container->data.container_decl.fields;
+                for (size_t i = 0; i < fields->length; i += 1) {
+                    add_dep(w, fields->at(i), decl->containers, decl->container_count);
+                }
+                ZigList<AstNode *> *decls = &container->data.container_decl.decls;
+                for (size_t i = 0; i < decls->length; i += 1) {
+                    add_dep(w, decls->at(i), decl->containers, decl->container_count);
+                }
+            }
+            return;
+        case NodeTypeContainerDecl:
+            w->inner.append(node);
+            ast_visit_node_children(node, walk_visit, w);
+            w->inner.pop();
+            return;
+        default:
+            break;
+    }
+    ast_visit_node_children(node, walk_visit, w);
+}
+
+static void walk_decl(CodeGen *g, ComptimeCacheDecl *decl) {
+    decl->walked = true;
+    if (decl->id == ComptimeCacheDeclIdUnloadedFile) {
+        walk_unloaded_file(g, decl);
+        return;
+    }
+    assert(decl->id == ComptimeCacheDeclIdNode);
+    hash_decl_tokens(decl);
+    if (decl->uncacheable)
+        return;
+    ComptimeCache *cache = g->comptime_cache;
+    cache->walk_count += 1;
+    DeclWalk w = {g, decl, cache->walk_count, {0}};
+    walk_node(&w, decl->node);
+    w.inner.deinit();
+}
+
+// Hashes every declaration the function can reach, and the files which it can
+// import and which are not loaded yet. Returns false if one of them cannot be
+// cached.
+static bool hash_closure(CodeGen *g, ComptimeCacheDecl *fn_decl, Buf *out_hex) {
+    ComptimeCache *cache = g->comptime_cache;
+    cache->visit_epoch += 1;
+    CacheHash ch;
+    cache_hash_init(&ch);
+    ZigList<ComptimeCacheDecl *> stack = {0};
+    stack.append(fn_decl);
+    fn_decl->visit_epoch = cache->visit_epoch;
+    bool ok = true;
+    while (stack.length != 0) {
+        ComptimeCacheDecl *decl = stack.pop();
+        if (!decl->walked)
+            walk_decl(g, decl);
+        if (decl->uncacheable) {
+            ok = false;
+            break;
+        }
+        switch (decl->id) {
+            case ComptimeCacheDeclIdNode:
+                cache_hash_add_buf(&ch, decl->node->owner->path);
+                cache_hash_add_int(&ch, decl->hash);
+                break;
+            case ComptimeCacheDeclIdLoadedFile:
+                break;
+            case ComptimeCacheDeclIdUnloadedFile:
+                cache_hash_add_str(&ch, "unloaded");
+                cache_hash_add_buf(&ch, decl->path);
+                cache_hash_add_int(&ch, decl->hash);
+                break;
+        }
+        for (size_t i = 0; i < decl->inputs.length; i += 1) {
+            cache_hash_add_buf(&ch, decl->inputs.at(i));
+        }
+        for (size_t i = decl->deps.length; i > 0; i -= 1) {
+            ComptimeCacheDecl *dep = decl->deps.at(i - 1);
+            if (dep->visit_epoch == cache->visit_epoch)
+                continue;
+            dep->visit_epoch = cache->visit_epoch;
+            stack.append(dep);
+        }
+    }
+    stack.deinit();
+    if (ok)
+        cache_hash_final(&ch, out_hex);
+    return ok;
+}
+
+// The arguments and the function of a call are all of the key, rather than a hash
+// of them, so that two different calls can never share a result. Only the code the
+// function can reach is represented by a hash, see hash_closure.
+static void key_add_mem(Buf *key, const void *ptr, size_t len) {
+    buf_append_mem(key, reinterpret_cast<const char *>(ptr), len);
+}
+
+static void key_add_int(Buf *key, uint64_t x) {
+    key_add_mem(key, &x, sizeof(x));
+}
+
+static void key_add_bool(Buf *key, bool b) {
+    buf_append_char(key, b ? 1 : 0);
+}
+
+static void key_add_buf(Buf *key, Buf *buf) {
+    key_add_int(key, buf_len(buf));
+    key_add_mem(key, buf_ptr(buf), buf_len(buf));
+}
+
+static bool key_type(Buf *key, TypeTableEntry *type_entry) {
+    switch (type_entry->id) {
+        case TypeTableEntryIdMetaType:
+        case TypeTableEntryIdVoid:
+        case TypeTableEntryIdBool:
+        case TypeTableEntryIdInt:
+        case TypeTableEntryIdFloat:
+        case TypeTableEntryIdNumLitInt:
+        case TypeTableEntryIdNumLitFloat:
+            break;
+        case TypeTableEntryIdArray:
+            if (!key_type(key, type_entry->data.array.child_type))
+                return false;
+            break;
+        case TypeTableEntryIdPointer:
+            if (!key_type(key, type_entry->data.pointer.child_type))
+                return false;
+            break;
+        case TypeTableEntryIdMaybe:
+            if (!key_type(key, type_entry->data.maybe.child_type))
+                return false;
+            break;
+        case TypeTableEntryIdStruct:
+            // the names of other containers do not identify them across builds
+            if (!type_entry->data.structure.is_slice)
+                return false;
+            if (!key_type(key, type_entry->data.structure.fields[0].type_entry))
+                return false;
+            break;
+        default:
+            return false;
+    }
+    // the names of these types are unique
+    key_add_buf(key, &type_entry->name);
+    return true;
+}
+
+static void key_bigint(Buf *key, BigInt *bigint) {
+    key_add_bool(key, bigint->is_negative);
+    key_add_int(key, bigint->digit_count);
+    const uint64_t *digits = bigint_ptr(bigint);
+    for (size_t i = 0; i < bigint->digit_count; i += 1) {
+        key_add_int(key, digits[i]);
+    }
+}
+
+static bool key_value(Buf *key, ConstExprValue *const_val);
+
+// The key does not depend on which form the array is in.
+static bool key_array_elems(Buf *key, ConstExprValue *array_val, uint64_t start, uint64_t end) {
+    ConstArrayValue *array = &array_val->data.x_array;
+    for (uint64_t i = start; i < end; i += 1) {
+        switch (array->special) {
+            case ConstArraySpecialNone:
+                if (!key_value(key, &array->s_none.elements[i]))
+                    return false;
+                break;
+            case ConstArraySpecialUndef:
+                return false;
+            case ConstArraySpecialRepeat:
+                if (!key_value(key, array->s_repeat.elem))
+                    return false;
+                break;
+            case ConstArraySpecialBuf:
+            case ConstArraySpecialInts:
+                {
+                    ConstExprValue elem_val = {};
+                    read_compact_array_elem(array_val, i, &elem_val);
+                    key_bigint(key, &elem_val.data.x_bigint);
+                    break;
+                }
+        }
+    }
+    return true;
+}
+
+static bool key_value(Buf *key, ConstExprValue *const_val) {
+    if (const_val->special != ConstValSpecialStatic)
+        return false;
+    TypeTableEntry *type_entry = const_val->type;
+    switch (type_entry->id) {
+        case TypeTableEntryIdVoid:
+            return true;
+        case TypeTableEntryIdBool:
+            key_add_bool(key, const_val->data.x_bool);
+            return true;
+        case TypeTableEntryIdInt:
+        case TypeTableEntryIdNumLitInt:
+            key_bigint(key, &const_val->data.x_bigint);
+            return true;
+        case TypeTableEntryIdFloat:
+            switch (type_entry->data.floating.bit_count) {
+                case 32:
+                    key_add_mem(key, &const_val->data.x_f32, 4);
+                    return true;
+                case 64:
+                    key_add_mem(key, &const_val->data.x_f64, 8);
+                    return true;
+                case 128:
+                    key_add_mem(key, &const_val->data.x_f128, 16);
+                    return true;
+                default:
+                    zig_unreachable();
+            }
+        case TypeTableEntryIdNumLitFloat:
+            {
+                float128_t f128 = bigfloat_to_f128(&const_val->data.x_bigfloat);
+                key_add_mem(key, &f128, 16);
+                return true;
+            }
+        case TypeTableEntryIdMetaType:
+            return key_type(key, const_val->data.x_type);
+        case TypeTableEntryIdArray:
+            return key_array_elems(key, const_val, 0, type_entry->data.array.len);
+        case TypeTableEntryIdPointer:
+            {
+                // the callee must not be able to observe anything but the value
+                if (const_val->data.x_ptr.mut != ConstPtrMutComptimeConst)
+                    return false;
+                switch (const_val->data.x_ptr.special) {
+                    case ConstPtrSpecialRef:
+                        return key_value(key, const_val->data.x_ptr.data.ref.pointee);
+                    case ConstPtrSpecialBaseArray:
+                        {
+                            ConstExprValue *array_val = const_val->data.x_ptr.data.base_array.array_val;
+                            if (array_val->special != ConstValSpecialStatic)
+                                return false;
+                            uint64_t len = array_val->type->data.array.len;
+                            size_t elem_index = const_val->data.x_ptr.data.base_array.elem_index;
+                            key_add_bool(key, const_val->data.x_ptr.data.base_array.is_cstr);
+                            key_add_int(key, len - elem_index);
+                            return key_array_elems(key, array_val, elem_index, len);
+                        }
+                    default:
+                        return false;
+                }
+            }
+        case TypeTableEntryIdStruct:
+            if (!type_entry->data.structure.is_slice)
+                return false;
+            return key_value(key, &const_val->data.x_struct.fields[slice_ptr_index]) &&
+                key_value(key, &const_val->data.x_struct.fields[slice_len_index]);
+        case TypeTableEntryIdMaybe:
+            key_add_bool(key, const_val->data.x_maybe != nullptr);
+            return const_val->data.x_maybe == nullptr || key_value(key, const_val->data.x_maybe);
+        default:
+            return false;
+    }
+}
+
+bool comptime_cache_key(CodeGen *g, Scope *exec_scope, Buf *out_key) {
+    buf_resize(out_key, 0);
+
+    Scope *scope = exec_scope;
+    while (scope->id == ScopeIdVarDecl) {
+        VariableTableEntry *var = ((ScopeVarDecl *)scope)->var;
+        key_add_buf(out_key, &var->name);
+        if (!key_type(out_key, var->value->type) || !key_value(out_key, var->value))
+            return false;
+        scope = scope->parent;
+    }
+    assert(scope->id == ScopeIdFnDef);
+    FnTableEntry *fn_entry = ((ScopeFnDef *)scope)->fn_entry;
+
+    // Functions of generic containers can refer to the parameters of the function
+    // which returned the container, which are not part of the key.
+    for (Scope *decls_scope = scope->parent; decls_scope != nullptr; decls_scope = decls_scope->parent) {
+        if (decls_scope->id != ScopeIdDecls)
+            return false;
+    }
+
+    AstNode *proto_node = fn_entry->proto_node;
+    if (proto_node == nullptr || proto_node->data.fn_proto.fn_def_node == nullptr)
+        return false;
+    ImportTableEntry *import = proto_node->owner;
+    if (import->c_import_node != nullptr)
+        return false;
+
+    size_t container_count = 0;
+    for (Scope *decls_scope = scope->parent; decls_scope != nullptr; decls_scope = decls_scope->parent) {
+        container_count += 1;
+    }
+    AstNode **containers = allocate<AstNode *>(container_count);
+    size_t container_index = container_count;
+    for (Scope *decls_scope = scope->parent; decls_scope != nullptr; decls_scope = decls_scope->parent) {
+        container_index -= 1;
+        containers[container_index] = decls_scope->source_node;
+    }
+
+    // The function is identified by its file and by the names of its containers,
+    // which stay the same when code is added before it.
+    key_add_buf(out_key, &import->package->root_src_dir);
+    key_add_buf(out_key, import->path);
+    for (size_t i = 1; i < container_count; i += 1) {
+        AstNode *container_decl = nullptr;
+        ZigList<AstNode *> *decls = container_decls(containers[i - 1]);
+        for (size_t j = 0; j < decls->length; j += 1) {
+            AstNode *decl_node = decls->at(j);
+            if (decl_node->type == NodeTypeVariableDeclaration &&
+                decl_node->data.variable_declaration.expr == containers[i])
+            {
+                container_decl = decl_node;
+                break;
+            }
+        }
+        if (container_decl != nullptr) {
+            key_add_buf(out_key, container_decl->data.variable_declaration.symbol);
+        } else {
+            key_add_int(out_key, containers[i]->line);
+            key_add_int(out_key, containers[i]->column);
+        }
+    }
+    key_add_buf(out_key, proto_node->data.fn_proto.name);
+
+    ComptimeCache *cache = g->comptime_cache;
+    if (cache->decls_import_count != (size_t)g->import_table.size()) {
+        cache->decls_import_count = g->import_table.size();
+        cache->decls.clear();
+        cache->unloaded_files.clear();
+        cache->closure_hashes.clear();
+    }
+    AstNode *fn_def_node = proto_node->data.fn_proto.fn_def_node;
+    Buf *closure_hash;
+    auto closure_entry = cache->closure_hashes.maybe_get(fn_def_node);
+    if (closure_entry != nullptr) {
+        closure_hash = closure_entry->value;
+    } else {
+        ComptimeCacheDecl *fn_decl = get_decl(cache, fn_def_node, containers, container_count);
+        closure_hash = buf_alloc();
+        if (!hash_closure(g, fn_decl, closure_hash))
+            closure_hash = nullptr;
+        cache->closure_hashes.put(fn_def_node, closure_hash);
+    }
+    free(containers);
+    if (closure_hash == nullptr)
+        return false;
+    key_add_buf(out_key, closure_hash);
+    return true;
+}
+
+// Values are stored as a string with a single letter prefix for each value.
+// The type of the value is known from the function, so there are no type tags.
+static bool serialize_value(Buf *out, ConstExprValue *const_val) {
+    if (const_val->special != ConstValSpecialStatic)
+        return false;
+    TypeTableEntry *type_entry = const_val->type;
+    switch (type_entry->id) {
+        case TypeTableEntryIdVoid:
+            buf_append_char(out, 'V');
+            return true;
+        case TypeTableEntryIdBool:
+            buf_append_char(out, const_val->data.x_bool ? 'T' : 'F');
+            return true;
+        case TypeTableEntryIdInt:
+        case TypeTableEntryIdNumLitInt:
+            {
+                BigInt *bigint = &const_val->data.x_bigint;
+                buf_append_str(out, bigint->is_negative ? "I-" : "I");
+                if (bigint->digit_count == 0) {
+                    buf_append_char(out, '0');
+                    return true;
+                }
+                const uint64_t *digits = bigint_ptr(bigint);
+                for (size_t i = 0; i < bigint->digit_count; i += 1) {
+                    buf_appendf(out, (i == 0) ? "%" ZIG_PRI_x64 : ".%" ZIG_PRI_x64, digits[i]);
+                }
+                return true;
+            }
+        case TypeTableEntryIdFloat:
+            {
+                const uint8_t *bytes;
+                switch (type_entry->data.floating.bit_count) {
+                    case 32:
+                        bytes = reinterpret_cast<const uint8_t *>(&const_val->data.x_f32);
+                        break;
+                    case 64:
+                        bytes = reinterpret_cast<const uint8_t *>(&const_val->data.x_f64);
+                        break;
+                    case 128:
+                        bytes = reinterpret_cast<const uint8_t *>(&const_val->data.x_f128);
+                        break;
+                    default:
+                        zig_unreachable();
+                }
+                buf_append_char(out, 'R');
+                for (size_t i = 0; i < type_entry->data.floating.bit_count / 8; i += 1) {
+                    buf_appendf(out, "%02x", bytes[i]);
+                }
+                return true;
+            }
+        case TypeTableEntryIdArray:
+            {
+                ConstArrayValue *array = &const_val->data.x_array;
+                uint64_t len = type_entry->data.array.len;
+                switch (array->special) {
+                    case ConstArraySpecialUndef:
+                        return false;
+                    case ConstArraySpecialRepeat:
+                        buf_append_char(out, 'P');
+                        return serialize_value(out, array->s_repeat.elem);
+                    case ConstArraySpecialBuf:
+                        buf_append_char(out, 'B');
+                        for (uint64_t i = 0; i < len; i += 1) {
+                            buf_appendf(out, "%02x", (uint8_t)buf_ptr(array->s_buf.bytes)[i]);
+                        }
+                        return true;
+                    case ConstArraySpecialNone:
+                        buf_append_char(out, 'A');
+                        for (uint64_t i = 0; i < len; i += 1) {
+                            if (!serialize_value(out, &array->s_none.elements[i]))
+                                return false;
+                        }
+                        return true;
+                    case ConstArraySpecialInts:
+                        {
+                            buf_append_char(out, 'A');
+                            ConstExprValue elem_val = {};
+                            for (uint64_t i = 0; i < len; i += 1) {
+                                read_compact_array_elem(const_val, i, &elem_val);
+                                if (!serialize_value(out, &elem_val))
+                                    return false;
+                            }
+                            return true;
+                        }
+                }
+                zig_unreachable();
+            }
+        case TypeTableEntryIdStruct:
+            {
+                if (type_entry->data.structure.is_slice)
+                    return false;
+                size_t field_count = type_entry->data.structure.src_field_count;
+                if (field_count != 0 && const_val->data.x_struct.fields == nullptr)
+                    return false;
+                buf_append_char(out, 'S');
+                for (size_t i = 0; i < field_count; i += 1) {
+                    if (!serialize_value(out, &const_val->data.x_struct.fields[i]))
+                        return false;
+                }
+                return true;
+            }
+        case TypeTableEntryIdMaybe:
+            if (const_val->data.x_maybe == nullptr) {
+                buf_append_char(out, 'N');
+                return true;
+            }
+            buf_append_char(out, 'M');
+            return serialize_value(out, const_val->data.x_maybe);
+        case TypeTableEntryIdErrorUnion:
+            if (const_val->data.x_err_union.err != nullptr || const_val->data.x_err_union.payload == nullptr)
+                return false;
+            buf_append_char(out, 'U');
+            return serialize_value(out, const_val->data.x_err_union.payload);
+        default:
+            return false;
+    }
+}
+
+static bool parse_value(CodeGen *g, const char **cursor, const char *end, TypeTableEntry *type_entry,
+        ConstExprValue *const_val)
+{
+    if (*cursor == end)
+        return false;
+    char tag = **cursor;
+    *cursor += 1;
+
+    const_val->type = type_entry;
+    const_val->special = ConstValSpecialStatic;
+    switch (type_entry->id) {
+        case TypeTableEntryIdVoid:
+            return tag == 'V';
+        case TypeTableEntryIdBool:
+            const_val->data.x_bool = (tag == 'T');
+            return tag == 'T' || tag == 'F';
+        case TypeTableEntryIdInt:
+        case TypeTableEntryIdNumLitInt:
+            {
+                if (tag != 'I')
+                    return false;
+                bool is_negative = (*cursor != end && **cursor == '-');
+                if (is_negative)
+                    *cursor += 1;
+                ZigList<uint64_t> digits = {0};
+                for (;;) {
+                    uint64_t digit = 0;
+                    size_t hex_count = 0;
+                    uint8_t nibble;
+                    while (*cursor != end && parse_hex_digit(**cursor, &nibble)) {
+                        digit = (digit << 4) | nibble;
+                        hex_count += 1;
+                        *cursor += 1;
+                    }
+                    if (hex_count == 0 || hex_count > 16)
+                        return false;
+                    digits.append(digit);
+                    if (*cursor == end || **cursor != '.')
+                        break;
+                    *cursor += 1;
+                }
+                bigint_init_data(&const_val->data.x_bigint, digits.items, digits.length, is_negative);
+                digits.deinit();
+                return true;
+            }
+        case TypeTableEntryIdFloat:
+            {
+                if (tag != 'R')
+                    return false;
+                size_t byte_count = type_entry->data.floating.bit_count / 8;
+                if ((size_t)(end - *cursor) < byte_count * 2)
+                    return false;
+                uint8_t bytes[16];
+                for (size_t i = 0; i < byte_count; i += 1) {
+                    uint8_t hi, lo;
+                    if (!parse_hex_digit((*cursor)[0], &hi) || !parse_hex_digit((*cursor)[1], &lo))
+                        return false;
+                    bytes[i] = (hi << 4) | lo;
+                    *cursor += 2;
+                }
+                switch (type_entry->data.floating.bit_count) {
+                    case 32:
+                        memcpy(&const_val->data.x_f32, bytes, 4);
+                        return true;
+                    case 64:
+                        memcpy(&const_val->data.x_f64, bytes, 8);
+                        return true;
+                    case 128:
+                        memcpy(&const_val->data.x_f128, bytes, 16);
+                        return true;
+                    default:
+                        zig_unreachable();
+                }
+            }
+        case TypeTableEntryIdArray:
+            {
+                uint64_t len = type_entry->data.array.len;
+                if (tag == 'P') {
+                    const_val->data.x_array.special = ConstArraySpecialRepeat;
+                    const_val->data.x_array.s_repeat.elem = create_const_vals(1);
+                    return parse_value(g, cursor, end, type_entry->data.array.child_type,
+                            const_val->data.x_array.s_repeat.elem);
+                } else if (tag == 'B') {
+                    if (type_entry->data.array.child_type != g->builtin_types.entry_u8 ||
+                        (uint64_t)(end - *cursor) < len * 2)
+                    {
+                        return false;
+                    }
+                    Buf *bytes = buf_alloc();
+                    buf_resize(bytes, len);
+                    for (uint64_t i = 0; i < len; i += 1) {
+                        uint8_t hi, lo;
+                        if (!parse_hex_digit((*cursor)[0], &hi) || !parse_hex_digit((*cursor)[1], &lo))
+                            return false;
+                        buf_ptr(bytes)[i] = (char)((hi << 4) | lo);
+                        *cursor += 2;
+                    }
+                    const_val->data.x_array.special = ConstArraySpecialBuf;
+                    const_val->data.x_array.s_buf.bytes = bytes;
+                    return true;
+                } else if (tag != 'A') {
+                    return false;
+                }
+                const_val->data.x_array.special = ConstArraySpecialNone;
+                const_val->data.x_array.s_none.elements = create_const_vals(len);
+                for (uint64_t i = 0; i < len; i += 1) {
+                    ConstExprValue *elem_val = &const_val->data.x_array.s_none.elements[i];
+                    if (!parse_value(g, cursor, end, type_entry->data.array.child_type, elem_val))
+                        return false;
+                    ConstParent *parent = get_const_val_parent(g, elem_val);
+                    if (parent != nullptr) {
+                        parent->id = ConstParentIdArray;
+                        parent->data.p_array.array_val = const_val;
+                        parent->data.p_array.elem_index = i;
+                    }
+                }
+                return true;
+            }
+        case TypeTableEntryIdStruct:
+            {
+                if (tag != 'S')
+                    return false;
+                ensure_complete_type(g, type_entry);
+                if (type_is_invalid(type_entry) || type_entry->data.structure.is_slice)
+                    return false;
+                size_t field_count = type_entry->data.structure.src_field_count;
+                const_val->data.x_struct.fields = create_const_vals(field_count);
+                for (size_t i = 0; i < field_count; i += 1) {
+                    ConstExprValue *field_val = &const_val->data.x_struct.fields[i];
+                    if (!parse_value(g, cursor, end, type_entry->data.structure.fields[i].type_entry, field_val))
+                        return false;
+                    ConstParent *parent = get_const_val_parent(g, field_val);
+                    if (parent != nullptr) {
+                        parent->id = ConstParentIdStruct;
+                        parent->data.p_struct.struct_val = const_val;
+                        parent->data.p_struct.field_index = i;
+                    }
+                }
+                return true;
+            }
+        case TypeTableEntryIdMaybe:
+            if (tag == 'N') {
+                const_val->data.x_maybe = nullptr;
+                return true;
+            } else if (tag == 'M') {
+                const_val->data.x_maybe = create_const_vals(1);
+                return parse_value(g, cursor, end, type_entry->data.maybe.child_type, const_val->data.x_maybe);
+            }
+            return false;
+        case TypeTableEntryIdErrorUnion:
+            if (tag != 'U')
+                return false;
+            const_val->data.x_err_union.err = nullptr;
+            const_val->data.x_err_union.payload = create_const_vals(1);
+            return parse_value(g, cursor, end, type_entry->data.error.child_type,
+                    const_val->data.x_err_union.payload);
+        default:
+            return false;
+    }
+}
+
+bool comptime_cache_get(CodeGen *g, Buf *key, TypeTableEntry *return_type, ConstExprValue *out_val,
+        size_t *out_branch_count)
+{
+    ComptimeCache *cache = g->comptime_cache;
+    if (!cache->have_prev_state)
+        return false;
+    auto entry = cache->prev_results.maybe_get(key);
+    if (entry == nullptr)
+        return false;
+    ComptimeCacheResult *prev_result = &entry->value;
+
+    const char *cursor = buf_ptr(prev_result->value);
+    const char *end = cursor + buf_len(prev_result->value);
+    if (!parse_value(g, &cursor, end, return_type, out_val) || cursor != end)
+        return false;
+
+    // kept for the next build
+    bool found_existing;
+    auto new_entry = cache->results.get_or_put(key, &found_existing);
+    if (!found_existing) {
+        new_entry->key = buf_create_from_buf(key);
+        new_entry->value = *prev_result;
+        cache->result_keys.append(new_entry->key);
+    }
+    *out_branch_count = prev_result->branch_count;
+    return true;
+}
+
+void comptime_cache_put(CodeGen *g, Buf *key, ConstExprValue *result, size_t branch_count) {
+    ComptimeCache *cache = g->comptime_cache;
+    Buf value = BUF_INIT;
+    buf_resize(&value, 0);
+    if (!serialize_value(&value, result)) {
+        buf_deinit(&value);
+        return;
+    }
+
+    bool found_existing;
+    auto entry = cache->results.get_or_put(key, &found_existing);
+    if (!found_existing) {
+        entry->key = buf_create_from_buf(key);
+        cache->result_keys.append(entry->key);
+    }
+    entry->value.branch_count = branch_count;
+    entry->value.value = buf_create_from_buf(&value);
+    buf_deinit(&value);
+}
+
+void comptime_cache_save(CodeGen *g) {
+    ComptimeCache *cache = g->comptime_cache;
+    if (cache->result_keys.length == 0 && !cache->have_prev_state)
+        return;
+
+    Buf *contents = buf_alloc();
+    buf_appendf(contents, "%s\n", cache_file_magic);
+    buf_appendf(contents, "options %s\n", buf_ptr(&cache->options_hash));
+    // results of the previous build which were not used in this one are dropped
+    for (size_t i = 0; i < cache->result_keys.length; i += 1) {
+        Buf *key = cache->result_keys.at(i);
+        ComptimeCacheResult *result = &cache->results.maybe_get(key)->value;
+        buf_appendf(contents, "result %" ZIG_PRI_usize " ", result->branch_count);
+        append_hex(contents, key);
+        buf_appendf(contents, " %s\n", buf_ptr(result->value));
+    }
+    int err;
+    if ((err = os_write_file_atomic(cache->cache_path, contents))) {
+        fprintf(stderr, "unable to save comptime cache %s: %s\n", buf_ptr(cache->cache_path), err_str(err));
+    }
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef ZIG_COMPTIME_CACHE_HPP
+#define ZIG_COMPTIME_CACHE_HPP
+
+#include "all_types.hpp"
+
+// The comptime cache saves the results of compile time function calls in the
+// cache dir so that later builds can skip evaluating them. A result is keyed by
+// the name of the function, the values of its arguments, and a hash of the tokens
+// of every declaration the function can reach by name, so that editing code which
+// the function cannot reach keeps the result. Only calls of functions declared in
+// non-generic containers, whose arguments and result are plain data (integers,
+// floats, bools, arrays, structs, optionals and constant slices of those), and
+// which cannot reach a @cImport, are cached.
+
+void comptime_cache_init(CodeGen *g);
+
+// Returns false if the call cannot be cached. exec_scope is the scope set up for
+// a compile time call, as used by memoized_fn_eval_table.
+bool comptime_cache_key(CodeGen *g, Scope *exec_scope, Buf *out_key);
+// Returns true if out_val was set to the result of a previous build.
+// out_branch_count is set to the number of backward branches that build took to
+// compute it, which the caller charges against its eval branch quota.
+bool comptime_cache_get(CodeGen *g, Buf *key, TypeTableEntry *return_type, ConstExprValue *out_val,
+        size_t *out_branch_count);
+void comptime_cache_put(CodeGen *g, Buf *key, ConstExprValue *result, size_t branch_count);
+
+// Call after semantic analysis finished without errors.
+void comptime_cache_save(CodeGen *g);
+
+#endif
@@ -26,6 +26,7 @@ const char *err_str(int err) {
         case ErrorExactDivRemainder: return "exact division had a remainder";
         case ErrorNegativeDenominator: return "negative denominator";
         case ErrorShiftedOutOneBits: return "exact shift shifted out one bits";
+        case ErrorFileChanged: return "file changed while it was being compiled";
     }
     return "(invalid error)";
 }
@@ -12,29 +12,42 @@
 
 #include <stdint.h>
 
+#if defined(ZIG_HAVE_SSE2)
+#include <emmintrin.h>
+#endif
+
+// Open addressing hash map in the style of a Swiss table. Slots are organized in
+// groups of 16 and every slot has one control byte which is either empty, deleted,
+// or holds 7 bits of the key's hash. A lookup compares the control bytes of a
+// whole group at once, and only calls EqualFn for slots whose cached 32-bit hash
+// is identical to the hash of the key being looked up. Control bytes, hashes and
+// entries are kept in separate arrays.
+//
+// Entry pointers are invalidated by any call which adds an item to the map.
 template<typename K, typename V, uint32_t (*HashFunction)(K key), bool (*EqualFn)(K a, K b)>
 class HashMap {
 public:
+    // capacity is the number of items the map can hold before it has to grow
     void init(int capacity) {
-        init_capacity(capacity);
+        init_capacity(capacity_for_size(capacity));
     }
     void deinit(void) {
+        free(_ctrl);
+        free(_hashes);
         free(_entries);
     }
 
     struct Entry {
-        bool used;
-        int distance_from_start_index;
         K key;
         V value;
     };
 
     void clear() {
         for (int i = 0; i < _capacity; i += 1) {
-            _entries[i].used = false;
+            _ctrl[i] = ctrl_empty;
         }
         _size = 0;
-        _max_distance_from_start_index = 0;
+        _growth_left = max_size_for_capacity(_capacity);
         _modification_count += 1;
     }
 
@@ -42,31 +55,53 @@ public:
         return _size;
     }
 
+    // grows the map, if necessary, so that it can hold count items without rehashing
+    void reserve(int count) {
+        if (count - _size > _growth_left)
+            rehash(capacity_for_size(count));
+    }
+
     void put(const K &key, const V &value) {
+        bool found_existing;
+        Entry *entry = get_or_put(key, &found_existing);
+        entry->value = value;
+    }
+
+    // Returns the existing entry for key, or adds a new entry whose value the
+    // caller is expected to fill in.
+    Entry *get_or_put(const K &key, bool *found_existing) {
         _modification_count += 1;
-        internal_put(key, value);
-
-        // if we get too full (60%), double the capacity
-        if (_size * 5 >= _capacity * 3) {
-            Entry *old_entries = _entries;
-            int old_capacity = _capacity;
-            init_capacity(_capacity * 2);
-            // dump all of the old elements into the new table
-            for (int i = 0; i < old_capacity; i += 1) {
-                Entry *old_entry = &old_entries[i];
-                if (old_entry->used)
-                    internal_put(old_entry->key, old_entry->value);
-            }
-            free(old_entries);
+        uint32_t hash = hash_key(key);
+        int index = find_index(key, hash);
+        if (index >= 0) {
+            *found_existing = true;
+            return &_entries[index];
         }
+        *found_existing = false;
+
+        index = find_free_index(hash);
+        if (_growth_left == 0 && _ctrl[index] == ctrl_empty) {
+            // reuse the memory of deleted slots before growing the table
+            int new_capacity = (_size * 2 <= max_size_for_capacity(_capacity)) ? _capacity : _capacity * 2;
+            rehash(new_capacity);
+            index = find_free_index(hash);
+        }
+        if (_ctrl[index] == ctrl_empty)
+            _growth_left -= 1;
+        _size += 1;
+        _ctrl[index] = hash_h2(hash);
+        _hashes[index] = hash;
+        _entries[index].key = key;
+        _entries[index].value = V();
+        return &_entries[index];
     }
 
     Entry *put_unique(const K &key, const V &value) {
-        // TODO make this more efficient
-        Entry *entry = internal_get(key);
-        if (entry)
+        bool found_existing;
+        Entry *entry = get_or_put(key, &found_existing);
+        if (found_existing)
             return entry;
-        put(key, value);
+        entry->value = value;
         return nullptr;
     }
 
@@ -81,40 +116,37 @@ public:
         return internal_get(key);
     }
 
-    void maybe_remove(const K &key) {
-        if (maybe_get(key)) {
-            remove(key);
-        }
+    // For looking up the same key in many maps of this type; hash must come from hash_key.
+    Entry *maybe_get_hashed(const K &key, uint32_t hash) const {
+        int index = find_index(key, hash);
+        return (index >= 0) ? &_entries[index] : NULL;
     }
 
-    void remove(const K &key) {
-        _modification_count += 1;
-        int start_index = key_to_index(key);
-        for (int roll_over = 0; roll_over <= _max_distance_from_start_index; roll_over += 1) {
-            int index = (start_index + roll_over) % _capacity;
-            Entry *entry = &_entries[index];
-
-            if (!entry->used)
-                zig_panic("key not found");
+    // Many of the hash functions in use are the identity function on integers or
+    // pointers, whose low bits are poorly distributed, so the bits are mixed before
+    // they pick a group.
+    static uint32_t hash_key(const K &key) {
+        uint32_t hash = HashFunction(key);
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6b;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35;
+        hash ^= hash >> 16;
+        return hash;
+    }
 
-            if (!EqualFn(entry->key, key))
-                continue;
+    // returns whether the key was present
+    bool maybe_remove(const K &key) {
+        int index = find_index(key, hash_key(key));
+        if (index < 0)
+            return false;
+        remove_index(index);
+        return true;
+    }
 
-            for (; roll_over < _capacity; roll_over += 1) {
-                int next_index = (start_index + roll_over + 1) % _capacity;
-                Entry *next_entry = &_entries[next_index];
-                if (!next_entry->used || next_entry->distance_from_start_index == 0) {
-                    entry->used = false;
-                    _size -= 1;
-                    return;
-                }
-                *entry = *next_entry;
-                entry->distance_from_start_index -= 1;
-                entry = next_entry;
-            }
-            zig_panic("shifting everything in the table");
-        }
-        zig_panic("key not found");
+    void remove(const K &key) {
+        if (!maybe_remove(key))
+            zig_panic("key not found");
     }
 
     class Iterator {
@@ -125,8 +157,8 @@ public:
             if (_count >= _table->size())
                 return NULL;
             for (; _index < _table->_capacity; _index += 1) {
-                Entry *entry = &_table->_entries[_index];
-                if (entry->used) {
+                if (_table->_ctrl[_index] >= 0) {
+                    Entry *entry = &_table->_entries[_index];
                     _index += 1;
                     _count += 1;
                     return entry;
@@ -154,88 +186,157 @@ public:
     }
 
 private:
-
+    static const int group_width = 16;
+    static const int min_capacity = 8;
+
+    // full slots store the top 7 bits of the hash, so they are never negative
+    static const int8_t ctrl_empty = -128;
+    static const int8_t ctrl_deleted = -2;
+    // pads the control bytes of tables smaller than one group
+    static const int8_t ctrl_sentinel = -1;
+
+    // max(_capacity, group_width) control bytes
+    int8_t *_ctrl;
+    uint32_t *_hashes;
     Entry *_entries;
     int _capacity;
+    int _group_mask;
     int _size;
-    int _max_distance_from_start_index;
+    // how many more empty slots may be filled before the table is rehashed
+    int _growth_left;
     // this is used to detect bugs where a hashtable is edited while an iterator is running.
     uint32_t _modification_count;
 
+    static int max_size_for_capacity(int capacity) {
+        return capacity - capacity / 8;
+    }
+
+    static int capacity_for_size(int size) {
+        int capacity = min_capacity;
+        while (max_size_for_capacity(capacity) < size) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    static int8_t hash_h2(uint32_t hash) {
+        return (int8_t)(hash >> 25);
+    }
+
+    static int hash_h1(uint32_t hash) {
+        return (int)(hash & 0x01ffffff);
+    }
+
+    // one bit per slot of the group whose control byte equals ctrl
+    static uint32_t group_match(const int8_t *group, int8_t ctrl) {
+#if defined(ZIG_HAVE_SSE2)
+        __m128i ctrl_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(ctrl), ctrl_bytes));
+#else
+        uint32_t mask = 0;
+        for (int i = 0; i < group_width; i += 1) {
+            if (group[i] == ctrl)
+                mask |= (uint32_t)1 << i;
+        }
+        return mask;
+#endif
+    }
+
+    static uint32_t group_match_empty_or_deleted(const int8_t *group) {
+#if defined(ZIG_HAVE_SSE2)
+        __m128i ctrl_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), ctrl_bytes));
+#else
+        uint32_t mask = 0;
+        for (int i = 0; i < group_width; i += 1) {
+            if (group[i] < ctrl_sentinel)
+                mask |= (uint32_t)1 << i;
+        }
+        return mask;
+#endif
+    }
+
     void init_capacity(int capacity) {
+        int ctrl_len = max(capacity, (int)group_width);
         _capacity = capacity;
+        _group_mask = ctrl_len / group_width - 1;
+        _ctrl = allocate_nonzero<int8_t>(ctrl_len);
+        _hashes = allocate_nonzero<uint32_t>(_capacity);
         _entries = allocate<Entry>(_capacity);
+        memset(_ctrl, (uint8_t)ctrl_empty, _capacity);
+        memset(_ctrl + _capacity, (uint8_t)ctrl_sentinel, ctrl_len - _capacity);
         _size = 0;
-        _max_distance_from_start_index = 0;
-        for (int i = 0; i < _capacity; i += 1) {
-            _entries[i].used = false;
-        }
+        _growth_left = max_size_for_capacity(_capacity);
     }
 
-    void internal_put(K key, V value) {
-        int start_index = key_to_index(key);
-        for (int roll_over = 0, distance_from_start_index = 0;
-                roll_over < _capacity; roll_over += 1, distance_from_start_index += 1)
-        {
-            int index = (start_index + roll_over) % _capacity;
-            Entry *entry = &_entries[index];
-
-            if (entry->used && !EqualFn(entry->key, key)) {
-                if (entry->distance_from_start_index < distance_from_start_index) {
-                    // robin hood to the rescue
-                    Entry tmp = *entry;
-                    if (distance_from_start_index > _max_distance_from_start_index)
-                        _max_distance_from_start_index = distance_from_start_index;
-                    *entry = {
-                        true,
-                        distance_from_start_index,
-                        key,
-                        value,
-                    };
-                    key = tmp.key;
-                    value = tmp.value;
-                    distance_from_start_index = tmp.distance_from_start_index;
-                }
+    void rehash(int new_capacity) {
+        int8_t *old_ctrl = _ctrl;
+        uint32_t *old_hashes = _hashes;
+        Entry *old_entries = _entries;
+        int old_capacity = _capacity;
+        init_capacity(new_capacity);
+        // the cached hashes save calling HashFunction again
+        for (int i = 0; i < old_capacity; i += 1) {
+            if (old_ctrl[i] < 0)
                 continue;
-            }
+            uint32_t hash = old_hashes[i];
+            int index = find_free_index(hash);
+            _ctrl[index] = hash_h2(hash);
+            _hashes[index] = hash;
+            _entries[index] = old_entries[i];
+            _size += 1;
+        }
+        _growth_left -= _size;
+        free(old_ctrl);
+        free(old_hashes);
+        free(old_entries);
+    }
 
-            if (!entry->used) {
-                // adding an entry. otherwise overwriting old value with
-                // same key
-                _size += 1;
+    int find_index(const K &key, uint32_t hash) const {
+        int8_t h2 = hash_h2(hash);
+        int group_index = hash_h1(hash) & _group_mask;
+        for (int step = 1;; step += 1) {
+            const int8_t *group = &_ctrl[group_index * group_width];
+            for (uint32_t match = group_match(group, h2); match != 0; match &= match - 1) {
+                int index = group_index * group_width + ctz32(match);
+                if (_hashes[index] == hash && EqualFn(_entries[index].key, key))
+                    return index;
             }
-
-            if (distance_from_start_index > _max_distance_from_start_index)
-                _max_distance_from_start_index = distance_from_start_index;
-            *entry = {
-                true,
-                distance_from_start_index,
-                key,
-                value,
-            };
-            return;
+            if (group_match(group, ctrl_empty) != 0)
+                return -1;
+            // triangular probing visits every group of a power of two sized table
+            group_index = (group_index + step) & _group_mask;
         }
-        zig_panic("put into a full HashMap");
     }
 
+    // a slot which is empty or deleted; there always is one because of the load factor
+    int find_free_index(uint32_t hash) const {
+        int group_index = hash_h1(hash) & _group_mask;
+        for (int step = 1;; step += 1) {
+            uint32_t free_mask = group_match_empty_or_deleted(&_ctrl[group_index * group_width]);
+            if (free_mask != 0)
+                return group_index * group_width + ctz32(free_mask);
+            group_index = (group_index + step) & _group_mask;
+        }
+    }
 
-    Entry *internal_get(const K &key) const {
-        int start_index = key_to_index(key);
-        for (int roll_over = 0; roll_over <= _max_distance_from_start_index; roll_over += 1) {
-            int index = (start_index + roll_over) % _capacity;
-            Entry *entry = &_entries[index];
-
-            if (!entry->used)
-                return NULL;
-
-            if (EqualFn(entry->key, key))
-                return entry;
+    void remove_index(int index) {
+        _modification_count += 1;
+        _size -= 1;
+        // A lookup only moves past a group when the group has no empty slot, so the
+        // slot can become empty again if its group already has an empty slot.
+        int group_start = index - index % group_width;
+        if (group_match(&_ctrl[group_start], ctrl_empty) != 0) {
+            _ctrl[index] = ctrl_empty;
+            _growth_left += 1;
+        } else {
+            _ctrl[index] = ctrl_deleted;
         }
-        return NULL;
     }
 
-    int key_to_index(const K &key) const {
-        return (int)(HashFunction(key) % ((uint32_t)_capacity));
+    Entry *internal_get(const K &key) const {
+        int index = find_index(key, hash_key(key));
+        return (index >= 0) ? &_entries[index] : NULL;
     }
 };
 
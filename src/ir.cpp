@@ -7,6 +7,7 @@
 
 #include "analyze.hpp"
 #include "ast_render.hpp"
+#include "comptime_cache.hpp"
 #include "error.hpp"
 #include "ir.hpp"
 #include "ir_print.hpp"
@@ -14,6 +15,10 @@
 #include "parsec.hpp"
 #include "range_set.hpp"
 #include "softfloat.hpp"
+#include "source_cache.hpp"
+#include "time_report.hpp"
+
+#include <mutex>
 
 struct IrExecContext {
     ConstExprValue *mem_slot_list;
@@ -24,8 +29,14 @@ struct IrBuilder {
     CodeGen *codegen;
     IrExecutable *exec;
     IrBasicBlock *current_basic_block;
+    // null unless the IR is generated on a worker thread
+    IrGenWorker *worker;
 };
 
+// Held by worker threads around the few things IR generation shares with other
+// functions: the type tables and the reference counts of global variables.
+static std::mutex ir_gen_worker_mutex;
+
 struct IrAnalyze {
     CodeGen *codegen;
     IrBuilder old_irb;
@@ -62,7 +73,7 @@ ConstExprValue *const_ptr_pointee(CodeGen *g, ConstExprValue *const_val) {
         case ConstPtrSpecialRef:
             return const_val->data.x_ptr.data.ref.pointee;
         case ConstPtrSpecialBaseArray:
-            expand_undef_array(g, const_val->data.x_ptr.data.base_array.array_val);
+            expand_const_array(g, const_val->data.x_ptr.data.base_array.array_val);
             return &const_val->data.x_ptr.data.base_array.array_val->data.x_array.s_none.elements[
                 const_val->data.x_ptr.data.base_array.elem_index];
         case ConstPtrSpecialBaseStruct:
@@ -151,8 +162,13 @@ static void ir_ref_var(VariableTableEntry *var) {
     var->ref_count += 1;
 }
 
+static Arena *ir_builder_arena(IrBuilder *irb) {
+    assert(!irb->codegen->ir_released);
+    return (irb->worker != nullptr) ? &irb->worker->arena : &irb->codegen->ir_arena;
+}
+
 static IrBasicBlock *ir_create_basic_block(IrBuilder *irb, Scope *scope, const char *name_hint) {
-    IrBasicBlock *result = allocate<IrBasicBlock>(1);
+    IrBasicBlock *result = arena_allocate<IrBasicBlock>(ir_builder_arena(irb), 1);
     result->scope = scope;
     result->name_hint = name_hint;
     result->debug_id = exec_next_debug_id(irb->exec);
@@ -567,15 +583,43 @@ static constexpr IrInstructionId ir_instruction_id(IrInstructionSetAlignStack *)
     return IrInstructionIdSetAlignStack;
 }
 
+static constexpr IrInstructionId ir_instruction_id(IrInstructionVectorType *) {
+    return IrInstructionIdVectorType;
+}
+
+static constexpr IrInstructionId ir_instruction_id(IrInstructionSplat *) {
+    return IrInstructionIdSplat;
+}
+
+static constexpr IrInstructionId ir_instruction_id(IrInstructionShuffle *) {
+    return IrInstructionIdShuffle;
+}
+
+static constexpr IrInstructionId ir_instruction_id(IrInstructionReduce *) {
+    return IrInstructionIdReduce;
+}
+
+static constexpr IrInstructionId ir_instruction_id(IrInstructionAtomicRmw *) {
+    return IrInstructionIdAtomicRmw;
+}
+
+static constexpr IrInstructionId ir_instruction_id(IrInstructionAtomicLoad *) {
+    return IrInstructionIdAtomicLoad;
+}
+
+static constexpr IrInstructionId ir_instruction_id(IrInstructionAtomicStore *) {
+    return IrInstructionIdAtomicStore;
+}
+
 template<typename T>
 static T *ir_create_instruction(IrBuilder *irb, Scope *scope, AstNode *source_node) {
-    T *special_instruction = allocate<T>(1);
+    T *special_instruction = arena_allocate<T>(ir_builder_arena(irb), 1);
     special_instruction->base.id = ir_instruction_id(special_instruction);
     special_instruction->base.scope = scope;
     special_instruction->base.source_node = source_node;
     special_instruction->base.debug_id = exec_next_debug_id(irb->exec);
     special_instruction->base.owner_bb = irb->current_basic_block;
-    special_instruction->base.value.global_refs = allocate<ConstGlobalRefs>(1);
+    special_instruction->base.value.global_refs = arena_allocate<ConstGlobalRefs>(ir_builder_arena(irb), 1);
     return special_instruction;
 }
 
@@ -771,7 +815,12 @@ static IrInstruction *ir_build_const_bound_fn(IrBuilder *irb, Scope *scope, AstN
     FnTableEntry *fn_entry, IrInstruction *first_arg)
 {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = get_bound_fn_type(irb->codegen, fn_entry);
+    if (irb->worker != nullptr) {
+        std::lock_guard<std::mutex> lock(ir_gen_worker_mutex);
+        const_instruction->base.value.type = get_bound_fn_type(irb->codegen, fn_entry);
+    } else {
+        const_instruction->base.value.type = get_bound_fn_type(irb->codegen, fn_entry);
+    }
     const_instruction->base.value.special = ConstValSpecialStatic;
     const_instruction->base.value.data.x_bound_fn.fn = fn_entry;
     const_instruction->base.value.data.x_bound_fn.first_arg = first_arg;
@@ -780,7 +829,12 @@ static IrInstruction *ir_build_const_bound_fn(IrBuilder *irb, Scope *scope, AstN
 
 static IrInstruction *ir_create_const_str_lit(IrBuilder *irb, Scope *scope, AstNode *source_node, Buf *str) {
     IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(irb, scope, source_node);
-    init_const_str_lit(irb->codegen, &const_instruction->base.value, str);
+    if (irb->worker != nullptr) {
+        std::lock_guard<std::mutex> lock(ir_gen_worker_mutex);
+        init_const_str_lit(irb->codegen, &const_instruction->base.value, str);
+    } else {
+        init_const_str_lit(irb->codegen, &const_instruction->base.value, str);
+    }
 
     return &const_instruction->base;
 }
@@ -792,7 +846,12 @@ static IrInstruction *ir_build_const_str_lit(IrBuilder *irb, Scope *scope, AstNo
 
 static IrInstruction *ir_build_const_c_str_lit(IrBuilder *irb, Scope *scope, AstNode *source_node, Buf *str) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    init_const_c_str_lit(irb->codegen, &const_instruction->base.value, str);
+    if (irb->worker != nullptr) {
+        std::lock_guard<std::mutex> lock(ir_gen_worker_mutex);
+        init_const_c_str_lit(irb->codegen, &const_instruction->base.value, str);
+    } else {
+        init_const_c_str_lit(irb->codegen, &const_instruction->base.value, str);
+    }
     return &const_instruction->base;
 }
 
@@ -828,7 +887,12 @@ static IrInstruction *ir_build_var_ptr(IrBuilder *irb, Scope *scope, AstNode *so
     instruction->is_const = is_const;
     instruction->is_volatile = is_volatile;
 
-    ir_ref_var(var);
+    if (irb->worker != nullptr) {
+        std::lock_guard<std::mutex> lock(ir_gen_worker_mutex);
+        ir_ref_var(var);
+    } else {
+        ir_ref_var(var);
+    }
 
     return &instruction->base;
 }
@@ -2263,6 +2327,167 @@ static IrInstruction *ir_build_set_align_stack(IrBuilder *irb, Scope *scope, Ast
     return &instruction->base;
 }
 
+static IrInstruction *ir_build_vector_type(IrBuilder *irb, Scope *scope, AstNode *source_node,
+        IrInstruction *len, IrInstruction *elem_type)
+{
+    IrInstructionVectorType *instruction = ir_build_instruction<IrInstructionVectorType>(irb, scope, source_node);
+    instruction->len = len;
+    instruction->elem_type = elem_type;
+
+    ir_ref_instruction(len, irb->current_basic_block);
+    ir_ref_instruction(elem_type, irb->current_basic_block);
+
+    return &instruction->base;
+}
+
+static IrInstruction *ir_build_splat(IrBuilder *irb, Scope *scope, AstNode *source_node,
+        IrInstruction *len, IrInstruction *scalar)
+{
+    IrInstructionSplat *instruction = ir_build_instruction<IrInstructionSplat>(irb, scope, source_node);
+    instruction->len = len;
+    instruction->scalar = scalar;
+
+    ir_ref_instruction(len, irb->current_basic_block);
+    ir_ref_instruction(scalar, irb->current_basic_block);
+
+    return &instruction->base;
+}
+
+static IrInstruction *ir_build_splat_from(IrBuilder *irb, IrInstruction *old_instruction,
+        IrInstruction *len, IrInstruction *scalar)
+{
+    IrInstruction *new_instruction = ir_build_splat(irb, old_instruction->scope, old_instruction->source_node,
+            len, scalar);
+    ir_link_new_instruction(new_instruction, old_instruction);
+    return new_instruction;
+}
+
+static IrInstruction *ir_build_shuffle(IrBuilder *irb, Scope *scope, AstNode *source_node,
+        IrInstruction *a, IrInstruction *b, IrInstruction *mask, uint32_t *mask_indices)
+{
+    IrInstructionShuffle *instruction = ir_build_instruction<IrInstructionShuffle>(irb, scope, source_node);
+    instruction->a = a;
+    instruction->b = b;
+    instruction->mask = mask;
+    instruction->mask_indices = mask_indices;
+
+    ir_ref_instruction(a, irb->current_basic_block);
+    ir_ref_instruction(b, irb->current_basic_block);
+    ir_ref_instruction(mask, irb->current_basic_block);
+
+    return &instruction->base;
+}
+
+static IrInstruction *ir_build_shuffle_from(IrBuilder *irb, IrInstruction *old_instruction,
+        IrInstruction *a, IrInstruction *b, IrInstruction *mask, uint32_t *mask_indices)
+{
+    IrInstruction *new_instruction = ir_build_shuffle(irb, old_instruction->scope, old_instruction->source_node,
+            a, b, mask, mask_indices);
+    ir_link_new_instruction(new_instruction, old_instruction);
+    return new_instruction;
+}
+
+static IrInstruction *ir_build_reduce(IrBuilder *irb, Scope *scope, AstNode *source_node,
+        IrInstruction *op_value, IrInstruction *value, ReduceOp op)
+{
+    IrInstructionReduce *instruction = ir_build_instruction<IrInstructionReduce>(irb, scope, source_node);
+    instruction->op_value = op_value;
+    instruction->value = value;
+    instruction->op = op;
+
+    ir_ref_instruction(op_value, irb->current_basic_block);
+    ir_ref_instruction(value, irb->current_basic_block);
+
+    return &instruction->base;
+}
+
+static IrInstruction *ir_build_reduce_from(IrBuilder *irb, IrInstruction *old_instruction,
+        IrInstruction *op_value, IrInstruction *value, ReduceOp op)
+{
+    IrInstruction *new_instruction = ir_build_reduce(irb, old_instruction->scope, old_instruction->source_node,
+            op_value, value, op);
+    ir_link_new_instruction(new_instruction, old_instruction);
+    return new_instruction;
+}
+
+static IrInstruction *ir_build_atomic_rmw(IrBuilder *irb, Scope *scope, AstNode *source_node,
+        IrInstruction *ptr, IrInstruction *op_value, IrInstruction *operand, IrInstruction *order_value,
+        AtomicRmwOp op, AtomicOrder order)
+{
+    IrInstructionAtomicRmw *instruction = ir_build_instruction<IrInstructionAtomicRmw>(irb, scope, source_node);
+    instruction->ptr = ptr;
+    instruction->op_value = op_value;
+    instruction->operand = operand;
+    instruction->order_value = order_value;
+    instruction->op = op;
+    instruction->order = order;
+
+    ir_ref_instruction(ptr, irb->current_basic_block);
+    ir_ref_instruction(op_value, irb->current_basic_block);
+    ir_ref_instruction(operand, irb->current_basic_block);
+    ir_ref_instruction(order_value, irb->current_basic_block);
+
+    return &instruction->base;
+}
+
+static IrInstruction *ir_build_atomic_rmw_from(IrBuilder *irb, IrInstruction *old_instruction,
+        IrInstruction *ptr, IrInstruction *op_value, IrInstruction *operand, IrInstruction *order_value,
+        AtomicRmwOp op, AtomicOrder order)
+{
+    IrInstruction *new_instruction = ir_build_atomic_rmw(irb, old_instruction->scope, old_instruction->source_node,
+            ptr, op_value, operand, order_value, op, order);
+    ir_link_new_instruction(new_instruction, old_instruction);
+    return new_instruction;
+}
+
+static IrInstruction *ir_build_atomic_load(IrBuilder *irb, Scope *scope, AstNode *source_node,
+        IrInstruction *ptr, IrInstruction *order_value, AtomicOrder order)
+{
+    IrInstructionAtomicLoad *instruction = ir_build_instruction<IrInstructionAtomicLoad>(irb, scope, source_node);
+    instruction->ptr = ptr;
+    instruction->order_value = order_value;
+    instruction->order = order;
+
+    ir_ref_instruction(ptr, irb->current_basic_block);
+    ir_ref_instruction(order_value, irb->current_basic_block);
+
+    return &instruction->base;
+}
+
+static IrInstruction *ir_build_atomic_load_from(IrBuilder *irb, IrInstruction *old_instruction,
+        IrInstruction *ptr, IrInstruction *order_value, AtomicOrder order)
+{
+    IrInstruction *new_instruction = ir_build_atomic_load(irb, old_instruction->scope, old_instruction->source_node,
+            ptr, order_value, order);
+    ir_link_new_instruction(new_instruction, old_instruction);
+    return new_instruction;
+}
+
+static IrInstruction *ir_build_atomic_store(IrBuilder *irb, Scope *scope, AstNode *source_node,
+        IrInstruction *ptr, IrInstruction *value, IrInstruction *order_value, AtomicOrder order)
+{
+    IrInstructionAtomicStore *instruction = ir_build_instruction<IrInstructionAtomicStore>(irb, scope, source_node);
+    instruction->ptr = ptr;
+    instruction->value = value;
+    instruction->order_value = order_value;
+    instruction->order = order;
+
+    ir_ref_instruction(ptr, irb->current_basic_block);
+    ir_ref_instruction(value, irb->current_basic_block);
+    ir_ref_instruction(order_value, irb->current_basic_block);
+
+    return &instruction->base;
+}
+
+static IrInstruction *ir_build_atomic_store_from(IrBuilder *irb, IrInstruction *old_instruction,
+        IrInstruction *ptr, IrInstruction *value, IrInstruction *order_value, AtomicOrder order)
+{
+    IrInstruction *new_instruction = ir_build_atomic_store(irb, old_instruction->scope, old_instruction->source_node,
+            ptr, value, order_value, order);
+    ir_link_new_instruction(new_instruction, old_instruction);
+    return new_instruction;
+}
+
 static IrInstruction *ir_instruction_br_get_dep(IrInstructionBr *instruction, size_t index) {
     return nullptr;
 }
@@ -2992,6 +3217,66 @@ static IrInstruction *ir_instruction_setalignstack_get_dep(IrInstructionSetAlign
     }
 }
 
+static IrInstruction *ir_instruction_vectortype_get_dep(IrInstructionVectorType *instruction, size_t index) {
+    switch (index) {
+        case 0: return instruction->len;
+        case 1: return instruction->elem_type;
+        default: return nullptr;
+    }
+}
+
+static IrInstruction *ir_instruction_splat_get_dep(IrInstructionSplat *instruction, size_t index) {
+    switch (index) {
+        case 0: return instruction->len;
+        case 1: return instruction->scalar;
+        default: return nullptr;
+    }
+}
+
+static IrInstruction *ir_instruction_shuffle_get_dep(IrInstructionShuffle *instruction, size_t index) {
+    switch (index) {
+        case 0: return instruction->a;
+        case 1: return instruction->b;
+        case 2: return instruction->mask;
+        default: return nullptr;
+    }
+}
+
+static IrInstruction *ir_instruction_reduce_get_dep(IrInstructionReduce *instruction, size_t index) {
+    switch (index) {
+        case 0: return instruction->op_value;
+        case 1: return instruction->value;
+        default: return nullptr;
+    }
+}
+
+static IrInstruction *ir_instruction_atomicrmw_get_dep(IrInstructionAtomicRmw *instruction, size_t index) {
+    switch (index) {
+        case 0: return instruction->ptr;
+        case 1: return instruction->op_value;
+        case 2: return instruction->operand;
+        case 3: return instruction->order_value;
+        default: return nullptr;
+    }
+}
+
+static IrInstruction *ir_instruction_atomicload_get_dep(IrInstructionAtomicLoad *instruction, size_t index) {
+    switch (index) {
+        case 0: return instruction->ptr;
+        case 1: return instruction->order_value;
+        default: return nullptr;
+    }
+}
+
+static IrInstruction *ir_instruction_atomicstore_get_dep(IrInstructionAtomicStore *instruction, size_t index) {
+    switch (index) {
+        case 0: return instruction->ptr;
+        case 1: return instruction->value;
+        case 2: return instruction->order_value;
+        default: return nullptr;
+    }
+}
+
 static IrInstruction *ir_instruction_get_dep(IrInstruction *instruction, size_t index) {
     switch (instruction->id) {
         case IrInstructionIdInvalid:
@@ -3194,6 +3479,20 @@ static IrInstruction *ir_instruction_get_dep(IrInstruction *instruction, size_t
             return ir_instruction_opaquetype_get_dep((IrInstructionOpaqueType *) instruction, index);
         case IrInstructionIdSetAlignStack:
             return ir_instruction_setalignstack_get_dep((IrInstructionSetAlignStack *) instruction, index);
+        case IrInstructionIdVectorType:
+            return ir_instruction_vectortype_get_dep((IrInstructionVectorType *) instruction, index);
+        case IrInstructionIdSplat:
+            return ir_instruction_splat_get_dep((IrInstructionSplat *) instruction, index);
+        case IrInstructionIdShuffle:
+            return ir_instruction_shuffle_get_dep((IrInstructionShuffle *) instruction, index);
+        case IrInstructionIdReduce:
+            return ir_instruction_reduce_get_dep((IrInstructionReduce *) instruction, index);
+        case IrInstructionIdAtomicRmw:
+            return ir_instruction_atomicrmw_get_dep((IrInstructionAtomicRmw *) instruction, index);
+        case IrInstructionIdAtomicLoad:
+            return ir_instruction_atomicload_get_dep((IrInstructionAtomicLoad *) instruction, index);
+        case IrInstructionIdAtomicStore:
+            return ir_instruction_atomicstore_get_dep((IrInstructionAtomicStore *) instruction, index);
     }
     zig_unreachable();
 }
@@ -3234,7 +3533,7 @@ static bool ir_gen_defers_for_block(IrBuilder *irb, Scope *inner_scope, Scope *o
                 (gen_error_defers && defer_kind == ReturnKindError))
             {
                 AstNode *defer_expr_node = defer_node->data.defer.expr;
-                Scope *defer_expr_scope = defer_node->data.defer.expr_scope;
+                Scope *defer_expr_scope = &((ScopeDefer *)scope)->expr_scope->base;
                 IrInstruction *defer_expr_value = ir_gen_node(irb, defer_expr_node, defer_expr_scope);
                 if (defer_expr_value != irb->codegen->invalid_instruction) {
                     ir_mark_gen(ir_build_check_statement_is_void(irb, defer_expr_scope, defer_expr_node, defer_expr_value));
@@ -3379,7 +3678,7 @@ static VariableTableEntry *create_local_var(CodeGen *codegen, AstNode *node, Sco
             add_error_note(codegen, msg, existing_var->decl_node, buf_sprintf("previous declaration is here"));
             variable_entry->value->type = codegen->builtin_types.entry_invalid;
         } else {
-            auto primitive_table_entry = codegen->primitive_type_table.maybe_get(name);
+            auto primitive_table_entry = codegen->primitive_type_table.maybe_get(intern_str(codegen->intern_table, name));
             if (primitive_table_entry) {
                 TypeTableEntry *type = primitive_table_entry->value;
                 add_node_error(codegen, node,
@@ -3447,6 +3746,18 @@ static ScopeBlock *find_block_scope(IrExecutable *exec, Scope *scope) {
     return nullptr;
 }
 
+// Returns the scope of the statements following the defer. The scopes are kept
+// in the scope chain rather than the AST node, since one body node is shared by
+// every instance of a generic function.
+static Scope *ir_gen_defer(IrBuilder *irb, Scope *parent_scope, AstNode *node) {
+    assert(node->type == NodeTypeDefer);
+
+    ScopeDefer *defer_child_scope = create_defer_scope(node, parent_scope);
+    defer_child_scope->expr_scope = create_defer_expr_scope(node, parent_scope);
+
+    return &defer_child_scope->base;
+}
+
 static IrInstruction *ir_gen_block(IrBuilder *irb, Scope *parent_scope, AstNode *block_node) {
     assert(block_node->type == NodeTypeBlock);
 
@@ -3502,17 +3813,21 @@ static IrInstruction *ir_gen_block(IrBuilder *irb, Scope *parent_scope, AstNode
             continue;
         }
 
+        if (statement_node->type == NodeTypeDefer) {
+            // defer starts a new scope
+            ir_build_const_void(irb, child_scope, statement_node);
+            child_scope = ir_gen_defer(irb, child_scope, statement_node);
+            is_continuation_unreachable = false;
+            continue;
+        }
+
         IrInstruction *statement_value = ir_gen_node(irb, statement_node, child_scope);
         is_continuation_unreachable = instr_is_unreachable(statement_value);
         if (is_continuation_unreachable) {
             // keep the last noreturn statement value around in case we need to return it
             noreturn_return_value = statement_value;
         }
-        if (statement_node->type == NodeTypeDefer && statement_value != irb->codegen->invalid_instruction) {
-            // defer starts a new scope
-            child_scope = statement_node->data.defer.child_scope;
-            assert(child_scope);
-        } else if (statement_value->id == IrInstructionIdDeclVar) {
+        if (statement_value->id == IrInstructionIdDeclVar) {
             // variable declarations start a new scope
             IrInstructionDeclVar *decl_var_instruction = (IrInstructionDeclVar *)statement_value;
             child_scope = decl_var_instruction->var->child_scope;
@@ -3851,14 +4166,21 @@ static IrInstruction *ir_gen_symbol(IrBuilder *irb, Scope *scope, AstNode *node,
 
     if (buf_eql_str(variable_name, "_") && lval.is_ptr) {
         IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, node);
-        const_instruction->base.value.type = get_pointer_to_type(irb->codegen,
-                irb->codegen->builtin_types.entry_void, false);
+        if (irb->worker != nullptr) {
+            std::lock_guard<std::mutex> lock(ir_gen_worker_mutex);
+            const_instruction->base.value.type = get_pointer_to_type(irb->codegen,
+                    irb->codegen->builtin_types.entry_void, false);
+        } else {
+            const_instruction->base.value.type = get_pointer_to_type(irb->codegen,
+                    irb->codegen->builtin_types.entry_void, false);
+        }
         const_instruction->base.value.special = ConstValSpecialStatic;
         const_instruction->base.value.data.x_ptr.special = ConstPtrSpecialDiscard;
         return &const_instruction->base;
     }
 
-    auto primitive_table_entry = irb->codegen->primitive_type_table.maybe_get(variable_name);
+    auto primitive_table_entry = irb->codegen->primitive_type_table.maybe_get(
+            intern_str(irb->codegen->intern_table, variable_name));
     if (primitive_table_entry) {
         IrInstruction *value = ir_build_const_type(irb, scope, node, primitive_table_entry->value);
         if (lval.is_ptr) {
@@ -3965,7 +4287,7 @@ static IrInstruction *ir_gen_builtin_fn_call(IrBuilder *irb, Scope *scope, AstNo
 
     AstNode *fn_ref_expr = node->data.fn_call_expr.fn_ref_expr;
     Buf *name = fn_ref_expr->data.symbol_expr.symbol;
-    auto entry = irb->codegen->builtin_fn_table.maybe_get(name);
+    auto entry = irb->codegen->builtin_fn_table.maybe_get(intern_str(irb->codegen->intern_table, name));
 
     if (!entry) {
         add_node_error(irb->codegen, node,
@@ -4629,49 +4951,169 @@ static IrInstruction *ir_gen_builtin_fn_call(IrBuilder *irb, Scope *scope, AstNo
 
                 return ir_build_set_align_stack(irb, scope, node, arg0_value);
             }
-    }
-    zig_unreachable();
-}
+        case BuiltinFnIdVectorType:
+            {
+                AstNode *arg0_node = node->data.fn_call_expr.params.at(0);
+                IrInstruction *arg0_value = ir_gen_node(irb, arg0_node, scope);
+                if (arg0_value == irb->codegen->invalid_instruction)
+                    return arg0_value;
 
-static IrInstruction *ir_gen_fn_call(IrBuilder *irb, Scope *scope, AstNode *node) {
-    assert(node->type == NodeTypeFnCallExpr);
+                AstNode *arg1_node = node->data.fn_call_expr.params.at(1);
+                IrInstruction *arg1_value = ir_gen_node(irb, arg1_node, scope);
+                if (arg1_value == irb->codegen->invalid_instruction)
+                    return arg1_value;
 
-    if (node->data.fn_call_expr.is_builtin)
-        return ir_gen_builtin_fn_call(irb, scope, node);
+                return ir_build_vector_type(irb, scope, node, arg0_value, arg1_value);
+            }
+        case BuiltinFnIdSplat:
+            {
+                AstNode *arg0_node = node->data.fn_call_expr.params.at(0);
+                IrInstruction *arg0_value = ir_gen_node(irb, arg0_node, scope);
+                if (arg0_value == irb->codegen->invalid_instruction)
+                    return arg0_value;
 
-    AstNode *fn_ref_node = node->data.fn_call_expr.fn_ref_expr;
-    IrInstruction *fn_ref = ir_gen_node(irb, fn_ref_node, scope);
-    if (fn_ref == irb->codegen->invalid_instruction)
-        return fn_ref;
+                AstNode *arg1_node = node->data.fn_call_expr.params.at(1);
+                IrInstruction *arg1_value = ir_gen_node(irb, arg1_node, scope);
+                if (arg1_value == irb->codegen->invalid_instruction)
+                    return arg1_value;
 
-    size_t arg_count = node->data.fn_call_expr.params.length;
-    IrInstruction **args = allocate<IrInstruction*>(arg_count);
-    for (size_t i = 0; i < arg_count; i += 1) {
-        AstNode *arg_node = node->data.fn_call_expr.params.at(i);
-        args[i] = ir_gen_node(irb, arg_node, scope);
-        if (args[i] == irb->codegen->invalid_instruction)
-            return args[i];
-    }
+                return ir_build_splat(irb, scope, node, arg0_value, arg1_value);
+            }
+        case BuiltinFnIdShuffle:
+            {
+                AstNode *arg0_node = node->data.fn_call_expr.params.at(0);
+                IrInstruction *arg0_value = ir_gen_node(irb, arg0_node, scope);
+                if (arg0_value == irb->codegen->invalid_instruction)
+                    return arg0_value;
 
-    return ir_build_call(irb, scope, node, nullptr, fn_ref, arg_count, args, false, false);
-}
+                AstNode *arg1_node = node->data.fn_call_expr.params.at(1);
+                IrInstruction *arg1_value = ir_gen_node(irb, arg1_node, scope);
+                if (arg1_value == irb->codegen->invalid_instruction)
+                    return arg1_value;
 
-static IrInstruction *ir_gen_if_bool_expr(IrBuilder *irb, Scope *scope, AstNode *node) {
-    assert(node->type == NodeTypeIfBoolExpr);
+                AstNode *arg2_node = node->data.fn_call_expr.params.at(2);
+                IrInstruction *arg2_value = ir_gen_node(irb, arg2_node, scope);
+                if (arg2_value == irb->codegen->invalid_instruction)
+                    return arg2_value;
 
-    IrInstruction *condition = ir_gen_node(irb, node->data.if_bool_expr.condition, scope);
-    if (condition == irb->codegen->invalid_instruction)
-        return condition;
+                return ir_build_shuffle(irb, scope, node, arg0_value, arg1_value, arg2_value, nullptr);
+            }
+        case BuiltinFnIdReduce:
+            {
+                AstNode *arg0_node = node->data.fn_call_expr.params.at(0);
+                IrInstruction *arg0_value = ir_gen_node(irb, arg0_node, scope);
+                if (arg0_value == irb->codegen->invalid_instruction)
+                    return arg0_value;
 
-    IrInstruction *is_comptime;
-    if (ir_should_inline(irb->exec, scope)) {
-        is_comptime = ir_build_const_bool(irb, scope, node, true);
-    } else {
-        is_comptime = ir_build_test_comptime(irb, scope, node, condition);
-    }
+                AstNode *arg1_node = node->data.fn_call_expr.params.at(1);
+                IrInstruction *arg1_value = ir_gen_node(irb, arg1_node, scope);
+                if (arg1_value == irb->codegen->invalid_instruction)
+                    return arg1_value;
 
-    AstNode *then_node = node->data.if_bool_expr.then_block;
-    AstNode *else_node = node->data.if_bool_expr.else_node;
+                return ir_build_reduce(irb, scope, node, arg0_value, arg1_value, ReduceOpAdd);
+            }
+        case BuiltinFnIdAtomicRmw:
+            {
+                AstNode *arg0_node = node->data.fn_call_expr.params.at(0);
+                IrInstruction *arg0_value = ir_gen_node(irb, arg0_node, scope);
+                if (arg0_value == irb->codegen->invalid_instruction)
+                    return arg0_value;
+
+                AstNode *arg1_node = node->data.fn_call_expr.params.at(1);
+                IrInstruction *arg1_value = ir_gen_node(irb, arg1_node, scope);
+                if (arg1_value == irb->codegen->invalid_instruction)
+                    return arg1_value;
+
+                AstNode *arg2_node = node->data.fn_call_expr.params.at(2);
+                IrInstruction *arg2_value = ir_gen_node(irb, arg2_node, scope);
+                if (arg2_value == irb->codegen->invalid_instruction)
+                    return arg2_value;
+
+                AstNode *arg3_node = node->data.fn_call_expr.params.at(3);
+                IrInstruction *arg3_value = ir_gen_node(irb, arg3_node, scope);
+                if (arg3_value == irb->codegen->invalid_instruction)
+                    return arg3_value;
+
+                return ir_build_atomic_rmw(irb, scope, node, arg0_value, arg1_value, arg2_value, arg3_value,
+                    AtomicRmwOpXchg, AtomicOrderUnordered);
+            }
+        case BuiltinFnIdAtomicLoad:
+            {
+                AstNode *arg0_node = node->data.fn_call_expr.params.at(0);
+                IrInstruction *arg0_value = ir_gen_node(irb, arg0_node, scope);
+                if (arg0_value == irb->codegen->invalid_instruction)
+                    return arg0_value;
+
+                AstNode *arg1_node = node->data.fn_call_expr.params.at(1);
+                IrInstruction *arg1_value = ir_gen_node(irb, arg1_node, scope);
+                if (arg1_value == irb->codegen->invalid_instruction)
+                    return arg1_value;
+
+                return ir_build_atomic_load(irb, scope, node, arg0_value, arg1_value, AtomicOrderUnordered);
+            }
+        case BuiltinFnIdAtomicStore:
+            {
+                AstNode *arg0_node = node->data.fn_call_expr.params.at(0);
+                IrInstruction *arg0_value = ir_gen_node(irb, arg0_node, scope);
+                if (arg0_value == irb->codegen->invalid_instruction)
+                    return arg0_value;
+
+                AstNode *arg1_node = node->data.fn_call_expr.params.at(1);
+                IrInstruction *arg1_value = ir_gen_node(irb, arg1_node, scope);
+                if (arg1_value == irb->codegen->invalid_instruction)
+                    return arg1_value;
+
+                AstNode *arg2_node = node->data.fn_call_expr.params.at(2);
+                IrInstruction *arg2_value = ir_gen_node(irb, arg2_node, scope);
+                if (arg2_value == irb->codegen->invalid_instruction)
+                    return arg2_value;
+
+                return ir_build_atomic_store(irb, scope, node, arg0_value, arg1_value, arg2_value,
+                    AtomicOrderUnordered);
+            }
+    }
+    zig_unreachable();
+}
+
+static IrInstruction *ir_gen_fn_call(IrBuilder *irb, Scope *scope, AstNode *node) {
+    assert(node->type == NodeTypeFnCallExpr);
+
+    if (node->data.fn_call_expr.is_builtin)
+        return ir_gen_builtin_fn_call(irb, scope, node);
+
+    AstNode *fn_ref_node = node->data.fn_call_expr.fn_ref_expr;
+    IrInstruction *fn_ref = ir_gen_node(irb, fn_ref_node, scope);
+    if (fn_ref == irb->codegen->invalid_instruction)
+        return fn_ref;
+
+    size_t arg_count = node->data.fn_call_expr.params.length;
+    IrInstruction **args = allocate<IrInstruction*>(arg_count);
+    for (size_t i = 0; i < arg_count; i += 1) {
+        AstNode *arg_node = node->data.fn_call_expr.params.at(i);
+        args[i] = ir_gen_node(irb, arg_node, scope);
+        if (args[i] == irb->codegen->invalid_instruction)
+            return args[i];
+    }
+
+    return ir_build_call(irb, scope, node, nullptr, fn_ref, arg_count, args, false, false);
+}
+
+static IrInstruction *ir_gen_if_bool_expr(IrBuilder *irb, Scope *scope, AstNode *node) {
+    assert(node->type == NodeTypeIfBoolExpr);
+
+    IrInstruction *condition = ir_gen_node(irb, node->data.if_bool_expr.condition, scope);
+    if (condition == irb->codegen->invalid_instruction)
+        return condition;
+
+    IrInstruction *is_comptime;
+    if (ir_should_inline(irb->exec, scope)) {
+        is_comptime = ir_build_const_bool(irb, scope, node, true);
+    } else {
+        is_comptime = ir_build_test_comptime(irb, scope, node, condition);
+    }
+
+    AstNode *then_node = node->data.if_bool_expr.then_block;
+    AstNode *else_node = node->data.if_bool_expr.else_node;
 
     IrBasicBlock *then_block = ir_build_basic_block(irb, scope, "Then");
     IrBasicBlock *else_block = ir_build_basic_block(irb, scope, "Else");
@@ -5976,18 +6418,6 @@ static IrInstruction *ir_gen_error_type(IrBuilder *irb, Scope *scope, AstNode *n
     return ir_build_const_type(irb, scope, node, irb->codegen->builtin_types.entry_pure_error);
 }
 
-static IrInstruction *ir_gen_defer(IrBuilder *irb, Scope *parent_scope, AstNode *node) {
-    assert(node->type == NodeTypeDefer);
-
-    ScopeDefer *defer_child_scope = create_defer_scope(node, parent_scope);
-    node->data.defer.child_scope = &defer_child_scope->base;
-
-    ScopeDeferExpr *defer_expr_scope = create_defer_expr_scope(node, parent_scope);
-    node->data.defer.expr_scope = &defer_expr_scope->base;
-
-    return ir_build_const_void(irb, parent_scope, node);
-}
-
 static IrInstruction *ir_gen_slice(IrBuilder *irb, Scope *scope, AstNode *node) {
     assert(node->type == NodeTypeSliceExpr);
 
@@ -6117,6 +6547,14 @@ static Buf *get_anon_type_name(CodeGen *codegen, IrExecutable *exec, const char
 static IrInstruction *ir_gen_container_decl(IrBuilder *irb, Scope *parent_scope, AstNode *node) {
     assert(node->type == NodeTypeContainerDecl);
 
+    if (irb->worker != nullptr) {
+        // this adds declarations to be resolved, in an order which must not depend
+        // on the scheduling of the workers
+        irb->worker->needs_main_thread = true;
+        irb->exec->invalid = true;
+        return irb->codegen->invalid_instruction;
+    }
+
     ContainerKind kind = node->data.container_decl.kind;
     Buf *name = get_anon_type_name(irb->codegen, irb->exec, container_string(kind), node);
 
@@ -6193,6 +6631,7 @@ static IrInstruction *ir_gen_node_raw(IrBuilder *irb, AstNode *node, Scope *scop
         case NodeTypeSwitchRange:
         case NodeTypeStructField:
         case NodeTypeLabel:
+        case NodeTypeDefer:
             zig_unreachable();
         case NodeTypeBlock:
             return ir_lval_wrap(irb, scope, ir_gen_block(irb, scope, node), lval);
@@ -6264,8 +6703,6 @@ static IrInstruction *ir_gen_node_raw(IrBuilder *irb, AstNode *node, Scope *scop
             return ir_lval_wrap(irb, scope, ir_gen_continue(irb, scope, node), lval);
         case NodeTypeUnreachable:
             return ir_lval_wrap(irb, scope, ir_build_unreachable(irb, scope, node), lval);
-        case NodeTypeDefer:
-            return ir_lval_wrap(irb, scope, ir_gen_defer(irb, scope, node), lval);
         case NodeTypeSliceExpr:
             return ir_lval_wrap(irb, scope, ir_gen_slice(irb, scope, node), lval);
         case NodeTypeUnwrapErrorExpr:
@@ -6360,7 +6797,9 @@ static bool ir_goto_pass2(IrBuilder *irb) {
     return true;
 }
 
-bool ir_gen(CodeGen *codegen, AstNode *node, Scope *scope, IrExecutable *ir_executable) {
+static bool ir_gen_extra(CodeGen *codegen, AstNode *node, Scope *scope, IrExecutable *ir_executable,
+        IrGenWorker *worker)
+{
     assert(node->owner);
 
     IrBuilder ir_builder = {0};
@@ -6368,6 +6807,7 @@ bool ir_gen(CodeGen *codegen, AstNode *node, Scope *scope, IrExecutable *ir_exec
 
     irb->codegen = codegen;
     irb->exec = ir_executable;
+    irb->worker = worker;
 
     irb->current_basic_block = ir_build_basic_block(irb, scope, "Entry");
     // Entry block gets a reference because we enter it to begin.
@@ -6390,6 +6830,10 @@ bool ir_gen(CodeGen *codegen, AstNode *node, Scope *scope, IrExecutable *ir_exec
     return true;
 }
 
+bool ir_gen(CodeGen *codegen, AstNode *node, Scope *scope, IrExecutable *ir_executable) {
+    return ir_gen_extra(codegen, node, scope, ir_executable, nullptr);
+}
+
 bool ir_gen_fn(CodeGen *codegen, FnTableEntry *fn_entry) {
     assert(fn_entry);
 
@@ -6401,6 +6845,13 @@ bool ir_gen_fn(CodeGen *codegen, FnTableEntry *fn_entry) {
     return ir_gen(codegen, body_node, fn_entry->child_scope, ir_executable);
 }
 
+bool ir_gen_fn_on_worker(CodeGen *codegen, FnTableEntry *fn_entry, IrGenWorker *worker) {
+    assert(fn_entry->child_scope);
+
+    worker->needs_main_thread = false;
+    return ir_gen_extra(codegen, fn_entry->body_node, fn_entry->child_scope, &fn_entry->ir_executable, worker);
+}
+
 static void add_call_stack_errors(CodeGen *codegen, IrExecutable *exec, ErrorMsg *err_msg, int limit) {
     if (!exec || !exec->source_node || limit < 0) return;
     add_error_note(codegen, err_msg, exec->source_node, buf_sprintf("called from here"));
@@ -7129,6 +7580,22 @@ enum ImplicitCastMatchResult {
     ImplicitCastMatchResultReportedError,
 };
 
+static bool is_array_vector_cast(TypeTableEntry *wanted_type, TypeTableEntry *actual_type) {
+    TypeTableEntry *array_type;
+    TypeTableEntry *vector_type;
+    if (wanted_type->id == TypeTableEntryIdArray && actual_type->id == TypeTableEntryIdVector) {
+        array_type = wanted_type;
+        vector_type = actual_type;
+    } else if (wanted_type->id == TypeTableEntryIdVector && actual_type->id == TypeTableEntryIdArray) {
+        array_type = actual_type;
+        vector_type = wanted_type;
+    } else {
+        return false;
+    }
+    return array_type->data.array.child_type == vector_type->data.vector.elem_type &&
+        array_type->data.array.len == vector_type->data.vector.len;
+}
+
 static ImplicitCastMatchResult ir_types_match_with_implicit_cast(IrAnalyze *ira, TypeTableEntry *expected_type,
         TypeTableEntry *actual_type, IrInstruction *value)
 {
@@ -7304,6 +7771,11 @@ static ImplicitCastMatchResult ir_types_match_with_implicit_cast(IrAnalyze *ira,
         return ImplicitCastMatchResultYes;
     }
 
+    // implicit [N]T to @Vector(N, T) and back
+    if (is_array_vector_cast(expected_type, actual_type)) {
+        return ImplicitCastMatchResultYes;
+    }
+
     // implicitly take a const pointer to something
     if (!type_requires_comptime(actual_type)) {
         TypeTableEntry *const_ptr_actual = get_pointer_to_type(ira->codegen, actual_type, true);
@@ -7549,6 +8021,8 @@ static void eval_const_expr_implicit_cast(CastOp cast_op,
             break;
         case CastOpResizeSlice:
         case CastOpBytesToSlice:
+        case CastOpArrayToVector:
+        case CastOpVectorToArray:
             // can't do it
             zig_unreachable();
         case CastOpIntToFloat:
@@ -7828,7 +8302,14 @@ static ConstExprValue *ir_resolve_const(IrAnalyze *ira, IrInstruction *value, Un
     zig_unreachable();
 }
 
-IrInstruction *ir_eval_const_value(CodeGen *codegen, Scope *scope, AstNode *node,
+static Buf *time_report_node_name(AstNode *node) {
+    // nodes translated from C have no file
+    const char *path = (node->owner != nullptr && node->owner->path != nullptr) ?
+        buf_ptr(node->owner->path) : "(C import)";
+    return buf_sprintf("%s:%" ZIG_PRI_usize ":%" ZIG_PRI_usize, path, node->line + 1, node->column + 1);
+}
+
+static IrInstruction *eval_const_value(CodeGen *codegen, Scope *scope, AstNode *node,
         TypeTableEntry *expected_type, size_t *backward_branch_count, size_t backward_branch_quota,
         FnTableEntry *fn_entry, Buf *c_import_buf, AstNode *source_node, Buf *exec_name,
         IrExecutable *parent_exec)
@@ -7879,6 +8360,25 @@ IrInstruction *ir_eval_const_value(CodeGen *codegen, Scope *scope, AstNode *node
     return ir_exec_const_result(codegen, &analyzed_executable);
 }
 
+IrInstruction *ir_eval_const_value(CodeGen *codegen, Scope *scope, AstNode *node,
+        TypeTableEntry *expected_type, size_t *backward_branch_count, size_t backward_branch_quota,
+        FnTableEntry *fn_entry, Buf *c_import_buf, AstNode *source_node, Buf *exec_name,
+        IrExecutable *parent_exec)
+{
+    if (codegen->time_report == nullptr) {
+        return eval_const_value(codegen, scope, node, expected_type, backward_branch_count,
+                backward_branch_quota, fn_entry, c_import_buf, source_node, exec_name, parent_exec);
+    }
+
+    // compile time calls are named after the function, other evaluations after their position
+    Buf *event_name = (exec_name != nullptr) ? exec_name : time_report_node_name(node);
+    size_t event_index = time_report_begin(codegen, "comptime", event_name);
+    IrInstruction *result = eval_const_value(codegen, scope, node, expected_type, backward_branch_count,
+            backward_branch_quota, fn_entry, c_import_buf, source_node, exec_name, parent_exec);
+    time_report_end(codegen, event_index);
+    return result;
+}
+
 static TypeTableEntry *ir_resolve_type(IrAnalyze *ira, IrInstruction *type_value) {
     if (type_is_invalid(type_value->value.type))
         return ira->codegen->builtin_types.entry_invalid;
@@ -8083,6 +8583,45 @@ static IrInstruction *ir_get_ref(IrAnalyze *ira, IrInstruction *source_instructi
     return new_instruction;
 }
 
+static IrInstruction *ir_analyze_array_vector_cast(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *value, TypeTableEntry *wanted_type)
+{
+    bool to_vector = (wanted_type->id == TypeTableEntryIdVector);
+    uint32_t len = to_vector ? wanted_type->data.vector.len : value->value.type->data.vector.len;
+
+    if (instr_is_comptime(value)) {
+        ConstExprValue *val = ir_resolve_const(ira, value, UndefOk);
+        if (!val)
+            return ira->codegen->invalid_instruction;
+
+        IrInstruction *result = ir_create_const(&ira->new_irb, source_instr->scope,
+                source_instr->source_node, wanted_type);
+        if (val->special == ConstValSpecialUndef) {
+            result->value.special = ConstValSpecialUndef;
+            return result;
+        }
+        if (to_vector && val->data.x_array.special == ConstArraySpecialUndef) {
+            result->value.special = ConstValSpecialUndef;
+            return result;
+        }
+        if (to_vector)
+            expand_const_array(ira->codegen, val);
+
+        result->value.data.x_array.s_none.elements = create_const_vals(len);
+        for (uint32_t i = 0; i < len; i += 1) {
+            copy_const_val(&result->value.data.x_array.s_none.elements[i],
+                    &val->data.x_array.s_none.elements[i], false);
+        }
+        return result;
+    }
+
+    IrInstruction *result = ir_build_cast(&ira->new_irb, source_instr->scope, source_instr->source_node,
+            wanted_type, value, to_vector ? CastOpArrayToVector : CastOpVectorToArray);
+    result->value.type = wanted_type;
+    ir_add_alloca(ira, result, wanted_type);
+    return result;
+}
+
 static IrInstruction *ir_analyze_array_to_slice(IrAnalyze *ira, IrInstruction *source_instr,
         IrInstruction *array_arg, TypeTableEntry *wanted_type)
 {
@@ -8381,6 +8920,11 @@ static IrInstruction *ir_analyze_cast(IrAnalyze *ira, IrInstruction *source_inst
         return ir_resolve_cast(ira, source_instr, value, wanted_type, CastOpFloatToInt, false);
     }
 
+    // explicit cast from [N]T to @Vector(N, T) and back
+    if (is_array_vector_cast(wanted_type, actual_type)) {
+        return ir_analyze_array_vector_cast(ira, source_instr, value, wanted_type);
+    }
+
     // explicit cast from [N]T to []const T
     if (is_slice(wanted_type) && actual_type->id == TypeTableEntryIdArray) {
         TypeTableEntry *ptr_type = wanted_type->data.structure.fields[slice_ptr_index].type_entry;
@@ -8741,6 +9285,19 @@ static IrInstruction *ir_get_deref(IrAnalyze *ira, IrInstruction *source_instruc
             if (ptr->value.data.x_ptr.mut == ConstPtrMutComptimeConst ||
                 ptr->value.data.x_ptr.mut == ConstPtrMutComptimeVar)
             {
+                // loading does not need the array to be expanded
+                if (ptr->value.data.x_ptr.special == ConstPtrSpecialBaseArray) {
+                    ConstExprValue *array_val = ptr->value.data.x_ptr.data.base_array.array_val;
+                    size_t elem_index = ptr->value.data.x_ptr.data.base_array.elem_index;
+                    if (array_val->type->data.array.child_type == child_type &&
+                        elem_index < array_val->type->data.array.len)
+                    {
+                        IrInstruction *result = ir_create_const(&ira->new_irb, source_instruction->scope,
+                            source_instruction->source_node, child_type);
+                        if (read_compact_array_elem(array_val, elem_index, &result->value))
+                            return result;
+                    }
+                }
                 ConstExprValue *pointee = const_ptr_pointee(ira->codegen, &ptr->value);
                 if (pointee->special != ConstValSpecialRuntime) {
                     IrInstruction *result = ir_create_const(&ira->new_irb, source_instruction->scope,
@@ -8854,7 +9411,10 @@ static bool ir_resolve_comptime(IrAnalyze *ira, IrInstruction *value, bool *out)
 }
 
 static ConstExprValue *get_builtin_value(CodeGen *codegen, const char *name) {
-    Tld *tld = codegen->compile_var_import->decls_scope->decl_table.get(buf_create_from_str(name));
+    Buf name_buf = BUF_INIT;
+    buf_init_from_str(&name_buf, name);
+    Tld *tld = codegen->compile_var_import->decls_scope->decl_table.get(intern_str(codegen->intern_table, &name_buf));
+    buf_deinit(&name_buf);
     resolve_top_level_decl(codegen, tld, false, nullptr);
     assert(tld->id == TldIdVar);
     TldVar *tld_var = (TldVar *)tld;
@@ -8883,6 +9443,46 @@ static bool ir_resolve_atomic_order(IrAnalyze *ira, IrInstruction *value, Atomic
     return true;
 }
 
+static bool ir_resolve_reduce_op(IrAnalyze *ira, IrInstruction *value, ReduceOp *out) {
+    if (type_is_invalid(value->value.type))
+        return false;
+
+    ConstExprValue *reduce_op_val = get_builtin_value(ira->codegen, "ReduceOp");
+    assert(reduce_op_val->type->id == TypeTableEntryIdMetaType);
+    TypeTableEntry *reduce_op_type = reduce_op_val->data.x_type;
+
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, reduce_op_type);
+    if (type_is_invalid(casted_value->value.type))
+        return false;
+
+    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
+    if (!const_val)
+        return false;
+
+    *out = (ReduceOp)const_val->data.x_enum.tag;
+    return true;
+}
+
+static bool ir_resolve_atomic_rmw_op(IrAnalyze *ira, IrInstruction *value, AtomicRmwOp *out) {
+    if (type_is_invalid(value->value.type))
+        return false;
+
+    ConstExprValue *atomic_rmw_op_val = get_builtin_value(ira->codegen, "AtomicRmwOp");
+    assert(atomic_rmw_op_val->type->id == TypeTableEntryIdMetaType);
+    TypeTableEntry *atomic_rmw_op_type = atomic_rmw_op_val->data.x_type;
+
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, atomic_rmw_op_type);
+    if (type_is_invalid(casted_value->value.type))
+        return false;
+
+    ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
+    if (!const_val)
+        return false;
+
+    *out = (AtomicRmwOp)const_val->data.x_enum.tag;
+    return true;
+}
+
 static bool ir_resolve_global_linkage(IrAnalyze *ira, IrInstruction *value, GlobalLinkageId *out) {
     if (type_is_invalid(value->value.type))
         return false;
@@ -8923,21 +9523,12 @@ static Buf *ir_resolve_str(IrAnalyze *ira, IrInstruction *value) {
 
     assert(ptr_field->data.x_ptr.special == ConstPtrSpecialBaseArray);
     ConstExprValue *array_val = ptr_field->data.x_ptr.data.base_array.array_val;
-    expand_undef_array(ira->codegen, array_val);
+    size_t start = ptr_field->data.x_ptr.data.base_array.elem_index;
     size_t len = bigint_as_unsigned(&len_field->data.x_bigint);
     Buf *result = buf_alloc();
-    buf_resize(result, len);
-    for (size_t i = 0; i < len; i += 1) {
-        size_t new_index = ptr_field->data.x_ptr.data.base_array.elem_index + i;
-        ConstExprValue *char_val = &array_val->data.x_array.s_none.elements[new_index];
-        if (char_val->special == ConstValSpecialUndef) {
-            ir_add_error(ira, casted_value, buf_sprintf("use of undefined value"));
-            return nullptr;
-        }
-        uint64_t big_c = bigint_as_unsigned(&char_val->data.x_bigint);
-        assert(big_c <= UINT8_MAX);
-        uint8_t c = (uint8_t)big_c;
-        buf_ptr(result)[i] = c;
+    if (!read_const_array_bytes(array_val, start, start + len, result)) {
+        ir_add_error(ira, casted_value, buf_sprintf("use of undefined value"));
+        return nullptr;
     }
     return result;
 }
@@ -9030,6 +9621,77 @@ static bool resolve_cmp_op_id(IrBinOp op_id, Cmp cmp) {
     }
 }
 
+static bool ir_eval_cmp_op(TypeTableEntry *type_entry, ConstExprValue *op1_val, IrBinOp op_id,
+        ConstExprValue *op2_val)
+{
+    if (type_entry->id == TypeTableEntryIdNumLitFloat || type_entry->id == TypeTableEntryIdFloat) {
+        Cmp cmp_result = float_cmp(op1_val, op2_val);
+        return resolve_cmp_op_id(op_id, cmp_result);
+    } else if (type_entry->id == TypeTableEntryIdNumLitInt || type_entry->id == TypeTableEntryIdInt) {
+        Cmp cmp_result = bigint_cmp(&op1_val->data.x_bigint, &op2_val->data.x_bigint);
+        return resolve_cmp_op_id(op_id, cmp_result);
+    } else {
+        bool are_equal = type_entry->id == TypeTableEntryIdVoid || const_values_equal(op1_val, op2_val);
+        if (op_id == IrBinOpCmpEq) {
+            return are_equal;
+        } else if (op_id == IrBinOpCmpNotEq) {
+            return !are_equal;
+        } else {
+            zig_unreachable();
+        }
+    }
+}
+
+// Like ir_resolve_const with UndefBad, but also rejects a vector with an undefined element,
+// which shuffling a vector with undefined produces.
+static ConstExprValue *ir_resolve_vector_const(IrAnalyze *ira, IrInstruction *value) {
+    ConstExprValue *val = ir_resolve_const(ira, value, UndefBad);
+    if (!val)
+        return nullptr;
+
+    assert(val->type->id == TypeTableEntryIdVector);
+    for (uint32_t i = 0; i < val->type->data.vector.len; i += 1) {
+        if (val->data.x_array.s_none.elements[i].special == ConstValSpecialUndef) {
+            ir_add_error(ira, value, buf_sprintf("use of undefined value"));
+            return nullptr;
+        }
+    }
+    return val;
+}
+
+// Vectors are compared element by element, giving a vector of bools.
+static TypeTableEntry *ir_analyze_vector_cmp(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction,
+        TypeTableEntry *vector_type, IrInstruction *op1, IrInstruction *op2)
+{
+    TypeTableEntry *elem_type = vector_type->data.vector.elem_type;
+    uint32_t len = vector_type->data.vector.len;
+    TypeTableEntry *result_type = get_vector_type(ira->codegen, ira->codegen->builtin_types.entry_bool, len);
+
+    if (instr_is_comptime(op1) && instr_is_comptime(op2)) {
+        ConstExprValue *op1_val = ir_resolve_vector_const(ira, op1);
+        if (!op1_val)
+            return ira->codegen->builtin_types.entry_invalid;
+        ConstExprValue *op2_val = ir_resolve_vector_const(ira, op2);
+        if (!op2_val)
+            return ira->codegen->builtin_types.entry_invalid;
+
+        ConstExprValue *out_val = ir_build_const_from(ira, &bin_op_instruction->base);
+        out_val->data.x_array.s_none.elements = create_const_vals(len);
+        for (uint32_t i = 0; i < len; i += 1) {
+            ConstExprValue *out_elem = &out_val->data.x_array.s_none.elements[i];
+            out_elem->special = ConstValSpecialStatic;
+            out_elem->type = ira->codegen->builtin_types.entry_bool;
+            out_elem->data.x_bool = ir_eval_cmp_op(elem_type, &op1_val->data.x_array.s_none.elements[i],
+                    bin_op_instruction->op_id, &op2_val->data.x_array.s_none.elements[i]);
+        }
+        return result_type;
+    }
+
+    ir_build_bin_op_from(&ira->new_irb, &bin_op_instruction->base, bin_op_instruction->op_id,
+            op1, op2, bin_op_instruction->safety_check_on);
+    return result_type;
+}
+
 static TypeTableEntry *ir_analyze_bin_op_cmp(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
     IrInstruction *op1 = bin_op_instruction->op1->other;
     IrInstruction *op2 = bin_op_instruction->op2->other;
@@ -9118,6 +9780,14 @@ static TypeTableEntry *ir_analyze_bin_op_cmp(IrAnalyze *ira, IrInstructionBinOp
             }
             break;
 
+        case TypeTableEntryIdVector:
+            if (!is_equality_cmp && resolved_type->data.vector.elem_type->id == TypeTableEntryIdBool) {
+                ir_add_error_node(ira, source_node,
+                    buf_sprintf("operator not allowed for type '%s'", buf_ptr(&resolved_type->name)));
+                return ira->codegen->builtin_types.entry_invalid;
+            }
+            break;
+
         case TypeTableEntryIdUnreachable:
         case TypeTableEntryIdArray:
         case TypeTableEntryIdStruct:
@@ -9145,26 +9815,13 @@ static TypeTableEntry *ir_analyze_bin_op_cmp(IrAnalyze *ira, IrInstructionBinOp
     if (casted_op2 == ira->codegen->invalid_instruction)
         return ira->codegen->builtin_types.entry_invalid;
 
+    if (resolved_type->id == TypeTableEntryIdVector)
+        return ir_analyze_vector_cmp(ira, bin_op_instruction, resolved_type, casted_op1, casted_op2);
+
     ConstExprValue *op1_val = &casted_op1->value;
     ConstExprValue *op2_val = &casted_op2->value;
     if ((value_is_comptime(op1_val) && value_is_comptime(op2_val)) || resolved_type->id == TypeTableEntryIdVoid) {
-        bool answer;
-        if (resolved_type->id == TypeTableEntryIdNumLitFloat || resolved_type->id == TypeTableEntryIdFloat) {
-            Cmp cmp_result = float_cmp(op1_val, op2_val);
-            answer = resolve_cmp_op_id(op_id, cmp_result);
-        } else if (resolved_type->id == TypeTableEntryIdNumLitInt || resolved_type->id == TypeTableEntryIdInt) {
-            Cmp cmp_result = bigint_cmp(&op1_val->data.x_bigint, &op2_val->data.x_bigint);
-            answer = resolve_cmp_op_id(op_id, cmp_result);
-        } else {
-            bool are_equal = resolved_type->id == TypeTableEntryIdVoid || const_values_equal(op1_val, op2_val);
-            if (op_id == IrBinOpCmpEq) {
-                answer = are_equal;
-            } else if (op_id == IrBinOpCmpNotEq) {
-                answer = !are_equal;
-            } else {
-                zig_unreachable();
-            }
-        }
+        bool answer = ir_eval_cmp_op(resolved_type, op1_val, op_id, op2_val);
 
         ConstExprValue *out_val = ir_build_const_from(ira, &bin_op_instruction->base);
         out_val->data.x_bool = answer;
@@ -9456,23 +10113,106 @@ static TypeTableEntry *ir_analyze_bit_shift(IrAnalyze *ira, IrInstructionBinOp *
     return op1->value.type;
 }
 
-static TypeTableEntry *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
+// Integer vector arithmetic is checked for overflow like scalar arithmetic, and
+// +%, -% and *% wrap. Integer division is left to scalar code.
+static TypeTableEntry *ir_analyze_vector_math(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction,
+        TypeTableEntry *vector_type)
+{
     IrInstruction *op1 = bin_op_instruction->op1->other;
     IrInstruction *op2 = bin_op_instruction->op2->other;
-    IrInstruction *instructions[] = {op1, op2};
-    TypeTableEntry *resolved_type = ir_resolve_peer_types(ira, bin_op_instruction->base.source_node, instructions, 2);
-    if (type_is_invalid(resolved_type))
-        return resolved_type;
+    TypeTableEntry *elem_type = vector_type->data.vector.elem_type;
+    uint32_t len = vector_type->data.vector.len;
+
     IrBinOp op_id = bin_op_instruction->op_id;
+    bool ok;
+    if (elem_type->id == TypeTableEntryIdInt) {
+        ok = (op_id == IrBinOpAdd ||
+            op_id == IrBinOpSub ||
+            op_id == IrBinOpMult ||
+            op_id == IrBinOpAddWrap ||
+            op_id == IrBinOpSubWrap ||
+            op_id == IrBinOpMultWrap ||
+            op_id == IrBinOpBinOr ||
+            op_id == IrBinOpBinXor ||
+            op_id == IrBinOpBinAnd);
+    } else if (elem_type->id == TypeTableEntryIdFloat) {
+        ok = (op_id == IrBinOpAdd ||
+            op_id == IrBinOpSub ||
+            op_id == IrBinOpMult ||
+            op_id == IrBinOpDivUnspecified);
+    } else {
+        ok = false;
+    }
+    if (!ok) {
+        ir_add_error(ira, &bin_op_instruction->base,
+            buf_sprintf("invalid operands to binary expression: '%s' and '%s'",
+                buf_ptr(&op1->value.type->name),
+                buf_ptr(&op2->value.type->name)));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
 
-    bool is_int = resolved_type->id == TypeTableEntryIdInt || resolved_type->id == TypeTableEntryIdNumLitInt;
-    bool is_float = resolved_type->id == TypeTableEntryIdFloat || resolved_type->id == TypeTableEntryIdNumLitFloat;
-    bool is_signed_div = (
-        (resolved_type->id == TypeTableEntryIdInt && resolved_type->data.integral.is_signed) ||
-        resolved_type->id == TypeTableEntryIdFloat ||
-        (resolved_type->id == TypeTableEntryIdNumLitFloat &&
-            ((bigfloat_cmp_zero(&op1->value.data.x_bigfloat) != CmpGT) !=
-             (bigfloat_cmp_zero(&op2->value.data.x_bigfloat) != CmpGT))) ||
+    IrInstruction *casted_op1 = ir_implicit_cast(ira, op1, vector_type);
+    if (casted_op1 == ira->codegen->invalid_instruction)
+        return ira->codegen->builtin_types.entry_invalid;
+
+    IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, vector_type);
+    if (casted_op2 == ira->codegen->invalid_instruction)
+        return ira->codegen->builtin_types.entry_invalid;
+
+    if (instr_is_comptime(casted_op1) && instr_is_comptime(casted_op2)) {
+        ConstExprValue *op1_val = ir_resolve_vector_const(ira, casted_op1);
+        if (!op1_val)
+            return ira->codegen->builtin_types.entry_invalid;
+        ConstExprValue *op2_val = ir_resolve_vector_const(ira, casted_op2);
+        if (!op2_val)
+            return ira->codegen->builtin_types.entry_invalid;
+
+        ConstExprValue *out_val = ir_build_const_from(ira, &bin_op_instruction->base);
+        out_val->data.x_array.s_none.elements = create_const_vals(len);
+        for (uint32_t i = 0; i < len; i += 1) {
+            int err;
+            if ((err = ir_eval_math_op(elem_type, &op1_val->data.x_array.s_none.elements[i], op_id,
+                &op2_val->data.x_array.s_none.elements[i], &out_val->data.x_array.s_none.elements[i])))
+            {
+                if (err == ErrorDivByZero) {
+                    ir_add_error(ira, &bin_op_instruction->base, buf_sprintf("division by zero is undefined"));
+                    return ira->codegen->builtin_types.entry_invalid;
+                } else if (err == ErrorOverflow) {
+                    ir_add_error(ira, &bin_op_instruction->base,
+                        buf_sprintf("operation caused overflow in element %" PRIu32, i));
+                    return ira->codegen->builtin_types.entry_invalid;
+                } else {
+                    zig_unreachable();
+                }
+            }
+        }
+        return vector_type;
+    }
+
+    ir_build_bin_op_from(&ira->new_irb, &bin_op_instruction->base, op_id,
+            casted_op1, casted_op2, bin_op_instruction->safety_check_on);
+    return vector_type;
+}
+
+static TypeTableEntry *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
+    IrInstruction *op1 = bin_op_instruction->op1->other;
+    IrInstruction *op2 = bin_op_instruction->op2->other;
+    IrInstruction *instructions[] = {op1, op2};
+    TypeTableEntry *resolved_type = ir_resolve_peer_types(ira, bin_op_instruction->base.source_node, instructions, 2);
+    if (type_is_invalid(resolved_type))
+        return resolved_type;
+    if (resolved_type->id == TypeTableEntryIdVector)
+        return ir_analyze_vector_math(ira, bin_op_instruction, resolved_type);
+    IrBinOp op_id = bin_op_instruction->op_id;
+
+    bool is_int = resolved_type->id == TypeTableEntryIdInt || resolved_type->id == TypeTableEntryIdNumLitInt;
+    bool is_float = resolved_type->id == TypeTableEntryIdFloat || resolved_type->id == TypeTableEntryIdNumLitFloat;
+    bool is_signed_div = (
+        (resolved_type->id == TypeTableEntryIdInt && resolved_type->data.integral.is_signed) ||
+        resolved_type->id == TypeTableEntryIdFloat ||
+        (resolved_type->id == TypeTableEntryIdNumLitFloat &&
+            ((bigfloat_cmp_zero(&op1->value.data.x_bigfloat) != CmpGT) !=
+             (bigfloat_cmp_zero(&op2->value.data.x_bigfloat) != CmpGT))) ||
         (resolved_type->id == TypeTableEntryIdNumLitInt &&
             ((bigint_cmp_zero(&op1->value.data.x_bigint) != CmpGT) !=
              (bigint_cmp_zero(&op2->value.data.x_bigint) != CmpGT)))
@@ -9745,9 +10485,39 @@ static TypeTableEntry *ir_analyze_array_cat(IrAnalyze *ira, IrInstructionBinOp *
         out_val->data.x_ptr.data.base_array.array_val = out_array_val;
         out_val->data.x_ptr.data.base_array.elem_index = 0;
     }
+    if (child_type == ira->codegen->builtin_types.entry_u8) {
+        Buf *bytes = buf_alloc();
+        if (read_const_array_bytes(op1_array_val, op1_array_index, op1_array_end, bytes) &&
+            read_const_array_bytes(op2_array_val, op2_array_index, op2_array_end, bytes))
+        {
+            if (buf_len(bytes) < new_len)
+                buf_append_char(bytes, 0);
+            assert(buf_len(bytes) == new_len);
+            out_array_val->data.x_array.special = ConstArraySpecialBuf;
+            out_array_val->data.x_array.s_buf.bytes = bytes;
+            return result_type;
+        }
+        buf_deinit(bytes);
+        free(bytes);
+    } else if (const_array_elem_is_packable(ira->codegen, child_type)) {
+        ZigList<uint64_t> values = {0};
+        if (read_const_array_ints(op1_array_val, op1_array_index, op1_array_end, &values) &&
+            read_const_array_ints(op2_array_val, op2_array_index, op2_array_end, &values))
+        {
+            if (values.length < new_len)
+                values.append(0);
+            assert(values.length == new_len);
+            out_array_val->data.x_array.special = ConstArraySpecialInts;
+            out_array_val->data.x_array.s_ints.values = values.items;
+            return result_type;
+        }
+        values.deinit();
+    }
+
     out_array_val->data.x_array.s_none.elements = create_const_vals(new_len);
 
-    expand_undef_array(ira->codegen, op1_array_val);
+    expand_const_array(ira->codegen, op1_array_val);
+    expand_const_array(ira->codegen, op2_array_val);
 
     size_t next_index = 0;
     for (size_t i = op1_array_index; i < op1_array_end; i += 1, next_index += 1) {
@@ -9799,10 +10569,63 @@ static TypeTableEntry *ir_analyze_array_mult(IrAnalyze *ira, IrInstructionBinOp
     }
 
     ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
+    TypeTableEntry *child_type = array_type->data.array.child_type;
+    TypeTableEntry *result_type = get_array_type(ira->codegen, child_type, new_array_len);
+
+    // The result keeps the compact form of the operand, so that for example a lookup
+    // table initialized with `[]u32{0} ** 65536` is a single value until it is modified.
+    ConstArrayValue *array = &array_val->data.x_array;
+    if (array->special == ConstArraySpecialUndef) {
+        out_val->data.x_array.special = ConstArraySpecialUndef;
+        return result_type;
+    }
+    if (child_type == ira->codegen->builtin_types.entry_u8) {
+        Buf *bytes = buf_alloc();
+        if (read_const_array_bytes(array_val, 0, old_array_len, bytes)) {
+            Buf *out_bytes = buf_alloc();
+            for (uint64_t x = 0; x < mult_amt; x += 1) {
+                buf_append_buf(out_bytes, bytes);
+            }
+            buf_deinit(bytes);
+            free(bytes);
+            out_val->data.x_array.special = ConstArraySpecialBuf;
+            out_val->data.x_array.s_buf.bytes = out_bytes;
+            return result_type;
+        }
+        buf_deinit(bytes);
+        free(bytes);
+    }
+    if (array->special == ConstArraySpecialRepeat || (old_array_len == 1 && new_array_len > 1)) {
+        ConstExprValue *elem_val;
+        if (array->special == ConstArraySpecialRepeat) {
+            elem_val = array->s_repeat.elem;
+        } else {
+            // the operand may be modified later
+            elem_val = create_const_vals(1);
+            copy_const_val(elem_val, &array->s_none.elements[0], false);
+        }
+        out_val->data.x_array.special = ConstArraySpecialRepeat;
+        out_val->data.x_array.s_repeat.elem = elem_val;
+        return result_type;
+    }
+    if (const_array_elem_is_packable(ira->codegen, child_type)) {
+        ZigList<uint64_t> values = {0};
+        if (read_const_array_ints(array_val, 0, old_array_len, &values)) {
+            uint64_t *out_values = allocate_nonzero<uint64_t>(new_array_len);
+            for (uint64_t x = 0; x < mult_amt; x += 1) {
+                memcpy(&out_values[x * old_array_len], values.items, old_array_len * sizeof(uint64_t));
+            }
+            values.deinit();
+            out_val->data.x_array.special = ConstArraySpecialInts;
+            out_val->data.x_array.s_ints.values = out_values;
+            return result_type;
+        }
+        values.deinit();
+    }
 
     out_val->data.x_array.s_none.elements = create_const_vals(new_array_len);
 
-    expand_undef_array(ira->codegen, array_val);
+    expand_const_array(ira->codegen, array_val);
 
     uint64_t i = 0;
     for (uint64_t x = 0; x < mult_amt; x += 1) {
@@ -9813,8 +10636,7 @@ static TypeTableEntry *ir_analyze_array_mult(IrAnalyze *ira, IrInstructionBinOp
     }
     assert(i == new_array_len);
 
-    TypeTableEntry *child_type = array_type->data.array.child_type;
-    return get_array_type(ira->codegen, child_type, new_array_len);
+    return result_type;
 }
 
 static TypeTableEntry *ir_analyze_instruction_bin_op(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
@@ -9882,6 +10704,7 @@ static VarClassRequired get_var_class_required(TypeTableEntry *type_entry) {
         case TypeTableEntryIdPureError:
         case TypeTableEntryIdFn:
         case TypeTableEntryIdEnumTag:
+        case TypeTableEntryIdVector:
             return VarClassRequiredAny;
         case TypeTableEntryIdNumLitFloat:
         case TypeTableEntryIdNumLitInt:
@@ -10269,13 +11092,44 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
         if (entry) {
             result = entry->value;
         } else {
-            // Analyze the fn body block like any other constant expression.
-            AstNode *body_node = fn_entry->body_node;
-            result = ir_eval_const_value(ira->codegen, exec_scope, body_node, return_type,
-                ira->new_irb.exec->backward_branch_count, ira->new_irb.exec->backward_branch_quota, fn_entry,
-                nullptr, call_instruction->base.source_node, nullptr, ira->new_irb.exec);
-            if (type_is_invalid(result->value.type))
-                return ira->codegen->builtin_types.entry_invalid;
+            // A previous build may have evaluated the same call.
+            Buf *cache_key = buf_alloc();
+            bool cacheable = ira->codegen->comptime_cache != nullptr &&
+                comptime_cache_key(ira->codegen, exec_scope, cache_key);
+            size_t *backward_branch_count = ira->new_irb.exec->backward_branch_count;
+            result = nullptr;
+            if (cacheable) {
+                IrInstruction *cached = ir_create_const(&ira->new_irb, call_instruction->base.scope,
+                        source_node, return_type);
+                size_t cached_branch_count;
+                if (comptime_cache_get(ira->codegen, cache_key, return_type, &cached->value, &cached_branch_count)) {
+                    // When the cached call would exceed the quota, it is evaluated again so
+                    // that the error points at the branch that went over.
+                    if (*backward_branch_count + cached_branch_count <= ira->new_irb.exec->backward_branch_quota) {
+                        *backward_branch_count += cached_branch_count;
+                        result = cached;
+                    }
+                }
+                if (ira->codegen->verbose_cache) {
+                    fprintf(stderr, "comptime cache %s: %s\n", (result != nullptr) ? "hit" : "miss",
+                            buf_ptr(&fn_entry->symbol_name));
+                }
+            }
+
+            if (result == nullptr) {
+                size_t branches_before = *backward_branch_count;
+                // Analyze the fn body block like any other constant expression.
+                AstNode *body_node = fn_entry->body_node;
+                result = ir_eval_const_value(ira->codegen, exec_scope, body_node, return_type,
+                    ira->new_irb.exec->backward_branch_count, ira->new_irb.exec->backward_branch_quota, fn_entry,
+                    nullptr, call_instruction->base.source_node, nullptr, ira->new_irb.exec);
+                if (type_is_invalid(result->value.type))
+                    return ira->codegen->builtin_types.entry_invalid;
+
+                if (cacheable)
+                    comptime_cache_put(ira->codegen, cache_key, &result->value,
+                            *backward_branch_count - branches_before);
+            }
 
             ira->codegen->memoized_fn_eval_table.put(exec_scope, result);
         }
@@ -10311,6 +11165,7 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
         // Fork a scope of the function with known values for the parameters.
         Scope *parent_scope = fn_entry->fndef_scope->base.parent;
         FnTableEntry *impl_fn = create_fn(fn_proto_node);
+        impl_fn->is_generic_instance = true;
         impl_fn->param_source_nodes = allocate<AstNode *>(new_fn_arg_count);
         buf_init_from_buf(&impl_fn->symbol_name, &fn_entry->symbol_name);
         impl_fn->fndef_scope = create_fndef_scope(impl_fn->body_node, parent_scope, impl_fn);
@@ -10593,6 +11448,7 @@ static TypeTableEntry *ir_analyze_unary_prefix_op_err(IrAnalyze *ira, IrInstruct
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdPointer:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdStruct:
         case TypeTableEntryIdMaybe:
         case TypeTableEntryIdErrorUnion:
@@ -10675,6 +11531,7 @@ static TypeTableEntry *ir_analyze_maybe(IrAnalyze *ira, IrInstructionUnOp *un_op
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdPointer:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdStruct:
         case TypeTableEntryIdNumLitFloat:
         case TypeTableEntryIdNumLitInt:
@@ -11264,7 +12121,7 @@ static TypeTableEntry *ir_analyze_container_member_access_inner(IrAnalyze *ira,
 {
     if (!is_slice(bare_struct_type)) {
         ScopeDecls *container_scope = get_container_scope(bare_struct_type);
-        auto entry = container_scope->decl_table.maybe_get(field_name);
+        auto entry = container_scope->decl_table.maybe_get(intern_str(ira->codegen->intern_table, field_name));
         Tld *tld = entry ? entry->value : nullptr;
         if (tld && tld->id == TldIdFn) {
             resolve_top_level_decl(ira->codegen, tld, false, field_ptr_instruction->base.source_node);
@@ -11531,7 +12388,7 @@ static TypeTableEntry *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstru
             }
             ScopeDecls *container_scope = get_container_scope(child_type);
             if (container_scope != nullptr) {
-                auto entry = container_scope->decl_table.maybe_get(field_name);
+                auto entry = container_scope->decl_table.maybe_get(intern_str(ira->codegen->intern_table, field_name));
                 Tld *tld = entry ? entry->value : nullptr;
                 if (tld) {
                     return ir_analyze_decl_ref(ira, &field_ptr_instruction->base, tld);
@@ -11542,7 +12399,7 @@ static TypeTableEntry *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstru
                     buf_ptr(&child_type->name), buf_ptr(field_name)));
             return ira->codegen->builtin_types.entry_invalid;
         } else if (child_type->id == TypeTableEntryIdPureError) {
-            auto err_table_entry = ira->codegen->error_table.maybe_get(field_name);
+            auto err_table_entry = ira->codegen->error_table.maybe_get(intern_str(ira->codegen->intern_table, field_name));
             if (err_table_entry) {
                 ConstExprValue *const_val = create_const_vals(1);
                 const_val->special = ConstValSpecialStatic;
@@ -11687,6 +12544,48 @@ static TypeTableEntry *ir_analyze_instruction_load_ptr(IrAnalyze *ira, IrInstruc
     return result->value.type;
 }
 
+// Stores through a pointer which is known at compile time. Returns nullptr if the store
+// has to be done at runtime.
+static TypeTableEntry *ir_analyze_comptime_store(IrAnalyze *ira, IrInstruction *source_instr,
+        IrInstruction *ptr, IrInstruction *casted_value)
+{
+    if (!instr_is_comptime(ptr) || ptr->value.data.x_ptr.special == ConstPtrSpecialHardCodedAddr)
+        return nullptr;
+
+    if (ptr->value.data.x_ptr.mut == ConstPtrMutComptimeConst) {
+        ir_add_error(ira, source_instr, buf_sprintf("cannot assign to constant"));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+    if (ptr->value.data.x_ptr.mut == ConstPtrMutComptimeVar) {
+        if (instr_is_comptime(casted_value)) {
+            // storing an integer in a packed array does not expand it
+            if (ptr->value.data.x_ptr.special == ConstPtrSpecialBaseArray &&
+                write_packed_array_elem(ira->codegen, ptr->value.data.x_ptr.data.base_array.array_val,
+                    ptr->value.data.x_ptr.data.base_array.elem_index, &casted_value->value))
+            {
+                if (!ira->new_irb.current_basic_block->must_be_comptime_source_instr) {
+                    ira->new_irb.current_basic_block->must_be_comptime_source_instr = source_instr;
+                }
+                return ir_analyze_void(ira, source_instr);
+            }
+            ConstExprValue *dest_val = const_ptr_pointee(ira->codegen, &ptr->value);
+            if (dest_val->special != ConstValSpecialRuntime) {
+                *dest_val = casted_value->value;
+                if (!ira->new_irb.current_basic_block->must_be_comptime_source_instr) {
+                    ira->new_irb.current_basic_block->must_be_comptime_source_instr = source_instr;
+                }
+                return ir_analyze_void(ira, source_instr);
+            }
+        }
+        ir_add_error(ira, source_instr, buf_sprintf("cannot store runtime value in compile time variable"));
+        ConstExprValue *dest_val = const_ptr_pointee(ira->codegen, &ptr->value);
+        dest_val->type = ira->codegen->builtin_types.entry_invalid;
+
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+    return nullptr;
+}
+
 static TypeTableEntry *ir_analyze_instruction_store_ptr(IrAnalyze *ira, IrInstructionStorePtr *store_ptr_instruction) {
     IrInstruction *ptr = store_ptr_instruction->ptr->other;
     if (type_is_invalid(ptr->value.type))
@@ -11716,30 +12615,9 @@ static TypeTableEntry *ir_analyze_instruction_store_ptr(IrAnalyze *ira, IrInstru
     if (casted_value == ira->codegen->invalid_instruction)
         return ira->codegen->builtin_types.entry_invalid;
 
-    if (instr_is_comptime(ptr) && ptr->value.data.x_ptr.special != ConstPtrSpecialHardCodedAddr) {
-        if (ptr->value.data.x_ptr.mut == ConstPtrMutComptimeConst) {
-            ir_add_error(ira, &store_ptr_instruction->base, buf_sprintf("cannot assign to constant"));
-            return ira->codegen->builtin_types.entry_invalid;
-        }
-        if (ptr->value.data.x_ptr.mut == ConstPtrMutComptimeVar) {
-            if (instr_is_comptime(casted_value)) {
-                ConstExprValue *dest_val = const_ptr_pointee(ira->codegen, &ptr->value);
-                if (dest_val->special != ConstValSpecialRuntime) {
-                    *dest_val = casted_value->value;
-                    if (!ira->new_irb.current_basic_block->must_be_comptime_source_instr) {
-                        ira->new_irb.current_basic_block->must_be_comptime_source_instr = &store_ptr_instruction->base;
-                    }
-                    return ir_analyze_void(ira, &store_ptr_instruction->base);
-                }
-            }
-            ir_add_error(ira, &store_ptr_instruction->base,
-                    buf_sprintf("cannot store runtime value in compile time variable"));
-            ConstExprValue *dest_val = const_ptr_pointee(ira->codegen, &ptr->value);
-            dest_val->type = ira->codegen->builtin_types.entry_invalid;
-
-            return ira->codegen->builtin_types.entry_invalid;
-        }
-    }
+    TypeTableEntry *comptime_result = ir_analyze_comptime_store(ira, &store_ptr_instruction->base, ptr, casted_value);
+    if (comptime_result != nullptr)
+        return comptime_result;
 
     ir_build_store_ptr_from(&ira->new_irb, &store_ptr_instruction->base, ptr, casted_value);
     return ira->codegen->builtin_types.entry_void;
@@ -11772,6 +12650,7 @@ static TypeTableEntry *ir_analyze_instruction_typeof(IrAnalyze *ira, IrInstructi
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdPointer:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdStruct:
         case TypeTableEntryIdMaybe:
         case TypeTableEntryIdErrorUnion:
@@ -12126,6 +13005,7 @@ static TypeTableEntry *ir_analyze_instruction_slice_type(IrAnalyze *ira,
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdPointer:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdStruct:
         case TypeTableEntryIdNumLitFloat:
         case TypeTableEntryIdNumLitInt:
@@ -12235,6 +13115,7 @@ static TypeTableEntry *ir_analyze_instruction_array_type(IrAnalyze *ira,
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdPointer:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdStruct:
         case TypeTableEntryIdNumLitFloat:
         case TypeTableEntryIdNumLitInt:
@@ -12291,6 +13172,7 @@ static TypeTableEntry *ir_analyze_instruction_size_of(IrAnalyze *ira,
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdPointer:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdStruct:
         case TypeTableEntryIdMaybe:
         case TypeTableEntryIdErrorUnion:
@@ -12657,6 +13539,7 @@ static TypeTableEntry *ir_analyze_instruction_switch_target(IrAnalyze *ira,
             zig_panic("TODO switch on enum tag type");
         case TypeTableEntryIdUnreachable:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdStruct:
         case TypeTableEntryIdUndefLit:
         case TypeTableEntryIdNullLit:
@@ -12759,7 +13642,6 @@ static TypeTableEntry *ir_analyze_instruction_import(IrAnalyze *ira, IrInstructi
     Buf full_path = BUF_INIT;
     os_path_join(search_dir, import_target_path, &full_path);
 
-    Buf *import_code = buf_alloc();
     Buf *abs_full_path = buf_alloc();
     int err;
     if ((err = os_path_real(&full_path, abs_full_path))) {
@@ -12782,7 +13664,8 @@ static TypeTableEntry *ir_analyze_instruction_import(IrAnalyze *ira, IrInstructi
         return ira->codegen->builtin_types.entry_namespace;
     }
 
-    if ((err = os_fetch_file_path(abs_full_path, import_code))) {
+    SourceFile *source_file;
+    if ((err = source_cache_fetch(abs_full_path, &source_file))) {
         if (err == ErrorFileNotFound) {
             ir_add_error_node(ira, source_node,
                     buf_sprintf("unable to find '%s'", buf_ptr(import_target_path)));
@@ -12793,7 +13676,8 @@ static TypeTableEntry *ir_analyze_instruction_import(IrAnalyze *ira, IrInstructi
             return ira->codegen->builtin_types.entry_invalid;
         }
     }
-    ImportTableEntry *target_import = add_source_file(ira->codegen, target_package, abs_full_path, import_code);
+    ImportTableEntry *target_import = add_source_file(ira->codegen, target_package, abs_full_path,
+            source_file->contents);
 
     scan_import(ira->codegen, target_import);
 
@@ -13155,6 +14039,7 @@ static TypeTableEntry *ir_analyze_min_max(IrAnalyze *ira, IrInstruction *source_
         case TypeTableEntryIdUnreachable:
         case TypeTableEntryIdPointer:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdStruct:
         case TypeTableEntryIdNumLitFloat:
         case TypeTableEntryIdNumLitInt:
@@ -13487,6 +14372,17 @@ static TypeTableEntry *ir_analyze_instruction_c_import(IrAnalyze *ira, IrInstruc
     if (type_is_invalid(result->value.type))
         return ira->codegen->builtin_types.entry_invalid;
 
+    auto existing_entry = ira->codegen->c_import_table.maybe_get(&cimport_scope->buf);
+    if (existing_entry != nullptr) {
+        if (ira->codegen->verbose_cache) {
+            fprintf(stderr, "cimport cache shared: %s:%" ZIG_PRI_usize "\n",
+                    buf_ptr(node->owner->path), node->line + 1);
+        }
+        ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
+        out_val->data.x_import = existing_entry->value;
+        return ira->codegen->builtin_types.entry_namespace;
+    }
+
     find_libc_include_path(ira->codegen);
 
     ImportTableEntry *child_import = allocate<ImportTableEntry>(1);
@@ -13495,11 +14391,19 @@ static TypeTableEntry *ir_analyze_instruction_c_import(IrAnalyze *ira, IrInstruc
 
     ZigList<ErrorMsg *> errors = {0};
 
+    size_t time_report_event = 0;
+    if (ira->codegen->time_report != nullptr) {
+        time_report_event = time_report_begin(ira->codegen, "cimport", time_report_node_name(node));
+    }
+
     int err;
     if ((err = parse_h_buf(child_import, &errors, &cimport_scope->buf, ira->codegen, node))) {
         zig_panic("unable to parse C file: %s\n", err_str(err));
     }
 
+    if (ira->codegen->time_report != nullptr)
+        time_report_end(ira->codegen, time_report_event);
+
     if (errors.length > 0) {
         ErrorMsg *parent_err_msg = ir_add_error_node(ira, node, buf_sprintf("C import failed"));
         for (size_t i = 0; i < errors.length; i += 1) {
@@ -13517,6 +14421,7 @@ static TypeTableEntry *ir_analyze_instruction_c_import(IrAnalyze *ira, IrInstruc
     }
 
     scan_decls(ira->codegen, child_import->decls_scope, child_import->root);
+    ira->codegen->c_import_table.put(buf_create_from_buf(&cimport_scope->buf), child_import);
 
     ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
     out_val->data.x_import = child_import;
@@ -13618,8 +14523,7 @@ static TypeTableEntry *ir_analyze_instruction_embed_file(IrAnalyze *ira, IrInstr
         }
     }
 
-    // TODO add dependency on the file we embedded so that we know if it changes
-    // we'll have to invalidate the cache
+    ira->codegen->embed_file_paths.append(buf_create_from_buf(&file_path));
 
     ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
     init_const_str_lit(ira->codegen, out_val, &file_contents);
@@ -13707,6 +14611,220 @@ static TypeTableEntry *ir_analyze_instruction_cmpxchg(IrAnalyze *ira, IrInstruct
     return ira->codegen->builtin_types.entry_bool;
 }
 
+// Checks the pointer argument of @atomicRmw, @atomicLoad and @atomicStore and returns the
+// type it points to, or nullptr after reporting an error. Integers must be a power of two
+// bits wide so that the target can access them with a single instruction.
+static TypeTableEntry *ir_resolve_atomic_operand_type(IrAnalyze *ira, IrInstruction *ptr, bool allow_ptr) {
+    if (ptr->value.type->id != TypeTableEntryIdPointer) {
+        ir_add_error(ira, ptr,
+            buf_sprintf("expected pointer argument, found '%s'", buf_ptr(&ptr->value.type->name)));
+        return nullptr;
+    }
+
+    TypeTableEntry *child_type = ptr->value.type->data.pointer.child_type;
+    if (child_type->id == TypeTableEntryIdInt) {
+        uint32_t bit_count = child_type->data.integral.bit_count;
+        if (bit_count < 8 || (bit_count & (bit_count - 1)) != 0) {
+            ir_add_error(ira, ptr,
+                buf_sprintf("expected integer type 8 bits or larger and a power of 2, found '%s'",
+                    buf_ptr(&child_type->name)));
+            return nullptr;
+        }
+    } else if (!(allow_ptr && child_type->id == TypeTableEntryIdPointer)) {
+        ir_add_error(ira, ptr,
+            buf_sprintf(allow_ptr ? "expected integer or pointer type, found '%s'" : "expected integer type, found '%s'",
+                buf_ptr(&child_type->name)));
+        return nullptr;
+    }
+
+    uint32_t align_bytes = ptr->value.type->data.pointer.alignment;
+    uint64_t size_bytes = type_size(ira->codegen, child_type);
+    if (align_bytes < size_bytes) {
+        ir_add_error(ira, ptr,
+            buf_sprintf("expected pointer alignment of at least %" ZIG_PRI_u64 ", found %" PRIu32,
+                size_bytes, align_bytes));
+        return nullptr;
+    }
+
+    return child_type;
+}
+
+static TypeTableEntry *ir_analyze_instruction_atomic_rmw(IrAnalyze *ira, IrInstructionAtomicRmw *instruction) {
+    IrInstruction *ptr = instruction->ptr->other;
+    if (type_is_invalid(ptr->value.type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    IrInstruction *op_value = instruction->op_value->other;
+    AtomicRmwOp op;
+    if (!ir_resolve_atomic_rmw_op(ira, op_value, &op))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    IrInstruction *operand = instruction->operand->other;
+    if (type_is_invalid(operand->value.type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    IrInstruction *order_value = instruction->order_value->other;
+    AtomicOrder order;
+    if (!ir_resolve_atomic_order(ira, order_value, &order))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    TypeTableEntry *child_type = ir_resolve_atomic_operand_type(ira, ptr, false);
+    if (child_type == nullptr)
+        return ira->codegen->builtin_types.entry_invalid;
+
+    if (ptr->value.type->data.pointer.is_const) {
+        ir_add_error(ira, &instruction->base, buf_sprintf("cannot assign to constant"));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+
+    if (order < AtomicOrderMonotonic) {
+        ir_add_error(ira, order_value, buf_sprintf("atomic ordering must be Monotonic or stricter"));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+
+    IrInstruction *casted_operand = ir_implicit_cast(ira, operand, child_type);
+    if (type_is_invalid(casted_operand->value.type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    if (instr_is_comptime(ptr) && ptr->value.data.x_ptr.special != ConstPtrSpecialHardCodedAddr &&
+        ptr->value.data.x_ptr.mut == ConstPtrMutComptimeVar)
+    {
+        ConstExprValue *dest_val = const_ptr_pointee(ira->codegen, &ptr->value);
+        if (dest_val->special == ConstValSpecialUndef) {
+            ir_add_error(ira, &instruction->base, buf_sprintf("use of undefined value"));
+            return ira->codegen->builtin_types.entry_invalid;
+        }
+        if (dest_val->special == ConstValSpecialStatic) {
+            ConstExprValue *operand_val = ir_resolve_const(ira, casted_operand, UndefBad);
+            if (!operand_val)
+                return ira->codegen->builtin_types.entry_invalid;
+
+            ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
+            copy_const_val(out_val, dest_val, false);
+
+            ConstExprValue new_val = {};
+            switch (op) {
+                case AtomicRmwOpXchg:
+                    copy_const_val(&new_val, operand_val, false);
+                    break;
+                case AtomicRmwOpAdd:
+                case AtomicRmwOpSub:
+                case AtomicRmwOpAnd:
+                case AtomicRmwOpOr:
+                case AtomicRmwOpXor:
+                    {
+                        IrBinOp bin_op;
+                        if (op == AtomicRmwOpAdd) {
+                            bin_op = IrBinOpAddWrap;
+                        } else if (op == AtomicRmwOpSub) {
+                            bin_op = IrBinOpSubWrap;
+                        } else if (op == AtomicRmwOpAnd) {
+                            bin_op = IrBinOpBinAnd;
+                        } else if (op == AtomicRmwOpOr) {
+                            bin_op = IrBinOpBinOr;
+                        } else {
+                            bin_op = IrBinOpBinXor;
+                        }
+                        if (ir_eval_math_op(child_type, out_val, bin_op, operand_val, &new_val))
+                            zig_unreachable();
+                        break;
+                    }
+                case AtomicRmwOpMin:
+                case AtomicRmwOpMax:
+                    {
+                        Cmp cmp = bigint_cmp(&out_val->data.x_bigint, &operand_val->data.x_bigint);
+                        bool keep_old = (op == AtomicRmwOpMin) ? (cmp != CmpGT) : (cmp != CmpLT);
+                        copy_const_val(&new_val, keep_old ? out_val : operand_val, false);
+                        break;
+                    }
+            }
+            *dest_val = new_val;
+            if (!ira->new_irb.current_basic_block->must_be_comptime_source_instr) {
+                ira->new_irb.current_basic_block->must_be_comptime_source_instr = &instruction->base;
+            }
+            return child_type;
+        }
+    }
+
+    ir_build_atomic_rmw_from(&ira->new_irb, &instruction->base, ptr, op_value, casted_operand, order_value,
+        op, order);
+    return child_type;
+}
+
+static TypeTableEntry *ir_analyze_instruction_atomic_load(IrAnalyze *ira, IrInstructionAtomicLoad *instruction) {
+    IrInstruction *ptr = instruction->ptr->other;
+    if (type_is_invalid(ptr->value.type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    IrInstruction *order_value = instruction->order_value->other;
+    AtomicOrder order;
+    if (!ir_resolve_atomic_order(ira, order_value, &order))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    TypeTableEntry *child_type = ir_resolve_atomic_operand_type(ira, ptr, true);
+    if (child_type == nullptr)
+        return ira->codegen->builtin_types.entry_invalid;
+
+    if (order == AtomicOrderRelease || order == AtomicOrderAcqRel) {
+        ir_add_error(ira, order_value, buf_sprintf("@atomicLoad atomic ordering must not be Release or AcqRel"));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+
+    if (instr_is_comptime(ptr) && ptr->value.data.x_ptr.special != ConstPtrSpecialHardCodedAddr &&
+        (ptr->value.data.x_ptr.mut == ConstPtrMutComptimeVar || ptr->value.data.x_ptr.mut == ConstPtrMutComptimeConst))
+    {
+        ConstExprValue *pointee = const_ptr_pointee(ira->codegen, &ptr->value);
+        if (pointee->special != ConstValSpecialRuntime) {
+            ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
+            copy_const_val(out_val, pointee, ptr->value.data.x_ptr.mut == ConstPtrMutComptimeConst);
+            return child_type;
+        }
+    }
+
+    ir_build_atomic_load_from(&ira->new_irb, &instruction->base, ptr, order_value, order);
+    return child_type;
+}
+
+static TypeTableEntry *ir_analyze_instruction_atomic_store(IrAnalyze *ira, IrInstructionAtomicStore *instruction) {
+    IrInstruction *ptr = instruction->ptr->other;
+    if (type_is_invalid(ptr->value.type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    IrInstruction *value = instruction->value->other;
+    if (type_is_invalid(value->value.type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    IrInstruction *order_value = instruction->order_value->other;
+    AtomicOrder order;
+    if (!ir_resolve_atomic_order(ira, order_value, &order))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    TypeTableEntry *child_type = ir_resolve_atomic_operand_type(ira, ptr, true);
+    if (child_type == nullptr)
+        return ira->codegen->builtin_types.entry_invalid;
+
+    if (ptr->value.type->data.pointer.is_const) {
+        ir_add_error(ira, &instruction->base, buf_sprintf("cannot assign to constant"));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+
+    if (order == AtomicOrderAcquire || order == AtomicOrderAcqRel) {
+        ir_add_error(ira, order_value, buf_sprintf("@atomicStore atomic ordering must not be Acquire or AcqRel"));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, child_type);
+    if (type_is_invalid(casted_value->value.type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    TypeTableEntry *comptime_result = ir_analyze_comptime_store(ira, &instruction->base, ptr, casted_value);
+    if (comptime_result != nullptr)
+        return comptime_result;
+
+    ir_build_atomic_store_from(&ira->new_irb, &instruction->base, ptr, casted_value, order_value, order);
+    return ira->codegen->builtin_types.entry_void;
+}
+
 static TypeTableEntry *ir_analyze_instruction_fence(IrAnalyze *ira, IrInstructionFence *instruction) {
     IrInstruction *order_value = instruction->order_value->other;
     if (type_is_invalid(order_value->value.type))
@@ -13860,7 +14978,7 @@ static TypeTableEntry *ir_analyze_instruction_memset(IrAnalyze *ira, IrInstructi
             case ConstPtrSpecialBaseArray:
                 {
                     ConstExprValue *array_val = dest_ptr_val->data.x_ptr.data.base_array.array_val;
-                    expand_undef_array(ira->codegen, array_val);
+                    expand_const_array(ira->codegen, array_val);
                     dest_elements = array_val->data.x_array.s_none.elements;
                     start = dest_ptr_val->data.x_ptr.data.base_array.elem_index;
                     bound_end = array_val->type->data.array.len;
@@ -13956,7 +15074,7 @@ static TypeTableEntry *ir_analyze_instruction_memcpy(IrAnalyze *ira, IrInstructi
             case ConstPtrSpecialBaseArray:
                 {
                     ConstExprValue *array_val = dest_ptr_val->data.x_ptr.data.base_array.array_val;
-                    expand_undef_array(ira->codegen, array_val);
+                    expand_const_array(ira->codegen, array_val);
                     dest_elements = array_val->data.x_array.s_none.elements;
                     dest_start = dest_ptr_val->data.x_ptr.data.base_array.elem_index;
                     dest_end = array_val->type->data.array.len;
@@ -13990,7 +15108,7 @@ static TypeTableEntry *ir_analyze_instruction_memcpy(IrAnalyze *ira, IrInstructi
             case ConstPtrSpecialBaseArray:
                 {
                     ConstExprValue *array_val = src_ptr_val->data.x_ptr.data.base_array.array_val;
-                    expand_undef_array(ira->codegen, array_val);
+                    expand_const_array(ira->codegen, array_val);
                     src_elements = array_val->data.x_array.s_none.elements;
                     src_start = src_ptr_val->data.x_ptr.data.base_array.elem_index;
                     src_end = array_val->type->data.array.len;
@@ -14291,6 +15409,7 @@ static TypeTableEntry *ir_analyze_instruction_align_of(IrAnalyze *ira, IrInstruc
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdPointer:
         case TypeTableEntryIdArray:
+        case TypeTableEntryIdVector:
         case TypeTableEntryIdStruct:
         case TypeTableEntryIdMaybe:
         case TypeTableEntryIdErrorUnion:
@@ -14886,6 +16005,21 @@ static TypeTableEntry *ir_analyze_instruction_ptr_cast(IrAnalyze *ira, IrInstruc
     return result->value.type;
 }
 
+// LLVM packs the elements of a vector by their bit count, so a vector has the memory
+// layout of an array only when its elements fill the bytes they are allocated.
+static bool vector_is_array_layout(CodeGen *codegen, TypeTableEntry *vector_type) {
+    TypeTableEntry *elem_type = vector_type->data.vector.elem_type;
+    uint32_t bit_count;
+    if (elem_type->id == TypeTableEntryIdInt) {
+        bit_count = elem_type->data.integral.bit_count;
+    } else if (elem_type->id == TypeTableEntryIdFloat) {
+        bit_count = elem_type->data.floating.bit_count;
+    } else {
+        return false;
+    }
+    return type_size(codegen, elem_type) * 8 == bit_count;
+}
+
 static void buf_write_value_bytes(CodeGen *codegen, uint8_t *buf, ConstExprValue *val) {
     assert(val->special == ConstValSpecialStatic);
     switch (val->type->id) {
@@ -14926,8 +16060,22 @@ static void buf_write_value_bytes(CodeGen *codegen, uint8_t *buf, ConstExprValue
             }
         case TypeTableEntryIdArray:
             {
+                if (val->data.x_array.special == ConstArraySpecialBuf) {
+                    Buf *bytes = val->data.x_array.s_buf.bytes;
+                    memcpy(buf, buf_ptr(bytes), buf_len(bytes));
+                    return;
+                }
+                if (val->data.x_array.special == ConstArraySpecialInts) {
+                    ConstExprValue elem = {};
+                    size_t elem_size = type_size(codegen, val->type->data.array.child_type);
+                    for (size_t elem_i = 0; elem_i < val->type->data.array.len; elem_i += 1) {
+                        read_compact_array_elem(val, elem_i, &elem);
+                        buf_write_value_bytes(codegen, &buf[elem_i * elem_size], &elem);
+                    }
+                    return;
+                }
                 size_t buf_i = 0;
-                expand_undef_array(codegen, val);
+                expand_const_array(codegen, val);
                 for (size_t elem_i = 0; elem_i < val->type->data.array.len; elem_i += 1) {
                     ConstExprValue *elem = &val->data.x_array.s_none.elements[elem_i];
                     buf_write_value_bytes(codegen, &buf[buf_i], elem);
@@ -14951,6 +16099,16 @@ static void buf_write_value_bytes(CodeGen *codegen, uint8_t *buf, ConstExprValue
             zig_panic("TODO buf_write_value_bytes fn type");
         case TypeTableEntryIdUnion:
             zig_panic("TODO buf_write_value_bytes union type");
+        case TypeTableEntryIdVector:
+            {
+                assert(vector_is_array_layout(codegen, val->type));
+                TypeTableEntry *elem_type = val->type->data.vector.elem_type;
+                size_t elem_size = type_size(codegen, elem_type);
+                for (uint32_t elem_i = 0; elem_i < val->type->data.vector.len; elem_i += 1) {
+                    buf_write_value_bytes(codegen, &buf[elem_i * elem_size], &val->data.x_array.s_none.elements[elem_i]);
+                }
+            }
+            return;
     }
     zig_unreachable();
 }
@@ -15011,6 +16169,21 @@ static void buf_read_value_bytes(CodeGen *codegen, uint8_t *buf, ConstExprValue
             zig_panic("TODO buf_read_value_bytes fn type");
         case TypeTableEntryIdUnion:
             zig_panic("TODO buf_read_value_bytes union type");
+        case TypeTableEntryIdVector:
+            {
+                assert(vector_is_array_layout(codegen, val->type));
+                TypeTableEntry *elem_type = val->type->data.vector.elem_type;
+                size_t elem_size = type_size(codegen, elem_type);
+                uint32_t len = val->type->data.vector.len;
+                val->data.x_array.s_none.elements = create_const_vals(len);
+                for (uint32_t elem_i = 0; elem_i < len; elem_i += 1) {
+                    ConstExprValue *elem = &val->data.x_array.s_none.elements[elem_i];
+                    elem->special = ConstValSpecialStatic;
+                    elem->type = elem_type;
+                    buf_read_value_bytes(codegen, &buf[elem_i * elem_size], elem);
+                }
+            }
+            return;
     }
     zig_unreachable();
 }
@@ -15094,7 +16267,20 @@ static TypeTableEntry *ir_analyze_instruction_bit_cast(IrAnalyze *ira, IrInstruc
     }
 
     if (instr_is_comptime(value)) {
-        ConstExprValue *val = ir_resolve_const(ira, value, UndefBad);
+        TypeTableEntry *vector_types[] = {src_type, dest_type};
+        for (size_t i = 0; i < array_length(vector_types); i += 1) {
+            if (vector_types[i]->id == TypeTableEntryIdVector &&
+                !vector_is_array_layout(ira->codegen, vector_types[i]))
+            {
+                ir_add_error(ira, &instruction->base,
+                    buf_sprintf("unable to @bitCast '%s' at compile time: its elements are not whole bytes",
+                        buf_ptr(&vector_types[i]->name)));
+                return ira->codegen->builtin_types.entry_invalid;
+            }
+        }
+
+        ConstExprValue *val = (src_type->id == TypeTableEntryIdVector) ?
+            ir_resolve_vector_const(ira, value) : ir_resolve_const(ira, value, UndefBad);
         if (!val)
             return ira->codegen->builtin_types.entry_invalid;
 
@@ -15337,6 +16523,295 @@ static TypeTableEntry *ir_analyze_instruction_set_align_stack(IrAnalyze *ira, Ir
     return ira->codegen->builtin_types.entry_void;
 }
 
+static bool is_vector_elem_type(TypeTableEntry *type_entry) {
+    return (type_entry->id == TypeTableEntryIdInt || type_entry->id == TypeTableEntryIdFloat ||
+            type_entry->id == TypeTableEntryIdBool) && type_has_bits(type_entry);
+}
+
+static bool ir_resolve_vector_len(IrAnalyze *ira, IrInstruction *value, uint32_t *out) {
+    uint64_t len;
+    if (!ir_resolve_usize(ira, value, &len))
+        return false;
+
+    if (len == 0 || len > UINT32_MAX) {
+        ir_add_error(ira, value,
+            buf_sprintf("vector length must be between 1 and %" PRIu32 ", found %" ZIG_PRI_u64, UINT32_MAX, len));
+        return false;
+    }
+    *out = (uint32_t)len;
+    return true;
+}
+
+static TypeTableEntry *ir_analyze_instruction_vector_type(IrAnalyze *ira, IrInstructionVectorType *instruction) {
+    uint32_t len;
+    if (!ir_resolve_vector_len(ira, instruction->len->other, &len))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    IrInstruction *elem_type_value = instruction->elem_type->other;
+    TypeTableEntry *elem_type = ir_resolve_type(ira, elem_type_value);
+    if (type_is_invalid(elem_type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    if (!is_vector_elem_type(elem_type)) {
+        ir_add_error(ira, elem_type_value,
+            buf_sprintf("vector element type must be an integer, float or bool, found '%s'",
+                buf_ptr(&elem_type->name)));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+
+    ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
+    out_val->data.x_type = get_vector_type(ira->codegen, elem_type, len);
+    return ira->codegen->builtin_types.entry_type;
+}
+
+static TypeTableEntry *ir_analyze_instruction_splat(IrAnalyze *ira, IrInstructionSplat *instruction) {
+    IrInstruction *len_value = instruction->len->other;
+    uint32_t len;
+    if (!ir_resolve_vector_len(ira, len_value, &len))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    IrInstruction *scalar = instruction->scalar->other;
+    TypeTableEntry *elem_type = scalar->value.type;
+    if (type_is_invalid(elem_type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    if (!is_vector_elem_type(elem_type)) {
+        ir_add_error(ira, scalar,
+            buf_sprintf("expected integer, float or bool, found '%s'", buf_ptr(&elem_type->name)));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+
+    TypeTableEntry *vector_type = get_vector_type(ira->codegen, elem_type, len);
+
+    if (instr_is_comptime(scalar)) {
+        ConstExprValue *scalar_val = ir_resolve_const(ira, scalar, UndefOk);
+        if (!scalar_val)
+            return ira->codegen->builtin_types.entry_invalid;
+
+        ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
+        if (scalar_val->special == ConstValSpecialUndef) {
+            out_val->special = ConstValSpecialUndef;
+            return vector_type;
+        }
+        out_val->data.x_array.s_none.elements = create_const_vals(len);
+        for (uint32_t i = 0; i < len; i += 1) {
+            copy_const_val(&out_val->data.x_array.s_none.elements[i], scalar_val, false);
+        }
+        return vector_type;
+    }
+
+    ir_build_splat_from(&ira->new_irb, &instruction->base, len_value, scalar);
+    return vector_type;
+}
+
+static TypeTableEntry *ir_analyze_instruction_shuffle(IrAnalyze *ira, IrInstructionShuffle *instruction) {
+    IrInstruction *a = instruction->a->other;
+    TypeTableEntry *vector_type = a->value.type;
+    if (type_is_invalid(vector_type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    if (vector_type->id != TypeTableEntryIdVector) {
+        ir_add_error(ira, a, buf_sprintf("expected vector, found '%s'", buf_ptr(&vector_type->name)));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+    TypeTableEntry *elem_type = vector_type->data.vector.elem_type;
+    uint32_t in_len = vector_type->data.vector.len;
+
+    IrInstruction *b = ir_implicit_cast(ira, instruction->b->other, vector_type);
+    if (type_is_invalid(b->value.type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    IrInstruction *mask = instruction->mask->other;
+    TypeTableEntry *mask_type = mask->value.type;
+    if (type_is_invalid(mask_type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    uint32_t mask_len;
+    if (mask_type->id == TypeTableEntryIdArray &&
+        mask_type->data.array.child_type->id == TypeTableEntryIdInt &&
+        mask_type->data.array.len != 0 && mask_type->data.array.len <= UINT32_MAX)
+    {
+        mask_len = (uint32_t)mask_type->data.array.len;
+    } else if (mask_type->id == TypeTableEntryIdVector &&
+        mask_type->data.vector.elem_type->id == TypeTableEntryIdInt)
+    {
+        mask_len = mask_type->data.vector.len;
+    } else {
+        ir_add_error(ira, mask,
+            buf_sprintf("expected array of integers for shuffle mask, found '%s'", buf_ptr(&mask_type->name)));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+
+    ConstExprValue *mask_val = ir_resolve_const(ira, mask, UndefBad);
+    if (!mask_val)
+        return ira->codegen->builtin_types.entry_invalid;
+    if (mask_type->id == TypeTableEntryIdArray)
+        expand_const_array(ira->codegen, mask_val);
+
+    uint32_t *mask_indices = allocate<uint32_t>(mask_len);
+    for (uint32_t i = 0; i < mask_len; i += 1) {
+        ConstExprValue *mask_elem = &mask_val->data.x_array.s_none.elements[i];
+        if (mask_elem->special == ConstValSpecialUndef) {
+            ir_add_error(ira, mask, buf_sprintf("shuffle mask index %" PRIu32 " is undefined", i));
+            return ira->codegen->builtin_types.entry_invalid;
+        }
+        BigInt *index_bigint = &mask_elem->data.x_bigint;
+        if (bigint_cmp_zero(index_bigint) == CmpLT || !bigint_fits_in_bits(index_bigint, 64, false) ||
+            bigint_as_unsigned(index_bigint) >= 2 * (uint64_t)in_len)
+        {
+            ir_add_error(ira, mask,
+                buf_sprintf("shuffle mask index %" PRIu32 " out of bounds: the operands have %" ZIG_PRI_u64 " elements",
+                    i, 2 * (uint64_t)in_len));
+            return ira->codegen->builtin_types.entry_invalid;
+        }
+        mask_indices[i] = (uint32_t)bigint_as_unsigned(index_bigint);
+    }
+
+    TypeTableEntry *result_type = get_vector_type(ira->codegen, elem_type, mask_len);
+
+    if (instr_is_comptime(a) && instr_is_comptime(b)) {
+        ConstExprValue *a_val = ir_resolve_const(ira, a, UndefOk);
+        if (!a_val)
+            return ira->codegen->builtin_types.entry_invalid;
+        ConstExprValue *b_val = ir_resolve_const(ira, b, UndefOk);
+        if (!b_val)
+            return ira->codegen->builtin_types.entry_invalid;
+
+        ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
+        out_val->data.x_array.s_none.elements = create_const_vals(mask_len);
+        for (uint32_t i = 0; i < mask_len; i += 1) {
+            ConstExprValue *out_elem = &out_val->data.x_array.s_none.elements[i];
+            uint32_t index = mask_indices[i];
+            ConstExprValue *src_val = (index < in_len) ? a_val : b_val;
+            if (src_val->special == ConstValSpecialUndef) {
+                out_elem->special = ConstValSpecialUndef;
+                out_elem->type = elem_type;
+            } else {
+                copy_const_val(out_elem, &src_val->data.x_array.s_none.elements[index % in_len], false);
+            }
+        }
+        return result_type;
+    }
+
+    ir_build_shuffle_from(&ira->new_irb, &instruction->base, a, b, mask, mask_indices);
+    return result_type;
+}
+
+static bool reduce_op_allowed(ReduceOp op, TypeTableEntry *elem_type) {
+    if (elem_type->id == TypeTableEntryIdInt) {
+        return true;
+    } else if (elem_type->id == TypeTableEntryIdFloat) {
+        return op == ReduceOpAdd || op == ReduceOpMul || op == ReduceOpMin || op == ReduceOpMax;
+    } else if (elem_type->id == TypeTableEntryIdBool) {
+        return op == ReduceOpAnd || op == ReduceOpOr || op == ReduceOpXor;
+    } else {
+        zig_unreachable();
+    }
+}
+
+// Folds one more element into a reduction at compile time. Integer Add and Mul wrap, like
+// the other vector integer arithmetic.
+static void ir_eval_reduce_op(ReduceOp op, TypeTableEntry *elem_type, ConstExprValue *op1_val,
+        ConstExprValue *op2_val, ConstExprValue *out_val)
+{
+    bool is_int = (elem_type->id == TypeTableEntryIdInt);
+    if (elem_type->id == TypeTableEntryIdBool) {
+        out_val->special = ConstValSpecialStatic;
+        out_val->type = elem_type;
+        switch (op) {
+            case ReduceOpAnd:
+                out_val->data.x_bool = op1_val->data.x_bool && op2_val->data.x_bool;
+                return;
+            case ReduceOpOr:
+                out_val->data.x_bool = op1_val->data.x_bool || op2_val->data.x_bool;
+                return;
+            case ReduceOpXor:
+                out_val->data.x_bool = op1_val->data.x_bool != op2_val->data.x_bool;
+                return;
+            case ReduceOpAdd:
+            case ReduceOpMul:
+            case ReduceOpMin:
+            case ReduceOpMax:
+                zig_unreachable();
+        }
+    }
+
+    IrBinOp bin_op;
+    switch (op) {
+        case ReduceOpAdd:
+            bin_op = is_int ? IrBinOpAddWrap : IrBinOpAdd;
+            break;
+        case ReduceOpMul:
+            bin_op = is_int ? IrBinOpMultWrap : IrBinOpMult;
+            break;
+        case ReduceOpAnd:
+            bin_op = IrBinOpBinAnd;
+            break;
+        case ReduceOpOr:
+            bin_op = IrBinOpBinOr;
+            break;
+        case ReduceOpXor:
+            bin_op = IrBinOpBinXor;
+            break;
+        case ReduceOpMin:
+        case ReduceOpMax:
+            {
+                Cmp cmp = is_int ? bigint_cmp(&op1_val->data.x_bigint, &op2_val->data.x_bigint) :
+                    float_cmp(op1_val, op2_val);
+                bool pick_op1 = (op == ReduceOpMin) ? (cmp != CmpGT) : (cmp != CmpLT);
+                copy_const_val(out_val, pick_op1 ? op1_val : op2_val, false);
+                return;
+            }
+    }
+    if (ir_eval_math_op(elem_type, op1_val, bin_op, op2_val, out_val))
+        zig_unreachable();
+}
+
+static TypeTableEntry *ir_analyze_instruction_reduce(IrAnalyze *ira, IrInstructionReduce *instruction) {
+    IrInstruction *op_value = instruction->op_value->other;
+    ReduceOp op;
+    if (!ir_resolve_reduce_op(ira, op_value, &op))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    IrInstruction *value = instruction->value->other;
+    TypeTableEntry *vector_type = value->value.type;
+    if (type_is_invalid(vector_type))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    if (vector_type->id != TypeTableEntryIdVector) {
+        ir_add_error(ira, value, buf_sprintf("expected vector, found '%s'", buf_ptr(&vector_type->name)));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+    TypeTableEntry *elem_type = vector_type->data.vector.elem_type;
+
+    if (!reduce_op_allowed(op, elem_type)) {
+        ir_add_error(ira, op_value,
+            buf_sprintf("invalid reduction for type '%s'", buf_ptr(&vector_type->name)));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+
+    if (instr_is_comptime(value)) {
+        ConstExprValue *vector_val = ir_resolve_vector_const(ira, value);
+        if (!vector_val)
+            return ira->codegen->builtin_types.entry_invalid;
+
+        ConstExprValue *elements = vector_val->data.x_array.s_none.elements;
+        ConstExprValue result = elements[0];
+        for (uint32_t i = 1; i < vector_type->data.vector.len; i += 1) {
+            ConstExprValue next = {};
+            ir_eval_reduce_op(op, elem_type, &result, &elements[i], &next);
+            result = next;
+        }
+
+        ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
+        copy_const_val(out_val, &result, false);
+        return elem_type;
+    }
+
+    ir_build_reduce_from(&ira->new_irb, &instruction->base, op_value, value, op);
+    return elem_type;
+}
+
 static TypeTableEntry *ir_analyze_instruction_nocast(IrAnalyze *ira, IrInstruction *instruction) {
     switch (instruction->id) {
         case IrInstructionIdInvalid:
@@ -15527,6 +17002,20 @@ static TypeTableEntry *ir_analyze_instruction_nocast(IrAnalyze *ira, IrInstructi
             return ir_analyze_instruction_opaque_type(ira, (IrInstructionOpaqueType *)instruction);
         case IrInstructionIdSetAlignStack:
             return ir_analyze_instruction_set_align_stack(ira, (IrInstructionSetAlignStack *)instruction);
+        case IrInstructionIdVectorType:
+            return ir_analyze_instruction_vector_type(ira, (IrInstructionVectorType *)instruction);
+        case IrInstructionIdSplat:
+            return ir_analyze_instruction_splat(ira, (IrInstructionSplat *)instruction);
+        case IrInstructionIdShuffle:
+            return ir_analyze_instruction_shuffle(ira, (IrInstructionShuffle *)instruction);
+        case IrInstructionIdReduce:
+            return ir_analyze_instruction_reduce(ira, (IrInstructionReduce *)instruction);
+        case IrInstructionIdAtomicRmw:
+            return ir_analyze_instruction_atomic_rmw(ira, (IrInstructionAtomicRmw *)instruction);
+        case IrInstructionIdAtomicLoad:
+            return ir_analyze_instruction_atomic_load(ira, (IrInstructionAtomicLoad *)instruction);
+        case IrInstructionIdAtomicStore:
+            return ir_analyze_instruction_atomic_store(ira, (IrInstructionAtomicStore *)instruction);
     }
     zig_unreachable();
 }
@@ -15550,6 +17039,7 @@ static TypeTableEntry *ir_analyze_instruction(IrAnalyze *ira, IrInstruction *ins
 TypeTableEntry *ir_analyze(CodeGen *codegen, IrExecutable *old_exec, IrExecutable *new_exec,
         TypeTableEntry *expected_type, AstNode *expected_type_source_node)
 {
+    assert(!codegen->ir_released);
     assert(!old_exec->invalid);
     assert(expected_type == nullptr || !type_is_invalid(expected_type));
 
@@ -15628,6 +17118,9 @@ bool ir_has_side_effects(IrInstruction *instruction) {
         case IrInstructionIdCUndef:
         case IrInstructionIdCmpxchg:
         case IrInstructionIdFence:
+        case IrInstructionIdAtomicRmw:
+        case IrInstructionIdAtomicLoad:
+        case IrInstructionIdAtomicStore:
         case IrInstructionIdMemset:
         case IrInstructionIdMemcpy:
         case IrInstructionIdBreakpoint:
@@ -15707,6 +17200,10 @@ bool ir_has_side_effects(IrInstruction *instruction) {
         case IrInstructionIdTypeId:
         case IrInstructionIdAlignCast:
         case IrInstructionIdOpaqueType:
+        case IrInstructionIdVectorType:
+        case IrInstructionIdSplat:
+        case IrInstructionIdShuffle:
+        case IrInstructionIdReduce:
             return false;
         case IrInstructionIdAsm:
             {
@@ -15722,3 +17219,501 @@ bool ir_has_side_effects(IrInstruction *instruction) {
     }
     zig_unreachable();
 }
+
+// The redundant safety check pass works on facts of the form "value < bound". The value is
+// the current value of an integer variable, or the result of a load instruction. The bound is
+// a compile time known integer, or the current length of a slice variable. Only the local
+// variables of the function which are never accessed through a pointer other than their own,
+// nor through a volatile one, take part, so that the loads and stores of the function are all
+// the ways they can change.
+struct IrSafetyFact {
+    VariableTableEntry *var;
+    IrInstruction *load;
+    VariableTableEntry *slice_var;
+    // when not set, the bound is the length of slice_var
+    bool has_limit;
+    BigInt limit;
+};
+
+// A load whose result is still the value of var, or the length of var when is_len is set.
+struct IrSafetyLoad {
+    IrInstruction *load;
+    VariableTableEntry *var;
+    bool is_len;
+};
+
+struct IrSafetyState {
+    ZigList<IrSafetyFact> facts;
+    ZigList<IrSafetyLoad> loads;
+};
+
+struct IrSafetyBlock {
+    bool reached;
+    bool queued;
+    // only facts about variables flow from one block to another
+    ZigList<IrSafetyFact> in_facts;
+};
+
+static uint32_t ir_safety_bb_hash(IrBasicBlock *bb) {
+    return ptr_hash(bb);
+}
+
+static bool ir_safety_bb_eql(IrBasicBlock *a, IrBasicBlock *b) {
+    return a == b;
+}
+
+static uint32_t ir_safety_var_hash(VariableTableEntry *var) {
+    return ptr_hash(var);
+}
+
+static bool ir_safety_var_eql(VariableTableEntry *a, VariableTableEntry *b) {
+    return a == b;
+}
+
+struct IrSafetyPass {
+    CodeGen *codegen;
+    FnTableEntry *fn_entry;
+    HashMap<IrBasicBlock *, size_t, ir_safety_bb_hash, ir_safety_bb_eql> block_index;
+    HashMap<VariableTableEntry *, bool, ir_safety_var_hash, ir_safety_var_eql> escaped_vars;
+    IrSafetyBlock *blocks;
+    ZigList<size_t> worklist;
+};
+
+static bool ir_safety_is_slice(TypeTableEntry *type_entry) {
+    return type_entry->id == TypeTableEntryIdStruct && type_entry->data.structure.is_slice;
+}
+
+// Whether use, which has var_ptr as an operand, keeps the variable from escaping.
+static bool ir_safety_var_ptr_use_ok(IrInstruction *use, IrInstruction *var_ptr) {
+    switch (use->id) {
+        case IrInstructionIdLoadPtr:
+            return true;
+        case IrInstructionIdStorePtr:
+            return ((IrInstructionStorePtr *)use)->value != var_ptr;
+        case IrInstructionIdStructFieldPtr:
+        case IrInstructionIdElemPtr:
+        case IrInstructionIdSlice:
+            {
+                // these read the fields of a slice, or point into the memory it refers to
+                TypeTableEntry *child_type = var_ptr->value.type->data.pointer.child_type;
+                if (!ir_safety_is_slice(child_type))
+                    return false;
+                if (use->id == IrInstructionIdElemPtr)
+                    return ((IrInstructionElemPtr *)use)->array_ptr == var_ptr;
+                if (use->id == IrInstructionIdSlice)
+                    return ((IrInstructionSlice *)use)->ptr == var_ptr;
+                return true;
+            }
+        default:
+            return false;
+    }
+}
+
+static void ir_safety_find_escaped_vars(IrSafetyPass *pass, IrExecutable *executable) {
+    for (size_t bb_i = 0; bb_i < executable->basic_block_list.length; bb_i += 1) {
+        IrBasicBlock *bb = executable->basic_block_list.at(bb_i);
+        for (size_t instr_i = 0; instr_i < bb->instruction_list.length; instr_i += 1) {
+            IrInstruction *instruction = bb->instruction_list.at(instr_i);
+            for (size_t dep_i = 0; ; dep_i += 1) {
+                IrInstruction *dep = ir_instruction_get_dep(instruction, dep_i);
+                if (dep == nullptr)
+                    break;
+                if (dep->id == IrInstructionIdVarPtr) {
+                    if (!ir_safety_var_ptr_use_ok(instruction, dep))
+                        pass->escaped_vars.put(((IrInstructionVarPtr *)dep)->var, true);
+                } else if (dep->id == IrInstructionIdStructFieldPtr) {
+                    IrInstruction *struct_ptr = ((IrInstructionStructFieldPtr *)dep)->struct_ptr;
+                    if (struct_ptr->id != IrInstructionIdVarPtr)
+                        continue;
+                    bool ok = instruction->id == IrInstructionIdLoadPtr ||
+                        (instruction->id == IrInstructionIdStorePtr &&
+                         ((IrInstructionStorePtr *)instruction)->value != dep);
+                    if (!ok)
+                        pass->escaped_vars.put(((IrInstructionVarPtr *)struct_ptr)->var, true);
+                }
+            }
+        }
+    }
+}
+
+// Returns the variable ptr points to if the pass keeps track of it.
+static VariableTableEntry *ir_safety_tracked_var(IrSafetyPass *pass, IrInstruction *ptr) {
+    if (ptr->id != IrInstructionIdVarPtr)
+        return nullptr;
+    if (ptr->value.type->data.pointer.is_volatile)
+        return nullptr;
+    VariableTableEntry *var = ((IrInstructionVarPtr *)ptr)->var;
+    // a global, or a variable of an enclosing function, can change in a call
+    if (scope_fn_entry(var->parent_scope) != pass->fn_entry)
+        return nullptr;
+    TypeTableEntry *var_type = var->value->type;
+    if (var_type->id != TypeTableEntryIdInt && !ir_safety_is_slice(var_type))
+        return nullptr;
+    if (pass->escaped_vars.maybe_get(var) != nullptr)
+        return nullptr;
+    return var;
+}
+
+// Returns the variable a store through ptr changes, if it is one of the variables the pass
+// can keep track of.
+static VariableTableEntry *ir_safety_stored_var(IrInstruction *ptr) {
+    if (ptr->id == IrInstructionIdStructFieldPtr)
+        ptr = ((IrInstructionStructFieldPtr *)ptr)->struct_ptr;
+    if (ptr->id != IrInstructionIdVarPtr)
+        return nullptr;
+    return ((IrInstructionVarPtr *)ptr)->var;
+}
+
+static bool ir_safety_fact_eql(const IrSafetyFact *a, const IrSafetyFact *b) {
+    if (a->var != b->var || a->load != b->load || a->slice_var != b->slice_var || a->has_limit != b->has_limit)
+        return false;
+    return !a->has_limit || bigint_cmp(&a->limit, &b->limit) == CmpEQ;
+}
+
+static bool ir_safety_has_fact(ZigList<IrSafetyFact> *facts, const IrSafetyFact *fact) {
+    for (size_t i = 0; i < facts->length; i += 1) {
+        if (ir_safety_fact_eql(&facts->at(i), fact))
+            return true;
+    }
+    return false;
+}
+
+static void ir_safety_add_fact(ZigList<IrSafetyFact> *facts, IrSafetyFact fact) {
+    if (!ir_safety_has_fact(facts, &fact))
+        facts->append(fact);
+}
+
+static void ir_safety_kill_var(IrSafetyState *state, VariableTableEntry *var) {
+    size_t fact_count = 0;
+    for (size_t i = 0; i < state->facts.length; i += 1) {
+        IrSafetyFact *fact = &state->facts.at(i);
+        if (fact->var != var && fact->slice_var != var)
+            state->facts.at(fact_count++) = *fact;
+    }
+    state->facts.resize(fact_count);
+
+    size_t load_count = 0;
+    for (size_t i = 0; i < state->loads.length; i += 1) {
+        IrSafetyLoad *load = &state->loads.at(i);
+        if (load->var != var)
+            state->loads.at(load_count++) = *load;
+    }
+    state->loads.resize(load_count);
+}
+
+static IrSafetyLoad *ir_safety_find_load(IrSafetyState *state, IrInstruction *instruction, bool is_len) {
+    for (size_t i = 0; i < state->loads.length; i += 1) {
+        IrSafetyLoad *load = &state->loads.at(i);
+        if (load->load == instruction && load->is_len == is_len)
+            return load;
+    }
+    return nullptr;
+}
+
+// Whether value is known to be less than the length of slice_var, or no more than limit.
+static bool ir_safety_is_below(IrSafetyState *state, IrInstruction *value, VariableTableEntry *slice_var,
+        BigInt *limit)
+{
+    for (size_t i = 0; i < state->facts.length; i += 1) {
+        IrSafetyFact *fact = &state->facts.at(i);
+        if (fact->load != value)
+            continue;
+        if (slice_var != nullptr && fact->slice_var == slice_var)
+            return true;
+        if (limit != nullptr && fact->has_limit && bigint_cmp(&fact->limit, limit) != CmpGT)
+            return true;
+    }
+    return false;
+}
+
+// Whether adding addend to value, which the facts bound from above, can not overflow.
+static bool ir_safety_add_is_safe(IrSafetyPass *pass, IrSafetyState *state, TypeTableEntry *type_entry,
+        IrInstruction *value, BigInt *addend)
+{
+    if (bigint_cmp_zero(addend) == CmpLT)
+        return false;
+
+    BigInt max_value;
+    eval_min_max_value_int(pass->codegen, type_entry, &max_value, true);
+    for (size_t i = 0; i < state->facts.length; i += 1) {
+        IrSafetyFact *fact = &state->facts.at(i);
+        if (fact->load != value)
+            continue;
+        if (fact->slice_var != nullptr) {
+            // a slice is never longer than the largest usize
+            BigInt one;
+            bigint_init_unsigned(&one, 1);
+            if (type_entry == pass->codegen->builtin_types.entry_usize && bigint_cmp(addend, &one) != CmpGT)
+                return true;
+        } else {
+            // value + addend <= limit - 1 + addend
+            BigInt sum;
+            bigint_add(&sum, &fact->limit, addend);
+            BigInt one;
+            bigint_init_unsigned(&one, 1);
+            BigInt largest_sum;
+            bigint_sub(&largest_sum, &sum, &one);
+            if (bigint_cmp(&largest_sum, &max_value) != CmpGT)
+                return true;
+        }
+    }
+    return false;
+}
+
+// Returns the fact a conditional branch on cond proves for its then block.
+static bool ir_safety_cond_fact(IrSafetyState *state, IrInstruction *cond, IrSafetyFact *out_fact) {
+    if (cond->id != IrInstructionIdBinOp)
+        return false;
+    IrInstructionBinOp *bin_op = (IrInstructionBinOp *)cond;
+    IrInstruction *value;
+    IrInstruction *bound;
+    if (bin_op->op_id == IrBinOpCmpLessThan) {
+        value = bin_op->op1;
+        bound = bin_op->op2;
+    } else if (bin_op->op_id == IrBinOpCmpGreaterThan) {
+        value = bin_op->op2;
+        bound = bin_op->op1;
+    } else {
+        return false;
+    }
+
+    IrSafetyLoad *value_load = ir_safety_find_load(state, value, false);
+    if (value_load == nullptr)
+        return false;
+
+    out_fact->var = value_load->var;
+    out_fact->load = nullptr;
+    if (bound->value.special == ConstValSpecialStatic && bound->value.type->id == TypeTableEntryIdInt) {
+        out_fact->slice_var = nullptr;
+        out_fact->has_limit = true;
+        out_fact->limit = bound->value.data.x_bigint;
+        return true;
+    }
+    IrSafetyLoad *len_load = ir_safety_find_load(state, bound, true);
+    if (len_load == nullptr)
+        return false;
+    out_fact->slice_var = len_load->var;
+    out_fact->has_limit = false;
+    return true;
+}
+
+// Updates state with the instructions of bb. When apply is set, the safety checks which
+// state proves redundant are turned off.
+static void ir_safety_walk_block(IrSafetyPass *pass, IrBasicBlock *bb, IrSafetyState *state, bool apply) {
+    for (size_t instr_i = 0; instr_i < bb->instruction_list.length; instr_i += 1) {
+        IrInstruction *instruction = bb->instruction_list.at(instr_i);
+        switch (instruction->id) {
+            case IrInstructionIdDeclVar:
+                ir_safety_kill_var(state, ((IrInstructionDeclVar *)instruction)->var);
+                break;
+            case IrInstructionIdStorePtr:
+                {
+                    VariableTableEntry *var = ir_safety_stored_var(((IrInstructionStorePtr *)instruction)->ptr);
+                    if (var != nullptr)
+                        ir_safety_kill_var(state, var);
+                    break;
+                }
+            case IrInstructionIdAsm:
+                // outputs are stored directly into variables
+                state->facts.resize(0);
+                state->loads.resize(0);
+                break;
+            case IrInstructionIdLoadPtr:
+                {
+                    IrInstruction *ptr = ((IrInstructionLoadPtr *)instruction)->ptr;
+                    VariableTableEntry *var = ir_safety_tracked_var(pass, ptr);
+                    if (var != nullptr) {
+                        state->loads.append({instruction, var, false});
+                        size_t fact_count = state->facts.length;
+                        for (size_t i = 0; i < fact_count; i += 1) {
+                            IrSafetyFact fact = state->facts.at(i);
+                            if (fact.var == var) {
+                                fact.var = nullptr;
+                                fact.load = instruction;
+                                ir_safety_add_fact(&state->facts, fact);
+                            }
+                        }
+                    } else if (ptr->id == IrInstructionIdStructFieldPtr) {
+                        IrInstructionStructFieldPtr *field_ptr = (IrInstructionStructFieldPtr *)ptr;
+                        VariableTableEntry *slice_var = ir_safety_tracked_var(pass, field_ptr->struct_ptr);
+                        if (slice_var != nullptr && ir_safety_is_slice(slice_var->value->type) &&
+                            field_ptr->field->src_index == slice_len_index)
+                        {
+                            state->loads.append({instruction, slice_var, true});
+                        }
+                    }
+                    break;
+                }
+            case IrInstructionIdElemPtr:
+                {
+                    IrInstructionElemPtr *elem_ptr = (IrInstructionElemPtr *)instruction;
+                    if (!elem_ptr->safety_check_on)
+                        break;
+                    TypeTableEntry *array_type = elem_ptr->array_ptr->value.type->data.pointer.child_type;
+                    IrSafetyFact fact = {};
+                    if (array_type->id == TypeTableEntryIdArray) {
+                        fact.has_limit = true;
+                        bigint_init_unsigned(&fact.limit, array_type->data.array.len);
+                    } else if (ir_safety_is_slice(array_type)) {
+                        fact.slice_var = ir_safety_tracked_var(pass, elem_ptr->array_ptr);
+                    }
+                    if (fact.slice_var == nullptr && !fact.has_limit)
+                        break;
+
+                    IrInstruction *index = elem_ptr->elem_index;
+                    if (apply && ir_safety_is_below(state, index, fact.slice_var,
+                        fact.has_limit ? &fact.limit : nullptr))
+                    {
+                        elem_ptr->safety_check_on = false;
+                    }
+
+                    // past the check the index is known to be in bounds
+                    fact.load = index;
+                    ir_safety_add_fact(&state->facts, fact);
+                    IrSafetyLoad *index_load = ir_safety_find_load(state, index, false);
+                    if (index_load != nullptr) {
+                        fact.var = index_load->var;
+                        fact.load = nullptr;
+                        ir_safety_add_fact(&state->facts, fact);
+                    }
+                    break;
+                }
+            case IrInstructionIdBinOp:
+                {
+                    IrInstructionBinOp *bin_op = (IrInstructionBinOp *)instruction;
+                    TypeTableEntry *type_entry = bin_op->base.value.type;
+                    if (!apply || !bin_op->safety_check_on || bin_op->op_id != IrBinOpAdd ||
+                        type_entry->id != TypeTableEntryIdInt)
+                    {
+                        break;
+                    }
+                    IrInstruction *value = bin_op->op1;
+                    IrInstruction *addend = bin_op->op2;
+                    if (addend->value.special != ConstValSpecialStatic) {
+                        value = bin_op->op2;
+                        addend = bin_op->op1;
+                    }
+                    if (addend->value.special != ConstValSpecialStatic)
+                        break;
+                    if (ir_safety_add_is_safe(pass, state, type_entry, value, &addend->value.data.x_bigint))
+                        bin_op->safety_check_on = false;
+                    break;
+                }
+            default:
+                break;
+        }
+    }
+}
+
+static void ir_safety_flow(IrSafetyPass *pass, IrBasicBlock *dest, IrSafetyState *state, IrSafetyFact *edge_fact) {
+    size_t index = pass->block_index.get(dest);
+    IrSafetyBlock *block = &pass->blocks[index];
+    if (!block->reached) {
+        block->reached = true;
+        for (size_t i = 0; i < state->facts.length; i += 1) {
+            IrSafetyFact *fact = &state->facts.at(i);
+            if (fact->var != nullptr)
+                ir_safety_add_fact(&block->in_facts, *fact);
+        }
+        if (edge_fact != nullptr)
+            ir_safety_add_fact(&block->in_facts, *edge_fact);
+    } else {
+        // only what holds on every way into the block holds in it
+        size_t fact_count = 0;
+        for (size_t i = 0; i < block->in_facts.length; i += 1) {
+            IrSafetyFact *fact = &block->in_facts.at(i);
+            if (ir_safety_has_fact(&state->facts, fact) || (edge_fact != nullptr && ir_safety_fact_eql(edge_fact, fact)))
+                block->in_facts.at(fact_count++) = *fact;
+        }
+        if (fact_count == block->in_facts.length)
+            return;
+        block->in_facts.resize(fact_count);
+    }
+    if (!block->queued) {
+        block->queued = true;
+        pass->worklist.append(index);
+    }
+}
+
+static void ir_safety_init_state(IrSafetyState *state, IrSafetyBlock *block) {
+    state->facts.resize(0);
+    state->loads.resize(0);
+    for (size_t i = 0; i < block->in_facts.length; i += 1) {
+        state->facts.append(block->in_facts.at(i));
+    }
+}
+
+void ir_elide_safety_checks(CodeGen *g, IrExecutable *executable) {
+    size_t block_count = executable->basic_block_list.length;
+    if (block_count == 0)
+        return;
+
+    IrSafetyPass pass = {};
+    pass.codegen = g;
+    pass.fn_entry = executable->fn_entry;
+    pass.block_index.init(block_count);
+    pass.escaped_vars.init(16);
+    pass.blocks = allocate<IrSafetyBlock>(block_count);
+    for (size_t i = 0; i < block_count; i += 1) {
+        pass.block_index.put(executable->basic_block_list.at(i), i);
+    }
+    ir_safety_find_escaped_vars(&pass, executable);
+
+    IrSafetyState state = {};
+    pass.blocks[0].reached = true;
+    pass.blocks[0].queued = true;
+    pass.worklist.append(0);
+    while (pass.worklist.length != 0) {
+        size_t index = pass.worklist.pop();
+        IrSafetyBlock *block = &pass.blocks[index];
+        block->queued = false;
+        IrBasicBlock *bb = executable->basic_block_list.at(index);
+
+        ir_safety_init_state(&state, block);
+        ir_safety_walk_block(&pass, bb, &state, false);
+
+        IrInstruction *terminator = bb->instruction_list.last();
+        switch (terminator->id) {
+            case IrInstructionIdBr:
+                ir_safety_flow(&pass, ((IrInstructionBr *)terminator)->dest_block, &state, nullptr);
+                break;
+            case IrInstructionIdCondBr:
+                {
+                    IrInstructionCondBr *cond_br = (IrInstructionCondBr *)terminator;
+                    IrSafetyFact then_fact = {};
+                    bool has_then_fact = ir_safety_cond_fact(&state, cond_br->condition, &then_fact);
+                    ir_safety_flow(&pass, cond_br->then_block, &state, has_then_fact ? &then_fact : nullptr);
+                    ir_safety_flow(&pass, cond_br->else_block, &state, nullptr);
+                    break;
+                }
+            case IrInstructionIdSwitchBr:
+                {
+                    IrInstructionSwitchBr *switch_br = (IrInstructionSwitchBr *)terminator;
+                    for (size_t i = 0; i < switch_br->case_count; i += 1) {
+                        ir_safety_flow(&pass, switch_br->cases[i].block, &state, nullptr);
+                    }
+                    ir_safety_flow(&pass, switch_br->else_block, &state, nullptr);
+                    break;
+                }
+            default:
+                break;
+        }
+    }
+
+    for (size_t i = 0; i < block_count; i += 1) {
+        if (!pass.blocks[i].reached)
+            continue;
+        ir_safety_init_state(&state, &pass.blocks[i]);
+        ir_safety_walk_block(&pass, executable->basic_block_list.at(i), &state, true);
+    }
+
+    state.facts.deinit();
+    state.loads.deinit();
+    for (size_t i = 0; i < block_count; i += 1) {
+        pass.blocks[i].in_facts.deinit();
+    }
+    free(pass.blocks);
+    pass.worklist.deinit();
+    pass.block_index.deinit();
+    pass.escaped_vars.deinit();
+}
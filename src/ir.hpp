@@ -13,6 +13,21 @@
 bool ir_gen(CodeGen *g, AstNode *node, Scope *scope, IrExecutable *ir_executable);
 bool ir_gen_fn(CodeGen *g, FnTableEntry *fn_entry);
 
+// A thread which generates function bodies at the same time as other threads.
+struct IrGenWorker {
+    // the IR of the bodies is allocated here instead of in the CodeGen's ir_arena
+    Arena arena;
+    // and their values here instead of in the CodeGen's analysis_arena
+    Arena analysis_arena;
+    // set when a body declares a container type, which only the main thread can do
+    bool needs_main_thread;
+};
+
+// Like ir_gen_fn, but safe to run on several threads while the main thread waits.
+// When worker->needs_main_thread is set afterwards the body has to be generated
+// again with ir_gen_fn, starting from the IrExecutable it had before this call.
+bool ir_gen_fn_on_worker(CodeGen *g, FnTableEntry *fn_entry, IrGenWorker *worker);
+
 IrInstruction *ir_eval_const_value(CodeGen *codegen, Scope *scope, AstNode *node,
         TypeTableEntry *expected_type, size_t *backward_branch_count, size_t backward_branch_quota,
         FnTableEntry *fn_entry, Buf *c_import_buf, AstNode *source_node, Buf *exec_name,
@@ -22,6 +37,10 @@ TypeTableEntry *ir_analyze(CodeGen *g, IrExecutable *old_executable, IrExecutabl
         TypeTableEntry *expected_type, AstNode *expected_type_source_node);
 
 bool ir_has_side_effects(IrInstruction *instruction);
+
+// Turns off the bounds and overflow checks of an analyzed function body which its loop
+// conditions and earlier checks already prove can not fail.
+void ir_elide_safety_checks(CodeGen *g, IrExecutable *executable);
 ConstExprValue *const_ptr_pointee(CodeGen *codegen, ConstExprValue *const_val);
 
 #endif
@@ -954,6 +954,70 @@ static void ir_print_set_align_stack(IrPrint *irp, IrInstructionSetAlignStack *i
     fprintf(irp->f, ")");
 }
 
+static void ir_print_vector_type(IrPrint *irp, IrInstructionVectorType *instruction) {
+    fprintf(irp->f, "@Vector(");
+    ir_print_other_instruction(irp, instruction->len);
+    fprintf(irp->f, ", ");
+    ir_print_other_instruction(irp, instruction->elem_type);
+    fprintf(irp->f, ")");
+}
+
+static void ir_print_splat(IrPrint *irp, IrInstructionSplat *instruction) {
+    fprintf(irp->f, "@splat(");
+    ir_print_other_instruction(irp, instruction->len);
+    fprintf(irp->f, ", ");
+    ir_print_other_instruction(irp, instruction->scalar);
+    fprintf(irp->f, ")");
+}
+
+static void ir_print_shuffle(IrPrint *irp, IrInstructionShuffle *instruction) {
+    fprintf(irp->f, "@shuffle(");
+    ir_print_other_instruction(irp, instruction->a);
+    fprintf(irp->f, ", ");
+    ir_print_other_instruction(irp, instruction->b);
+    fprintf(irp->f, ", ");
+    ir_print_other_instruction(irp, instruction->mask);
+    fprintf(irp->f, ")");
+}
+
+static void ir_print_reduce(IrPrint *irp, IrInstructionReduce *instruction) {
+    fprintf(irp->f, "@reduce(");
+    ir_print_other_instruction(irp, instruction->op_value);
+    fprintf(irp->f, ", ");
+    ir_print_other_instruction(irp, instruction->value);
+    fprintf(irp->f, ")");
+}
+
+static void ir_print_atomic_rmw(IrPrint *irp, IrInstructionAtomicRmw *instruction) {
+    fprintf(irp->f, "@atomicRmw(");
+    ir_print_other_instruction(irp, instruction->ptr);
+    fprintf(irp->f, ", ");
+    ir_print_other_instruction(irp, instruction->op_value);
+    fprintf(irp->f, ", ");
+    ir_print_other_instruction(irp, instruction->operand);
+    fprintf(irp->f, ", ");
+    ir_print_other_instruction(irp, instruction->order_value);
+    fprintf(irp->f, ")");
+}
+
+static void ir_print_atomic_load(IrPrint *irp, IrInstructionAtomicLoad *instruction) {
+    fprintf(irp->f, "@atomicLoad(");
+    ir_print_other_instruction(irp, instruction->ptr);
+    fprintf(irp->f, ", ");
+    ir_print_other_instruction(irp, instruction->order_value);
+    fprintf(irp->f, ")");
+}
+
+static void ir_print_atomic_store(IrPrint *irp, IrInstructionAtomicStore *instruction) {
+    fprintf(irp->f, "@atomicStore(");
+    ir_print_other_instruction(irp, instruction->ptr);
+    fprintf(irp->f, ", ");
+    ir_print_other_instruction(irp, instruction->value);
+    fprintf(irp->f, ", ");
+    ir_print_other_instruction(irp, instruction->order_value);
+    fprintf(irp->f, ")");
+}
+
 static void ir_print_instruction(IrPrint *irp, IrInstruction *instruction) {
     ir_print_prefix(irp, instruction);
     switch (instruction->id) {
@@ -1256,6 +1320,27 @@ static void ir_print_instruction(IrPrint *irp, IrInstruction *instruction) {
         case IrInstructionIdSetAlignStack:
             ir_print_set_align_stack(irp, (IrInstructionSetAlignStack *)instruction);
             break;
+        case IrInstructionIdVectorType:
+            ir_print_vector_type(irp, (IrInstructionVectorType *)instruction);
+            break;
+        case IrInstructionIdSplat:
+            ir_print_splat(irp, (IrInstructionSplat *)instruction);
+            break;
+        case IrInstructionIdShuffle:
+            ir_print_shuffle(irp, (IrInstructionShuffle *)instruction);
+            break;
+        case IrInstructionIdReduce:
+            ir_print_reduce(irp, (IrInstructionReduce *)instruction);
+            break;
+        case IrInstructionIdAtomicRmw:
+            ir_print_atomic_rmw(irp, (IrInstructionAtomicRmw *)instruction);
+            break;
+        case IrInstructionIdAtomicLoad:
+            ir_print_atomic_load(irp, (IrInstructionAtomicLoad *)instruction);
+            break;
+        case IrInstructionIdAtomicStore:
+            ir_print_atomic_store(irp, (IrInstructionAtomicStore *)instruction);
+            break;
     }
     fprintf(irp->f, "\n");
 }
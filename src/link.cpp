@@ -10,6 +10,7 @@
 #include "config.h"
 #include "codegen.hpp"
 #include "analyze.hpp"
+#include "cache_hash.hpp"
 
 struct LinkJob {
     CodeGen *codegen;
@@ -31,20 +32,110 @@ static const char *get_libc_static_file(CodeGen *g, const char *file) {
     return buf_ptr(out_buf);
 }
 
+// The special objects only depend on the options which are forwarded to the child
+// CodeGen in build_o_raw, plus the contents of the files it imports. The options
+// go into the name of the cached object; the imported files are listed in a
+// manifest next to it and re-hashed before the object is reused.
+static void get_special_o_cache_key(CodeGen *parent_gen, const char *oname, Buf *full_path, Buf *out_key) {
+    CacheHash ch;
+    cache_hash_init(&ch);
+    cache_hash_add_compiler(&ch);
+    cache_hash_add_str(&ch, oname);
+    cache_hash_add_buf(&ch, full_path);
+
+    Buf triple_str = BUF_INIT;
+    get_target_triple(&triple_str, &parent_gen->zig_target);
+    cache_hash_add_buf(&ch, &triple_str);
+    cache_hash_add_bool(&ch, parent_gen->is_native_target);
+
+    cache_hash_add_int(&ch, parent_gen->build_mode);
+    cache_hash_add_int(&ch, parent_gen->lto_mode);
+    cache_hash_add_bool(&ch, parent_gen->strip_debug_symbols);
+    cache_hash_add_bool(&ch, parent_gen->is_static);
+    if (parent_gen->mmacosx_version_min)
+        cache_hash_add_buf(&ch, parent_gen->mmacosx_version_min);
+    if (parent_gen->mios_version_min)
+        cache_hash_add_buf(&ch, parent_gen->mios_version_min);
+
+    for (size_t i = 0; i < parent_gen->link_libs_list.length; i += 1) {
+        LinkLib *link_lib = parent_gen->link_libs_list.at(i);
+        cache_hash_add_buf(&ch, link_lib->name);
+    }
+
+    buf_resize(out_key, 0);
+    buf_appendf(out_key, "%s-", oname);
+    cache_hash_final(&ch, out_key);
+}
+
+static void write_special_o_manifest(CodeGen *child_gen, Buf *manifest_path) {
+    ZigList<Buf *> input_paths = {0};
+    auto it = child_gen->import_table.entry_iterator();
+    for (;;) {
+        auto *entry = it.next();
+        if (!entry)
+            break;
+
+        ImportTableEntry *import = entry->value;
+        // builtin.zig is generated from the options in the cache key and is
+        // rewritten by every CodeGen that shares the cache dir.
+        if (import == child_gen->compile_var_import)
+            continue;
+        input_paths.append(import->path);
+    }
+
+    int err;
+    if ((err = cache_manifest_write(manifest_path, &input_paths))) {
+        // not fatal; without a manifest the object is rebuilt next time
+        if (child_gen->verbose || child_gen->verbose_link) {
+            fprintf(stderr, "unable to write cache manifest %s: %s\n", buf_ptr(manifest_path), err_str(err));
+        }
+    }
+}
+
 static Buf *build_o_raw(CodeGen *parent_gen, const char *oname, Buf *full_path) {
+    int err;
+    Buf *cache_key = buf_alloc();
+    get_special_o_cache_key(parent_gen, oname, full_path, cache_key);
+
+    const char *o_ext = target_o_file_ext(&parent_gen->zig_target);
+    Buf *output_path = buf_alloc();
+    os_path_join(parent_gen->cache_dir, buf_sprintf("%s%s", buf_ptr(cache_key), o_ext), output_path);
+    Buf *manifest_path = buf_alloc();
+    os_path_join(parent_gen->cache_dir, buf_sprintf("%s.manifest", buf_ptr(cache_key)), manifest_path);
+
+    bool output_exists;
+    if ((err = os_file_exists(output_path, &output_exists))) {
+        output_exists = false;
+    }
+    if (output_exists && cache_manifest_check(manifest_path, nullptr)) {
+        if (parent_gen->verbose || parent_gen->verbose_link) {
+            fprintf(stderr, "using cached %s: %s\n", oname, buf_ptr(output_path));
+        }
+        return output_path;
+    }
+
     ZigTarget *child_target = parent_gen->is_native_target ? nullptr : &parent_gen->zig_target;
     CodeGen *child_gen = codegen_create(full_path, child_target, OutTypeObj, parent_gen->build_mode,
         parent_gen->zig_lib_dir);
 
     child_gen->want_h_file = false;
     child_gen->verbose_link = parent_gen->verbose_link;
+    child_gen->verbose_cache = parent_gen->verbose_cache;
+    child_gen->want_comptime_cache = parent_gen->want_comptime_cache;
 
     codegen_set_cache_dir(child_gen, parent_gen->cache_dir);
 
     codegen_set_strip(child_gen, parent_gen->strip_debug_symbols);
     codegen_set_is_static(child_gen, parent_gen->is_static);
+    codegen_set_lto(child_gen, parent_gen->lto_mode);
+    child_gen->lto_keep_exports = true;
 
-    codegen_set_out_name(child_gen, buf_create_from_str(oname));
+    // Builds which share the cache dir can run at the same time. The child emits its
+    // object under a name no other build uses, and codegen_link renames it over
+    // output_path, so a reader of output_path never sees a partly written object.
+    Buf *scratch_name = buf_alloc();
+    os_tmp_path_beside(cache_key, scratch_name);
+    codegen_set_out_name(child_gen, scratch_name);
 
     codegen_set_verbose(child_gen, parent_gen->verbose);
     codegen_set_errmsg_color(child_gen, parent_gen->err_color);
@@ -59,11 +150,8 @@ static Buf *build_o_raw(CodeGen *parent_gen, const char *oname, Buf *full_path)
     }
 
     codegen_build(child_gen);
-    const char *o_ext = target_o_file_ext(&child_gen->zig_target);
-    Buf *o_out_name = buf_sprintf("%s%s", oname, o_ext);
-    Buf *output_path = buf_alloc();
-    os_path_join(parent_gen->cache_dir, o_out_name, output_path);
     codegen_link(child_gen, buf_ptr(output_path));
+    write_special_o_manifest(child_gen, manifest_path);
 
     codegen_destroy(child_gen);
 
@@ -174,6 +262,15 @@ static void construct_linker_job_elf(LinkJob *lj) {
 
     lj->args.append("--gc-sections");
 
+    if (g->lto_mode != ZigLLVMLTOModeNone) {
+        lj->args.append(build_mode_is_debug(g->build_mode) ? "--lto-O0" : "--lto-O3");
+        // --codegen-threads splits the link time code generation instead of the module
+        if (g->codegen_threads > 1) {
+            const char *jobs_arg = (g->lto_mode == ZigLLVMLTOModeThin) ? "--thinlto-jobs" : "--lto-partitions";
+            lj->args.append(buf_ptr(buf_sprintf("%s=%" ZIG_PRI_usize, jobs_arg, g->codegen_threads)));
+        }
+    }
+
     lj->args.append("-m");
     lj->args.append(getLDMOption(&g->zig_target));
 
@@ -362,6 +459,14 @@ static void construct_linker_job_coff(LinkJob *lj) {
 
     coff_append_machine_arg(g, &lj->args);
 
+    if (g->lto_mode != ZigLLVMLTOModeNone) {
+        lj->args.append(build_mode_is_debug(g->build_mode) ? "/opt:lldlto=0" : "/opt:lldlto=3");
+        if (g->codegen_threads > 1) {
+            const char *jobs_arg = (g->lto_mode == ZigLLVMLTOModeThin) ? "/opt:lldltojobs" : "/opt:lldltopartitions";
+            lj->args.append(buf_ptr(buf_sprintf("%s=%" ZIG_PRI_usize, jobs_arg, g->codegen_threads)));
+        }
+    }
+
     if (g->windows_subsystem_windows) {
         lj->args.append("/SUBSYSTEM:windows");
     } else if (g->windows_subsystem_console) {
@@ -407,7 +512,7 @@ static void construct_linker_job_coff(LinkJob *lj) {
 
     if (lj->link_in_crt) {
         const char *lib_str = g->is_static ? "lib" : "";
-        const char *d_str = (g->build_mode == BuildModeDebug) ? "d" : "";
+        const char *d_str = build_mode_is_debug(g->build_mode) ? "d" : "";
 
         Buf *cmt_lib_name = buf_sprintf("libcmt%s.lib", d_str);
         lj->args.append(buf_ptr(cmt_lib_name));
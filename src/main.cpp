@@ -7,11 +7,13 @@
 
 #include "ast_render.hpp"
 #include "buffer.hpp"
+#include "cache_hash.hpp"
 #include "codegen.hpp"
 #include "config.h"
 #include "error.hpp"
 #include "link.hpp"
 #include "os.hpp"
+#include "source_cache.hpp"
 #include "target.hpp"
 
 #include <stdio.h>
@@ -24,6 +26,7 @@ static int usage(const char *arg0) {
         "  build-lib [source]           create library from source or object files\n"
         "  build-obj [source]           create object from source or assembly\n"
         "  parsec [source]              convert c code to zig code\n"
+        "  server                       run the commands read from stdin in a warm process\n"
         "  targets                      list available compilation targets\n"
         "  test [source]                create and run a test build\n"
         "  version                      print version number and exit\n"
@@ -31,10 +34,16 @@ static int usage(const char *arg0) {
         "Compile Options:\n"
         "  --assembly [source]          add assembly file to build\n"
         "  --cache-dir [path]           override the cache directory\n"
+        "  --codegen-threads [count]    optimize and emit code on this many threads\n"
         "  --color [auto|off|on]        enable or disable colored error messages\n"
+        "  --dep-manifest [file]        list the files the build read with hashes of their contents\n"
         "  --enable-timing-info         print timing diagnostics\n"
+        "  --fast-debug                 debug build with the fastest LLVM backend pipeline\n"
+        "  --ir-gen-threads [count]     generate the IR of function bodies on this many threads\n"
         "  --libc-include-dir [path]    directory where libc stdlib.h resides\n"
+        "  --lto [thin|full]            emit bitcode and optimize the whole program when linking\n"
         "  --name [name]                override output name\n"
+        "  --no-comptime-cache          evaluate every compile time call instead of reusing results\n"
         "  --output [file]              override destination path\n"
         "  --output-h [file]            override generated header file path\n"
         "  --pkg-begin [name] [path]    make package available to import and push current pkg\n"
@@ -46,9 +55,12 @@ static int usage(const char *arg0) {
         "  --target-arch [name]         specify target architecture\n"
         "  --target-environ [name]      specify target environment\n"
         "  --target-os [name]           specify target operating system\n"
+        "  --time-report [file]         print the time spent per function, @cImport and comptime call\n"
+        "                               and write a Chrome trace of it to file\n"
         "  --verbose                    turn on compiler debug output\n"
         "  --verbose-link               turn on compiler debug output for linking only\n"
         "  --verbose-ir                 turn on compiler debug output for IR only\n"
+        "  --verbose-cache              print which cached compile time calls and @cImports are reused\n"
         "  --zig-install-prefix [path]  override directory where zig thinks it is installed\n"
         "  -dirafter [dir]              same as -isystem but do it last\n"
         "  -isystem [dir]               add additional search path for other .h files\n"
@@ -82,6 +94,8 @@ static int usage(const char *arg0) {
         "  --test-name-prefix [text]    add prefix to all tests\n"
         "  --test-cmd [arg]             specify test execution command one arg at a time\n"
         "  --test-cmd-bin               appends test binary path to test cmd args\n"
+        "  --jobs [count]               run the tests in this many processes at once (not on Windows)\n"
+        "  --shard [i/n]                run only the ith of n equal parts of the tests\n"
     , arg0);
     return EXIT_FAILURE;
 }
@@ -232,6 +246,106 @@ enum Cmd {
 
 static const char *default_zig_cache_name = "zig-cache";
 
+struct TestWorker {
+    Buf *shard_arg;
+    // the test which started and did not pass yet
+    Buf *current_test;
+    double current_start;
+};
+
+struct TestTiming {
+    Buf *name;
+    double seconds;
+};
+
+struct TestRunState {
+    TestWorker *workers;
+    ZigList<TestTiming> passed;
+};
+
+// The lines which a test runner started with --report writes to OS_CHILD_REPORT_FD.
+static void on_test_runner_line(void *context, size_t worker_index, Buf *line) {
+    TestRunState *state = reinterpret_cast<TestRunState *>(context);
+    TestWorker *worker = &state->workers[worker_index];
+    if (buf_starts_with_str(line, "start ")) {
+        // start <index> <name>
+        const char *space = strchr(buf_ptr(line) + strlen("start "), ' ');
+        worker->current_test = buf_create_from_str((space == nullptr) ? "" : space + 1);
+        worker->current_start = os_get_time();
+    } else if (buf_starts_with_str(line, "pass ") && worker->current_test != nullptr) {
+        TestTiming *timing = state->passed.add_one();
+        timing->name = worker->current_test;
+        timing->seconds = os_get_time() - worker->current_start;
+        worker->current_test = nullptr;
+    }
+}
+
+static int compare_test_timings(const void *a, const void *b) {
+    double a_seconds = reinterpret_cast<const TestTiming *>(a)->seconds;
+    double b_seconds = reinterpret_cast<const TestTiming *>(b)->seconds;
+    return (a_seconds < b_seconds) ? 1 : (a_seconds > b_seconds) ? -1 : 0;
+}
+
+// Runs job_count test runners at once, which split the tests of shard shard_index
+// (counting from 0) of shard_count between them.
+static int run_tests_in_parallel(const char *exe, ZigList<const char *> &exe_args, size_t job_count,
+        size_t shard_index, size_t shard_count, bool timing_info)
+{
+    TestRunState state = {0};
+    state.workers = allocate<TestWorker>(job_count);
+    OsChildCommand *commands = allocate<OsChildCommand>(job_count);
+    for (size_t i = 0; i < job_count; i += 1) {
+        // the test runner counts shards from 1
+        state.workers[i].shard_arg = buf_sprintf("%" ZIG_PRI_usize "/%" ZIG_PRI_usize,
+                shard_index + shard_count * i + 1, shard_count * job_count);
+        commands[i].exe = exe;
+        for (size_t arg_i = 0; arg_i < exe_args.length; arg_i += 1) {
+            commands[i].args.append(exe_args.at(arg_i));
+        }
+        commands[i].args.append("--report");
+        commands[i].args.append("--shard");
+        commands[i].args.append(buf_ptr(state.workers[i].shard_arg));
+    }
+
+    double start_time = os_get_time();
+    os_exec_processes_by_line(commands, job_count, on_test_runner_line, &state);
+    double elapsed = os_get_time() - start_time;
+
+    bool all_passed = true;
+    for (size_t i = 0; i < job_count; i += 1) {
+        Termination *term = &commands[i].term;
+        if (term->how == TerminationIdClean && term->code == 0)
+            continue;
+        all_passed = false;
+        TestWorker *worker = &state.workers[i];
+        if (worker->current_test != nullptr) {
+            fprintf(stderr, "\nTest %s failed.\n", buf_ptr(worker->current_test));
+        } else {
+            fprintf(stderr, "\nTest runner failed.\n");
+        }
+        fprintf(stderr, "Use the following command to reproduce the failure:\n");
+        fprintf(stderr, "%s", exe);
+        for (size_t arg_i = 0; arg_i < exe_args.length; arg_i += 1) {
+            fprintf(stderr, " %s", exe_args.at(arg_i));
+        }
+        fprintf(stderr, " --shard %s\n", buf_ptr(worker->shard_arg));
+    }
+
+    qsort(state.passed.items, state.passed.length, sizeof(TestTiming), compare_test_timings);
+    size_t listed_count = timing_info ? state.passed.length : min(state.passed.length, (size_t)5);
+    if (listed_count != 0) {
+        fprintf(stderr, "%s tests:\n", timing_info ? "All" : "Slowest");
+        for (size_t i = 0; i < listed_count; i += 1) {
+            TestTiming *timing = &state.passed.at(i);
+            fprintf(stderr, "  %8.3fs %s\n", timing->seconds, buf_ptr(timing->name));
+        }
+    }
+    fprintf(stderr, "%" ZIG_PRI_usize " tests passed in %.3fs using %" ZIG_PRI_usize " processes.\n",
+            state.passed.length, elapsed, job_count);
+
+    return all_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 struct CliPkg {
     const char *name;
     const char *path;
@@ -262,13 +376,13 @@ static void add_package(CodeGen *g, CliPkg *cli_pkg, PackageTableEntry *pkg) {
     }
 }
 
-int main(int argc, char **argv) {
-    os_init();
-
+static int run_command(int argc, char **argv) {
     char *arg0 = argv[0];
     Cmd cmd = CmdInvalid;
     const char *in_file = nullptr;
     const char *out_file = nullptr;
+    const char *dep_manifest = nullptr;
+    const char *time_report_path = nullptr;
     const char *out_file_h = nullptr;
     bool strip = false;
     bool is_static = false;
@@ -277,6 +391,8 @@ int main(int argc, char **argv) {
     bool verbose = false;
     bool verbose_link = false;
     bool verbose_ir = false;
+    bool verbose_cache = false;
+    bool want_comptime_cache = true;
     ErrColor color = ErrColorAuto;
     const char *libc_lib_dir = nullptr;
     const char *libc_static_lib_dir = nullptr;
@@ -303,6 +419,9 @@ int main(int argc, char **argv) {
     const char *linker_script = nullptr;
     ZigList<const char *> rpath_list = {0};
     bool each_lib_rpath = false;
+    size_t codegen_threads = 1;
+    size_t ir_gen_threads = 1;
+    ZigLLVMLTOMode lto_mode = ZigLLVMLTOModeNone;
     ZigList<const char *> objects = {0};
     ZigList<const char *> asm_files = {0};
     const char *test_filter = nullptr;
@@ -315,6 +434,9 @@ int main(int argc, char **argv) {
     CliPkg *cur_pkg = allocate<CliPkg>(1);
     BuildMode build_mode = BuildModeDebug;
     ZigList<const char *> test_exec_args = {0};
+    size_t test_jobs = 1;
+    size_t test_shard_index = 0;
+    size_t test_shard_count = 1;
 
     if (argc >= 2 && strcmp(argv[1], "build") == 0) {
         const char *zig_exe_path = arg0;
@@ -403,6 +525,8 @@ int main(int argc, char **argv) {
                         "  --verbose              Print commands before executing them\n"
                         "  --debug-build-verbose  Print verbose debugging information for the build system itself\n"
                         "  --prefix [prefix]      Override default install prefix\n"
+                        "  -j [N]                 Run the commands of up to N independent steps at once (not on Windows)\n"
+                        "  --server               Run the compiler commands in one zig server process\n"
                         "\n"
                         "More options become available when the build file is found.\n"
                         "Run this command with no options to generate a build.zig template.\n"
@@ -448,6 +572,8 @@ int main(int argc, char **argv) {
                 build_mode = BuildModeFastRelease;
             } else if (strcmp(arg, "--release-safe") == 0) {
                 build_mode = BuildModeSafeRelease;
+            } else if (strcmp(arg, "--fast-debug") == 0) {
+                build_mode = BuildModeFastDebug;
             } else if (strcmp(arg, "--strip") == 0) {
                 strip = true;
             } else if (strcmp(arg, "--static") == 0) {
@@ -458,6 +584,10 @@ int main(int argc, char **argv) {
                 verbose_link = true;
             } else if (strcmp(arg, "--verbose-ir") == 0) {
                 verbose_ir = true;
+            } else if (strcmp(arg, "--verbose-cache") == 0) {
+                verbose_cache = true;
+            } else if (strcmp(arg, "--no-comptime-cache") == 0) {
+                want_comptime_cache = false;
             } else if (strcmp(arg, "-mwindows") == 0) {
                 mwindows = true;
             } else if (strcmp(arg, "-mconsole") == 0) {
@@ -503,6 +633,13 @@ int main(int argc, char **argv) {
                     out_file = argv[i];
                 } else if (strcmp(arg, "--output-h") == 0) {
                     out_file_h = argv[i];
+                } else if (strcmp(arg, "--dep-manifest") == 0) {
+                    dep_manifest = argv[i];
+                } else if (strcmp(arg, "--time-report") == 0) {
+                    time_report_path = argv[i];
+                    timing_info = true;
+                    // LLVM reports the time of each of its passes
+                    llvm_argv.append("-time-passes");
                 } else if (strcmp(arg, "--color") == 0) {
                     if (strcmp(argv[i], "auto") == 0) {
                         color = ErrColorAuto;
@@ -514,6 +651,15 @@ int main(int argc, char **argv) {
                         fprintf(stderr, "--color options are 'auto', 'on', or 'off'\n");
                         return usage(arg0);
                     }
+                } else if (strcmp(arg, "--lto") == 0) {
+                    if (strcmp(argv[i], "thin") == 0) {
+                        lto_mode = ZigLLVMLTOModeThin;
+                    } else if (strcmp(argv[i], "full") == 0) {
+                        lto_mode = ZigLLVMLTOModeFull;
+                    } else {
+                        fprintf(stderr, "--lto options are 'thin' or 'full'\n");
+                        return usage(arg0);
+                    }
                 } else if (strcmp(arg, "--name") == 0) {
                     out_name = argv[i];
                 } else if (strcmp(arg, "--libc-lib-dir") == 0) {
@@ -577,8 +723,47 @@ int main(int argc, char **argv) {
                     ver_minor = atoi(argv[i]);
                 } else if (strcmp(arg, "--ver-patch") == 0) {
                     ver_patch = atoi(argv[i]);
+                } else if (strcmp(arg, "--codegen-threads") == 0) {
+                    int thread_count = atoi(argv[i]);
+                    if (thread_count < 1) {
+                        fprintf(stderr, "--codegen-threads expects a positive number\n");
+                        return usage(arg0);
+                    }
+                    codegen_threads = thread_count;
+                } else if (strcmp(arg, "--ir-gen-threads") == 0) {
+                    int thread_count = atoi(argv[i]);
+                    if (thread_count < 1) {
+                        fprintf(stderr, "--ir-gen-threads expects a positive number\n");
+                        return usage(arg0);
+                    }
+                    ir_gen_threads = thread_count;
                 } else if (strcmp(arg, "--test-cmd") == 0) {
                     test_exec_args.append(argv[i]);
+                } else if (strcmp(arg, "--jobs") == 0) {
+                    int job_count = atoi(argv[i]);
+                    if (job_count < 1) {
+                        fprintf(stderr, "--jobs expects a positive number\n");
+                        return usage(arg0);
+                    }
+#if defined(ZIG_OS_WINDOWS)
+                    if (job_count > 1) {
+                        fprintf(stderr, "--jobs is not supported on Windows\n");
+                        return usage(arg0);
+                    }
+#endif
+                    test_jobs = job_count;
+                } else if (strcmp(arg, "--shard") == 0) {
+                    unsigned shard_number;
+                    unsigned shard_count;
+                    char extra;
+                    if (sscanf(argv[i], "%u/%u%c", &shard_number, &shard_count, &extra) != 2 ||
+                        shard_number < 1 || shard_number > shard_count)
+                    {
+                        fprintf(stderr, "--shard expects i/n where 1 <= i <= n\n");
+                        return usage(arg0);
+                    }
+                    test_shard_index = shard_number - 1;
+                    test_shard_count = shard_count;
                 } else {
                     fprintf(stderr, "Invalid argument: %s\n", arg);
                     return usage(arg0);
@@ -743,8 +928,22 @@ int main(int argc, char **argv) {
             if (dynamic_linker)
                 codegen_set_dynamic_linker(g, buf_create_from_str(dynamic_linker));
             codegen_set_verbose(g, verbose);
+            if (time_report_path)
+                codegen_set_time_report(g, buf_create_from_str(time_report_path));
+            codegen_set_codegen_threads(g, codegen_threads);
+            codegen_set_ir_gen_threads(g, ir_gen_threads);
+            if (lto_mode != ZigLLVMLTOModeNone) {
+                // LLD does not do link time optimization for MachO
+                if (g->zig_target.oformat == ZigLLVM_MachO) {
+                    fprintf(stderr, "--lto is not supported for MachO targets\n");
+                    return EXIT_FAILURE;
+                }
+                codegen_set_lto(g, lto_mode);
+            }
             g->verbose_link = verbose_link;
             g->verbose_ir = verbose_ir;
+            g->verbose_cache = verbose_cache;
+            g->want_comptime_cache = want_comptime_cache;
             codegen_set_errmsg_color(g, color);
 
             for (size_t i = 0; i < lib_dirs.length; i += 1) {
@@ -800,6 +999,16 @@ int main(int argc, char **argv) {
                 }
                 codegen_build(g);
                 codegen_link(g, out_file);
+                if (dep_manifest) {
+                    // the build system skips running this command again while
+                    // neither the command line nor any file listed changed
+                    CacheHash args_hash;
+                    cache_hash_init(&args_hash);
+                    for (int i = 0; i < argc; i += 1) {
+                        cache_hash_add_str(&args_hash, argv[i]);
+                    }
+                    codegen_write_dep_manifest(g, buf_create_from_str(dep_manifest), args_hash.value);
+                }
                 if (timing_info)
                     codegen_print_timing_report(g, stdout);
                 return EXIT_SUCCESS;
@@ -832,18 +1041,36 @@ int main(int argc, char **argv) {
                     return 0;
                 }
 
-                Termination term;
+                const char *test_exe = buf_ptr(test_exe_name);
+                ZigList<const char *> test_args = {0};
                 if (test_exec_args.length > 0) {
-                    ZigList<const char *> rest_args = {0};
+                    test_exe = test_exec_args.items[0];
                     for (size_t i = 1; i < test_exec_args.length; i += 1) {
-                        rest_args.append(test_exec_args.at(i));
+                        test_args.append(test_exec_args.at(i));
                     }
-                    os_spawn_process(test_exec_args.items[0], rest_args, &term);
-                } else {
-                    ZigList<const char *> no_args = {0};
-                    os_spawn_process(buf_ptr(test_exe_name), no_args, &term);
                 }
 
+#if defined(ZIG_OS_WINDOWS)
+                // the runner reports the tests of run_tests_in_parallel through a pipe
+                // that Windows does not give it, so a shard runs without the timings
+                if (test_shard_count > 1) {
+                    test_args.append("--shard");
+                    test_args.append(buf_ptr(buf_sprintf("%" ZIG_PRI_usize "/%" ZIG_PRI_usize,
+                            test_shard_index + 1, test_shard_count)));
+                    test_shard_count = 1;
+                }
+#endif
+                if (test_jobs > 1 || test_shard_count > 1) {
+                    int result = run_tests_in_parallel(test_exe, test_args, test_jobs,
+                            test_shard_index, test_shard_count, timing_info);
+                    if (result == EXIT_SUCCESS && timing_info)
+                        codegen_print_timing_report(g, stdout);
+                    return result;
+                }
+
+                Termination term;
+                os_spawn_process(test_exe, test_args, &term);
+
                 if (term.how != TerminationIdClean || term.code != 0) {
                     fprintf(stderr, "\nTests failed. Use the following command to reproduce the failure:\n");
                     fprintf(stderr, "%s\n", buf_ptr(test_exe_name));
@@ -867,3 +1094,119 @@ int main(int argc, char **argv) {
         return usage(arg0);
     }
 }
+
+static int parse_preloaded_files(void *context) {
+    source_cache_parse_preloaded();
+    return EXIT_SUCCESS;
+}
+
+static int run_server_request(void *context) {
+    ZigList<char *> *args = reinterpret_cast<ZigList<char *> *>(context);
+    return run_command((int)args->length, args->items);
+}
+
+// Returns false at the end of the file. The line terminator is not included.
+static bool read_line(FILE *f, Buf *out_line) {
+    buf_resize(out_line, 0);
+    int c;
+    while ((c = getc(f)) != EOF) {
+        if (c == '\n') {
+            if (buf_len(out_line) > 0 && buf_ptr(out_line)[buf_len(out_line) - 1] == '\r')
+                buf_resize(out_line, buf_len(out_line) - 1);
+            return true;
+        }
+        buf_append_char(out_line, (uint8_t)c);
+    }
+    return buf_len(out_line) > 0;
+}
+
+// The server keeps the targets initialized and the tokens and syntax trees of the
+// standard library in memory, and runs each command in a fork of itself so that the
+// command starts out with all of that, and so that a failing command cannot take the
+// server down.
+//
+// Each request is one line of tab separated fields: the working directory followed
+// by the arguments of a zig command, for example
+//     /home/me/proj<TAB>build-exe<TAB>main.zig<TAB>--release-fast
+// The command's output, including what it prints to stdout, goes to stderr. Once it
+// finishes the server answers on stdout with one line, "exit <code>",
+// "signal <number>" or "error <message>". The server prints "ready" when it starts
+// and stops at the end of stdin or at an empty line.
+static int server(const char *arg0, int argc, char **argv) {
+    const char *zig_install_prefix = nullptr;
+    for (int i = 2; i < argc; i += 1) {
+        if (i + 1 < argc && strcmp(argv[i], "--zig-install-prefix") == 0) {
+            i += 1;
+            zig_install_prefix = argv[i];
+        } else {
+            fprintf(stderr, "Unrecognized argument: %s\n", argv[i]);
+            return usage(arg0);
+        }
+    }
+#if defined(ZIG_OS_WINDOWS)
+    fprintf(stderr, "zig server is not supported on Windows\n");
+    return EXIT_FAILURE;
+#endif
+
+    init_all_targets();
+
+    Buf *zig_lib_dir = resolve_zig_lib_dir(zig_install_prefix);
+    Buf std_dir = BUF_INIT;
+    os_path_join(zig_lib_dir, buf_create_from_str("std"), &std_dir);
+    Buf abs_std_dir = BUF_INIT;
+    int err;
+    if ((err = os_path_real(&std_dir, &abs_std_dir))) {
+        fprintf(stderr, "unable to open '%s': %s\n", buf_ptr(&std_dir), err_str(err));
+        return EXIT_FAILURE;
+    }
+    source_cache_preload_dir(&abs_std_dir);
+    // a syntax error would exit the server, in which case the commands parse the files
+    Termination parse_term;
+    if (!os_run_forked(&abs_std_dir, parse_preloaded_files, nullptr, &parse_term) &&
+        parse_term.how == TerminationIdClean && parse_term.code == 0)
+    {
+        source_cache_parse_preloaded();
+    }
+
+    printf("ready\n");
+    fflush(stdout);
+
+    Buf line = BUF_INIT;
+    while (read_line(stdin, &line) && buf_len(&line) > 0) {
+        // the fields point into line, which stays the same until the child exits
+        ZigList<char *> args = {0};
+        args.append(const_cast<char *>(arg0));
+        char *cwd = buf_ptr(&line);
+        for (char *tab = strchr(cwd, '\t'); tab != nullptr; tab = strchr(tab + 1, '\t')) {
+            *tab = 0;
+            args.append(tab + 1);
+        }
+
+        if (args.length < 2) {
+            printf("error missing command\n");
+        } else if (strcmp(args.at(1), "server") == 0) {
+            printf("error server cannot run itself\n");
+        } else {
+            Termination term;
+            if ((err = os_run_forked(buf_create_from_str(cwd), run_server_request, &args, &term))) {
+                printf("error %s\n", err_str(err));
+            } else if (term.how == TerminationIdClean) {
+                printf("exit %d\n", term.code);
+            } else {
+                printf("signal %d\n", term.code);
+            }
+        }
+        fflush(stdout);
+        args.deinit();
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    os_init();
+
+    if (argc >= 2 && strcmp(argv[1], "server") == 0)
+        return server(argv[0], argc, argv);
+
+    return run_command(argc, argv);
+}
@@ -32,11 +32,14 @@ typedef SSIZE_T ssize_t;
 #define ZIG_OS_POSIX
 
 #include <unistd.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <dirent.h>
+#include <poll.h>
 
 #endif
 
@@ -56,6 +59,8 @@ static clock_serv_t cclock;
 #include <errno.h>
 #include <time.h>
 
+#include <atomic>
+
 // these implementations are lazy. But who cares, we'll make a robust
 // implementation in the zig standard library and then this code all gets
 // deleted when we self-host. it works for now.
@@ -528,6 +533,120 @@ int os_exec_process(const char *exe, ZigList<const char *> &args,
 #endif
 }
 
+#if defined(ZIG_OS_POSIX)
+static void append_child_output(Buf *partial_line, const char *bytes, size_t len,
+        void (*on_line)(void *context, size_t command_index, Buf *line), void *context, size_t command_index)
+{
+    for (size_t i = 0; i < len; i += 1) {
+        if (bytes[i] == '\n') {
+            on_line(context, command_index, partial_line);
+            buf_resize(partial_line, 0);
+        } else {
+            buf_append_char(partial_line, bytes[i]);
+        }
+    }
+}
+
+static void os_exec_processes_by_line_posix(OsChildCommand *commands, size_t command_count,
+        void (*on_line)(void *context, size_t command_index, Buf *line), void *context)
+{
+    pid_t *pids = allocate<pid_t>(command_count);
+    struct pollfd *poll_fds = allocate<struct pollfd>(command_count);
+    Buf *partial_lines = allocate<Buf>(command_count);
+
+    for (size_t cmd_i = 0; cmd_i < command_count; cmd_i += 1) {
+        OsChildCommand *command = &commands[cmd_i];
+        buf_resize(&partial_lines[cmd_i], 0);
+
+        int report_pipe[2];
+        if (pipe(report_pipe))
+            zig_panic("pipe failed");
+        // the children started after this one must not keep the pipe open
+        fcntl(report_pipe[0], F_SETFD, FD_CLOEXEC);
+        fcntl(report_pipe[1], F_SETFD, FD_CLOEXEC);
+
+        const char **argv = allocate<const char *>(command->args.length + 2);
+        argv[0] = command->exe;
+        argv[command->args.length + 1] = nullptr;
+        for (size_t i = 0; i < command->args.length; i += 1) {
+            argv[i + 1] = command->args.at(i);
+        }
+
+        pid_t pid = fork();
+        if (pid == -1)
+            zig_panic("fork failed");
+        if (pid == 0) {
+            // child
+            if (report_pipe[1] == OS_CHILD_REPORT_FD) {
+                // dup2 would keep FD_CLOEXEC
+                if (fcntl(OS_CHILD_REPORT_FD, F_SETFD, 0) == -1)
+                    zig_panic("fcntl failed");
+            } else if (dup2(report_pipe[1], OS_CHILD_REPORT_FD) == -1) {
+                zig_panic("dup2 failed");
+            }
+            execvp(command->exe, const_cast<char * const *>(argv));
+            zig_panic("execvp failed: %s", strerror(errno));
+        }
+        free(argv);
+        close(report_pipe[1]);
+        pids[cmd_i] = pid;
+        poll_fds[cmd_i].fd = report_pipe[0];
+        poll_fds[cmd_i].events = POLLIN;
+    }
+
+    size_t open_count = command_count;
+    while (open_count > 0) {
+        if (poll(poll_fds, command_count, -1) == -1) {
+            if (errno == EINTR)
+                continue;
+            zig_panic("poll failed: %s", strerror(errno));
+        }
+        for (size_t cmd_i = 0; cmd_i < command_count; cmd_i += 1) {
+            // poll ignores the negative fds of closed pipes
+            if (poll_fds[cmd_i].fd < 0 || poll_fds[cmd_i].revents == 0)
+                continue;
+            char chunk[4096];
+            ssize_t amt_read = read(poll_fds[cmd_i].fd, chunk, sizeof(chunk));
+            if (amt_read == -1 && errno == EINTR)
+                continue;
+            if (amt_read <= 0) {
+                close(poll_fds[cmd_i].fd);
+                poll_fds[cmd_i].fd = -1;
+                open_count -= 1;
+                continue;
+            }
+            append_child_output(&partial_lines[cmd_i], chunk, amt_read, on_line, context, cmd_i);
+        }
+    }
+
+    for (size_t cmd_i = 0; cmd_i < command_count; cmd_i += 1) {
+        if (buf_len(&partial_lines[cmd_i]) != 0)
+            on_line(context, cmd_i, &partial_lines[cmd_i]);
+        buf_deinit(&partial_lines[cmd_i]);
+
+        int status;
+        waitpid(pids[cmd_i], &status, 0);
+        populate_termination(&commands[cmd_i].term, status);
+    }
+
+    free(pids);
+    free(poll_fds);
+    free(partial_lines);
+}
+#endif
+
+void os_exec_processes_by_line(OsChildCommand *commands, size_t command_count,
+        void (*on_line)(void *context, size_t command_index, Buf *line), void *context)
+{
+#if defined(ZIG_OS_WINDOWS)
+    zig_panic("os_exec_processes_by_line is not supported on Windows");
+#elif defined(ZIG_OS_POSIX)
+    os_exec_processes_by_line_posix(commands, command_count, on_line, context);
+#else
+#error "missing os_exec_processes_by_line implementation"
+#endif
+}
+
 void os_write_file(Buf *full_path, Buf *contents) {
     FILE *f = fopen(buf_ptr(full_path), "wb");
     if (!f) {
@@ -540,6 +659,48 @@ void os_write_file(Buf *full_path, Buf *contents) {
         zig_panic("close failed");
 }
 
+void os_tmp_path_beside(Buf *full_path, Buf *out_tmp_path) {
+    static std::atomic<uint32_t> next_tmp_id(0);
+#if defined(ZIG_OS_WINDOWS)
+    uint64_t pid = GetCurrentProcessId();
+#else
+    uint64_t pid = getpid();
+#endif
+    unsigned tmp_id = next_tmp_id++;
+    buf_resize(out_tmp_path, 0);
+    buf_appendf(out_tmp_path, "%s.%" ZIG_PRI_u64 ".%u.tmp", buf_ptr(full_path), pid, tmp_id);
+}
+
+int os_write_file_atomic(Buf *full_path, Buf *contents) {
+    Buf tmp_path = BUF_INIT;
+    os_tmp_path_beside(full_path, &tmp_path);
+
+    FILE *f = fopen(buf_ptr(&tmp_path), "wb");
+    if (!f) {
+        int err = errno;
+        if (err == EACCES || err == EPERM) {
+            return ErrorAccess;
+        } else if (err == ENOENT) {
+            return ErrorFileNotFound;
+        } else {
+            return ErrorFileSystem;
+        }
+    }
+    size_t amt_written = fwrite(buf_ptr(contents), 1, buf_len(contents), f);
+    bool write_failed = amt_written != (size_t)buf_len(contents);
+    if (fclose(f) || write_failed) {
+        os_delete_file(&tmp_path);
+        return ErrorFileSystem;
+    }
+
+    int err;
+    if ((err = os_rename(&tmp_path, full_path))) {
+        os_delete_file(&tmp_path);
+        return err;
+    }
+    return 0;
+}
+
 int os_copy_file(Buf *src_path, Buf *dest_path) {
     FILE *src_f = fopen(buf_ptr(src_path), "rb");
     if (!src_f) {
@@ -616,6 +777,213 @@ int os_fetch_file_path(Buf *full_path, Buf *out_contents) {
     return result;
 }
 
+#if defined(ZIG_OS_POSIX)
+static void stat_to_mtime(struct stat *st, OsTimeStamp *out_mtime) {
+#if defined(ZIG_OS_DARWIN)
+    out_mtime->sec = st->st_mtimespec.tv_sec;
+    out_mtime->nsec = st->st_mtimespec.tv_nsec;
+#else
+    out_mtime->sec = st->st_mtim.tv_sec;
+    out_mtime->nsec = st->st_mtim.tv_nsec;
+#endif
+}
+
+static int errno_to_file_error(int err) {
+    switch (err) {
+        case EACCES:
+            return ErrorAccess;
+        case EINTR:
+            return ErrorInterrupted;
+        case ENFILE:
+        case EMFILE:
+        case ENOMEM:
+            return ErrorSystemResources;
+        case ENOENT:
+        case ENOTDIR:
+            return ErrorFileNotFound;
+        default:
+            return ErrorFileSystem;
+    }
+}
+#endif
+
+int os_file_mtime(Buf *full_path, OsTimeStamp *out_mtime) {
+#if defined(ZIG_OS_WINDOWS)
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(buf_ptr(full_path), GetFileExInfoStandard, &attributes))
+        return ErrorFileNotFound;
+    uint64_t ticks = ((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) |
+        attributes.ftLastWriteTime.dwLowDateTime;
+    // FILETIME counts 100 nanosecond intervals
+    out_mtime->sec = ticks / 10000000;
+    out_mtime->nsec = (ticks % 10000000) * 100;
+    return 0;
+#else
+    struct stat st;
+    if (stat(buf_ptr(full_path), &st) == -1)
+        return errno_to_file_error(errno);
+    stat_to_mtime(&st, out_mtime);
+    return 0;
+#endif
+}
+
+int os_file_stat(Buf *full_path, OsTimeStamp *out_mtime, uint64_t *out_size) {
+#if defined(ZIG_OS_WINDOWS)
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(buf_ptr(full_path), GetFileExInfoStandard, &attributes))
+        return ErrorFileNotFound;
+    uint64_t ticks = ((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) |
+        attributes.ftLastWriteTime.dwLowDateTime;
+    out_mtime->sec = ticks / 10000000;
+    out_mtime->nsec = (ticks % 10000000) * 100;
+    *out_size = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+    return 0;
+#else
+    struct stat st;
+    if (stat(buf_ptr(full_path), &st) == -1)
+        return errno_to_file_error(errno);
+    stat_to_mtime(&st, out_mtime);
+    *out_size = st.st_size;
+    return 0;
+#endif
+}
+
+// Smaller files are copied. That costs little next to tokenizing them, and a copy
+// cannot be truncated or edited in place behind our back.
+static const size_t min_mapped_file_size = 16 * 1024;
+
+int os_map_file_path(Buf *full_path, Buf *out_contents, OsTimeStamp *out_mtime, bool *out_is_mapped) {
+    *out_is_mapped = false;
+#if defined(ZIG_OS_POSIX)
+    int fd = open(buf_ptr(full_path), O_RDONLY|O_CLOEXEC);
+    if (fd == -1)
+        return errno_to_file_error(errno);
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        int err = errno;
+        close(fd);
+        return errno_to_file_error(err);
+    }
+    stat_to_mtime(&st, out_mtime);
+
+    // Buf contents must be null terminated. The kernel fills the remainder of the last
+    // page of a mapping with zeroes. When the size is a multiple of the page size there
+    // is no remainder, so the file is mapped over the start of an anonymous mapping
+    // one page longer, whose last page provides the terminator.
+    size_t size = st.st_size;
+    static const size_t page_size = sysconf(_SC_PAGESIZE);
+    if (S_ISREG(st.st_mode) && size >= min_mapped_file_size) {
+        void *addr;
+        if (size % page_size == 0) {
+            addr = mmap(nullptr, size + page_size, PROT_READ, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+            if (addr != MAP_FAILED &&
+                mmap(addr, size, PROT_READ, MAP_PRIVATE|MAP_FIXED, fd, 0) == MAP_FAILED)
+            {
+                int err = errno;
+                munmap(addr, size + page_size);
+                close(fd);
+                return errno_to_file_error(err);
+            }
+        } else {
+            addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        int err = errno;
+        close(fd);
+        if (addr == MAP_FAILED)
+            return errno_to_file_error(err);
+        out_contents->list.items = reinterpret_cast<char *>(addr);
+        out_contents->list.length = size + 1;
+        out_contents->list.capacity = size + 1;
+        *out_is_mapped = true;
+        return 0;
+    }
+
+    FILE *f = fdopen(fd, "rb");
+    if (!f) {
+        int err = errno;
+        close(fd);
+        return errno_to_file_error(err);
+    }
+    int result = os_fetch_file(f, out_contents);
+    fclose(f);
+    return result;
+#else
+    int err;
+    if ((err = os_file_mtime(full_path, out_mtime)))
+        return err;
+    return os_fetch_file_path(full_path, out_contents);
+#endif
+}
+
+int os_list_dir(Buf *dir_path, ZigList<OsDirEntry> *out_entries) {
+#if defined(ZIG_OS_WINDOWS)
+    Buf *pattern = buf_sprintf("%s\\*", buf_ptr(dir_path));
+    WIN32_FIND_DATA find_data;
+    HANDLE handle = FindFirstFile(buf_ptr(pattern), &find_data);
+    if (handle == INVALID_HANDLE_VALUE)
+        return ErrorFileNotFound;
+    do {
+        if (strcmp(find_data.cFileName, ".") == 0 || strcmp(find_data.cFileName, "..") == 0)
+            continue;
+        OsDirEntry *entry = out_entries->add_one();
+        entry->name = buf_create_from_str(find_data.cFileName);
+        entry->is_dir = (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    } while (FindNextFile(handle, &find_data));
+    FindClose(handle);
+    return 0;
+#elif defined(ZIG_OS_POSIX)
+    DIR *dir = opendir(buf_ptr(dir_path));
+    if (!dir)
+        return errno_to_file_error(errno);
+    struct dirent *dirent;
+    while ((dirent = readdir(dir)) != nullptr) {
+        if (strcmp(dirent->d_name, ".") == 0 || strcmp(dirent->d_name, "..") == 0)
+            continue;
+        OsDirEntry *entry = out_entries->add_one();
+        entry->name = buf_create_from_str(dirent->d_name);
+        entry->is_dir = false;
+        if (dirent->d_type == DT_DIR) {
+            entry->is_dir = true;
+        } else if (dirent->d_type == DT_UNKNOWN || dirent->d_type == DT_LNK) {
+            Buf *full_path = buf_alloc();
+            os_path_join(dir_path, entry->name, full_path);
+            struct stat st;
+            entry->is_dir = stat(buf_ptr(full_path), &st) == 0 && S_ISDIR(st.st_mode);
+        }
+    }
+    closedir(dir);
+    return 0;
+#else
+#error "missing os_list_dir implementation"
+#endif
+}
+
+int os_run_forked(Buf *cwd, int (*fn)(void *context), void *context, Termination *term) {
+#if defined(ZIG_OS_POSIX)
+    // otherwise the child would write out the parent's buffered output again
+    fflush(nullptr);
+    pid_t pid = fork();
+    if (pid == -1)
+        return ErrorSystemResources;
+    if (pid == 0) {
+        // child
+        if (chdir(buf_ptr(cwd)) == -1) {
+            fprintf(stderr, "unable to change directory to '%s': %s\n", buf_ptr(cwd), strerror(errno));
+            _exit(1);
+        }
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+        exit(fn(context));
+    }
+    int status;
+    if (waitpid(pid, &status, 0) == -1)
+        return ErrorUnexpected;
+    populate_termination(term, status);
+    return 0;
+#else
+    return ErrorUnexpected;
+#endif
+}
+
 int os_get_cwd(Buf *out_cwd) {
 #if defined(ZIG_OS_WINDOWS)
     buf_resize(out_cwd, 4096);
@@ -793,9 +1161,16 @@ int os_delete_file(Buf *path) {
 }
 
 int os_rename(Buf *src_path, Buf *dest_path) {
+#if defined(ZIG_OS_WINDOWS)
+    // rename does not replace an existing file on windows
+    if (!MoveFileExA(buf_ptr(src_path), buf_ptr(dest_path), MOVEFILE_REPLACE_EXISTING)) {
+        return ErrorFileSystem;
+    }
+#else
     if (rename(buf_ptr(src_path), buf_ptr(dest_path)) == -1) {
         return ErrorFileSystem;
     }
+#endif
     return 0;
 }
 
@@ -35,12 +35,33 @@ struct Termination {
     int code;
 };
 
+struct OsTimeStamp {
+    int64_t sec;
+    int64_t nsec;
+};
+
 int os_init(void);
 
 void os_spawn_process(const char *exe, ZigList<const char *> &args, Termination *term);
 int os_exec_process(const char *exe, ZigList<const char *> &args,
         Termination *term, Buf *out_stderr, Buf *out_stdout);
 
+struct OsChildCommand {
+    const char *exe;
+    ZigList<const char *> args;
+    Termination term;
+};
+
+// The file descriptor which os_exec_processes_by_line reads the lines of a child from.
+#define OS_CHILD_REPORT_FD 3
+
+// Runs all of the commands at the same time and calls on_line with each line that
+// one of them writes to OS_CHILD_REPORT_FD as soon as the line arrives. stdin,
+// stdout and stderr are inherited, so nothing the child prints to them can be
+// mistaken for a line. Not supported on Windows.
+void os_exec_processes_by_line(OsChildCommand *commands, size_t command_count,
+        void (*on_line)(void *context, size_t command_index, Buf *line), void *context);
+
 void os_path_dirname(Buf *full_path, Buf *out_dirname);
 void os_path_split(Buf *full_path, Buf *out_dirname, Buf *out_basename);
 void os_path_extname(Buf *full_path, Buf *out_basename, Buf *out_extname);
@@ -53,10 +74,34 @@ int os_make_path(Buf *path);
 int os_make_dir(Buf *path);
 
 void os_write_file(Buf *full_path, Buf *contents);
+// Writes contents to a file next to full_path and renames it over full_path, so
+// that another process reading full_path sees either the old or the new contents.
+int os_write_file_atomic(Buf *full_path, Buf *contents);
+// Sets out_tmp_path to full_path with a suffix no other thread or process uses.
+void os_tmp_path_beside(Buf *full_path, Buf *out_tmp_path);
 int os_copy_file(Buf *src_path, Buf *dest_path);
 
 int os_fetch_file(FILE *file, Buf *out_contents);
 int os_fetch_file_path(Buf *full_path, Buf *out_contents);
+// Maps large files read-only where possible and reads the others. The mapping
+// is never released, so out_contents must not be modified or freed. A mapped
+// file which is truncated later raises SIGBUS when the lost pages are touched,
+// see source_cache_revalidate.
+int os_map_file_path(Buf *full_path, Buf *out_contents, OsTimeStamp *out_mtime, bool *out_is_mapped);
+int os_file_mtime(Buf *full_path, OsTimeStamp *out_mtime);
+int os_file_stat(Buf *full_path, OsTimeStamp *out_mtime, uint64_t *out_size);
+
+struct OsDirEntry {
+    Buf *name;
+    bool is_dir;
+};
+// Entries other than "." and "..", in no particular order.
+int os_list_dir(Buf *dir_path, ZigList<OsDirEntry> *out_entries);
+
+// Runs fn in a copy of this process whose working directory is cwd and whose
+// stdout goes to stderr, and waits for it to exit with the value fn returns.
+// Returns ErrorUnexpected on systems which cannot fork.
+int os_run_forked(Buf *cwd, int (*fn)(void *context), void *context, Termination *term);
 
 int os_get_cwd(Buf *out_cwd);
 
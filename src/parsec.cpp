@@ -7,6 +7,7 @@
 
 #include "all_types.hpp"
 #include "analyze.hpp"
+#include "c_import_cache.hpp"
 #include "c_tokenizer.hpp"
 #include "error.hpp"
 #include "ir.hpp"
@@ -17,6 +18,7 @@
 
 #include <clang/Frontend/ASTUnit.h>
 #include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/Utils.h>
 #include <clang/AST/Expr.h>
 
 #include <string.h>
@@ -3150,49 +3152,11 @@ static void process_preprocessor_entities(Context *c, ASTUnit &unit) {
     }
 }
 
-int parse_h_buf(ImportTableEntry *import, ZigList<ErrorMsg *> *errors, Buf *source,
-        CodeGen *codegen, AstNode *source_node)
-{
-    int err;
-    Buf tmp_file_path = BUF_INIT;
-    if ((err = os_buf_to_tmp_file(source, buf_create_from_str(".h"), &tmp_file_path))) {
-        return err;
-    }
+static void get_clang_argv(CodeGen *codegen, ZigList<const char *> *clang_argv) {
+    clang_argv->append("-x");
+    clang_argv->append("c");
 
-    err = parse_h_file(import, errors, buf_ptr(&tmp_file_path), codegen, source_node);
-
-    os_delete_file(&tmp_file_path);
-
-    return err;
-}
-
-int parse_h_file(ImportTableEntry *import, ZigList<ErrorMsg *> *errors, const char *target_file,
-        CodeGen *codegen, AstNode *source_node)
-{
-    Context context = {0};
-    Context *c = &context;
-    c->warnings_on = codegen->verbose;
-    c->import = import;
-    c->errors = errors;
-    if (buf_ends_with_str(buf_create_from_str(target_file), ".h")) {
-        c->visib_mod = VisibModPub;
-        c->export_visib_mod = VisibModPub;
-    } else {
-        c->visib_mod = VisibModPub;
-        c->export_visib_mod = VisibModExport;
-    }
-    c->decl_table.init(8);
-    c->macro_table.init(8);
-    c->ptr_params.init(8);
-    c->codegen = codegen;
-    c->source_node = source_node;
-
-    ZigList<const char *> clang_argv = {0};
-
-    clang_argv.append("-x");
-    clang_argv.append("c");
-
-    if (c->codegen->is_native_target) {
+    if (codegen->is_native_target) {
         char *ZIG_PARSEC_CFLAGS = getenv("ZIG_NATIVE_PARSEC_CFLAGS");
         if (ZIG_PARSEC_CFLAGS) {
             Buf tmp_buf = BUF_INIT;
@@ -3201,82 +3165,136 @@ int parse_h_file(ImportTableEntry *import, ZigList<ErrorMsg *> *errors, const ch
             while (space) {
                 if (space - start > 0) {
                     buf_init_from_mem(&tmp_buf, start, space - start);
-                    clang_argv.append(buf_ptr(buf_create_from_buf(&tmp_buf)));
+                    clang_argv->append(buf_ptr(buf_create_from_buf(&tmp_buf)));
                 }
                 start = space + 1;
                 space = strstr(start, " ");
             }
             buf_init_from_str(&tmp_buf, start);
-            clang_argv.append(buf_ptr(buf_create_from_buf(&tmp_buf)));
+            clang_argv->append(buf_ptr(buf_create_from_buf(&tmp_buf)));
         }
     }
 
-    clang_argv.append("-isystem");
-    clang_argv.append(buf_ptr(codegen->zig_c_headers_dir));
+    clang_argv->append("-isystem");
+    clang_argv->append(buf_ptr(codegen->zig_c_headers_dir));
 
-    clang_argv.append("-isystem");
-    clang_argv.append(buf_ptr(codegen->libc_include_dir));
+    clang_argv->append("-isystem");
+    clang_argv->append(buf_ptr(codegen->libc_include_dir));
 
     // windows c runtime requires -D_DEBUG if using debug libraries
-    if (codegen->build_mode == BuildModeDebug) {
-        clang_argv.append("-D_DEBUG");
+    if (build_mode_is_debug(codegen->build_mode)) {
+        clang_argv->append("-D_DEBUG");
     }
 
     for (size_t i = 0; i < codegen->clang_argv_len; i += 1) {
-        clang_argv.append(codegen->clang_argv[i]);
+        clang_argv->append(codegen->clang_argv[i]);
     }
 
     // we don't need spell checking and it slows things down
-    clang_argv.append("-fno-spell-checking");
+    clang_argv->append("-fno-spell-checking");
 
     // this gives us access to preprocessing entities, presumably at
     // the cost of performance
-    clang_argv.append("-Xclang");
-    clang_argv.append("-detailed-preprocessing-record");
+    clang_argv->append("-Xclang");
+    clang_argv->append("-detailed-preprocessing-record");
 
-    if (!c->codegen->is_native_target) {
-        clang_argv.append("-target");
-        clang_argv.append(buf_ptr(&c->codegen->triple_str));
+    if (!codegen->is_native_target) {
+        clang_argv->append("-target");
+        clang_argv->append(buf_ptr(&codegen->triple_str));
     }
+}
 
-    clang_argv.append(target_file);
+// The command line is parsed once per compilation. Every translation starts from a
+// copy of that invocation, and all of them share one file manager so that headers
+// which were already looked up are served from its cache.
+struct ParsecState {
+    std::shared_ptr<CompilerInvocation> invocation;
+    IntrusiveRefCntPtr<FileManager> file_manager;
+    size_t virtual_file_count;
+};
+
+static ParsecState *get_parsec_state(CodeGen *codegen) {
+    if (codegen->parsec_state != nullptr)
+        return codegen->parsec_state;
 
-    // to make the [start...end] argument work
-    clang_argv.append(nullptr);
+    ZigList<const char *> clang_argv = {0};
+    get_clang_argv(codegen, &clang_argv);
+    // the driver wants an input file; each translation replaces it with its own
+    clang_argv.append("cimport.h");
+
+    IntrusiveRefCntPtr<DiagnosticsEngine> diags(CompilerInstance::createDiagnostics(new DiagnosticOptions));
+    std::shared_ptr<CompilerInvocation> invocation(createInvocationFromCommandLine(
+            llvm::makeArrayRef(clang_argv.items, clang_argv.length), diags));
+    clang_argv.deinit();
+    if (!invocation)
+        return nullptr;
+    invocation->getHeaderSearchOpts().ResourceDir = buf_ptr(codegen->zig_c_headers_dir);
+
+    ParsecState *state = new ParsecState();
+    state->invocation = invocation;
+    state->file_manager = new FileManager(invocation->getFileSystemOpts());
+    codegen->parsec_state = state;
+    return state;
+}
+
+// contents is null if target_file should be read from disk
+static int translate_h_file(ImportTableEntry *import, ZigList<ErrorMsg *> *errors, const char *target_file,
+        Buf *contents, CodeGen *codegen, AstNode *source_node, ZigList<Buf *> *out_header_paths)
+{
+    Context context = {0};
+    Context *c = &context;
+    c->warnings_on = codegen->verbose;
+    c->import = import;
+    c->errors = errors;
+    if (buf_ends_with_str(buf_create_from_str(target_file), ".h")) {
+        c->visib_mod = VisibModPub;
+        c->export_visib_mod = VisibModPub;
+    } else {
+        c->visib_mod = VisibModPub;
+        c->export_visib_mod = VisibModExport;
+    }
+    c->decl_table.init(8);
+    c->macro_table.init(8);
+    c->ptr_params.init(8);
+    c->codegen = codegen;
+    c->source_node = source_node;
+
+    ParsecState *state = get_parsec_state(codegen);
+    if (state == nullptr) {
+        return ErrorFileSystem;
+    }
+
+    std::shared_ptr<CompilerInvocation> invocation = std::make_shared<CompilerInvocation>(*state->invocation);
+    FrontendOptions &frontend_opts = invocation->getFrontendOpts();
+    InputKind input_kind = frontend_opts.Inputs[0].getKind();
+    frontend_opts.Inputs.clear();
+    frontend_opts.Inputs.push_back(FrontendInputFile(target_file, input_kind));
+    if (contents != nullptr) {
+        // the ASTUnit takes ownership of the buffer
+        std::unique_ptr<llvm::MemoryBuffer> buffer = llvm::MemoryBuffer::getMemBufferCopy(
+                StringRef(buf_ptr(contents), buf_len(contents)), target_file);
+        invocation->getPreprocessorOpts().addRemappedFile(target_file, buffer.release());
+    }
 
     IntrusiveRefCntPtr<DiagnosticsEngine> diags(CompilerInstance::createDiagnostics(new DiagnosticOptions));
 
     std::shared_ptr<PCHContainerOperations> pch_container_ops = std::make_shared<PCHContainerOperations>();
 
-    bool skip_function_bodies = false;
     bool only_local_decls = true;
     bool capture_diagnostics = true;
     bool user_files_are_volatile = true;
-    bool allow_pch_with_compiler_errors = false;
-    bool single_file_parse = false;
-    bool for_serialization = false;
-    const char *resources_path = buf_ptr(codegen->zig_c_headers_dir);
-    std::unique_ptr<ASTUnit> err_unit;
-    std::unique_ptr<ASTUnit> ast_unit(ASTUnit::LoadFromCommandLine(
-            &clang_argv.at(0), &clang_argv.last(),
-            pch_container_ops, diags, resources_path,
-            only_local_decls, capture_diagnostics, None, true, 0, TU_Complete,
-            false, false, allow_pch_with_compiler_errors, skip_function_bodies,
-            single_file_parse, user_files_are_volatile, for_serialization, None, &err_unit,
-            nullptr));
-
-    // Early failures in LoadFromCommandLine may return with ErrUnit unset.
-    if (!ast_unit && !err_unit) {
+    std::unique_ptr<ASTUnit> ast_unit(ASTUnit::LoadFromCompilerInvocation(invocation,
+            pch_container_ops, diags, state->file_manager.get(),
+            only_local_decls, capture_diagnostics, 0, TU_Complete,
+            false, false, user_files_are_volatile));
+
+    if (!ast_unit) {
         return ErrorFileSystem;
     }
 
     if (diags->getClient()->getNumErrors() > 0) {
-        if (ast_unit) {
-            err_unit = std::move(ast_unit);
-        }
-
-        for (ASTUnit::stored_diag_iterator it = err_unit->stored_diag_begin(),
-                it_end = err_unit->stored_diag_end();
+        for (ASTUnit::stored_diag_iterator it = ast_unit->stored_diag_begin(),
+                it_end = ast_unit->stored_diag_end();
                 it != it_end; ++it)
         {
             switch (it->getLevel()) {
@@ -3333,5 +3351,62 @@ int parse_h_file(ImportTableEntry *import, ZigList<ErrorMsg *> *errors, const ch
 
     import->root = c->root;
 
+    if (out_header_paths != nullptr) {
+        for (SourceManager::fileinfo_iterator it = c->source_manager->fileinfo_begin(),
+                it_end = c->source_manager->fileinfo_end();
+                it != it_end; ++it)
+        {
+            StringRef name = it->first->getName();
+            Buf *path = buf_create_from_mem((const char *)name.bytes_begin(), name.size());
+            if (!buf_eql_str(path, target_file)) {
+                out_header_paths->append(path);
+            }
+        }
+    }
+
     return 0;
 }
+
+int parse_h_file(ImportTableEntry *import, ZigList<ErrorMsg *> *errors, const char *target_file,
+        CodeGen *codegen, AstNode *source_node)
+{
+    return translate_h_file(import, errors, target_file, nullptr, codegen, source_node, nullptr);
+}
+
+int parse_h_buf(ImportTableEntry *import, ZigList<ErrorMsg *> *errors, Buf *source,
+        CodeGen *codegen, AstNode *source_node)
+{
+    ZigList<const char *> clang_argv = {0};
+    get_clang_argv(codegen, &clang_argv);
+    Buf cache_key = BUF_INIT;
+    c_import_cache_key(codegen, source, &clang_argv, &cache_key);
+    clang_argv.deinit();
+    bool hit = c_import_cache_get(codegen, &cache_key, import, &codegen->dep_input_paths);
+    if (codegen->verbose_cache) {
+        fprintf(stderr, "cimport cache %s: %s:%" ZIG_PRI_usize "\n", hit ? "hit" : "miss",
+                buf_ptr(source_node->owner->path), source_node->line + 1);
+    }
+    if (hit) {
+        return 0;
+    }
+
+    ParsecState *state = get_parsec_state(codegen);
+    if (state == nullptr) {
+        return ErrorFileSystem;
+    }
+    // the source is handed to clang from memory under a name which no other block uses
+    Buf *virtual_path = buf_sprintf("cimport%" ZIG_PRI_usize ".h", state->virtual_file_count);
+    state->virtual_file_count += 1;
+
+    ZigList<Buf *> header_paths = {0};
+    int err = translate_h_file(import, errors, buf_ptr(virtual_path), source, codegen, source_node, &header_paths);
+
+    if (!err && errors->length == 0) {
+        c_import_cache_put(codegen, &cache_key, import, &header_paths);
+        for (size_t i = 0; i < header_paths.length; i += 1) {
+            codegen->dep_input_paths.append(header_paths.at(i));
+        }
+    }
+
+    return err;
+}
@@ -12,6 +12,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <limits.h>
+#include <mutex>
 #include <errno.h>
 
 struct ParseContext {
@@ -20,8 +21,12 @@ struct ParseContext {
     ZigList<Token> *tokens;
     ImportTableEntry *owner;
     ErrColor err_color;
+    Arena *arena;
+    HashMap<Buf *, InternedStr *, buf_hash, buf_eql_buf> *intern_table;
     // These buffers are used freqently so we preallocate them once here.
     Buf *void_buf;
+    // holds the name of a symbol while it is looked up in intern_table
+    Buf *symbol_buf;
 };
 
 ATTRIBUTE_PRINTF(4, 5)
@@ -55,17 +60,19 @@ static void ast_error(ParseContext *pc, Token *token, const char *format, ...) {
     va_end(ap);
 
 
-    ErrorMsg *err = err_msg_create_with_line(pc->owner->path, token->start_line, token->start_column,
+    size_t line, column;
+    token_line_column(pc->owner->line_offsets, token->start_pos, &line, &column);
+    ErrorMsg *err = err_msg_create_with_line(pc->owner->path, line, column,
             pc->owner->source_code, pc->owner->line_offsets, msg);
-    err->line_start = token->start_line;
-    err->column_start = token->start_column;
+    err->line_start = line;
+    err->column_start = column;
 
     print_err_msg(err, pc->err_color);
     exit(EXIT_FAILURE);
 }
 
 static AstNode *ast_create_node_no_line_info(ParseContext *pc, NodeType type) {
-    AstNode *node = allocate<AstNode>(1);
+    AstNode *node = arena_allocate<AstNode>(pc->arena, 1);
     node->type = type;
     node->owner = pc->owner;
     return node;
@@ -73,8 +80,7 @@ static AstNode *ast_create_node_no_line_info(ParseContext *pc, NodeType type) {
 
 static void ast_update_node_line_info(AstNode *node, Token *first_token) {
     assert(first_token);
-    node->line = first_token->start_line;
-    node->column = first_token->start_column;
+    token_line_column(node->owner->line_offsets, first_token->start_pos, &node->line, &node->column);
 }
 
 static AstNode *ast_create_node(ParseContext *pc, NodeType type, Token *first_token) {
@@ -177,29 +183,50 @@ static void parse_asm_template(ParseContext *pc, AstNode *node) {
     }
 }
 
-static Buf *token_buf(Token *token) {
-    assert(token->id == TokenIdStringLiteral || token->id == TokenIdSymbol);
-    return &token->data.str_lit.str;
-}
+// The intern table is shared by every CodeGen of the process, and the IR gen
+// workers intern the names of C declarations and of builtin lookups.
+static std::mutex intern_table_mutex;
+
+InternedStr *intern_str(HashMap<Buf *, InternedStr *, buf_hash, buf_eql_buf> *intern_table, Buf *str) {
+    if (str->interned)
+        return str->interned;
+
+    std::lock_guard<std::mutex> lock(intern_table_mutex);
+    bool found_existing;
+    auto entry = intern_table->get_or_put(str, &found_existing);
+    if (found_existing)
+        return entry->value;
 
-static BigInt *token_bigint(Token *token) {
-    assert(token->id == TokenIdIntLiteral);
-    return &token->data.int_lit.bigint;
+    InternedStr *interned = allocate<InternedStr>(1);
+    buf_init_from_buf(&interned->buf, str);
+    interned->hash = buf_hash(str);
+    interned->buf.interned = interned;
+    entry->key = &interned->buf;
+    entry->value = interned;
+    return interned;
 }
 
-static BigFloat *token_bigfloat(Token *token) {
-    assert(token->id == TokenIdFloatLiteral);
-    return &token->data.float_lit.bigfloat;
+static Buf *token_buf(ParseContext *pc, Token *token) {
+    assert(token->id == TokenIdStringLiteral || token->id == TokenIdSymbol);
+    bool is_c_str;
+    if (token->id == TokenIdSymbol) {
+        token_str_lit(pc->buf, token, pc->symbol_buf, &is_c_str);
+        return &intern_str(pc->intern_table, pc->symbol_buf)->buf;
+    }
+    Buf *str = buf_alloc();
+    token_str_lit(pc->buf, token, str, &is_c_str);
+    return str;
 }
 
-static uint8_t token_char_lit(Token *token) {
-    assert(token->id == TokenIdCharLiteral);
-    return token->data.char_lit.c;
+static BigInt *token_bigint(ParseContext *pc, Token *token) {
+    BigInt *bigint = arena_allocate<BigInt>(pc->arena, 1);
+    token_int_lit(pc->buf, token, bigint);
+    return bigint;
 }
 
 static void ast_buf_from_token(ParseContext *pc, Token *token, Buf *buf) {
     if (token->id == TokenIdSymbol) {
-        buf_init_from_buf(buf, token_buf(token));
+        buf_init_from_buf(buf, token_buf(pc, token));
     } else {
         buf_init_from_mem(buf, buf_ptr(pc->buf) + token->start_pos, token->end_pos - token->start_pos);
     }
@@ -280,7 +307,7 @@ static AstNode *ast_parse_param_decl(ParseContext *pc, size_t *token_index) {
     if (token->id == TokenIdSymbol) {
         Token *next_token = &pc->tokens->at(*token_index + 1);
         if (next_token->id == TokenIdColon) {
-            node->data.param_decl.name = token_buf(token);
+            node->data.param_decl.name = token_buf(pc, token);
             *token_index += 2;
         }
     }
@@ -440,8 +467,8 @@ static void ast_parse_asm_input_item(ParseContext *pc, size_t *token_index, AstN
     ast_eat_token(pc, token_index, TokenIdRParen);
 
     AsmInput *asm_input = allocate<AsmInput>(1);
-    asm_input->asm_symbolic_name = token_buf(alias);
-    asm_input->constraint = token_buf(constraint);
+    asm_input->asm_symbolic_name = token_buf(pc, alias);
+    asm_input->constraint = token_buf(pc, constraint);
     asm_input->expr = expr_node;
     node->data.asm_expr.input_list.append(asm_input);
 }
@@ -463,7 +490,7 @@ static void ast_parse_asm_output_item(ParseContext *pc, size_t *token_index, Ast
     Token *token = &pc->tokens->at(*token_index);
     *token_index += 1;
     if (token->id == TokenIdSymbol) {
-        asm_output->variable_name = token_buf(token);
+        asm_output->variable_name = token_buf(pc, token);
     } else if (token->id == TokenIdArrow) {
         asm_output->return_type = ast_parse_type_expr(pc, token_index, true);
     } else {
@@ -472,8 +499,8 @@ static void ast_parse_asm_output_item(ParseContext *pc, size_t *token_index, Ast
 
     ast_eat_token(pc, token_index, TokenIdRParen);
 
-    asm_output->asm_symbolic_name = token_buf(alias);
-    asm_output->constraint = token_buf(constraint);
+    asm_output->asm_symbolic_name = token_buf(pc, alias);
+    asm_output->constraint = token_buf(pc, constraint);
     node->data.asm_expr.output_list.append(asm_output);
 }
 
@@ -493,7 +520,7 @@ static void ast_parse_asm_clobbers(ParseContext *pc, size_t *token_index, AstNod
         ast_expect_token(pc, string_tok, TokenIdStringLiteral);
         *token_index += 1;
 
-        Buf *clobber_buf = token_buf(string_tok);
+        Buf *clobber_buf = token_buf(pc, string_tok);
         node->data.asm_expr.clobber_list.append(clobber_buf);
 
         Token *comma = &pc->tokens->at(*token_index);
@@ -622,7 +649,7 @@ static AstNode *ast_parse_asm_expr(ParseContext *pc, size_t *token_index, bool m
 
     Token *template_tok = ast_eat_token(pc, token_index, TokenIdStringLiteral);
 
-    node->data.asm_expr.asm_template = token_buf(template_tok);
+    node->data.asm_expr.asm_template = token_buf(pc, template_tok);
     parse_asm_template(pc, node);
 
     ast_parse_asm_output(pc, token_index, node);
@@ -649,7 +676,7 @@ static AstNode *ast_parse_goto_expr(ParseContext *pc, size_t *token_index, bool
     AstNode *node = ast_create_node(pc, NodeTypeGoto, goto_token);
 
     Token *dest_symbol = ast_eat_token(pc, token_index, TokenIdSymbol);
-    node->data.goto_expr.name = token_buf(dest_symbol);
+    node->data.goto_expr.name = token_buf(pc, dest_symbol);
     return node;
 }
 
@@ -684,24 +711,24 @@ static AstNode *ast_parse_primary_expr(ParseContext *pc, size_t *token_index, bo
 
     if (token->id == TokenIdIntLiteral) {
         AstNode *node = ast_create_node(pc, NodeTypeIntLiteral, token);
-        node->data.int_literal.bigint = token_bigint(token);
+        node->data.int_literal.bigint = token_bigint(pc, token);
         *token_index += 1;
         return node;
     } else if (token->id == TokenIdFloatLiteral) {
         AstNode *node = ast_create_node(pc, NodeTypeFloatLiteral, token);
-        node->data.float_literal.bigfloat = token_bigfloat(token);
-        node->data.float_literal.overflow = token->data.float_lit.overflow;
+        node->data.float_literal.bigfloat = arena_allocate<BigFloat>(pc->arena, 1);
+        node->data.float_literal.overflow = token_float_lit(pc->buf, token, node->data.float_literal.bigfloat);
         *token_index += 1;
         return node;
     } else if (token->id == TokenIdStringLiteral) {
         AstNode *node = ast_create_node(pc, NodeTypeStringLiteral, token);
-        node->data.string_literal.buf = token_buf(token);
-        node->data.string_literal.c = token->data.str_lit.is_c_str;
+        node->data.string_literal.buf = buf_alloc();
+        token_str_lit(pc->buf, token, node->data.string_literal.buf, &node->data.string_literal.c);
         *token_index += 1;
         return node;
     } else if (token->id == TokenIdCharLiteral) {
         AstNode *node = ast_create_node(pc, NodeTypeCharLiteral, token);
-        node->data.char_literal.value = token_char_lit(token);
+        node->data.char_literal.value = token_char_lit(pc->buf, token);
         *token_index += 1;
         return node;
     } else if (token->id == TokenIdKeywordTrue) {
@@ -742,7 +769,7 @@ static AstNode *ast_parse_primary_expr(ParseContext *pc, size_t *token_index, bo
         *token_index += 1;
         Token *name_tok = ast_eat_token(pc, token_index, TokenIdSymbol);
         AstNode *name_node = ast_create_node(pc, NodeTypeSymbol, name_tok);
-        name_node->data.symbol_expr.symbol = token_buf(name_tok);
+        name_node->data.symbol_expr.symbol = token_buf(pc, name_tok);
 
         AstNode *node = ast_create_node(pc, NodeTypeFnCallExpr, token);
         node->data.fn_call_expr.fn_ref_expr = name_node;
@@ -754,7 +781,7 @@ static AstNode *ast_parse_primary_expr(ParseContext *pc, size_t *token_index, bo
     } else if (token->id == TokenIdSymbol) {
         *token_index += 1;
         AstNode *node = ast_create_node(pc, NodeTypeSymbol, token);
-        node->data.symbol_expr.symbol = token_buf(token);
+        node->data.symbol_expr.symbol = token_buf(pc, token);
         return node;
     }
 
@@ -834,7 +861,7 @@ static AstNode *ast_parse_curly_suffix_expr(ParseContext *pc, size_t *token_inde
 
                         AstNode *field_node = ast_create_node(pc, NodeTypeStructValueField, token);
 
-                        field_node->data.struct_val_field.name = token_buf(field_name_tok);
+                        field_node->data.struct_val_field.name = token_buf(pc, field_name_tok);
                         field_node->data.struct_val_field.expr = ast_parse_expression(pc, token_index, true);
 
                         node->data.container_init_expr.entries.append(field_node);
@@ -949,7 +976,7 @@ static AstNode *ast_parse_suffix_op_expr(ParseContext *pc, size_t *token_index,
 
             AstNode *node = ast_create_node(pc, NodeTypeFieldAccessExpr, first_token);
             node->data.field_access_expr.struct_expr = primary_expr;
-            node->data.field_access_expr.field_name = token_buf(name_token);
+            node->data.field_access_expr.field_name = token_buf(pc, name_token);
 
             primary_expr = node;
         } else {
@@ -992,8 +1019,8 @@ static AstNode *ast_parse_addr_of(ParseContext *pc, size_t *token_index) {
             ast_eat_token(pc, token_index, TokenIdColon);
             Token *bit_offset_end_tok = ast_eat_token(pc, token_index, TokenIdIntLiteral);
 
-            node->data.addr_of_expr.bit_offset_start = token_bigint(bit_offset_start_tok);
-            node->data.addr_of_expr.bit_offset_end = token_bigint(bit_offset_end_tok);
+            node->data.addr_of_expr.bit_offset_start = token_bigint(pc, bit_offset_start_tok);
+            node->data.addr_of_expr.bit_offset_end = token_bigint(pc, bit_offset_end_tok);
         }
         ast_eat_token(pc, token_index, TokenIdRParen);
         token = &pc->tokens->at(*token_index);
@@ -1426,17 +1453,17 @@ static AstNode *ast_parse_if_try_test_expr(ParseContext *pc, size_t *token_index
         node->data.try_expr.target_node = condition;
         node->data.try_expr.var_is_ptr = var_is_ptr;
         if (var_name_tok != nullptr) {
-            node->data.try_expr.var_symbol = token_buf(var_name_tok);
+            node->data.try_expr.var_symbol = token_buf(pc, var_name_tok);
         }
         node->data.try_expr.then_node = body_node;
-        node->data.try_expr.err_symbol = token_buf(err_name_tok);
+        node->data.try_expr.err_symbol = token_buf(pc, err_name_tok);
         node->data.try_expr.else_node = else_node;
         return node;
     } else if (var_name_tok != nullptr) {
         AstNode *node = ast_create_node(pc, NodeTypeTestExpr, if_token);
         node->data.test_expr.target_node = condition;
         node->data.test_expr.var_is_ptr = var_is_ptr;
-        node->data.test_expr.var_symbol = token_buf(var_name_tok);
+        node->data.test_expr.var_symbol = token_buf(pc, var_name_tok);
         node->data.test_expr.then_node = body_node;
         node->data.test_expr.else_node = else_node;
         return node;
@@ -1582,7 +1609,7 @@ static AstNode *ast_parse_variable_declaration_expr(ParseContext *pc, size_t *to
     node->data.variable_declaration.visib_mod = visib_mod;
 
     Token *name_token = ast_eat_token(pc, token_index, TokenIdSymbol);
-    node->data.variable_declaration.symbol = token_buf(name_token);
+    node->data.variable_declaration.symbol = token_buf(pc, name_token);
 
     Token *next_token = &pc->tokens->at(*token_index);
 
@@ -1684,7 +1711,7 @@ static AstNode *ast_parse_while_expr(ParseContext *pc, size_t *token_index, bool
         }
 
         Token *var_name_tok = ast_eat_token(pc, token_index, TokenIdSymbol);
-        node->data.while_expr.var_symbol = token_buf(var_name_tok);
+        node->data.while_expr.var_symbol = token_buf(pc, var_name_tok);
         ast_eat_token(pc, token_index, TokenIdBinOr);
     }
 
@@ -1707,7 +1734,7 @@ static AstNode *ast_parse_while_expr(ParseContext *pc, size_t *token_index, bool
             *token_index += 1;
 
             Token *err_name_tok = ast_eat_token(pc, token_index, TokenIdSymbol);
-            node->data.while_expr.err_symbol = token_buf(err_name_tok);
+            node->data.while_expr.err_symbol = token_buf(pc, err_name_tok);
 
             ast_eat_token(pc, token_index, TokenIdBinOr);
         }
@@ -1721,7 +1748,7 @@ static AstNode *ast_parse_while_expr(ParseContext *pc, size_t *token_index, bool
 static AstNode *ast_parse_symbol(ParseContext *pc, size_t *token_index) {
     Token *token = ast_eat_token(pc, token_index, TokenIdSymbol);
     AstNode *node = ast_create_node(pc, NodeTypeSymbol, token);
-    node->data.symbol_expr.symbol = token_buf(token);
+    node->data.symbol_expr.symbol = token_buf(pc, token);
     return node;
 }
 
@@ -2107,7 +2134,7 @@ static AstNode *ast_parse_label(ParseContext *pc, size_t *token_index, bool mand
     *token_index += 2;
 
     AstNode *node = ast_create_node(pc, NodeTypeLabel, symbol_token);
-    node->data.label.name = token_buf(symbol_token);
+    node->data.label.name = token_buf(pc, symbol_token);
     return node;
 }
 
@@ -2243,7 +2270,7 @@ static AstNode *ast_parse_fn_proto(ParseContext *pc, size_t *token_index, bool m
 
     if (fn_name->id == TokenIdSymbol) {
         *token_index += 1;
-        node->data.fn_proto.name = token_buf(fn_name);
+        node->data.fn_proto.name = token_buf(pc, fn_name);
     } else {
         node->data.fn_proto.name = nullptr;
     }
@@ -2330,7 +2357,7 @@ static AstNode *ast_parse_extern_decl(ParseContext *pc, size_t *token_index, boo
     Token *lib_name_tok = &pc->tokens->at(*token_index);
     Buf *lib_name = nullptr;
     if (lib_name_tok->id == TokenIdStringLiteral) {
-        lib_name = token_buf(lib_name_tok);
+        lib_name = token_buf(pc, lib_name_tok);
         *token_index += 1;
     }
 
@@ -2453,7 +2480,7 @@ static AstNode *ast_parse_container_decl(ParseContext *pc, size_t *token_index,
             *token_index += 1;
 
             field_node->data.struct_field.visib_mod = visib_mod;
-            field_node->data.struct_field.name = token_buf(token);
+            field_node->data.struct_field.name = token_buf(pc, token);
 
             Token *token = &pc->tokens->at(*token_index);
             if (token->id == TokenIdComma || token->id == TokenIdRBrace) {
@@ -2500,7 +2527,7 @@ static AstNode *ast_parse_error_value_decl(ParseContext *pc, size_t *token_index
     ast_eat_token(pc, token_index, TokenIdSemicolon);
 
     AstNode *node = ast_create_node(pc, NodeTypeErrorValueDecl, first_token);
-    node->data.error_value_decl.name = token_buf(name_tok);
+    node->data.error_value_decl.name = token_buf(pc, name_tok);
 
     return node;
 }
@@ -2519,7 +2546,7 @@ static AstNode *ast_parse_test_decl_node(ParseContext *pc, size_t *token_index)
     Token *name_tok = ast_eat_token(pc, token_index, TokenIdStringLiteral);
 
     AstNode *node = ast_create_node(pc, NodeTypeTestDecl, first_token);
-    node->data.test_decl.name = token_buf(name_tok);
+    node->data.test_decl.name = token_buf(pc, name_tok);
     node->data.test_decl.body = ast_parse_block(pc, token_index, true);
 
     return node;
@@ -2607,11 +2634,14 @@ static AstNode *ast_parse_root(ParseContext *pc, size_t *token_index) {
 }
 
 AstNode *ast_parse(Buf *buf, ZigList<Token> *tokens, ImportTableEntry *owner,
-        ErrColor err_color)
+        ErrColor err_color, Arena *arena, HashMap<Buf *, InternedStr *, buf_hash, buf_eql_buf> *intern_table)
 {
     ParseContext pc = {0};
-    pc.void_buf = buf_create_from_str("void");
+    pc.void_buf = &intern_str(intern_table, buf_create_from_str("void"))->buf;
+    pc.symbol_buf = buf_alloc();
     pc.err_color = err_color;
+    pc.arena = arena;
+    pc.intern_table = intern_table;
     pc.owner = owner;
     pc.buf = buf;
     pc.tokens = tokens;
@@ -2752,13 +2782,16 @@ void ast_visit_node_children(AstNode *node, void (*visit)(AstNode **, void *cont
             break;
         case NodeTypeWhileExpr:
             visit_field(&node->data.while_expr.condition, visit, context);
+            visit_field(&node->data.while_expr.continue_expr, visit, context);
             visit_field(&node->data.while_expr.body, visit, context);
+            visit_field(&node->data.while_expr.else_node, visit, context);
             break;
         case NodeTypeForExpr:
             visit_field(&node->data.for_expr.elem_node, visit, context);
             visit_field(&node->data.for_expr.array_expr, visit, context);
             visit_field(&node->data.for_expr.index_node, visit, context);
             visit_field(&node->data.for_expr.body, visit, context);
+            visit_field(&node->data.for_expr.else_node, visit, context);
             break;
         case NodeTypeSwitchExpr:
             visit_field(&node->data.switch_expr.expr, visit, context);
@@ -2783,7 +2816,7 @@ void ast_visit_node_children(AstNode *node, void (*visit)(AstNode **, void *cont
             visit_field(&node->data.comptime_expr.expr, visit, context);
             break;
         case NodeTypeBreak:
-            // none
+            visit_field(&node->data.break_expr.expr, visit, context);
             break;
         case NodeTypeContinue:
             // none
@@ -2802,6 +2835,7 @@ void ast_visit_node_children(AstNode *node, void (*visit)(AstNode **, void *cont
             }
             break;
         case NodeTypeContainerDecl:
+            visit_field(&node->data.container_decl.init_arg_expr, visit, context);
             visit_node_list(&node->data.container_decl.fields, visit, context);
             visit_node_list(&node->data.container_decl.decls, visit, context);
             break;
@@ -17,7 +17,13 @@ void ast_token_error(Token *token, const char *format, ...);
 
 
 // This function is provided by generated code, generated by parsergen.cpp
-AstNode * ast_parse(Buf *buf, ZigList<Token> *tokens, ImportTableEntry *owner, ErrColor err_color);
+AstNode * ast_parse(Buf *buf, ZigList<Token> *tokens, ImportTableEntry *owner, ErrColor err_color, Arena *arena,
+        HashMap<Buf *, InternedStr *, buf_hash, buf_eql_buf> *intern_table);
+
+// Returns the InternedStr with the contents of str, making it if there is none yet.
+// str is copied and can be modified afterwards; the InternedStr must not be. Safe to
+// call from any thread.
+InternedStr *intern_str(HashMap<Buf *, InternedStr *, buf_hash, buf_eql_buf> *intern_table, Buf *str);
 
 void ast_print(AstNode *node, int indent);
 
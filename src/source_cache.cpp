@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "source_cache.hpp"
+#include "all_types.hpp"
+#include "hash_map.hpp"
+#include "parser.hpp"
+
+static HashMap<Buf *, SourceFile *, buf_hash, buf_eql_buf> source_files;
+static bool source_files_init = false;
+
+// the nodes of parsed_import, which outlive the CodeGen that takes them over
+static Arena parse_arena;
+static HashMap<Buf *, InternedStr *, buf_hash, buf_eql_buf> intern_table;
+static bool intern_table_init = false;
+
+HashMap<Buf *, InternedStr *, buf_hash, buf_eql_buf> *source_cache_intern_table(void) {
+    if (!intern_table_init) {
+        intern_table.init(1024);
+        intern_table_init = true;
+    }
+    return &intern_table;
+}
+
+int source_cache_fetch(Buf *abs_full_path, SourceFile **out_file) {
+    if (!source_files_init) {
+        source_files.init(256);
+        source_files_init = true;
+    }
+
+    int err;
+    OsTimeStamp mtime;
+    auto entry = source_files.maybe_get(abs_full_path);
+    if (entry != nullptr) {
+        SourceFile *source_file = entry->value;
+        if ((err = os_file_mtime(abs_full_path, &mtime)))
+            return err;
+        if (mtime.sec == source_file->mtime.sec && mtime.nsec == source_file->mtime.nsec) {
+            *out_file = source_file;
+            return 0;
+        }
+    }
+
+    // Imports of an older version of the file may still point at the old entry,
+    // so it is replaced rather than updated.
+    SourceFile *source_file = allocate<SourceFile>(1);
+    source_file->path = buf_create_from_buf(abs_full_path);
+    // not buf_alloc, the mapping replaces the memory of the list
+    source_file->contents = allocate<Buf>(1);
+    if ((err = os_map_file_path(abs_full_path, source_file->contents, &source_file->mtime,
+                    &source_file->is_mapped)))
+    {
+        return err;
+    }
+    source_files.put(source_file->path, source_file);
+    *out_file = source_file;
+    return 0;
+}
+
+int source_cache_revalidate(SourceFile *source_file) {
+    if (!source_file->is_mapped)
+        return 0;
+    int err;
+    OsTimeStamp mtime;
+    uint64_t size;
+    if ((err = os_file_stat(source_file->path, &mtime, &size)))
+        return err;
+    if (size != buf_len(source_file->contents) || mtime.sec != source_file->mtime.sec ||
+        mtime.nsec != source_file->mtime.nsec)
+    {
+        return ErrorFileChanged;
+    }
+    return 0;
+}
+
+SourceFile *source_cache_get(Buf *abs_full_path, Buf *source_code) {
+    if (!source_files_init)
+        return nullptr;
+    auto entry = source_files.maybe_get(abs_full_path);
+    if (entry == nullptr || entry->value->contents != source_code)
+        return nullptr;
+    return entry->value;
+}
+
+size_t source_cache_preload_dir(Buf *dir_path) {
+    ZigList<OsDirEntry> entries = {0};
+    if (os_list_dir(dir_path, &entries))
+        return 0;
+
+    size_t count = 0;
+    for (size_t i = 0; i < entries.length; i += 1) {
+        OsDirEntry *entry = &entries.at(i);
+        Buf *full_path = buf_alloc();
+        os_path_join(dir_path, entry->name, full_path);
+        if (entry->is_dir) {
+            count += source_cache_preload_dir(full_path);
+            continue;
+        }
+        if (!buf_ends_with_str(entry->name, ".zig"))
+            continue;
+
+        SourceFile *source_file;
+        if (source_cache_fetch(full_path, &source_file))
+            continue;
+        if (source_cache_revalidate(source_file))
+            continue;
+        count += 1;
+        if (source_file->tokenization != nullptr)
+            continue;
+        // files with errors are tokenized again when imported, which reports the error
+        Tokenization tokenization = {0};
+        tokenize(source_file->contents, &tokenization);
+        if (tokenization.err)
+            continue;
+        source_file->tokenization = allocate<Tokenization>(1);
+        *source_file->tokenization = tokenization;
+    }
+    entries.deinit();
+    return count;
+}
+
+void source_cache_parse_preloaded(void) {
+    if (!source_files_init)
+        return;
+    auto it = source_files.entry_iterator();
+    for (;;) {
+        auto *entry = it.next();
+        if (!entry)
+            break;
+        SourceFile *source_file = entry->value;
+        if (source_file->tokenization == nullptr || source_file->parsed_import != nullptr)
+            continue;
+        if (source_cache_revalidate(source_file))
+            continue;
+        ImportTableEntry *import_entry = allocate<ImportTableEntry>(1);
+        import_entry->source_code = source_file->contents;
+        import_entry->line_offsets = source_file->tokenization->line_offsets;
+        import_entry->path = source_file->path;
+        import_entry->root = ast_parse(source_file->contents, source_file->tokenization->tokens, import_entry,
+                ErrColorAuto, &parse_arena, source_cache_intern_table());
+        source_file->parsed_import = import_entry;
+    }
+}
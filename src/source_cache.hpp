@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef ZIG_SOURCE_CACHE_HPP
+#define ZIG_SOURCE_CACHE_HPP
+
+#include "buffer.hpp"
+#include "hash_map.hpp"
+#include "os.hpp"
+#include "tokenizer.hpp"
+
+struct ImportTableEntry;
+
+// Process wide cache of source files, shared by every CodeGen including the ones
+// which build compiler_rt and builtin, so that each file of the standard library
+// is read and tokenized once per process.
+struct SourceFile {
+    Buf *path;
+    OsTimeStamp mtime;
+    // read-only, see os_map_file_path
+    Buf *contents;
+    // contents is a mapping of the file rather than a copy
+    bool is_mapped;
+    // null until the file is first tokenized
+    Tokenization *tokenization;
+    // Set by source_cache_parse_preloaded. Analysis keeps state in the import and in
+    // its nodes, so the first add_source_file of the file in a process takes it over
+    // and later ones parse the file again.
+    ImportTableEntry *parsed_import;
+};
+
+// The table of intern_str shared by every CodeGen of the process and by
+// source_cache_parse_preloaded. Interned names are never freed. Only intern_str,
+// which holds a lock, may use the table once it is made.
+HashMap<Buf *, InternedStr *, buf_hash, buf_eql_buf> *source_cache_intern_table(void);
+
+// abs_full_path must be a real path. The file is read again only if its
+// modification time changed since it was last fetched.
+int source_cache_fetch(Buf *abs_full_path, SourceFile **out_file);
+
+// Returns ErrorFileChanged if source_file is mapped and the file was modified since
+// it was mapped. Reading the contents of such a file could raise SIGBUS, so this
+// is called before the contents are tokenized and parsed. There is still a window
+// between the check and the reads, which only files of 16 KiB or more have.
+int source_cache_revalidate(SourceFile *source_file);
+
+// Returns the entry for abs_full_path if its contents are source_code, otherwise null.
+SourceFile *source_cache_get(Buf *abs_full_path, Buf *source_code);
+
+// Fetches and tokenizes every .zig file below dir_path, which must be a real path,
+// ahead of the compilations of a long running process. Returns the file count.
+size_t source_cache_preload_dir(Buf *dir_path);
+
+// Parses every tokenized file of the cache which is not parsed yet. A syntax error
+// exits the process like it does in add_source_file, so zig server tries this in
+// a fork of itself first.
+void source_cache_parse_preloaded(void);
+
+#endif
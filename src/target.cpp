@@ -290,6 +290,12 @@ int parse_target_environ(const char *str, ZigLLVM_EnvironmentType *out_environ)
 }
 
 void init_all_targets(void) {
+    // the compile server initializes the targets once for all of its commands
+    static bool initialized = false;
+    if (initialized)
+        return;
+    initialized = true;
+
     LLVMInitializeAllTargets();
     LLVMInitializeAllTargetInfos();
     LLVMInitializeAllTargetMCs();
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "time_report.hpp"
+#include "os.hpp"
+
+struct TimeReportEvent {
+    const char *category;
+    Buf *name;
+    double start_time;
+    double end_time;
+    size_t start_allocation_count;
+    size_t allocation_count;
+    // spent in the events nested inside this one
+    double child_time;
+    size_t child_allocation_count;
+};
+
+struct TimeReport {
+    Buf *trace_path;
+    ZigList<TimeReportEvent> events;
+    ZigList<size_t> open_events;
+};
+
+struct TimeReportEntry {
+    const char *category;
+    Buf *name;
+    size_t count;
+    double self_time;
+    size_t self_allocation_count;
+};
+
+// the number of entries time_report_finish prints
+static const size_t printed_entry_count = 30;
+
+TimeReport *time_report_create(Buf *trace_path) {
+    TimeReport *report = allocate<TimeReport>(1);
+    report->trace_path = trace_path;
+    count_allocations = true;
+    return report;
+}
+
+size_t time_report_begin(CodeGen *g, const char *category, Buf *name) {
+    TimeReport *report = g->time_report;
+    size_t event_index = report->events.length;
+    TimeReportEvent *event = report->events.add_one();
+    event->category = category;
+    event->name = name;
+    event->child_time = 0.0;
+    event->child_allocation_count = 0;
+    report->open_events.append(event_index);
+    event->start_allocation_count = allocation_count;
+    event->start_time = os_get_time();
+    return event_index;
+}
+
+void time_report_end(CodeGen *g, size_t event_index) {
+    double end_time = os_get_time();
+    TimeReport *report = g->time_report;
+    assert(report->open_events.last() == event_index);
+    report->open_events.pop();
+
+    TimeReportEvent *event = &report->events.at(event_index);
+    event->end_time = end_time;
+    event->allocation_count = allocation_count - event->start_allocation_count;
+    if (report->open_events.length != 0) {
+        TimeReportEvent *parent = &report->events.at(report->open_events.last());
+        parent->child_time += end_time - event->start_time;
+        parent->child_allocation_count += event->allocation_count;
+    }
+}
+
+static int compare_entries(const void *a, const void *b) {
+    const TimeReportEntry *entry_a = (const TimeReportEntry *)a;
+    const TimeReportEntry *entry_b = (const TimeReportEntry *)b;
+    if (entry_a->self_time > entry_b->self_time)
+        return -1;
+    if (entry_a->self_time < entry_b->self_time)
+        return 1;
+    return 0;
+}
+
+static void append_json_string(Buf *out, const char *str) {
+    buf_append_char(out, '"');
+    for (const char *c = str; *c != 0; c += 1) {
+        switch (*c) {
+            case '"':
+                buf_append_str(out, "\\\"");
+                break;
+            case '\\':
+                buf_append_str(out, "\\\\");
+                break;
+            default:
+                if ((uint8_t)*c < 0x20) {
+                    buf_appendf(out, "\\u%04x", (unsigned)*c);
+                } else {
+                    buf_append_char(out, *c);
+                }
+                break;
+        }
+    }
+    buf_append_char(out, '"');
+}
+
+static void append_trace_event(Buf *out, const char *category, const char *name, double start_time,
+        double end_time, double base_time, size_t allocation_count)
+{
+    if (buf_len(out) != 0 && buf_ptr(out)[buf_len(out) - 1] == '}')
+        buf_append_str(out, ",\n");
+    buf_append_str(out, "{\"cat\":");
+    append_json_string(out, category);
+    buf_append_str(out, ",\"name\":");
+    append_json_string(out, name);
+    // trace timestamps are in microseconds
+    buf_appendf(out, ",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+            "\"args\":{\"allocations\":%" ZIG_PRI_usize "}}",
+            (start_time - base_time) * 1000000.0, (end_time - start_time) * 1000000.0, allocation_count);
+}
+
+static void write_trace(CodeGen *g) {
+    TimeReport *report = g->time_report;
+    double base_time = g->timing_events.at(0).time;
+
+    Buf *out = buf_alloc();
+    buf_append_str(out, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i + 1 < g->timing_events.length; i += 1) {
+        TimeEvent *te = &g->timing_events.at(i);
+        TimeEvent *next_te = &g->timing_events.at(i + 1);
+        append_trace_event(out, "phase", te->name, te->time, next_te->time, base_time, 0);
+    }
+    for (size_t i = 0; i < report->events.length; i += 1) {
+        TimeReportEvent *event = &report->events.at(i);
+        append_trace_event(out, event->category, buf_ptr(event->name), event->start_time, event->end_time,
+                base_time, event->allocation_count);
+    }
+    buf_append_str(out, "\n]}\n");
+    os_write_file(report->trace_path, out);
+}
+
+void time_report_finish(CodeGen *g, FILE *f) {
+    TimeReport *report = g->time_report;
+    assert(report->open_events.length == 0);
+
+    // the same function or comptime call can be measured many times
+    HashMap<Buf *, size_t, buf_hash, buf_eql_buf> entry_index = {};
+    entry_index.init(256);
+    ZigList<TimeReportEntry> entries = {0};
+    for (size_t i = 0; i < report->events.length; i += 1) {
+        TimeReportEvent *event = &report->events.at(i);
+        Buf *key = buf_sprintf("%s %s", event->category, buf_ptr(event->name));
+        auto existing = entry_index.maybe_get(key);
+        TimeReportEntry *entry;
+        if (existing != nullptr) {
+            entry = &entries.at(existing->value);
+            buf_deinit(key);
+        } else {
+            entry_index.put(key, entries.length);
+            entry = entries.add_one();
+            entry->category = event->category;
+            entry->name = event->name;
+            entry->count = 0;
+            entry->self_time = 0.0;
+            entry->self_allocation_count = 0;
+        }
+        entry->count += 1;
+        entry->self_time += (event->end_time - event->start_time) - event->child_time;
+        entry->self_allocation_count += event->allocation_count - event->child_allocation_count;
+    }
+    entry_index.deinit();
+
+    qsort(entries.items, entries.length, sizeof(TimeReportEntry), compare_entries);
+
+    fprintf(f, "\n%12s%12s%8s  %-10s %s\n", "Self", "Allocs", "Count", "Category", "Name");
+    for (size_t i = 0; i < entries.length && i < printed_entry_count; i += 1) {
+        TimeReportEntry *entry = &entries.at(i);
+        fprintf(f, "%12.4f%12" ZIG_PRI_usize "%8" ZIG_PRI_usize "  %-10s %s\n", entry->self_time,
+                entry->self_allocation_count, entry->count, entry->category, buf_ptr(entry->name));
+    }
+    entries.deinit();
+
+    write_trace(g);
+    fprintf(f, "Trace written to %s\n", buf_ptr(report->trace_path));
+}
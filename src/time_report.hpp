@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef ZIG_TIME_REPORT_HPP
+#define ZIG_TIME_REPORT_HPP
+
+#include "all_types.hpp"
+
+#include <stdio.h>
+
+// The detailed time report measures the time and the number of allocations spent
+// on every function body (IR generation, analysis and rendering to LLVM IR), every
+// @cImport block and every compile time evaluation. Events nest; the report
+// attributes to an event only what was not spent in the events inside it. The
+// events are written to a Chrome trace file, which chrome://tracing can show.
+// While the report is on, the compiler runs on one thread: --ir-gen-threads and
+// --codegen-threads are ignored.
+
+TimeReport *time_report_create(Buf *trace_path);
+
+// name has to live until time_report_finish. Returns the event to pass to
+// time_report_end, which has to be called before the enclosing event ends.
+size_t time_report_begin(CodeGen *g, const char *category, Buf *name);
+void time_report_end(CodeGen *g, size_t event_index);
+
+// Prints the events which took the most time to f and writes the trace file.
+void time_report_finish(CodeGen *g, FILE *f);
+
+#endif
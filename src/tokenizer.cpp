@@ -15,6 +15,10 @@
 #include <limits.h>
 #include <errno.h>
 
+#if defined(ZIG_HAVE_SSE2)
+#include <emmintrin.h>
+#endif
+
 #define WHITESPACE \
          ' ': \
     case '\n'
@@ -149,6 +153,29 @@ static const struct ZigKeyword zig_keywords[] = {
     {"while", TokenIdKeywordWhile},
 };
 
+// zig_keywords is sorted, so the keywords starting with the same letter are adjacent
+static TokenId get_keyword_id(const char *mem, size_t len) {
+    static uint8_t first_index[256];
+    static uint8_t end_index[256];
+    static bool indexes_init = false;
+    if (!indexes_init) {
+        for (size_t i = array_length(zig_keywords); i > 0; i -= 1) {
+            uint8_t first_char = (uint8_t)zig_keywords[i - 1].text[0];
+            first_index[first_char] = (uint8_t)(i - 1);
+            if (end_index[first_char] == 0)
+                end_index[first_char] = (uint8_t)i;
+        }
+        indexes_init = true;
+    }
+
+    uint8_t first_char = (uint8_t)mem[0];
+    for (size_t i = first_index[first_char]; i < end_index[first_char]; i += 1) {
+        if (mem_eql_str(mem, len, zig_keywords[i].text))
+            return zig_keywords[i].token_id;
+    }
+    return TokenIdSymbol;
+}
+
 bool is_zig_keyword(Buf *buf) {
     for (size_t i = 0; i < array_length(zig_keywords); i += 1) {
         if (buf_eql_str(buf, zig_keywords[i].text)) {
@@ -167,6 +194,67 @@ static bool is_symbol_char(uint8_t c) {
     }
 }
 
+// The scan_* functions return the length of the run of bytes starting at ptr which
+// all continue the current token, so that it can be consumed at once. None of these
+// runs can contain a newline. With SSE2 they look at 16 bytes at a time, as long as
+// 16 bytes remain before end.
+
+static size_t scan_symbol_chars(const uint8_t *ptr, const uint8_t *end) {
+    const uint8_t *start = ptr;
+#if defined(ZIG_HAVE_SSE2)
+    const __m128i digit_lo = _mm_set1_epi8('0' - 1);
+    const __m128i digit_hi = _mm_set1_epi8('9' + 1);
+    const __m128i alpha_lo = _mm_set1_epi8('a' - 1);
+    const __m128i alpha_hi = _mm_set1_epi8('z' + 1);
+    const __m128i lower_bit = _mm_set1_epi8(0x20);
+    const __m128i underscore = _mm_set1_epi8('_');
+    while (end - ptr >= 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+        // bytes >= 0x80 are negative, so they fail the signed range checks
+        __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(bytes, digit_lo), _mm_cmplt_epi8(bytes, digit_hi));
+        __m128i lower = _mm_or_si128(bytes, lower_bit);
+        __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, alpha_lo), _mm_cmplt_epi8(lower, alpha_hi));
+        __m128i is_symbol = _mm_or_si128(_mm_or_si128(is_digit, is_alpha), _mm_cmpeq_epi8(bytes, underscore));
+        uint32_t other_mask = ~(uint32_t)_mm_movemask_epi8(is_symbol) & 0xffff;
+        if (other_mask != 0)
+            return (ptr - start) + ctz32(other_mask);
+        ptr += 16;
+    }
+#endif
+    while (ptr < end && is_symbol_char(*ptr)) {
+        ptr += 1;
+    }
+    return ptr - start;
+}
+
+static size_t scan_string_chars(const uint8_t *ptr, const uint8_t *end) {
+    const uint8_t *start = ptr;
+#if defined(ZIG_HAVE_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - ptr >= 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+        __m128i is_special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, quote),
+                    _mm_cmpeq_epi8(bytes, backslash)), _mm_cmpeq_epi8(bytes, newline));
+        uint32_t special_mask = (uint32_t)_mm_movemask_epi8(is_special);
+        if (special_mask != 0)
+            return (ptr - start) + ctz32(special_mask);
+        ptr += 16;
+    }
+#endif
+    while (ptr < end && *ptr != '"' && *ptr != '\\' && *ptr != '\n') {
+        ptr += 1;
+    }
+    return ptr - start;
+}
+
+static size_t scan_comment_chars(const uint8_t *ptr, const uint8_t *end) {
+    // memchr is vectorized by every libc we care about
+    const void *newline = memchr(ptr, '\n', end - ptr);
+    return newline ? (const uint8_t *)newline - ptr : end - ptr;
+}
+
 enum TokenizeState {
     TokenizeStateStart,
     TokenizeStateSymbol,
@@ -213,38 +301,30 @@ enum TokenizeState {
 };
 
 
+// The tokenizer only validates the literals. Their values are decoded from the source
+// when the parser asks for them, see token_int_lit and friends, and the line and
+// column of a token are found from its position with token_line_column.
 struct Tokenize {
     Buf *buf;
     size_t pos;
     TokenizeState state;
     ZigList<Token> *tokens;
-    int line;
-    int column;
     Token *cur_tok;
     Tokenization *out;
     uint32_t radix;
-    int32_t exp_add_amt;
-    bool is_exp_negative;
+    bool is_c_str;
     size_t char_code_index;
     size_t char_code_end;
     bool unicode;
     uint32_t char_code;
-    int exponent_in_bin_or_dec;
-    BigInt specified_exponent;
-    BigInt significand;
 };
 
 ATTRIBUTE_PRINTF(2, 3)
 static void tokenize_error(Tokenize *t, const char *format, ...) {
     t->state = TokenizeStateError;
 
-    if (t->cur_tok) {
-        t->out->err_line = t->cur_tok->start_line;
-        t->out->err_column = t->cur_tok->start_column;
-    } else {
-        t->out->err_line = t->line;
-        t->out->err_column = t->column;
-    }
+    size_t pos = t->cur_tok ? t->cur_tok->start_pos : t->pos;
+    token_line_column(t->out->line_offsets, pos, &t->out->err_line, &t->out->err_column);
 
     va_list ap;
     va_start(ap, format);
@@ -254,26 +334,14 @@ static void tokenize_error(Tokenize *t, const char *format, ...) {
 
 static void set_token_id(Tokenize *t, Token *token, TokenId id) {
     token->id = id;
-
-    if (id == TokenIdIntLiteral) {
-        bigint_init_unsigned(&token->data.int_lit.bigint, 0);
-    } else if (id == TokenIdFloatLiteral) {
-        bigfloat_init_32(&token->data.float_lit.bigfloat, 0.0f);
-        token->data.float_lit.overflow = false;
-    } else if (id == TokenIdStringLiteral || id == TokenIdSymbol) {
-        memset(&token->data.str_lit.str, 0, sizeof(Buf));
-        buf_resize(&token->data.str_lit.str, 0);
-        token->data.str_lit.is_c_str = false;
-    }
 }
 
 static void begin_token(Tokenize *t, TokenId id) {
     assert(!t->cur_tok);
     t->tokens->add_one();
     Token *token = &t->tokens->last();
-    token->start_line = t->line;
-    token->start_column = t->column;
-    token->start_pos = t->pos;
+    token->start_pos = (uint32_t)t->pos;
+    t->is_c_str = false;
 
     set_token_id(t, token, id);
 
@@ -285,99 +353,15 @@ static void cancel_token(Tokenize *t) {
     t->cur_tok = nullptr;
 }
 
-static void end_float_token(Tokenize *t) {
-    if (t->radix == 10) {
-        uint8_t *ptr_buf = (uint8_t*)buf_ptr(t->buf) + t->cur_tok->start_pos;
-        size_t buf_len = t->cur_tok->end_pos - t->cur_tok->start_pos;
-        if (bigfloat_init_buf_base10(&t->cur_tok->data.float_lit.bigfloat, ptr_buf, buf_len)) {
-            t->cur_tok->data.float_lit.overflow = true;
-        }
-        return;
-    }
-
-    BigInt int_max;
-    bigint_init_unsigned(&int_max, INT_MAX);
-
-    if (bigint_cmp(&t->specified_exponent, &int_max) != CmpLT) {
-        t->cur_tok->data.float_lit.overflow = true;
-        return;
-    }
-
-    if (!bigint_fits_in_bits(&t->specified_exponent, 128, true)) {
-        t->cur_tok->data.float_lit.overflow = true;
-        return;
-    }
-
-    int64_t specified_exponent = bigint_as_signed(&t->specified_exponent);
-    if (t->is_exp_negative) {
-        specified_exponent = -specified_exponent;
-    }
-    t->exponent_in_bin_or_dec = (int)(t->exponent_in_bin_or_dec + specified_exponent);
-
-    if (!bigint_fits_in_bits(&t->significand, 128, false)) {
-        t->cur_tok->data.float_lit.overflow = true;
-        return;
-    }
-
-    // A SoftFloat-3d float128 is represented internally as a standard
-    // quad-precision float with 15bit exponent and 113bit fractional.
-    union { uint64_t repr[2]; float128_t actual; } f_bits;
-
-    if (bigint_cmp_zero(&t->significand) == CmpEQ) {
-        f_bits.repr[0] = 0;
-        f_bits.repr[1] = 0;
-    } else {
-        // normalize the significand
-        if (t->radix == 10) {
-            zig_panic("TODO: decimal floats");
-        } else {
-            int significand_magnitude_in_bin = 127 - bigint_clz(&t->significand, 128);
-            t->exponent_in_bin_or_dec += significand_magnitude_in_bin;
-            if (!(-16382 <= t->exponent_in_bin_or_dec && t->exponent_in_bin_or_dec <= 16383)) {
-                t->cur_tok->data.float_lit.overflow = true;
-                return;
-            }
-
-            uint64_t sig_bits[2] = {0, 0};
-            bigint_write_twos_complement(&t->significand, (uint8_t*) sig_bits, 128, false);
-
-            const uint64_t shift = 112 - significand_magnitude_in_bin;
-            const uint64_t exp_shift = 48;
-            // Mask the sign bit to 0 since always non-negative lex
-            const uint64_t exp_mask = 0xffffull << exp_shift;
-
-            if (shift >= 64) {
-                f_bits.repr[0] = 0;
-                f_bits.repr[1] = sig_bits[0] << (shift - 64);
-            } else {
-                f_bits.repr[0] = sig_bits[0] << shift;
-                f_bits.repr[1] = ((sig_bits[1] << shift) | (sig_bits[0] >> (64 - shift)));
-            }
-
-            f_bits.repr[1] &= ~exp_mask;
-            f_bits.repr[1] |= (uint64_t)(t->exponent_in_bin_or_dec + 16383) << exp_shift;
-        }
-    }
-
-    bigfloat_init_128(&t->cur_tok->data.float_lit.bigfloat, f_bits.actual);
-}
-
 static void end_token(Tokenize *t) {
     assert(t->cur_tok);
-    t->cur_tok->end_pos = t->pos + 1;
+    // tokens which end the file are ended with t->pos one past the last byte
+    t->cur_tok->end_pos = (uint32_t)min(t->pos + 1, buf_len(t->buf));
 
-    if (t->cur_tok->id == TokenIdFloatLiteral) {
-        end_float_token(t);
-    } else if (t->cur_tok->id == TokenIdSymbol) {
+    if (t->cur_tok->id == TokenIdSymbol) {
         char *token_mem = buf_ptr(t->buf) + t->cur_tok->start_pos;
-        int token_len = (int)(t->cur_tok->end_pos - t->cur_tok->start_pos);
-
-        for (size_t i = 0; i < array_length(zig_keywords); i += 1) {
-            if (mem_eql_str(token_mem, token_len, zig_keywords[i].text)) {
-                t->cur_tok->id = zig_keywords[i].token_id;
-                break;
-            }
-        }
+        size_t token_len = t->cur_tok->end_pos - t->cur_tok->start_pos;
+        t->cur_tok->id = get_keyword_id(token_mem, token_len);
     }
 
     t->cur_tok = nullptr;
@@ -404,12 +388,24 @@ static uint32_t get_digit_value(uint8_t c) {
     return UINT32_MAX;
 }
 
-static void handle_string_escape(Tokenize *t, uint8_t c) {
+// Moves past the next run_len bytes, which must not contain a newline. The byte at
+// t->pos is still accounted for by the main loop.
+static void skip_run(Tokenize *t, size_t run_len) {
+    t->pos += run_len;
+}
+
+static const uint8_t *next_byte(Tokenize *t) {
+    return (const uint8_t *)buf_ptr(t->buf) + t->pos + 1;
+}
+
+static const uint8_t *end_byte(Tokenize *t) {
+    return (const uint8_t *)buf_ptr(t->buf) + buf_len(t->buf);
+}
+
+static void handle_string_escape(Tokenize *t) {
     if (t->cur_tok->id == TokenIdCharLiteral) {
-        t->cur_tok->data.char_lit.c = c;
         t->state = TokenizeStateCharLiteralEnd;
     } else if (t->cur_tok->id == TokenIdStringLiteral || t->cur_tok->id == TokenIdSymbol) {
-        buf_append_char(&t->cur_tok->data.str_lit.str, c);
         t->state = TokenizeStateString;
     } else {
         zig_unreachable();
@@ -425,6 +421,10 @@ void tokenize(Buf *buf, Tokenization *out) {
     out->line_offsets = allocate<ZigList<size_t>>(1);
 
     out->line_offsets->append(0);
+    if (buf_len(buf) >= UINT32_MAX) {
+        tokenize_error(&t, "file too big");
+        return;
+    }
     for (t.pos = 0; t.pos < buf_len(t.buf); t.pos += 1) {
         uint8_t c = buf_ptr(t.buf)[t.pos];
         switch (t.state) {
@@ -432,36 +432,37 @@ void tokenize(Buf *buf, Tokenization *out) {
                 break;
             case TokenizeStateStart:
                 switch (c) {
-                    case WHITESPACE:
+                    case ' ':
+                        {
+                            const uint8_t *ptr = next_byte(&t);
+                            const uint8_t *end = end_byte(&t);
+                            while (ptr < end && *ptr == ' ') {
+                                ptr += 1;
+                            }
+                            skip_run(&t, ptr - next_byte(&t));
+                        }
+                        break;
+                    case '\n':
                         break;
                     case 'c':
                         t.state = TokenizeStateSymbolFirstC;
                         begin_token(&t, TokenIdSymbol);
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
                         break;
                     case ALPHA_EXCEPT_C:
                     case '_':
                         t.state = TokenizeStateSymbol;
                         begin_token(&t, TokenIdSymbol);
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
+                        skip_run(&t, scan_symbol_chars(next_byte(&t), end_byte(&t)));
                         break;
                     case '0':
                         t.state = TokenizeStateZero;
                         begin_token(&t, TokenIdIntLiteral);
                         t.radix = 10;
-                        t.exp_add_amt = 1;
-                        t.exponent_in_bin_or_dec = 0;
-                        bigint_init_unsigned(&t.cur_tok->data.int_lit.bigint, 0);
-                        bigint_init_unsigned(&t.specified_exponent, 0);
                         break;
                     case DIGIT_NON_ZERO:
                         t.state = TokenizeStateNumber;
                         begin_token(&t, TokenIdIntLiteral);
                         t.radix = 10;
-                        t.exp_add_amt = 1;
-                        t.exponent_in_bin_or_dec = 0;
-                        bigint_init_unsigned(&t.cur_tok->data.int_lit.bigint, get_digit_value(c));
-                        bigint_init_unsigned(&t.specified_exponent, 0);
                         break;
                     case '"':
                         begin_token(&t, TokenIdStringLiteral);
@@ -900,7 +901,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateLineStringEnd;
                         break;
                     default:
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
+                        skip_run(&t, scan_comment_chars(next_byte(&t), end_byte(&t)));
                         break;
                 }
                 break;
@@ -909,7 +910,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                     case WHITESPACE:
                         break;
                     case 'c':
-                        if (!t.cur_tok->data.str_lit.is_c_str) {
+                        if (!t.is_c_str) {
                             t.pos -= 1;
                             end_token(&t);
                             t.state = TokenizeStateStart;
@@ -918,7 +919,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateLineStringContinueC;
                         break;
                     case '\\':
-                        if (t.cur_tok->data.str_lit.is_c_str) {
+                        if (t.is_c_str) {
                             tokenize_error(&t, "invalid character: '%c'", c);
                         }
                         t.state = TokenizeStateLineStringContinue;
@@ -946,7 +947,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                 switch (c) {
                     case '\\':
                         t.state = TokenizeStateLineString;
-                        buf_append_char(&t.cur_tok->data.str_lit.str, '\n');
                         break;
                     default:
                         tokenize_error(&t, "invalid character: '%c'", c);
@@ -959,7 +959,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateStart;
                         break;
                     default:
-                        // do nothing
+                        skip_run(&t, scan_comment_chars(next_byte(&t), end_byte(&t)));
                         break;
                 }
                 break;
@@ -967,17 +967,16 @@ void tokenize(Buf *buf, Tokenization *out) {
                 switch (c) {
                     case '"':
                         set_token_id(&t, t.cur_tok, TokenIdStringLiteral);
-                        t.cur_tok->data.str_lit.is_c_str = true;
+                        t.is_c_str = true;
                         t.state = TokenizeStateString;
                         break;
                     case '\\':
                         set_token_id(&t, t.cur_tok, TokenIdStringLiteral);
-                        t.cur_tok->data.str_lit.is_c_str = true;
+                        t.is_c_str = true;
                         t.state = TokenizeStateSawBackslash;
                         break;
                     case SYMBOL_CHAR:
                         t.state = TokenizeStateSymbol;
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
                         break;
                     default:
                         t.pos -= 1;
@@ -1002,7 +1001,7 @@ void tokenize(Buf *buf, Tokenization *out) {
             case TokenizeStateSymbol:
                 switch (c) {
                     case SYMBOL_CHAR:
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
+                        skip_run(&t, scan_symbol_chars(next_byte(&t), end_byte(&t)));
                         break;
                     default:
                         t.pos -= 1;
@@ -1024,7 +1023,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateStringEscape;
                         break;
                     default:
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
+                        skip_run(&t, scan_string_chars(next_byte(&t), end_byte(&t)));
                         break;
                 }
                 break;
@@ -1055,22 +1054,22 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.unicode = true;
                         break;
                     case 'n':
-                        handle_string_escape(&t, '\n');
+                        handle_string_escape(&t);
                         break;
                     case 'r':
-                        handle_string_escape(&t, '\r');
+                        handle_string_escape(&t);
                         break;
                     case '\\':
-                        handle_string_escape(&t, '\\');
+                        handle_string_escape(&t);
                         break;
                     case 't':
-                        handle_string_escape(&t, '\t');
+                        handle_string_escape(&t);
                         break;
                     case '\'':
-                        handle_string_escape(&t, '\'');
+                        handle_string_escape(&t);
                         break;
                     case '"':
-                        handle_string_escape(&t, '\"');
+                        handle_string_escape(&t);
                         break;
                     default:
                         tokenize_error(&t, "invalid character: '%c'", c);
@@ -1090,30 +1089,30 @@ void tokenize(Buf *buf, Tokenization *out) {
                         if (t.unicode) {
                             if (t.char_code <= 0x7f) {
                                 // 00000000 00000000 00000000 0xxxxxxx
-                                handle_string_escape(&t, (uint8_t)t.char_code);
+                                handle_string_escape(&t);
                             } else if (t.cur_tok->id == TokenIdCharLiteral) {
                                 tokenize_error(&t, "unicode value too large for character literal: %x", t.char_code);
                             } else if (t.char_code <= 0x7ff) {
                                 // 00000000 00000000 00000xxx xx000000
-                                handle_string_escape(&t, (uint8_t)(0xc0 | (t.char_code >> 6)));
+                                handle_string_escape(&t);
                                 // 00000000 00000000 00000000 00xxxxxx
-                                handle_string_escape(&t, (uint8_t)(0x80 | (t.char_code & 0x3f)));
+                                handle_string_escape(&t);
                             } else if (t.char_code <= 0xffff) {
                                 // 00000000 00000000 xxxx0000 00000000
-                                handle_string_escape(&t, (uint8_t)(0xe0 | (t.char_code >> 12)));
+                                handle_string_escape(&t);
                                 // 00000000 00000000 0000xxxx xx000000
-                                handle_string_escape(&t, (uint8_t)(0x80 | ((t.char_code >> 6) & 0x3f)));
+                                handle_string_escape(&t);
                                 // 00000000 00000000 00000000 00xxxxxx
-                                handle_string_escape(&t, (uint8_t)(0x80 | (t.char_code & 0x3f)));
+                                handle_string_escape(&t);
                             } else if (t.char_code <= 0x10ffff) {
                                 // 00000000 000xxx00 00000000 00000000
-                                handle_string_escape(&t, (uint8_t)(0xf0 | (t.char_code >> 18)));
+                                handle_string_escape(&t);
                                 // 00000000 000000xx xxxx0000 00000000
-                                handle_string_escape(&t, (uint8_t)(0x80 | ((t.char_code >> 12) & 0x3f)));
+                                handle_string_escape(&t);
                                 // 00000000 00000000 0000xxxx xx000000
-                                handle_string_escape(&t, (uint8_t)(0x80 | ((t.char_code >> 6) & 0x3f)));
+                                handle_string_escape(&t);
                                 // 00000000 00000000 00000000 00xxxxxx
-                                handle_string_escape(&t, (uint8_t)(0x80 | (t.char_code & 0x3f)));
+                                handle_string_escape(&t);
                             } else {
                                 tokenize_error(&t, "unicode value out of range: %x", t.char_code);
                             }
@@ -1122,7 +1121,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                                 tokenize_error(&t, "value too large for character literal: '%x'",
                                         t.char_code);
                             }
-                            handle_string_escape(&t, (uint8_t)t.char_code);
+                            handle_string_escape(&t);
                         }
                     }
                 }
@@ -1135,7 +1134,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateStringEscape;
                         break;
                     default:
-                        t.cur_tok->data.char_lit.c = c;
                         t.state = TokenizeStateCharLiteralEnd;
                         break;
                 }
@@ -1158,12 +1156,10 @@ void tokenize(Buf *buf, Tokenization *out) {
                         break;
                     case 'o':
                         t.radix = 8;
-                        t.exp_add_amt = 3;
                         t.state = TokenizeStateNumber;
                         break;
                     case 'x':
                         t.radix = 16;
-                        t.exp_add_amt = 4;
                         t.state = TokenizeStateNumber;
                         break;
                     default:
@@ -1182,7 +1178,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                     if (is_exponent_signifier(c, t.radix)) {
                         t.state = TokenizeStateFloatExponentUnsigned;
                         assert(t.cur_tok->id == TokenIdIntLiteral);
-                        bigint_init_bigint(&t.significand, &t.cur_tok->data.int_lit.bigint);
                         set_token_id(&t, t.cur_tok, TokenIdFloatLiteral);
                         break;
                     }
@@ -1197,16 +1192,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateStart;
                         continue;
                     }
-                    BigInt digit_value_bi;
-                    bigint_init_unsigned(&digit_value_bi, digit_value);
-
-                    BigInt radix_bi;
-                    bigint_init_unsigned(&radix_bi, t.radix);
-
-                    BigInt multiplied;
-                    bigint_mul(&multiplied, &t.cur_tok->data.int_lit.bigint, &radix_bi);
-
-                    bigint_add(&t.cur_tok->data.int_lit.bigint, &multiplied, &digit_value_bi);
                     break;
                 }
             case TokenizeStateNumberDot:
@@ -1220,7 +1205,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                     t.pos -= 1;
                     t.state = TokenizeStateFloatFraction;
                     assert(t.cur_tok->id == TokenIdIntLiteral);
-                    bigint_init_bigint(&t.significand, &t.cur_tok->data.int_lit.bigint);
                     set_token_id(&t, t.cur_tok, TokenIdFloatLiteral);
                     continue;
                 }
@@ -1241,38 +1225,17 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateStart;
                         continue;
                     }
-                    t.exponent_in_bin_or_dec -= t.exp_add_amt;
-                    if (t.radix == 10) {
-                        // For now we use strtod to parse decimal floats, so we just have to get to the
-                        // end of the token.
-                        break;
-                    }
-                    BigInt digit_value_bi;
-                    bigint_init_unsigned(&digit_value_bi, digit_value);
-
-                    BigInt radix_bi;
-                    bigint_init_unsigned(&radix_bi, t.radix);
-
-                    BigInt multiplied;
-                    bigint_mul(&multiplied, &t.significand, &radix_bi);
-
-                    bigint_add(&t.significand, &multiplied, &digit_value_bi);
                     break;
                 }
             case TokenizeStateFloatExponentUnsigned:
                 switch (c) {
                     case '+':
-                        t.is_exp_negative = false;
-                        t.state = TokenizeStateFloatExponentNumber;
-                        break;
                     case '-':
-                        t.is_exp_negative = true;
                         t.state = TokenizeStateFloatExponentNumber;
                         break;
                     default:
                         // reinterpret as normal exponent number
                         t.pos -= 1;
-                        t.is_exp_negative = false;
                         t.state = TokenizeStateFloatExponentNumber;
                         continue;
                 }
@@ -1290,21 +1253,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateStart;
                         continue;
                     }
-                    if (t.radix == 10) {
-                        // For now we use strtod to parse decimal floats, so we just have to get to the
-                        // end of the token.
-                        break;
-                    }
-                    BigInt digit_value_bi;
-                    bigint_init_unsigned(&digit_value_bi, digit_value);
-
-                    BigInt radix_bi;
-                    bigint_init_unsigned(&radix_bi, 10);
-
-                    BigInt multiplied;
-                    bigint_mul(&multiplied, &t.specified_exponent, &radix_bi);
-
-                    bigint_add(&t.specified_exponent, &multiplied, &digit_value_bi);
                 }
                 break;
             case TokenizeStateSawDash:
@@ -1347,10 +1295,6 @@ void tokenize(Buf *buf, Tokenization *out) {
         }
         if (c == '\n') {
             out->line_offsets->append(t.pos + 1);
-            t.line += 1;
-            t.column = 0;
-        } else {
-            t.column += 1;
         }
     }
     // EOF
@@ -1421,8 +1365,6 @@ void tokenize(Buf *buf, Tokenization *out) {
     if (t.state != TokenizeStateError) {
         if (t.tokens->length > 0) {
             Token *last_token = &t.tokens->last();
-            t.line = (int)last_token->start_line;
-            t.column = (int)last_token->start_column;
             t.pos = last_token->start_pos;
         } else {
             t.pos = 0;
@@ -1547,13 +1489,319 @@ void print_tokens(Buf *buf, ZigList<Token> *tokens) {
     for (size_t i = 0; i < tokens->length; i += 1) {
         Token *token = &tokens->at(i);
         fprintf(stderr, "%s ", token_name(token->id));
-        if (token->start_pos != SIZE_MAX) {
-            fwrite(buf_ptr(buf) + token->start_pos, 1, token->end_pos - token->start_pos, stderr);
-        }
+        fwrite(buf_ptr(buf) + token->start_pos, 1, token->end_pos - token->start_pos, stderr);
         fprintf(stderr, "\n");
     }
 }
 
+void token_line_column(ZigList<size_t> *line_offsets, size_t pos, size_t *out_line, size_t *out_column) {
+    // the last line which starts at or before pos
+    size_t lo = 0;
+    size_t hi = line_offsets->length;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (line_offsets->at(mid) <= pos) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    *out_line = lo;
+    *out_column = pos - line_offsets->at(lo);
+}
+
+// Returns the digits of the number literal token and sets the radix from its prefix.
+static const uint8_t *number_digits(Buf *buf, Token *token, uint32_t *out_radix) {
+    const uint8_t *ptr = (const uint8_t *)buf_ptr(buf) + token->start_pos;
+    *out_radix = 10;
+    if (token->end_pos - token->start_pos >= 2 && ptr[0] == '0') {
+        switch (ptr[1]) {
+            case 'b':
+                *out_radix = 2;
+                return ptr + 2;
+            case 'o':
+                *out_radix = 8;
+                return ptr + 2;
+            case 'x':
+                *out_radix = 16;
+                return ptr + 2;
+        }
+    }
+    return ptr;
+}
+
+static void bigint_append_digit(BigInt *bigint, uint32_t radix, uint32_t digit_value) {
+    BigInt digit_value_bi;
+    bigint_init_unsigned(&digit_value_bi, digit_value);
+
+    BigInt radix_bi;
+    bigint_init_unsigned(&radix_bi, radix);
+
+    BigInt multiplied;
+    bigint_mul(&multiplied, bigint, &radix_bi);
+
+    bigint_add(bigint, &multiplied, &digit_value_bi);
+}
+
+void token_int_lit(Buf *buf, Token *token, BigInt *out_bigint) {
+    assert(token->id == TokenIdIntLiteral);
+    uint32_t radix;
+    const uint8_t *ptr = number_digits(buf, token, &radix);
+    const uint8_t *end = (const uint8_t *)buf_ptr(buf) + token->end_pos;
+
+    // most literals fit in 64 bits, which saves the BigInt arithmetic
+    uint64_t value = 0;
+    bool fits = true;
+    for (; ptr < end; ptr += 1) {
+        uint32_t digit_value = get_digit_value(*ptr);
+        if (value > (UINT64_MAX - digit_value) / radix) {
+            fits = false;
+            break;
+        }
+        value = value * radix + digit_value;
+    }
+    bigint_init_unsigned(out_bigint, value);
+    if (fits)
+        return;
+    for (; ptr < end; ptr += 1) {
+        bigint_append_digit(out_bigint, radix, get_digit_value(*ptr));
+    }
+}
+
+bool token_float_lit(Buf *buf, Token *token, BigFloat *out_bigfloat) {
+    assert(token->id == TokenIdFloatLiteral);
+    uint32_t radix;
+    const uint8_t *ptr = number_digits(buf, token, &radix);
+    const uint8_t *end = (const uint8_t *)buf_ptr(buf) + token->end_pos;
+
+    bigfloat_init_32(out_bigfloat, 0.0f);
+    if (radix == 10) {
+        // For now we use strtod to parse decimal floats.
+        return bigfloat_init_buf_base10(out_bigfloat, ptr, end - ptr) != 0;
+    }
+
+    int exp_add_amt = (radix == 8) ? 3 : (radix == 16) ? 4 : 1;
+    int exponent_in_bin_or_dec = 0;
+    BigInt significand;
+    bigint_init_unsigned(&significand, 0);
+    for (; ptr < end && !is_exponent_signifier(*ptr, radix); ptr += 1) {
+        if (*ptr == '.')
+            break;
+        bigint_append_digit(&significand, radix, get_digit_value(*ptr));
+    }
+    if (ptr < end && *ptr == '.') {
+        for (ptr += 1; ptr < end && !is_exponent_signifier(*ptr, radix); ptr += 1) {
+            exponent_in_bin_or_dec -= exp_add_amt;
+            bigint_append_digit(&significand, radix, get_digit_value(*ptr));
+        }
+    }
+    BigInt specified_exponent;
+    bigint_init_unsigned(&specified_exponent, 0);
+    bool is_exp_negative = false;
+    if (ptr < end) {
+        ptr += 1;
+        if (ptr < end && (*ptr == '+' || *ptr == '-')) {
+            is_exp_negative = (*ptr == '-');
+            ptr += 1;
+        }
+        for (; ptr < end; ptr += 1) {
+            bigint_append_digit(&specified_exponent, 10, get_digit_value(*ptr));
+        }
+    }
+
+    BigInt int_max;
+    bigint_init_unsigned(&int_max, INT_MAX);
+
+    if (bigint_cmp(&specified_exponent, &int_max) != CmpLT) {
+        return true;
+    }
+
+    if (!bigint_fits_in_bits(&specified_exponent, 128, true)) {
+        return true;
+    }
+
+    int64_t specified_exponent_int = bigint_as_signed(&specified_exponent);
+    if (is_exp_negative) {
+        specified_exponent_int = -specified_exponent_int;
+    }
+    exponent_in_bin_or_dec = (int)(exponent_in_bin_or_dec + specified_exponent_int);
+
+    if (!bigint_fits_in_bits(&significand, 128, false)) {
+        return true;
+    }
+
+    // A SoftFloat-3d float128 is represented internally as a standard
+    // quad-precision float with 15bit exponent and 113bit fractional.
+    union { uint64_t repr[2]; float128_t actual; } f_bits;
+
+    if (bigint_cmp_zero(&significand) == CmpEQ) {
+        f_bits.repr[0] = 0;
+        f_bits.repr[1] = 0;
+    } else {
+        // normalize the significand
+        int significand_magnitude_in_bin = 127 - bigint_clz(&significand, 128);
+        exponent_in_bin_or_dec += significand_magnitude_in_bin;
+        if (!(-16382 <= exponent_in_bin_or_dec && exponent_in_bin_or_dec <= 16383)) {
+            return true;
+        }
+
+        uint64_t sig_bits[2] = {0, 0};
+        bigint_write_twos_complement(&significand, (uint8_t*) sig_bits, 128, false);
+
+        const uint64_t shift = 112 - significand_magnitude_in_bin;
+        const uint64_t exp_shift = 48;
+        // Mask the sign bit to 0 since always non-negative lex
+        const uint64_t exp_mask = 0xffffull << exp_shift;
+
+        if (shift >= 64) {
+            f_bits.repr[0] = 0;
+            f_bits.repr[1] = sig_bits[0] << (shift - 64);
+        } else {
+            f_bits.repr[0] = sig_bits[0] << shift;
+            f_bits.repr[1] = ((sig_bits[1] << shift) | (sig_bits[0] >> (64 - shift)));
+        }
+
+        f_bits.repr[1] &= ~exp_mask;
+        f_bits.repr[1] |= (uint64_t)(exponent_in_bin_or_dec + 16383) << exp_shift;
+    }
+
+    bigfloat_init_128(out_bigfloat, f_bits.actual);
+    return false;
+}
+
+static void append_utf8(Buf *buf, uint32_t char_code) {
+    if (char_code <= 0x7f) {
+        // 00000000 00000000 00000000 0xxxxxxx
+        buf_append_char(buf, (uint8_t)char_code);
+    } else if (char_code <= 0x7ff) {
+        // 00000000 00000000 00000xxx xx000000
+        buf_append_char(buf, (uint8_t)(0xc0 | (char_code >> 6)));
+        // 00000000 00000000 00000000 00xxxxxx
+        buf_append_char(buf, (uint8_t)(0x80 | (char_code & 0x3f)));
+    } else if (char_code <= 0xffff) {
+        // 00000000 00000000 xxxx0000 00000000
+        buf_append_char(buf, (uint8_t)(0xe0 | (char_code >> 12)));
+        // 00000000 00000000 0000xxxx xx000000
+        buf_append_char(buf, (uint8_t)(0x80 | ((char_code >> 6) & 0x3f)));
+        // 00000000 00000000 00000000 00xxxxxx
+        buf_append_char(buf, (uint8_t)(0x80 | (char_code & 0x3f)));
+    } else {
+        // 00000000 000xxx00 00000000 00000000
+        buf_append_char(buf, (uint8_t)(0xf0 | (char_code >> 18)));
+        // 00000000 000000xx xxxx0000 00000000
+        buf_append_char(buf, (uint8_t)(0x80 | ((char_code >> 12) & 0x3f)));
+        // 00000000 00000000 0000xxxx xx000000
+        buf_append_char(buf, (uint8_t)(0x80 | ((char_code >> 6) & 0x3f)));
+        // 00000000 00000000 00000000 00xxxxxx
+        buf_append_char(buf, (uint8_t)(0x80 | (char_code & 0x3f)));
+    }
+}
+
+// ptr points after the backslash of an escape sequence which the tokenizer accepted.
+// Appends the bytes it stands for to out and returns the end of the sequence.
+static const uint8_t *decode_escape(const uint8_t *ptr, Buf *out) {
+    size_t digit_count;
+    switch (*ptr) {
+        case 'x':
+            digit_count = 2;
+            break;
+        case 'u':
+            digit_count = 4;
+            break;
+        case 'U':
+            digit_count = 6;
+            break;
+        case 'n':
+            buf_append_char(out, '\n');
+            return ptr + 1;
+        case 'r':
+            buf_append_char(out, '\r');
+            return ptr + 1;
+        case 't':
+            buf_append_char(out, '\t');
+            return ptr + 1;
+        default:
+            // '\\', '\'' and '"'
+            buf_append_char(out, *ptr);
+            return ptr + 1;
+    }
+    uint32_t char_code = 0;
+    for (size_t i = 1; i <= digit_count; i += 1) {
+        char_code = char_code * 16 + get_digit_value(ptr[i]);
+    }
+    if (*ptr == 'x') {
+        buf_append_char(out, (uint8_t)char_code);
+    } else {
+        append_utf8(out, char_code);
+    }
+    return ptr + 1 + digit_count;
+}
+
+void token_str_lit(Buf *buf, Token *token, Buf *out_str, bool *out_is_c_str) {
+    assert(token->id == TokenIdStringLiteral || token->id == TokenIdSymbol);
+    const uint8_t *ptr = (const uint8_t *)buf_ptr(buf) + token->start_pos;
+    const uint8_t *end = (const uint8_t *)buf_ptr(buf) + token->end_pos;
+    buf_resize(out_str, 0);
+    *out_is_c_str = false;
+
+    if (token->id == TokenIdSymbol) {
+        if (*ptr != '@') {
+            buf_append_mem(out_str, (const char *)ptr, end - ptr);
+            return;
+        }
+        ptr += 1;
+    } else if (*ptr == 'c') {
+        *out_is_c_str = true;
+        ptr += 1;
+    }
+
+    if (*ptr == '"') {
+        ptr += 1;
+        for (;;) {
+            const uint8_t *run_end = ptr + scan_string_chars(ptr, end);
+            buf_append_mem(out_str, (const char *)ptr, run_end - ptr);
+            ptr = run_end;
+            if (*ptr != '\\')
+                break;
+            ptr = decode_escape(ptr + 1, out_str);
+        }
+        return;
+    }
+
+    // multiline string literal; each line starts with \\ or c\\ after whitespace
+    for (;;) {
+        assert(ptr[0] == '\\' && ptr[1] == '\\');
+        ptr += 2;
+        const uint8_t *line_end = ptr + scan_comment_chars(ptr, end);
+        buf_append_mem(out_str, (const char *)ptr, line_end - ptr);
+
+        const uint8_t *next = line_end;
+        while (next < end && (*next == ' ' || *next == '\n')) {
+            next += 1;
+        }
+        if (next < end && *next == 'c') {
+            next += 1;
+        }
+        if (end - next < 2 || next[0] != '\\' || next[1] != '\\')
+            return;
+        buf_append_char(out_str, '\n');
+        ptr = next;
+    }
+}
+
+uint8_t token_char_lit(Buf *buf, Token *token) {
+    assert(token->id == TokenIdCharLiteral);
+    const uint8_t *ptr = (const uint8_t *)buf_ptr(buf) + token->start_pos + 1;
+    if (*ptr != '\\')
+        return *ptr;
+    Buf value = BUF_INIT;
+    buf_resize(&value, 0);
+    decode_escape(ptr + 1, &value);
+    uint8_t c = (uint8_t)buf_ptr(&value)[0];
+    buf_deinit(&value);
+    return c;
+}
+
 bool valid_symbol_starter(uint8_t c) {
     switch (c) {
         case SYMBOL_START:
@@ -119,46 +119,13 @@ enum TokenId {
     TokenIdTimesPercentEq,
 };
 
-struct TokenFloatLit {
-    BigFloat bigfloat;
-    // overflow is true if when parsing the number, we discovered it would not fit
-    // without losing data
-    bool overflow;
-};
-
-struct TokenIntLit {
-    BigInt bigint;
-};
-
-struct TokenStrLit {
-    Buf str;
-    bool is_c_str;
-};
-
-struct TokenCharLit {
-    uint8_t c;
-};
-
+// Tokens only record where they are in the source. The values of literals, and the
+// line and column of the token, are computed from the source by the functions below
+// when they are needed.
 struct Token {
     TokenId id;
-    size_t start_pos;
-    size_t end_pos;
-    size_t start_line;
-    size_t start_column;
-
-    union {
-        // TokenIdIntLiteral
-        TokenIntLit int_lit;
-
-        // TokenIdFloatLiteral
-        TokenFloatLit float_lit;
-
-        // TokenIdStringLiteral or TokenIdSymbol
-        TokenStrLit str_lit;
-
-        // TokenIdCharLiteral
-        TokenCharLit char_lit;
-    } data;
+    uint32_t start_pos;
+    uint32_t end_pos;
 };
 
 struct Tokenization {
@@ -177,6 +144,17 @@ void print_tokens(Buf *buf, ZigList<Token> *tokens);
 
 const char * token_name(TokenId id);
 
+// line and column are 0 based. line_offsets must contain the lines up to pos.
+void token_line_column(ZigList<size_t> *line_offsets, size_t pos, size_t *out_line, size_t *out_column);
+
+// token must have been produced by tokenize from buf without an error.
+void token_int_lit(Buf *buf, Token *token, BigInt *out_bigint);
+// Returns true if the value does not fit in a BigFloat without losing data.
+bool token_float_lit(Buf *buf, Token *token, BigFloat *out_bigfloat);
+// For TokenIdStringLiteral and TokenIdSymbol, including @"symbols".
+void token_str_lit(Buf *buf, Token *token, Buf *out_str, bool *out_is_c_str);
+uint8_t token_char_lit(Buf *buf, Token *token);
+
 bool valid_symbol_starter(uint8_t c);
 bool is_zig_keyword(Buf *buf);
 
@@ -11,6 +11,9 @@
 
 #include "util.hpp"
 
+bool count_allocations = false;
+size_t allocation_count = 0;
+
 void zig_panic(const char *format, ...) {
     va_list ap;
     va_start(ap, format);
@@ -35,6 +35,10 @@
 
 #define BREAKPOINT __asm("int $0x03")
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ZIG_HAVE_SSE2
+#endif
+
 ATTRIBUTE_COLD
 ATTRIBUTE_NORETURN
 ATTRIBUTE_PRINTF(1, 2)
@@ -61,12 +65,30 @@ static inline int clzll(unsigned long long mask) {
 	return 63 - lz;
 #endif
 }
+static inline int ctz32(uint32_t mask) {
+	unsigned long tz;
+	if (_BitScanForward(&tz, mask))
+		return static_cast<int>(tz);
+	zig_unreachable();
+}
 #else
 #define clzll(x) __builtin_clzll(x)
+#define ctz32(x) __builtin_ctz(x)
 #endif
 
+// Allocations are only counted for the detailed time report, which keeps the
+// compiler on one thread.
+extern bool count_allocations;
+extern size_t allocation_count;
+
+static inline void note_allocation(void) {
+    if (count_allocations)
+        allocation_count += 1;
+}
+
 template<typename T>
 ATTRIBUTE_RETURNS_NOALIAS static inline T *allocate_nonzero(size_t count) {
+    note_allocation();
     T *ptr = reinterpret_cast<T*>(malloc(count * sizeof(T)));
     if (!ptr)
         zig_panic("allocation failed");
@@ -75,6 +97,7 @@ ATTRIBUTE_RETURNS_NOALIAS static inline T *allocate_nonzero(size_t count) {
 
 template<typename T>
 ATTRIBUTE_RETURNS_NOALIAS static inline T *allocate(size_t count) {
+    note_allocation();
     T *ptr = reinterpret_cast<T*>(calloc(count, sizeof(T)));
     if (!ptr)
         zig_panic("allocation failed");
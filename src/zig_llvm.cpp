@@ -24,12 +24,16 @@
 
 #include <llvm/Analysis/TargetLibraryInfo.h>
 #include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Bitcode/BitcodeWriterPass.h>
 #include <llvm/IR/DIBuilder.h>
 #include <llvm/IR/DiagnosticInfo.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/InlineAsm.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Verifier.h>
 #include <llvm/InitializePasses.h>
@@ -37,15 +41,21 @@
 #include <llvm/PassRegistry.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/TargetParser.h>
+#include <llvm/Support/Timer.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/IPO.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 #include <llvm/Transforms/IPO/AlwaysInliner.h>
 #include <llvm/Transforms/Scalar.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
 
 #include <lld/Driver/Driver.h>
 
+#include <thread>
+#include <vector>
+
 using namespace llvm;
 
 void ZigLLVMInitializeLoopStrengthReducePass(LLVMPassRegistryRef R) {
@@ -83,8 +93,19 @@ static const bool assertions_on = true;
 static const bool assertions_on = false;
 #endif
 
-bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMModuleRef module_ref,
-        const char *filename, LLVMCodeGenFileType file_type, char **error_message, bool is_debug)
+// Calls to inline functions have to be gone before validate_inline_fns looks for
+// them, so the minimal pipeline keeps the always inliner for modules which need it.
+static bool module_has_always_inline_fns(Module *module) {
+    for (Function &F : *module) {
+        if (!F.isDeclaration() && F.hasFnAttribute(Attribute::AlwaysInline))
+            return true;
+    }
+    return false;
+}
+
+static bool emit_module_to_file(TargetMachine *target_machine, Module *module, const char *filename,
+        TargetMachine::CodeGenFileType ft, char **error_message, bool is_debug, bool minimal_pipeline,
+        ZigLLVMLTOMode lto_mode)
 {
     std::error_code EC;
     raw_fd_ostream dest(filename, EC, sys::fs::F_None);
@@ -92,10 +113,24 @@ bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMM
         *error_message = strdup(EC.message().c_str());
         return true;
     }
-    TargetMachine* target_machine = reinterpret_cast<TargetMachine*>(targ_machine_ref);
     target_machine->setO0WantsFastISel(true);
 
-    Module* module = unwrap(module_ref);
+    if (minimal_pipeline && lto_mode == ZigLLVMLTOModeNone) {
+        target_machine->setFastISel(true);
+
+        legacy::PassManager MPM;
+        if (module_has_always_inline_fns(module)) {
+            MPM.add(createAlwaysInlinerLegacyPass(false));
+        }
+        if (target_machine->addPassesToEmitFile(MPM, dest, ft)) {
+            *error_message = strdup("TargetMachine can't emit a file of this type");
+            return true;
+        }
+        MPM.run(*module);
+
+        dest.close();
+        return false;
+    }
 
     PassManagerBuilder *PMBuilder = new PassManagerBuilder();
     PMBuilder->OptLevel = target_machine->getOptLevel();
@@ -112,8 +147,8 @@ bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMM
     PMBuilder->VerifyInput = assertions_on;
     PMBuilder->VerifyOutput = assertions_on;
     PMBuilder->MergeFunctions = !is_debug;
-    PMBuilder->PrepareForLTO = false;
-    PMBuilder->PrepareForThinLTO = false;
+    PMBuilder->PrepareForLTO = (lto_mode == ZigLLVMLTOModeFull);
+    PMBuilder->PrepareForThinLTO = (lto_mode == ZigLLVMLTOModeThin);
     PMBuilder->PerformThinLTO = false;
 
     TargetLibraryInfoImpl tlii(Triple(module->getTargetTriple()));
@@ -142,18 +177,20 @@ bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMM
     MPM.add(createTargetTransformInfoWrapperPass(target_machine->getTargetIRAnalysis()));
     PMBuilder->populateModulePassManager(MPM);
 
-    TargetMachine::CodeGenFileType ft;
-    switch (file_type) {
-        case LLVMAssemblyFile:
-            ft = TargetMachine::CGFT_AssemblyFile;
+    // the linker runs the rest of the pipeline and the code generator on the bitcode
+    switch (lto_mode) {
+        case ZigLLVMLTOModeNone:
+            if (target_machine->addPassesToEmitFile(MPM, dest, ft)) {
+                *error_message = strdup("TargetMachine can't emit a file of this type");
+                return true;
+            }
             break;
-        default:
-            ft = TargetMachine::CGFT_ObjectFile;
+        case ZigLLVMLTOModeThin:
+            MPM.add(createWriteThinLTOBitcodePass(dest));
+            break;
+        case ZigLLVMLTOModeFull:
+            MPM.add(createBitcodeWriterPass(dest));
             break;
-    }
-    if (target_machine->addPassesToEmitFile(MPM, dest, ft)) {
-        *error_message = strdup("TargetMachine can't emit a file of this type");
-        return true;
     }
 
     // run per function optimization passes
@@ -170,6 +207,110 @@ bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMM
     return false;
 }
 
+bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMModuleRef module_ref,
+        const char *filename, LLVMCodeGenFileType file_type, char **error_message, bool is_debug,
+        bool minimal_pipeline, ZigLLVMLTOMode lto_mode)
+{
+    TargetMachine* target_machine = reinterpret_cast<TargetMachine*>(targ_machine_ref);
+    Module* module = unwrap(module_ref);
+
+    TargetMachine::CodeGenFileType ft;
+    switch (file_type) {
+        case LLVMAssemblyFile:
+            ft = TargetMachine::CGFT_AssemblyFile;
+            break;
+        default:
+            ft = TargetMachine::CGFT_ObjectFile;
+            break;
+    }
+    return emit_module_to_file(target_machine, module, filename, ft, error_message, is_debug, minimal_pipeline,
+            lto_mode);
+}
+
+// Each partition is handed to its thread as bitcode because an LLVMContext
+// must not be used by more than one thread at a time.
+static void emit_partition(TargetMachine *parent_machine, const SmallVector<char, 0> *bitcode,
+        const char *filename, char **error_message, bool is_debug, bool minimal_pipeline)
+{
+    LLVMContext context;
+    MemoryBufferRef buffer(StringRef(bitcode->data(), bitcode->size()), filename);
+    Expected<std::unique_ptr<Module>> module_or_err = parseBitcodeFile(buffer, context);
+    if (!module_or_err) {
+        *error_message = strdup(toString(module_or_err.takeError()).c_str());
+        return;
+    }
+    std::unique_ptr<Module> module = std::move(*module_or_err);
+
+    const Target &target = parent_machine->getTarget();
+    std::unique_ptr<TargetMachine> target_machine(target.createTargetMachine(
+                parent_machine->getTargetTriple().str(), parent_machine->getTargetCPU(),
+                parent_machine->getTargetFeatureString(), parent_machine->Options,
+                parent_machine->getRelocationModel(), parent_machine->getCodeModel(),
+                parent_machine->getOptLevel()));
+
+    emit_module_to_file(target_machine.get(), module.get(), filename, TargetMachine::CGFT_ObjectFile,
+            error_message, is_debug, minimal_pipeline, ZigLLVMLTOModeNone);
+}
+
+bool ZigLLVMTargetMachineEmitToFiles(LLVMTargetMachineRef targ_machine_ref, LLVMModuleRef module_ref,
+        const char **filenames, size_t partition_count, char **error_message, bool is_debug,
+        bool minimal_pipeline)
+{
+    TargetMachine* target_machine = reinterpret_cast<TargetMachine*>(targ_machine_ref);
+    Module* module = unwrap(module_ref);
+
+    // Functions marked inline must be gone before the module is split, otherwise a call
+    // and its callee could land in different partitions. This also happens in place so
+    // that the caller can still find the inline functions that could not be inlined.
+    legacy::PassManager inline_pm;
+    inline_pm.add(createAlwaysInlinerLegacyPass(false));
+    inline_pm.run(*module);
+
+    std::unique_ptr<Module> split_module = CloneModule(module);
+
+    // SplitModule turns local symbols into hidden globals so that the partitions can
+    // reference each other. Give them names which cannot collide with the symbols of
+    // other objects in the same link.
+    std::string local_prefix = "__zig_part." + module->getModuleIdentifier() + ".";
+    for (GlobalValue &global_value : split_module->global_values()) {
+        if (global_value.hasLocalLinkage() && global_value.hasName() &&
+            !global_value.getName().startswith("llvm."))
+        {
+            global_value.setName(local_prefix + global_value.getName());
+        }
+    }
+
+    std::vector<SmallVector<char, 0>> bitcodes(partition_count);
+    size_t partition_index = 0;
+    SplitModule(std::move(split_module), partition_count, [&](std::unique_ptr<Module> part) {
+        // module level inline assembly is cloned into every partition
+        if (partition_index != 0)
+            part->setModuleInlineAsm("");
+        raw_svector_ostream bitcode_stream(bitcodes[partition_index]);
+        WriteBitcodeToFile(part.get(), bitcode_stream);
+        partition_index += 1;
+    });
+    assert(partition_index == partition_count);
+
+    std::vector<char *> error_messages(partition_count, nullptr);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < partition_count; i += 1) {
+        threads.emplace_back(emit_partition, target_machine, &bitcodes[i], filenames[i],
+                &error_messages[i], is_debug, minimal_pipeline);
+    }
+    for (size_t i = 0; i < partition_count; i += 1) {
+        threads[i].join();
+    }
+
+    for (size_t i = 0; i < partition_count; i += 1) {
+        if (error_messages[i] != nullptr) {
+            *error_message = error_messages[i];
+            return true;
+        }
+    }
+    return false;
+}
+
 
 LLVMValueRef ZigLLVMBuildCall(LLVMBuilderRef B, LLVMValueRef Fn, LLVMValueRef *Args,
         unsigned NumArgs, unsigned CC, bool always_inline, const char *Name)
@@ -217,6 +358,18 @@ ZigLLVMDIType *ZigLLVMCreateDebugArrayType(ZigLLVMDIBuilder *dibuilder, uint64_t
     return reinterpret_cast<ZigLLVMDIType*>(di_type);
 }
 
+ZigLLVMDIType *ZigLLVMCreateDebugVectorType(ZigLLVMDIBuilder *dibuilder, uint64_t size_in_bits,
+        uint64_t align_in_bits, ZigLLVMDIType *elem_type, int elem_count)
+{
+    SmallVector<Metadata *, 1> subrange;
+    subrange.push_back(reinterpret_cast<DIBuilder*>(dibuilder)->getOrCreateSubrange(0, elem_count));
+    DIType *di_type = reinterpret_cast<DIBuilder*>(dibuilder)->createVectorType(
+            size_in_bits, align_in_bits,
+            reinterpret_cast<DIType*>(elem_type),
+            reinterpret_cast<DIBuilder*>(dibuilder)->getOrCreateArray(subrange));
+    return reinterpret_cast<ZigLLVMDIType*>(di_type);
+}
+
 ZigLLVMDIEnumerator *ZigLLVMCreateDebugEnumerator(ZigLLVMDIBuilder *dibuilder, const char *name, int64_t val) {
     DIEnumerator *di_enumerator = reinterpret_cast<DIBuilder*>(dibuilder)->createEnumerator(name, val);
     return reinterpret_cast<ZigLLVMDIEnumerator*>(di_enumerator);
@@ -607,6 +760,10 @@ void ZigLLVMParseCommandLineOptions(int argc, const char *const *argv) {
     llvm::cl::ParseCommandLineOptions(argc, argv);
 }
 
+void ZigLLVMPrintTimers(void) {
+    TimerGroup::printAll(errs());
+}
+
 
 static_assert((Triple::ArchType)ZigLLVM_LastArchType == Triple::LastArchType, "");
 static_assert((Triple::VendorType)ZigLLVM_LastVendorType == Triple::LastVendorType, "");
@@ -732,6 +889,14 @@ LLVMValueRef ZigLLVMBuildCmpXchg(LLVMBuilderRef builder, LLVMValueRef ptr, LLVMV
                 mapFromLLVMOrdering(success_ordering), mapFromLLVMOrdering(failure_ordering)));
 }
 
+LLVMValueRef ZigLLVMBuildCondBrWeighted(LLVMBuilderRef builder, LLVMValueRef cond,
+        LLVMBasicBlockRef then_block, LLVMBasicBlockRef else_block, unsigned then_weight, unsigned else_weight)
+{
+    IRBuilder<> *irb = unwrap(builder);
+    MDNode *weights = MDBuilder(irb->getContext()).createBranchWeights(then_weight, else_weight);
+    return wrap(irb->CreateCondBr(unwrap(cond), unwrap(then_block), unwrap(else_block), weights));
+}
+
 LLVMValueRef ZigLLVMBuildNSWShl(LLVMBuilderRef builder, LLVMValueRef LHS, LLVMValueRef RHS,
         const char *name)
 {
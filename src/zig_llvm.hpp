@@ -34,8 +34,24 @@ void ZigLLVMInitializeLowerIntrinsicsPass(LLVMPassRegistryRef R);
 char *ZigLLVMGetHostCPUName(void);
 char *ZigLLVMGetNativeFeatures(void);
 
+enum ZigLLVMLTOMode {
+    ZigLLVMLTOModeNone,
+    ZigLLVMLTOModeThin,
+    ZigLLVMLTOModeFull,
+};
+
+// minimal_pipeline skips all optimization and verification passes and uses FastISel.
+// With an lto_mode other than none the module is optimized for link time
+// optimization and written as bitcode instead of file_type.
 bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMModuleRef module_ref,
-        const char *filename, LLVMCodeGenFileType file_type, char **error_message, bool is_debug);
+        const char *filename, LLVMCodeGenFileType file_type, char **error_message, bool is_debug,
+        bool minimal_pipeline, ZigLLVMLTOMode lto_mode);
+
+// Splits the module into partition_count object files which are optimized and
+// emitted concurrently, one thread per partition.
+bool ZigLLVMTargetMachineEmitToFiles(LLVMTargetMachineRef targ_machine_ref, LLVMModuleRef module_ref,
+        const char **filenames, size_t partition_count, char **error_message, bool is_debug,
+        bool minimal_pipeline);
 
 LLVMValueRef ZigLLVMBuildCall(LLVMBuilderRef B, LLVMValueRef Fn, LLVMValueRef *Args,
         unsigned NumArgs, unsigned CC, bool always_inline, const char *Name);
@@ -44,6 +60,9 @@ LLVMValueRef ZigLLVMBuildCmpXchg(LLVMBuilderRef builder, LLVMValueRef ptr, LLVMV
         LLVMValueRef new_val, LLVMAtomicOrdering success_ordering,
         LLVMAtomicOrdering failure_ordering);
 
+LLVMValueRef ZigLLVMBuildCondBrWeighted(LLVMBuilderRef builder, LLVMValueRef cond,
+        LLVMBasicBlockRef then_block, LLVMBasicBlockRef else_block, unsigned then_weight, unsigned else_weight);
+
 LLVMValueRef ZigLLVMBuildNSWShl(LLVMBuilderRef builder, LLVMValueRef LHS, LLVMValueRef RHS,
         const char *name);
 LLVMValueRef ZigLLVMBuildNUWShl(LLVMBuilderRef builder, LLVMValueRef LHS, LLVMValueRef RHS,
@@ -63,6 +82,10 @@ ZigLLVMDIType *ZigLLVMCreateDebugArrayType(ZigLLVMDIBuilder *dibuilder,
         uint64_t size_in_bits, uint64_t align_in_bits, ZigLLVMDIType *elem_type,
         int elem_count);
 
+ZigLLVMDIType *ZigLLVMCreateDebugVectorType(ZigLLVMDIBuilder *dibuilder,
+        uint64_t size_in_bits, uint64_t align_in_bits, ZigLLVMDIType *elem_type,
+        int elem_count);
+
 ZigLLVMDIEnumerator *ZigLLVMCreateDebugEnumerator(ZigLLVMDIBuilder *dibuilder, const char *name, int64_t val);
 
 ZigLLVMDIType *ZigLLVMCreateDebugEnumerationType(ZigLLVMDIBuilder *dibuilder, ZigLLVMDIScope *scope,
@@ -166,6 +189,8 @@ void ZigLLVMAddFunctionAttr(LLVMValueRef fn, const char *attr_name, const char *
 void ZigLLVMAddFunctionAttrCold(LLVMValueRef fn);
 
 void ZigLLVMParseCommandLineOptions(int argc, const char *const *argv);
+// Prints the timers which are still running to stderr, such as those of -time-passes.
+void ZigLLVMPrintTimers(void);
 
 
 // copied from include/llvm/ADT/Triple.h
@@ -11,6 +11,7 @@ const StdIo = os.ChildProcess.StdIo;
 const Term = os.ChildProcess.Term;
 const BufSet = @import("buf_set.zig").BufSet;
 const BufMap = @import("buf_map.zig").BufMap;
+const Buffer = @import("buffer.zig").Buffer;
 const fmt_lib = @import("fmt/index.zig");
 
 error ExtraArg;
@@ -19,6 +20,7 @@ error InvalidStepName;
 error DependencyLoopDetected;
 error NoCompilerFound;
 error NeedAnObject;
+error ParallelBuildUnsupported;
 
 pub const Builder = struct {
     uninstall_tls: TopLevelStep,
@@ -45,6 +47,16 @@ pub const Builder = struct {
     build_root: []const u8,
     cache_root: []const u8,
     release_mode: ?builtin.Mode,
+    /// How many child processes of steps may run at the same time.
+    max_jobs: usize,
+    /// Whether the compiler commands of steps are run by one `zig server`, which
+    /// keeps the standard library parsed between them. The server runs one
+    /// command at a time.
+    use_server: bool,
+    server: ?&os.ChildProcess,
+    /// The compiler binary which compiler_hash was computed from, see hashCompiler.
+    compiler_hash_path: ?[]const u8,
+    compiler_hash: u64,
 
     const UserInputOptionsMap = HashMap([]const u8, UserInputOption, mem.hash_slice_u8, mem.eql_slice_u8);
     const AvailableOptionsMap = HashMap([]const u8, AvailableOption, mem.hash_slice_u8, mem.eql_slice_u8);
@@ -114,6 +126,11 @@ pub const Builder = struct {
             },
             .have_install_step = false,
             .release_mode = null,
+            .max_jobs = 1,
+            .use_server = false,
+            .server = null,
+            .compiler_hash_path = null,
+            .compiler_hash = 0,
         };
         self.processNixOSEnvVars();
         self.default_step = self.step("default", "Build the project");
@@ -239,6 +256,15 @@ pub const Builder = struct {
             }
         }
 
+        if (self.max_jobs > 1) {
+            // the children of steps are polled, which Windows cannot do with pipes
+            if (builtin.os == builtin.Os.windows) {
+                %%io.stderr.printf("Running steps in parallel is not supported on Windows\n");
+                return error.ParallelBuildUnsupported;
+            }
+            return self.makeParallel(wanted_steps.toSliceConst());
+        }
+
         for (wanted_steps.toSliceConst()) |s| {
             %return self.makeOneStep(s);
         }
@@ -297,6 +323,177 @@ pub const Builder = struct {
         %return s.make();
     }
 
+    /// Appends s and the steps it depends on to all_steps, dependencies first.
+    fn collectSteps(self: &Builder, s: &Step, all_steps: &ArrayList(&Step)) -> %void {
+        if (s.loop_flag) {
+            %%io.stderr.printf("Dependency loop detected:\n  {}\n", s.name);
+            return error.DependencyLoopDetected;
+        }
+        for (all_steps.toSliceConst()) |collected_step| {
+            if (collected_step == s)
+                return;
+        }
+        s.loop_flag = true;
+
+        for (s.dependencies.toSlice()) |dep| {
+            self.collectSteps(dep, all_steps) %% |err| {
+                if (err == error.DependencyLoopDetected) {
+                    %%io.stderr.printf("  {}\n", s.name);
+                }
+                return err;
+            };
+        }
+
+        s.loop_flag = false;
+
+        %%all_steps.append(s);
+    }
+
+    /// Makes every step as soon as all of its dependencies are done, so that the
+    /// child processes of up to max_jobs steps run at the same time. A step is
+    /// done when its make function returned and the child it started, if any,
+    /// exited. The output of each child is printed after it exited.
+    fn makeParallel(self: &Builder, wanted_steps: []const &Step) -> %void {
+        var all_steps = ArrayList(&Step).init(self.allocator);
+        defer all_steps.deinit();
+        for (wanted_steps) |s| {
+            %return self.collectSteps(s, &all_steps);
+        }
+
+        var running_steps = ArrayList(&Step).init(self.allocator);
+        defer running_steps.deinit();
+        var poll_fds = ArrayList(os.posix.pollfd).init(self.allocator);
+        defer poll_fds.deinit();
+        var polled_outputs = ArrayList(PolledOutput).init(self.allocator);
+        defer polled_outputs.deinit();
+
+        var first_error: ?error = null;
+        while (true) {
+            // all_steps lists dependencies first, so one pass starts every ready step
+            for (all_steps.toSliceConst()) |s| {
+                if (first_error != null or running_steps.len >= self.max_jobs)
+                    break;
+                if (s.started_flag or s.done_flag or !s.dependenciesDone())
+                    continue;
+                startStep(s, &running_steps) %% |err| {
+                    first_error = err;
+                };
+            }
+            if (running_steps.len == 0)
+                break;
+
+            self.pollRunningSteps(&running_steps, &poll_fds, &polled_outputs) %% |err| {
+                if (first_error == null)
+                    first_error = err;
+            };
+        }
+
+        if (first_error) |err|
+            return err;
+    }
+
+    fn startStep(s: &Step, running_steps: &ArrayList(&Step)) -> %void {
+        s.started_flag = true;
+        %return s.makeFn(s);
+        if (s.child == null) {
+            s.done_flag = true;
+        } else {
+            %%running_steps.append(s);
+        }
+    }
+
+    /// The step and the index in its child_fds of the pollfd at the same index.
+    const PolledOutput = struct {
+        step: &Step,
+        child_fd_index: usize,
+    };
+
+    /// Reads the output of the children of running_steps until at least one of
+    /// them closed its output, and finishes the steps whose child closed it.
+    fn pollRunningSteps(self: &Builder, running_steps: &ArrayList(&Step),
+        poll_fds: &ArrayList(os.posix.pollfd), polled_outputs: &ArrayList(PolledOutput)) -> %void
+    {
+        %%poll_fds.resize(0);
+        %%polled_outputs.resize(0);
+        for (running_steps.toSliceConst()) |s| {
+            for (s.child_fds) |fd, fd_index| {
+                if (fd == -1)
+                    continue;
+                %%poll_fds.append(os.posix.pollfd {
+                    .fd = fd,
+                    .events = os.posix.POLLIN,
+                    .revents = 0,
+                });
+                %%polled_outputs.append(PolledOutput {
+                    .step = s,
+                    .child_fd_index = fd_index,
+                });
+            }
+        }
+
+        while (true) {
+            const err = os.posix.getErrno(os.posix.poll(&poll_fds.toSlice()[0], poll_fds.len, -1));
+            if (err == 0)
+                break;
+            if (err != os.posix.EINTR)
+                return os.unexpectedErrorPosix(err);
+        }
+
+        var buf: [4096]u8 = undefined;
+        for (poll_fds.toSliceConst()) |poll_fd, i| {
+            if (poll_fd.revents == 0)
+                continue;
+            const polled_output = polled_outputs.toSliceConst()[i];
+            const s = polled_output.step;
+            const amt_read = os.posix.read(poll_fd.fd, &buf[0], buf.len);
+            const err = os.posix.getErrno(amt_read);
+            if (err == os.posix.EINTR)
+                continue;
+            if (err == 0 and amt_read != 0) {
+                %%s.child_output.appendSlice(buf[0..amt_read]);
+            } else {
+                // the pipe is closed when the child stream is cleaned up
+                s.child_fds[polled_output.child_fd_index] = -1;
+            }
+        }
+
+        var first_error: ?error = null;
+        var still_running: usize = 0;
+        for (running_steps.toSliceConst()) |s| {
+            if (s.child_fds[0] != -1 or s.child_fds[1] != -1) {
+                running_steps.toSlice()[still_running] = s;
+                still_running += 1;
+                continue;
+            }
+            self.finishStep(s) %% |err| {
+                if (first_error == null)
+                    first_error = err;
+            };
+        }
+        running_steps.resizeDown(still_running);
+
+        if (first_error) |err|
+            return err;
+    }
+
+    fn finishStep(self: &Builder, s: &Step) -> %void {
+        const child = ??s.child;
+        defer child.deinit();
+        s.child = null;
+
+        const wait_result = child.wait();
+        %%io.stderr.write(s.child_output.toSliceConst());
+        %%io.stderr.flush();
+        s.child_output.deinit();
+
+        const term = %return wait_result;
+        %return self.checkChildTerm(s.child_name, &term);
+        if (s.finishFn) |finishFn| {
+            %return finishFn(s);
+        }
+        s.done_flag = true;
+    }
+
     fn getTopLevelStepByName(self: &Builder, name: []const u8) -> %&Step {
         for (self.top_level_steps.toSliceConst()) |top_level_step| {
             if (mem.eql(u8, top_level_step.step.name, name)) {
@@ -539,13 +736,7 @@ pub const Builder = struct {
     fn spawnChildEnvMap(self: &Builder, cwd: ?[]const u8, env_map: &const BufMap,
         argv: []const []const u8) -> %void
     {
-        if (self.verbose) {
-            if (cwd) |yes_cwd| %%io.stderr.print("cd {}; ", yes_cwd);
-            for (argv) |arg| {
-                %%io.stderr.print("{} ", arg);
-            }
-            %%io.stderr.printf("\n");
-        }
+        self.printChildCommand(cwd, argv);
 
         const child = %%os.ChildProcess.init(argv, self.allocator);
         defer child.deinit();
@@ -558,19 +749,226 @@ pub const Builder = struct {
             return err;
         };
 
-        switch (term) {
+        %return self.checkChildTerm(argv[0], &term);
+    }
+
+    /// Runs argv as the child process of step s. With -j the child runs while
+    /// other steps are made, and finishFn, if any, is called once it exited
+    /// successfully; otherwise this waits for the child and then calls finishFn.
+    pub fn startChild(self: &Builder, s: &Step, cwd: ?[]const u8, env_map: &const BufMap,
+        argv: []const []const u8, finishFn: ?fn(&Step) -> %void) -> %void
+    {
+        if (self.use_server and env_map == &self.env_map and argv.len >= 2 and
+            mem.eql(u8, argv[0], self.zig_exe))
+        {
+            %return self.runInServer(cwd, argv);
+            if (finishFn) |f| {
+                %return f(s);
+            }
+            return;
+        }
+
+        if (self.max_jobs <= 1) {
+            %return self.spawnChildEnvMap(cwd, env_map, argv);
+            if (finishFn) |f| {
+                %return f(s);
+            }
+            return;
+        }
+
+        self.printChildCommand(cwd, argv);
+
+        const child = %%os.ChildProcess.init(argv, self.allocator);
+        %defer child.deinit();
+
+        child.cwd = cwd;
+        child.env_map = env_map;
+        child.stdout_behavior = os.ChildProcess.StdIo.Pipe;
+        child.stderr_behavior = os.ChildProcess.StdIo.Pipe;
+
+        child.spawn() %% |err| {
+            %%io.stderr.printf("Unable to spawn {}: {}\n", argv[0], @errorName(err));
+            return err;
+        };
+
+        s.child = child;
+        s.child_name = argv[0];
+        s.child_fds[0] = (??child.stdout).fd;
+        s.child_fds[1] = (??child.stderr).fd;
+        s.child_output = ArrayList(u8).init(self.allocator);
+        s.finishFn = finishFn;
+    }
+
+    /// Returns true if running the compiler command argv would reproduce
+    /// output_path: the output exists, and the dependency manifest the command
+    /// wrote records the same compiler binary, the same command line and the
+    /// current contents of every file the compiler read.
+    pub fn isUpToDate(self: &Builder, argv: []const []const u8, output_path: []const u8,
+        dep_manifest_path: []const u8) -> bool
+    {
+        var output_stream = io.InStream.open(output_path, self.allocator) %% return false;
+        output_stream.close();
+
+        var manifest = Buffer.initNull(self.allocator);
+        defer manifest.deinit();
+        readFileInto(self.allocator, dep_manifest_path, &manifest) %% return false;
+
+        var line_it = mem.split(manifest.toSliceConst(), "\n");
+        const magic_line = line_it.next() ?? return false;
+        if (!mem.eql(u8, magic_line, "zig-dep-manifest 2"))
+            return false;
+        // compiler <version> <hash of the binary> <path of the binary>
+        const compiler_line = line_it.next() ?? return false;
+        if (!mem.startsWith(u8, compiler_line, "compiler "))
+            return false;
+        const version_end = mem.indexOfScalarPos(u8, compiler_line, 9, ' ') ?? return false;
+        const compiler_entry = compiler_line[version_end + 1..];
+        if (compiler_entry.len < 18 or compiler_entry[16] != ' ')
+            return false;
+        const expected_compiler_hash = fmt_lib.parseUnsigned(u64, compiler_entry[0..16], 16) %% return false;
+        const compiler_hash = self.hashCompiler(compiler_entry[17..]) %% return false;
+        if (compiler_hash != expected_compiler_hash)
+            return false;
+
+        const args_line = line_it.next() ?? return false;
+        if (!mem.startsWith(u8, args_line, "args "))
+            return false;
+        const expected_args_hash = fmt_lib.parseUnsigned(u64, args_line[5..], 16) %% return false;
+        var args_hash = fnv_offset_basis;
+        for (argv) |arg| {
+            // the compiler hashes each argument with its null terminator
+            fnvHash(&args_hash, arg);
+            fnvHash(&args_hash, []u8{0});
+        }
+        if (args_hash != expected_args_hash)
+            return false;
+
+        var contents = Buffer.initNull(self.allocator);
+        defer contents.deinit();
+        while (line_it.next()) |line| {
+            // 16 hex digits, a space, and the path
+            if (line.len < 18 or line[16] != ' ')
+                return false;
+            const expected_hash = fmt_lib.parseUnsigned(u64, line[0..16], 16) %% return false;
+            readFileInto(self.allocator, line[17..], &contents) %% return false;
+            var hash = fnv_offset_basis;
+            fnvHash(&hash, contents.toSliceConst());
+            if (hash != expected_hash)
+                return false;
+        }
+        return true;
+    }
+
+    /// Hashes the compiler binary at path like the compiler does for the dependency
+    /// manifest. The binary is large and the same for every step, so the hash is
+    /// computed once per build.
+    fn hashCompiler(self: &Builder, path: []const u8) -> %u64 {
+        if (self.compiler_hash_path) |hashed_path| {
+            if (mem.eql(u8, hashed_path, path))
+                return self.compiler_hash;
+        }
+        var contents = Buffer.initNull(self.allocator);
+        defer contents.deinit();
+        %return readFileInto(self.allocator, path, &contents);
+        var hash = fnv_offset_basis;
+        fnvHash(&hash, contents.toSliceConst());
+        self.compiler_hash_path = %return mem.dupe(self.allocator, u8, path);
+        self.compiler_hash = hash;
+        return hash;
+    }
+
+    /// Runs the zig command argv in the server, which is started the first time.
+    /// See the comment of the server function in src/main.cpp for the protocol.
+    fn runInServer(self: &Builder, cwd: ?[]const u8, argv: []const []const u8) -> %void {
+        // the fields of a request are separated by tabs and end at a newline
+        for (argv) |arg| {
+            if (mem.indexOfAny(u8, arg, "\t\n") != null) {
+                return self.spawnChildEnvMap(cwd, &self.env_map, argv);
+            }
+        }
+
+        self.printChildCommand(cwd, argv);
+
+        if (self.server == null) {
+            self.server = %return self.startServer();
+        }
+        const server = ??self.server;
+
+        var request = %%Buffer.init(self.allocator, cwd ?? ".");
+        defer request.deinit();
+        for (argv[1..]) |arg| {
+            %%request.appendByte('\t');
+            %%request.append(arg);
+        }
+        %%request.appendByte('\n');
+        const stdin = ??server.stdin;
+        %return stdin.write(request.toSliceConst());
+        %return stdin.flush();
+
+        var reply = Buffer.initNull(self.allocator);
+        defer reply.deinit();
+        (??server.stdout).readLine(&reply) %% |err| {
+            %%io.stderr.printf("zig server stopped unexpectedly\n");
+            return err;
+        };
+        if (!mem.eql(u8, reply.toSliceConst(), "exit 0\n")) {
+            %%io.stderr.printf("Process {} failed: {}", argv[0], reply.toSliceConst());
+            return error.UncleanExit;
+        }
+    }
+
+    fn startServer(self: &Builder) -> %&os.ChildProcess {
+        const argv = [][]const u8{self.zig_exe, "server"};
+        self.printChildCommand(null, argv);
+
+        const child = %%os.ChildProcess.init(argv, self.allocator);
+        %defer child.deinit();
+
+        child.env_map = &self.env_map;
+        child.stdin_behavior = StdIo.Pipe;
+        child.stdout_behavior = StdIo.Pipe;
+
+        child.spawn() %% |err| {
+            %%io.stderr.printf("Unable to spawn {}: {}\n", self.zig_exe, @errorName(err));
+            return err;
+        };
+
+        var line = Buffer.initNull(self.allocator);
+        defer line.deinit();
+        (??child.stdout).readLine(&line) %% |err| {
+            %%io.stderr.printf("Unable to start zig server: {}\n", @errorName(err));
+            return err;
+        };
+        if (!mem.eql(u8, line.toSliceConst(), "ready\n")) {
+            %%io.stderr.printf("Unable to start zig server: {}", line.toSliceConst());
+            return error.UncleanExit;
+        }
+        return child;
+    }
+
+    fn printChildCommand(self: &Builder, cwd: ?[]const u8, argv: []const []const u8) {
+        if (self.verbose) {
+            if (cwd) |yes_cwd| %%io.stderr.print("cd {}; ", yes_cwd);
+            for (argv) |arg| {
+                %%io.stderr.print("{} ", arg);
+            }
+            %%io.stderr.printf("\n");
+        }
+    }
+
+    fn checkChildTerm(self: &Builder, name: []const u8, term: &const Term) -> %void {
+        switch (*term) {
             Term.Exited => |code| {
                 if (code != 0) {
-                    %%io.stderr.printf("Process {} exited with error code {}\n", argv[0], code);
+                    %%io.stderr.printf("Process {} exited with error code {}\n", name, code);
                     return error.UncleanExit;
                 }
             },
             else => {
-                %%io.stderr.printf("Process {} terminated unexpectedly\n", argv[0]);
+                %%io.stderr.printf("Process {} terminated unexpectedly\n", name);
                 return error.UncleanExit;
             },
         };
-
     }
 
     pub fn makePath(self: &Builder, path: []const u8) -> %void {
@@ -744,6 +1142,7 @@ pub const LibExeObjStep = struct {
     out_h_filename: []const u8,
     assembly_files: ArrayList([]const u8),
     packages: ArrayList(Pkg),
+    compile_args: ArrayList([]const u8),
 
     // C only stuff
     source_files: ArrayList([]const u8),
@@ -838,6 +1237,7 @@ pub const LibExeObjStep = struct {
             .object_files = ArrayList([]const u8).init(builder.allocator),
             .assembly_files = ArrayList([]const u8).init(builder.allocator),
             .packages = ArrayList(Pkg).init(builder.allocator),
+            .compile_args = ArrayList([]const u8).init(builder.allocator),
             .is_zig = true,
             .full_path_libs = ArrayList([]const u8).init(builder.allocator),
             .need_flat_namespace_hack = false,
@@ -885,6 +1285,7 @@ pub const LibExeObjStep = struct {
             .out_h_filename = undefined,
             .assembly_files = undefined,
             .packages = undefined,
+            .compile_args = undefined,
         };
         self.computeOutFileNames();
         return self;
@@ -987,6 +1388,13 @@ pub const LibExeObjStep = struct {
         self.build_mode = mode;
     }
 
+    /// Passes an argument to the compiler after the ones the step derives from its
+    /// settings, so it can override them.
+    pub fn addCompileArg(self: &LibExeObjStep, arg: []const u8) {
+        assert(self.is_zig);
+        %%self.compile_args.append(arg);
+    }
+
     pub fn setOutputPath(self: &LibExeObjStep, file_path: []const u8) {
         self.output_path = file_path;
 
@@ -1128,6 +1536,10 @@ pub const LibExeObjStep = struct {
             builtin.Mode.ReleaseFast => %%zig_args.append("--release-fast"),
         }
 
+        for (self.compile_args.toSliceConst()) |arg| {
+            %%zig_args.append(arg);
+        }
+
         %%zig_args.append("--cache-dir");
         %%zig_args.append(builder.pathFromRoot(builder.cache_root));
 
@@ -1223,9 +1635,28 @@ pub const LibExeObjStep = struct {
             }
         }
 
-        %return builder.spawnChild(zig_args.toSliceConst());
+        const dep_manifest_path = %%os.path.join(builder.allocator,
+            builder.pathFromRoot(builder.cache_root), builder.fmt("{}.deps", self.out_filename));
+        %%zig_args.append("--dep-manifest");
+        %%zig_args.append(dep_manifest_path);
+
+        if (builder.isUpToDate(zig_args.toSliceConst(), output_path, dep_manifest_path)) {
+            if (builder.verbose) {
+                %%io.stderr.printf("{} is up to date\n", output_path);
+            }
+            return;
+        }
+
+        %return builder.startChild(&self.step, null, &builder.env_map, zig_args.toSliceConst(),
+            finishZig);
+    }
+
+    fn finishZig(step: &Step) -> %void {
+        const self = @fieldParentPtr(LibExeObjStep, "step", step);
+        const builder = self.builder;
 
         if (self.kind == Kind.Lib and !self.static and self.target.wantSharedLibSymLinks()) {
+            const output_path = builder.pathFromRoot(self.getOutputPath());
             %return doAtomicSymLinks(builder.allocator, output_path, self.major_only_filename,
                 self.name_only_filename);
         }
@@ -1634,7 +2065,7 @@ pub const TestStep = struct {
             %%zig_args.append(lib_path);
         }
 
-        %return builder.spawnChild(zig_args.toSliceConst());
+        %return builder.startChild(&self.step, null, &builder.env_map, zig_args.toSliceConst(), null);
     }
 };
 
@@ -1666,7 +2097,7 @@ pub const CommandStep = struct {
         const self = @fieldParentPtr(CommandStep, "step", step);
 
         const cwd = if (self.cwd) |cwd| self.builder.pathFromRoot(cwd) else null;
-        return self.builder.spawnChildEnvMap(cwd, self.env_map, self.argv);
+        return self.builder.startChild(&self.step, cwd, self.env_map, self.argv, null);
     }
 };
 
@@ -1821,6 +2252,14 @@ pub const Step = struct {
     loop_flag: bool,
     done_flag: bool,
 
+    // used by Builder.makeParallel and Builder.startChild
+    started_flag: bool,
+    child: ?&os.ChildProcess,
+    child_name: []const u8,
+    child_fds: [2]i32,
+    child_output: ArrayList(u8),
+    finishFn: ?fn(self: &Step) -> %void,
+
     pub fn init(name: []const u8, allocator: &Allocator, makeFn: fn (&Step)->%void) -> Step {
         Step {
             .name = name,
@@ -1828,8 +2267,22 @@ pub const Step = struct {
             .dependencies = ArrayList(&Step).init(allocator),
             .loop_flag = false,
             .done_flag = false,
+            .started_flag = false,
+            .child = null,
+            .child_name = undefined,
+            .child_fds = undefined,
+            .child_output = undefined,
+            .finishFn = null,
         }
     }
+
+    fn dependenciesDone(self: &const Step) -> bool {
+        for (self.dependencies.toSliceConst()) |dep| {
+            if (!dep.done_flag)
+                return false;
+        }
+        return true;
+    }
     pub fn initNoOp(name: []const u8, allocator: &Allocator) -> Step {
         init(name, allocator, makeNoOp)
     }
@@ -1849,6 +2302,22 @@ pub const Step = struct {
     fn makeNoOp(self: &Step) -> %void {}
 };
 
+// FNV-1a, as used for the hashes in the dependency manifests of the compiler
+const fnv_offset_basis: u64 = 14695981039346656037;
+const fnv_prime: u64 = 1099511628211;
+
+fn fnvHash(hash: &u64, bytes: []const u8) {
+    for (bytes) |b| {
+        *hash = (*hash ^ b) *% fnv_prime;
+    }
+}
+
+fn readFileInto(allocator: &Allocator, path: []const u8, buf: &Buffer) -> %void {
+    var stream = %return io.InStream.open(path, allocator);
+    defer stream.close();
+    %return stream.readAll(buf);
+}
+
 fn doAtomicSymLinks(allocator: &Allocator, output_path: []const u8, filename_major_only: []const u8,
     filename_name_only: []const u8) -> %void
 {
@@ -33,6 +33,12 @@ pub const timespec = extern struct {
     tv_nsec: isize,
 };
 
+pub const pollfd = extern struct {
+    fd: c_int,
+    events: c_short,
+    revents: c_short,
+};
+
 pub const sigset_t = u32;
 
 /// Renamed from `sigaction` to `Sigaction` to avoid conflict with function name.
@@ -191,6 +191,10 @@ pub fn pipe(fds: &[2]i32) -> usize {
     errnoWrap(c.pipe(@ptrCast(&c_int, fds)))
 }
 
+pub fn poll(fds: &pollfd, nfds: usize, timeout: i32) -> usize {
+    errnoWrap(c.poll(fds, c_uint(nfds), timeout))
+}
+
 pub fn mkdir(path: &const u8, mode: u32) -> usize {
     errnoWrap(c.mkdir(path, mode))
 }
@@ -268,6 +272,11 @@ pub const sigset_t = c.sigset_t;
 pub const empty_sigset = sigset_t(0);
 
 pub const timespec = c.timespec;
+pub const pollfd = c.pollfd;
+
+pub const POLLIN  = 0x0001;
+pub const POLLERR = 0x0008;
+pub const POLLHUP = 0x0010;
 
 /// Renamed from `sigaction` to `Sigaction` to avoid conflict with the syscall.
 pub const Sigaction = struct {
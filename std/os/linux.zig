@@ -423,6 +423,10 @@ pub fn pipe2(fd: &[2]i32, flags: usize) -> usize {
     arch.syscall2(arch.SYS_pipe2, @ptrToInt(fd), flags)
 }
 
+pub fn poll(fds: &pollfd, nfds: usize, timeout: i32) -> usize {
+    arch.syscall3(arch.SYS_poll, @ptrToInt(fds), nfds, @bitCast(usize, isize(timeout)))
+}
+
 pub fn write(fd: i32, buf: &const u8, count: usize) -> usize {
     arch.syscall3(arch.SYS_write, usize(fd), @ptrToInt(buf), count)
 }
@@ -731,6 +735,16 @@ pub fn accept4(fd: i32, noalias addr: &sockaddr, noalias len: &socklen_t, flags:
 pub const Stat = arch.Stat;
 pub const timespec = arch.timespec;
 
+pub const pollfd = extern struct {
+    fd: i32,
+    events: i16,
+    revents: i16,
+};
+
+pub const POLLIN  = 0x001;
+pub const POLLERR = 0x008;
+pub const POLLHUP = 0x010;
+
 pub fn fstat(fd: i32, stat_buf: &Stat) -> usize {
     arch.syscall2(arch.SYS_fstat, usize(fd), @ptrToInt(stat_buf))
 }
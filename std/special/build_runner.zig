@@ -1,5 +1,6 @@
 const root = @import("@build");
 const std = @import("std");
+const builtin = @import("builtin");
 const io = std.io;
 const fmt = std.fmt;
 const os = std.os;
@@ -69,6 +70,22 @@ pub fn main() -> %void {
                     %%io.stderr.printf("Expected argument after --prefix\n\n");
                     return usage(&builder, false, &io.stderr);
                 });
+            } else if (mem.eql(u8, arg, "--server")) {
+                builder.use_server = true;
+            } else if (mem.eql(u8, arg, "-j")) {
+                const jobs_arg = %return unwrapArg(arg_it.next(allocator) ?? {
+                    %%io.stderr.printf("Expected number of jobs after -j\n\n");
+                    return usage(&builder, false, &io.stderr);
+                });
+                builder.max_jobs = fmt.parseUnsigned(usize, jobs_arg, 10) %% 0;
+                if (builder.max_jobs == 0) {
+                    %%io.stderr.printf("Invalid number of jobs: {}\n\n", jobs_arg);
+                    return usage(&builder, false, &io.stderr);
+                }
+                if (builder.max_jobs > 1 and builtin.os == builtin.Os.windows) {
+                    %%io.stderr.printf("-j is not supported on Windows\n\n");
+                    return usage(&builder, false, &io.stderr);
+                }
             } else {
                 %%io.stderr.printf("Unrecognized argument: {}\n\n", arg);
                 return usage(&builder, false, &io.stderr);
@@ -121,6 +138,8 @@ fn usage(builder: &Builder, already_ran_build: bool, out_stream: &io.OutStream)
         \\  --verbose              Print commands before executing them
         \\  --debug-build-verbose  Print verbose debugging information for the build system itself
         \\  --prefix [prefix]      Override default install prefix
+        \\  -j [N]                 Run the commands of up to N independent steps at once (not on Windows)
+        \\  --server               Run the compiler commands in one zig server process
         \\
         \\Project-Specific Options:
         \\
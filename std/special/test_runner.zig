@@ -1,13 +1,93 @@
-const io = @import("std").io;
+const std = @import("std");
+const io = std.io;
+const os = std.os;
+const fmt = std.fmt;
+const mem = std.mem;
 const builtin = @import("builtin");
 const test_fn_list = builtin.__zig_test_fn_slice;
 
+error InvalidArgs;
+
+// `--shard i/n` runs the tests whose index modulo n is i - 1.
+// `--report` writes the start and the end of each test to file descriptor 3
+// instead of the progress to stderr; zig test --jobs uses it to time the tests.
+// The output of the tests cannot be mistaken for these lines since it does not
+// go to the same file.
 pub fn main() -> %void {
+    const allocator = &std.debug.global_allocator;
+    var shard = Shard { .index = 0, .count = 1 };
+    var report = false;
+    var report_stream: io.OutStream = undefined;
+
+    var arg_it = os.args();
+    _ = arg_it.skip();
+    while (arg_it.next(allocator)) |err_or_arg| {
+        const arg = %return err_or_arg;
+        if (mem.eql(u8, arg, "--report")) {
+            if (builtin.os == builtin.Os.windows) {
+                %%io.stderr.printf("--report is not supported on Windows\n");
+                return error.InvalidArgs;
+            } else {
+                report = true;
+                report_stream = io.OutStream {
+                    .fd = report_fd,
+                    .handle_id = {},
+                    .handle = {},
+                    .buffer = undefined,
+                    .index = 0,
+                };
+            }
+        } else if (mem.eql(u8, arg, "--shard")) {
+            const shard_arg = %return (arg_it.next(allocator) ?? {
+                %%io.stderr.printf("Expected i/n after --shard\n");
+                return error.InvalidArgs;
+            });
+            shard = parseShard(shard_arg) %% |err| {
+                %%io.stderr.printf("Invalid shard: {}\n", shard_arg);
+                return err;
+            };
+        } else {
+            %%io.stderr.printf("Unrecognized argument: {}\n", arg);
+            return error.InvalidArgs;
+        }
+    }
+
     for (test_fn_list) |test_fn, i| {
-        %%io.stderr.printf("Test {}/{} {}...", i + 1, test_fn_list.len, test_fn.name);
+        if (i % shard.count != shard.index)
+            continue;
+
+        if (report) {
+            %%report_stream.printf("start {} {}\n", i, test_fn.name);
+        } else {
+            %%io.stderr.printf("Test {}/{} {}...", i + 1, test_fn_list.len, test_fn.name);
+        }
 
         test_fn.func();
 
-        %%io.stderr.printf("OK\n");
+        if (report) {
+            %%report_stream.printf("pass {}\n", i);
+        } else {
+            %%io.stderr.printf("OK\n");
+        }
     }
 }
+
+// OS_CHILD_REPORT_FD in src/os.hpp
+const report_fd = 3;
+
+const Shard = struct {
+    index: usize,
+    count: usize,
+};
+
+fn parseShard(arg: []const u8) -> %Shard {
+    const slash_index = mem.indexOfScalar(u8, arg, '/') ?? return error.InvalidArgs;
+    const number = %return fmt.parseUnsigned(usize, arg[0..slash_index], 10);
+    const count = %return fmt.parseUnsigned(usize, arg[slash_index + 1..], 10);
+    if (number == 0 or number > count)
+        return error.InvalidArgs;
+    return Shard {
+        .index = number - 1,
+        .count = count,
+    };
+}
@@ -41,6 +41,7 @@ comptime {
     _ = @import("cases/try.zig");
     _ = @import("cases/undefined.zig");
     _ = @import("cases/var_args.zig");
+    _ = @import("cases/vector.zig");
     _ = @import("cases/void.zig");
     _ = @import("cases/while.zig");
 }
@@ -1,5 +1,6 @@
 const assert = @import("std").debug.assert;
 const AtomicOrder = @import("builtin").AtomicOrder;
+const AtomicRmwOp = @import("builtin").AtomicRmwOp;
 
 test "cmpxchg" {
     var x: i32 = 1234;
@@ -12,3 +13,60 @@ test "fence" {
     @fence(AtomicOrder.SeqCst);
     x = 5678;
 }
+
+test "atomicrmw and atomicload" {
+    var data: u8 = 200;
+    testAtomicRmw(&data);
+    assert(data == 42);
+    testAtomicLoad(&data);
+}
+
+fn testAtomicRmw(ptr: &u8) {
+    const prev_value = @atomicRmw(ptr, AtomicRmwOp.Xchg, 42, AtomicOrder.SeqCst);
+    assert(prev_value == 200);
+    comptime {
+        var x: i32 = 1234;
+        const y: i32 = 12345;
+        assert(@atomicLoad(&x, AtomicOrder.SeqCst) == 1234);
+        assert(@atomicLoad(&y, AtomicOrder.SeqCst) == 12345);
+    }
+}
+
+fn testAtomicLoad(ptr: &u8) {
+    const x = @atomicLoad(ptr, AtomicOrder.SeqCst);
+    assert(x == 42);
+}
+
+test "atomicrmw arithmetic" {
+    testAtomicRmwArithmetic();
+    comptime testAtomicRmwArithmetic();
+}
+
+fn testAtomicRmwArithmetic() {
+    var x: u32 = 10;
+    assert(@atomicRmw(&x, AtomicRmwOp.Add, 5, AtomicOrder.SeqCst) == 10);
+    assert(@atomicRmw(&x, AtomicRmwOp.Sub, 20, AtomicOrder.Monotonic) == 15);
+    assert(x == 0xfffffffb);
+    assert(@atomicRmw(&x, AtomicRmwOp.And, 0xff, AtomicOrder.AcqRel) == 0xfffffffb);
+    assert(@atomicRmw(&x, AtomicRmwOp.Or, 0x100, AtomicOrder.Acquire) == 0xfb);
+    assert(@atomicRmw(&x, AtomicRmwOp.Xor, 0x1ff, AtomicOrder.Release) == 0x1fb);
+    assert(x == 4);
+
+    var y: i64 = -3;
+    assert(@atomicRmw(&y, AtomicRmwOp.Max, 7, AtomicOrder.SeqCst) == -3);
+    assert(@atomicRmw(&y, AtomicRmwOp.Min, -9, AtomicOrder.SeqCst) == 7);
+    assert(y == -9);
+}
+
+test "atomicstore" {
+    testAtomicStore();
+    comptime testAtomicStore();
+}
+
+fn testAtomicStore() {
+    var x: u32 = 0;
+    @atomicStore(&x, 1, AtomicOrder.SeqCst);
+    assert(@atomicLoad(&x, AtomicOrder.SeqCst) == 1);
+    @atomicStore(&x, 12345678, AtomicOrder.Release);
+    assert(@atomicLoad(&x, AtomicOrder.Acquire) == 12345678);
+}
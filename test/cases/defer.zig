@@ -43,3 +43,23 @@ fn testBreakContInDefer(x: usize) {
         assert(i == 5);
     };
 }
+
+fn storeOnReturn(comptime T: type, x: T, out: &T) {
+    defer {*out = x;};
+    *out = 0;
+}
+
+test "defer in several instances of one generic function" {
+    var a: u8 = undefined;
+    var b: i32 = undefined;
+    var c: u64 = undefined;
+    var d: i16 = undefined;
+    storeOnReturn(u8, 1, &a);
+    storeOnReturn(i32, -2, &b);
+    storeOnReturn(u64, 3, &c);
+    storeOnReturn(i16, -4, &d);
+    assert(a == 1);
+    assert(b == -2);
+    assert(c == 3);
+    assert(d == -4);
+}
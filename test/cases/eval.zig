@@ -375,3 +375,49 @@ test "f128 at compile time is lossy" {
 
 // TODO need a better implementation of bigfloat_init_bigint
 // assert(f128(1 << 113) == 10384593717069655257060992658440192);
+
+test "modify one element of a compile-time array made with **" {
+    comptime {
+        const source = []u32{7};
+        var table = source ** 65536;
+        table[1000] = 1;
+        assert(table[999] == 7);
+        assert(table[1000] == 1);
+        assert(table[65535] == 7);
+        assert(source[0] == 7);
+    }
+}
+
+test "modify a compile-time string made with ++ and **" {
+    comptime {
+        var s = "ab" ++ "x" ** 3;
+        s[3] = 'y';
+        assert(s.len == 5);
+        assert(s[0] == 'a' and s[2] == 'x' and s[3] == 'y' and s[4] == 'x');
+    }
+}
+
+const lookup_table = {
+    @setEvalBranchQuota(70000);
+    var result = []i16{0} ** 65536;
+    var i: usize = 0;
+    while (i < result.len) : (i += 1) {
+        result[i] = i16(i % 1000) - 500;
+    }
+    result
+};
+
+test "compile-time integer lookup table filled in a loop" {
+    comptime assert(lookup_table[1234] == -266);
+    var index: usize = 65535;
+    assert(lookup_table[index] == 35);
+}
+
+test "++ and ** on compile-time integer arrays" {
+    comptime {
+        const a = []i32{-1, 2} ** 3;
+        const b = a ++ []i32{5, -6};
+        assert(b.len == 8);
+        assert(b[0] == -1 and b[5] == 2 and b[6] == 5 and b[7] == -6);
+    }
+}
@@ -0,0 +1,126 @@
+const assert = @import("std").debug.assert;
+const mem = @import("std").mem;
+const ReduceOp = @import("builtin").ReduceOp;
+
+test "vector integer arithmetic" {
+    testVectorIntArithmetic();
+    comptime testVectorIntArithmetic();
+}
+fn testVectorIntArithmetic() {
+    var a: @Vector(4, i32) = []i32{1, 2, 3, -4};
+    var b: @Vector(4, i32) = []i32{10, 20, 30, 2};
+    const sum: [4]i32 = a + b;
+    assert(mem.eql(i32, sum, []i32{11, 22, 33, -2}));
+    const diff: [4]i32 = a - b;
+    assert(mem.eql(i32, diff, []i32{-9, -18, -27, -6}));
+    const product: [4]i32 = a * b;
+    assert(mem.eql(i32, product, []i32{10, 40, 90, -8}));
+    const bits: [4]i32 = (a & b) | (a ^ b);
+    assert(mem.eql(i32, bits, []i32{11, 22, 31, -2}));
+}
+
+test "vector wrapping arithmetic" {
+    testVectorWrappingArithmetic();
+    comptime testVectorWrappingArithmetic();
+}
+fn testVectorWrappingArithmetic() {
+    var a: @Vector(4, u32) = []u32{1, 2, 3, 0xffffffff};
+    var b: @Vector(4, u32) = []u32{10, 20, 30, 2};
+    const sum: [4]u32 = a +% b;
+    assert(mem.eql(u32, sum, []u32{11, 22, 33, 1}));
+    const diff: [4]u32 = a -% b;
+    assert(mem.eql(u32, diff, []u32{0xfffffff7, 0xffffffee, 0xffffffe5, 0xfffffffd}));
+    const product: [4]u32 = a *% b;
+    assert(mem.eql(u32, product, []u32{10, 40, 90, 0xfffffffe}));
+}
+
+test "vector bit cast" {
+    testVectorBitCast();
+    comptime testVectorBitCast();
+}
+fn testVectorBitCast() {
+    var v: @Vector(2, u32) = []u32{1, 2};
+    const x = @bitCast(u64, v);
+    assert(x == 0x0000000200000001 or x == 0x0000000100000002);
+    const back: [2]u32 = @bitCast(@Vector(2, u32), x);
+    assert(mem.eql(u32, back, []u32{1, 2}));
+}
+
+test "vector float arithmetic" {
+    testVectorFloatArithmetic();
+    comptime testVectorFloatArithmetic();
+}
+fn testVectorFloatArithmetic() {
+    var a: @Vector(4, f32) = []f32{1.0, 2.0, 3.0, 4.0};
+    var b: @Vector(4, f32) = []f32{0.5, 0.5, 2.0, 8.0};
+    const result: [4]f32 = (a + b) * a / b - a;
+    assert(mem.eql(f32, result, []f32{2.0, 8.0, 4.5, 2.0}));
+}
+
+test "vector comparison" {
+    testVectorComparison();
+    comptime testVectorComparison();
+}
+fn testVectorComparison() {
+    var a: @Vector(4, i32) = []i32{-1, 2, 3, 4};
+    var b: @Vector(4, i32) = []i32{1, 2, -3, 5};
+    const less: [4]bool = a < b;
+    assert(mem.eql(bool, less, []bool{true, false, false, true}));
+    const equal: [4]bool = a == b;
+    assert(mem.eql(bool, equal, []bool{false, true, false, false}));
+}
+
+test "vector splat" {
+    testVectorSplat();
+    comptime testVectorSplat();
+}
+fn testVectorSplat() {
+    var x: u8 = 7;
+    const v: [8]u8 = @splat(8, x);
+    assert(mem.eql(u8, v, []u8{7, 7, 7, 7, 7, 7, 7, 7}));
+}
+
+test "vector shuffle" {
+    testVectorShuffle();
+    comptime testVectorShuffle();
+}
+fn testVectorShuffle() {
+    var a: @Vector(4, u16) = []u16{0, 1, 2, 3};
+    var b: @Vector(4, u16) = []u16{4, 5, 6, 7};
+    const interleaved: [4]u16 = @shuffle(a, b, []u32{0, 4, 1, 5});
+    assert(mem.eql(u16, interleaved, []u16{0, 4, 1, 5}));
+    const reversed: [4]u16 = @shuffle(a, undefined, []u32{3, 2, 1, 0});
+    assert(mem.eql(u16, reversed, []u16{3, 2, 1, 0}));
+    const low: [2]u16 = @shuffle(a, undefined, []u32{0, 1});
+    assert(mem.eql(u16, low, []u16{0, 1}));
+}
+
+test "vector reduce" {
+    testVectorReduce();
+    comptime testVectorReduce();
+}
+fn testVectorReduce() {
+    var a: @Vector(4, i32) = []i32{3, -1, 4, 1};
+    assert(@reduce(ReduceOp.Add, a) == 7);
+    assert(@reduce(ReduceOp.Mul, a) == -12);
+    assert(@reduce(ReduceOp.Min, a) == -1);
+    assert(@reduce(ReduceOp.Max, a) == 4);
+
+    var odd: @Vector(3, u8) = []u8{200, 100, 1};
+    assert(@reduce(ReduceOp.Add, odd) == 45);
+    assert(@reduce(ReduceOp.Xor, odd) == 173);
+
+    var f: @Vector(4, f64) = []f64{0.5, 1.5, 2.0, 4.0};
+    assert(@reduce(ReduceOp.Add, f) == 8.0);
+    assert(@reduce(ReduceOp.Max, f) == 4.0);
+
+    var ok: @Vector(2, bool) = []bool{true, false};
+    assert(@reduce(ReduceOp.Or, ok));
+    assert(!@reduce(ReduceOp.And, ok));
+}
+
+test "vector type name" {
+    assert(mem.eql(u8, @typeName(@Vector(4, f32)), "@Vector(4, f32)"));
+    assert(@Vector(4, f32) == @Vector(4, f32));
+    assert(@sizeOf(@Vector(4, u32)) == 16);
+}
@@ -0,0 +1,431 @@
+const os = @import("std").os;
+const builtin = @import("builtin");
+const tests = @import("tests.zig");
+
+/// --verbose prints the body of each function, then its IR, then its analyzed IR.
+fn analyzedIr(marker: []const u8) -> tests.CommandSequenceContext.Section {
+    return tests.CommandSequenceContext.Section {
+        .marker = marker,
+        .begin = "{ // (analyzed)\n",
+        .end = "\n}\n",
+    };
+}
+
+const comptime_cache_main =
+    \\const io = @import("std").io;
+    \\const scale = @import("scale.zig");
+    \\
+    \\fn triangle(n: u32) -> u32 {
+    \\    var total: u32 = 0;
+    \\    var i: u32 = 1;
+    \\    while (i <= n) : (i += 1) {
+    \\        total += i * scale.factor;
+    \\    }
+    \\    return total;
+    \\}
+    \\
+    \\const value = triangle(100);
+    \\
+    \\pub fn main() -> %void {
+    \\    %return io.stdout.printf("{}\n", value);
+    \\}
+    \\
+;
+// moves triangle and adds a declaration it does not use
+const comptime_cache_edited_main =
+    \\const io = @import("std").io;
+    \\const scale = @import("scale.zig");
+    \\
+    \\const unused: u32 = 1;
+    \\
+    \\fn triangle(n: u32) -> u32 {
+    \\    var total: u32 = 0;
+    \\    var i: u32 = 1;
+    \\    while (i <= n) : (i += 1) {
+    \\        total += i * scale.factor;
+    \\    }
+    \\    return total;
+    \\}
+    \\
+    \\const value = triangle(100);
+    \\
+    \\pub fn main() -> %void {
+    \\    %return io.stdout.printf("{}\n", value);
+    \\}
+    \\
+;
+
+const ComptimeCacheBuild = struct {
+    main: []const u8,
+    scale: []const u8,
+    extra_args: []const []const u8,
+    // whether --verbose-cache reports a miss or a hit for the call of triangle
+    miss: bool,
+    hit: bool,
+    output: []const u8,
+};
+
+const scale_factor_2 = "pub const factor = 2;\n";
+const scale_factor_3 = "pub const factor = 3;\n";
+
+const comptime_cache_builds = []ComptimeCacheBuild {
+    ComptimeCacheBuild { .main = comptime_cache_main, .scale = scale_factor_2, .extra_args = [][]const u8{}, .miss = true, .hit = false, .output = "10100\n" },
+    ComptimeCacheBuild { .main = comptime_cache_main, .scale = scale_factor_2, .extra_args = [][]const u8{}, .miss = false, .hit = true, .output = "10100\n" },
+    ComptimeCacheBuild { .main = comptime_cache_edited_main, .scale = scale_factor_2, .extra_args = [][]const u8{}, .miss = false, .hit = true, .output = "10100\n" },
+    // triangle reaches scale.factor
+    ComptimeCacheBuild { .main = comptime_cache_edited_main, .scale = scale_factor_3, .extra_args = [][]const u8{}, .miss = true, .hit = false, .output = "15150\n" },
+    ComptimeCacheBuild { .main = comptime_cache_edited_main, .scale = scale_factor_3, .extra_args = [][]const u8{"--no-comptime-cache"}, .miss = false, .hit = false, .output = "15150\n" },
+};
+
+const CImportCacheBuild = struct {
+    header: []const u8,
+    hit: bool,
+    output: []const u8,
+};
+
+const cimport_cache_builds = []CImportCacheBuild {
+    CImportCacheBuild { .header = "struct Point { int x; int y; };\n#define POINT_DIM 2\n", .hit = false, .output = "2 2\n" },
+    CImportCacheBuild { .header = "struct Point { int x; int y; };\n#define POINT_DIM 2\n", .hit = true, .output = "2 2\n" },
+    CImportCacheBuild { .header = "struct Point { int x; int y; };\n#define POINT_DIM 3\n", .hit = false, .output = "2 3\n" },
+};
+
+const test_jobs_passing =
+    \\test "jobs a" {}
+    \\test "jobs b" {}
+    \\test "jobs c" {}
+    \\test "jobs d" {}
+    \\test "jobs e" {}
+    \\test "jobs f" {}
+    \\
+;
+const test_jobs_failing =
+    \\const assert = @import("std").debug.assert;
+    \\
+    \\test "jobs a" {}
+    \\test "jobs b" {}
+    \\test "jobs c" {
+    \\    var ok = false;
+    \\    assert(ok);
+    \\}
+    \\test "jobs d" {}
+    \\test "jobs e" {}
+    \\test "jobs f" {}
+    \\
+;
+const test_jobs_printing =
+    \\const io = @import("std").io;
+    \\
+    \\test "jobs a" {
+    \\    %%io.stdout.printf("pass 0\nstart 1 forged\n");
+    \\}
+    \\test "jobs b" {}
+    \\
+;
+
+// The commands print lines while the others print theirs, and one of them fails
+// while two others are running.
+const build_jobs_source =
+    \\const Builder = @import("std").build.Builder;
+    \\
+    \\pub fn build(b: &Builder) {
+    \\    const slow_a = b.addCommand(null, &b.env_map, [][]const u8{"sh", "-c", "echo a1; sleep 0.4; echo a2"});
+    \\    const slow_b = b.addCommand(null, &b.env_map, [][]const u8{"sh", "-c", "sleep 0.2; echo b1; sleep 0.4; echo b2"});
+    \\    const fail = b.addCommand(null, &b.env_map, [][]const u8{"sh", "-c", "sleep 0.1; echo failing; exit 3"});
+    \\    const after = b.addCommand(null, &b.env_map, [][]const u8{"sh", "-c", "echo after"});
+    \\    after.step.dependOn(&fail.step);
+    \\
+    \\    const pass_step = b.step("pass", "Run the commands which pass");
+    \\    pass_step.dependOn(&slow_a.step);
+    \\    pass_step.dependOn(&slow_b.step);
+    \\
+    \\    const fail_step = b.step("fail", "Run every command");
+    \\    fail_step.dependOn(&slow_a.step);
+    \\    fail_step.dependOn(&slow_b.step);
+    \\    fail_step.dependOn(&after.step);
+    \\}
+    \\
+;
+
+const UpToDateRun = struct {
+    value: []const u8,
+    data: []const u8,
+    dim: []const u8,
+    up_to_date: bool,
+    output: []const u8,
+};
+
+// every run writes all of the files again, with the same contents or new ones
+const up_to_date_runs = []UpToDateRun {
+    UpToDateRun { .value = "1", .data = "one", .dim = "2", .up_to_date = false, .output = "1 one 2\n" },
+    UpToDateRun { .value = "1", .data = "one", .dim = "2", .up_to_date = true, .output = "1 one 2\n" },
+    UpToDateRun { .value = "5", .data = "one", .dim = "2", .up_to_date = false, .output = "5 one 2\n" },
+    UpToDateRun { .value = "5", .data = "two", .dim = "2", .up_to_date = false, .output = "5 two 2\n" },
+    UpToDateRun { .value = "5", .data = "two", .dim = "3", .up_to_date = false, .output = "5 two 3\n" },
+    UpToDateRun { .value = "5", .data = "two", .dim = "3", .up_to_date = true, .output = "5 two 3\n" },
+};
+
+pub fn addCases(cases: &tests.CommandSequenceContext) {
+    // zig server is not supported on Windows
+    if (builtin.os != builtin.Os.windows) {
+        // zig server answers each request with one line, and stops at the end of its input
+        const tc = cases.create("server build-obj replies");
+        const server = tc.addZig([][]const u8{"server"});
+        server.addFile("server_ok.zig",
+            \\export fn add(a: i32, b: i32) -> i32 {
+            \\    return a + b;
+            \\}
+        );
+        server.addFile("server_error.zig",
+            \\export fn add(a: i32, b: i32) -> i32 {
+            \\    return a + c;
+            \\}
+        );
+        server.stdin = ".\tbuild-obj\tserver_ok.zig\n.\tbuild-obj\tserver_error.zig\n";
+        server.stream = tests.CommandSequenceContext.Stream.Stdout;
+        server.expected_output = "ready\nexit 0\nexit 1\n";
+        cases.addCase(tc);
+    }
+
+    {
+        const tc = cases.create("safety elision (ReleaseSafe)");
+        const build_obj = tc.addZig([][]const u8{
+            "build-obj", "safety_elision.zig", "--name", "safety_elision", "--output", "safety_elision.o",
+            "--release-safe", "--verbose",
+        });
+        build_obj.addFile("safety_elision.zig",
+            \\var global_index: usize = 0;
+            \\
+            \\fn resetGlobalIndex() {
+            \\    global_index = 100;
+            \\}
+            \\
+            \\export fn sumLocalIndex(array: &const [8]u32) -> u32 {
+            \\    var local_total: u32 = 0;
+            \\    var i: usize = 0;
+            \\    while (i < 8) : (i += 1) {
+            \\        local_total +%= (*array)[i];
+            \\    }
+            \\    return local_total;
+            \\}
+            \\
+            \\export fn sumGlobalIndex(array: &const [8]u32) -> u32 {
+            \\    var global_total: u32 = 0;
+            \\    global_index = 0;
+            \\    while (global_index < 8) : (global_index += 1) {
+            \\        resetGlobalIndex();
+            \\        global_total +%= (*array)[global_index];
+            \\    }
+            \\    return global_total;
+            \\}
+            \\
+            \\export fn elemAtUnknownIndex(array: &const [8]u32, unknown_index: usize) -> u32 {
+            \\    return (*array)[unknown_index];
+            \\}
+        );
+        // each marker is a name which only occurs in the body of one function
+        // i < 8 bounds the index and the increment
+        build_obj.addCheck(analyzedIr("local_total"), " // no safety", true);
+        // the call may change a global between the comparison and the access
+        build_obj.addCheck(analyzedIr("global_total"), " // no safety", false);
+        build_obj.addCheck(analyzedIr("unknown_index"), " // no safety", false);
+        cases.addCase(tc);
+    }
+
+    {
+        // every build uses one cache directory, and the source changes in between
+        const tc = cases.create("comptime cache across rebuilds");
+        for (comptime_cache_builds) |build| {
+            const build_exe = tc.addZig([][]const u8{
+                "build-exe", "main.zig", "--name", "comptime_cache", "--output", "comptime_cache",
+                "--cache-dir", "zig-cache", "--verbose-cache",
+            });
+            build_exe.addArgs(build.extra_args);
+            build_exe.addFile("main.zig", build.main);
+            build_exe.addFile("scale.zig", build.scale);
+            build_exe.addCheck(null, "comptime cache miss: triangle\n", build.miss);
+            build_exe.addCheck(null, "comptime cache hit: triangle\n", build.hit);
+
+            const run = tc.addRun([][]const u8{"comptime_cache"});
+            run.expected_output = build.output;
+        }
+        cases.addCase(tc);
+    }
+
+    {
+        // every build uses one cache directory, and the header changes in between
+        const tc = cases.create("cimport cache across rebuilds");
+        for (cimport_cache_builds) |build, i| {
+            const build_exe = tc.addZig([][]const u8{
+                "build-exe", "main.zig", "--name", "cimport_cache", "--output", "cimport_cache",
+                "--cache-dir", "zig-cache", "--verbose-cache", "-isystem", ".",
+            });
+            if (i == 0) {
+                build_exe.addFile("main.zig",
+                    \\const io = @import("std").io;
+                    \\const a = @cImport(@cInclude("point.h"));
+                    \\const b = @cImport(@cInclude("point.h"));
+                    \\
+                    \\// a and b have the same types only if both blocks share one translation
+                    \\fn samePoint(p: &const a.struct_Point) -> &const b.struct_Point {
+                    \\    return p;
+                    \\}
+                    \\
+                    \\pub fn main() -> %void {
+                    \\    const point = a.struct_Point { .x = 1, .y = 2 };
+                    \\    %return io.stdout.printf("{} {}\n", samePoint(&point).y, b.POINT_DIM);
+                    \\}
+                    \\
+                );
+            }
+            build_exe.addFile("point.h", build.header);
+            build_exe.addCheck(null, "cimport cache hit: ", build.hit);
+            build_exe.addCheck(null, "cimport cache miss: ", !build.hit);
+            build_exe.addExpected("cimport cache shared: ");
+
+            const run = tc.addRun([][]const u8{"cimport_cache"});
+            run.expected_output = build.output;
+        }
+        cases.addCase(tc);
+    }
+
+    // zig test --jobs is rejected on Windows, and a shard runs there without the timings
+    if (builtin.os != builtin.Os.windows) {
+        // each expected line ends with a newline, so that "jobs a" does not match "jobs ab"
+        {
+            const tc = cases.create("zig test --jobs 3");
+            const zig_test = tc.addZig([][]const u8{"test", "jobs.zig", "--jobs", "3", "--enable-timing-info"});
+            zig_test.addFile("jobs.zig", test_jobs_passing);
+            for ([][]const u8{
+                "All tests:\n", "s jobs a\n", "s jobs b\n", "s jobs c\n", "s jobs d\n", "s jobs e\n",
+                "s jobs f\n", "\n6 tests passed in ", " using 3 processes.\n",
+            }) |text| {
+                zig_test.addExpected(text);
+            }
+            zig_test.addUnexpected("failed.\n");
+            cases.addCase(tc);
+        }
+
+        {
+            const tc = cases.create("zig test --shard 2/3");
+            const zig_test = tc.addZig([][]const u8{"test", "jobs.zig", "--shard", "2/3", "--enable-timing-info"});
+            zig_test.addFile("jobs.zig", test_jobs_passing);
+            for ([][]const u8{"s jobs b\n", "s jobs e\n", "\n2 tests passed in ", " using 1 processes.\n"}) |text| {
+                zig_test.addExpected(text);
+            }
+            for ([][]const u8{"s jobs a\n", "s jobs c\n", "s jobs d\n", "s jobs f\n", "failed.\n"}) |text| {
+                zig_test.addUnexpected(text);
+            }
+            cases.addCase(tc);
+        }
+
+        {
+            // jobs c and jobs f are the third shard of three, and jobs f does not run
+            const tc = cases.create("zig test --jobs 3 with a failing test");
+            const zig_test = tc.addZig([][]const u8{"test", "jobs.zig", "--jobs", "3"});
+            zig_test.addFile("jobs.zig", test_jobs_failing);
+            zig_test.passed = false;
+            for ([][]const u8{
+                "\nTest jobs c failed.\n", "Use the following command to reproduce the failure:\n",
+                "test --shard 3/3\n", "\n4 tests passed in ",
+            }) |text| {
+                zig_test.addExpected(text);
+            }
+            zig_test.addUnexpected("Test runner failed.\n");
+            cases.addCase(tc);
+        }
+
+        {
+            // the runner reports to a file of its own, so what a test prints is not a report
+            const tc = cases.create("zig test --jobs 2 with a test which prints reports");
+            const zig_test = tc.addZig([][]const u8{"test", "jobs.zig", "--jobs", "2", "--enable-timing-info"});
+            zig_test.addFile("jobs.zig", test_jobs_printing);
+            for ([][]const u8{"s jobs a\n", "s jobs b\n", "\n2 tests passed in "}) |text| {
+                zig_test.addExpected(text);
+            }
+            for ([][]const u8{"forged\n", "failed.\n"}) |text| {
+                zig_test.addUnexpected(text);
+            }
+            cases.addCase(tc);
+        }
+    }
+
+    // the build script runs sh, and -j is rejected on Windows
+    if (builtin.os != builtin.Os.windows) {
+        {
+            // a cache directory of its own keeps the files these steps write apart from
+            // the ones the same steps of this build write
+            const tc = cases.create("zig build -j 4 test steps");
+            const zig_build = tc.addZig([][]const u8{
+                "build", "-j", "4", "--cache-dir", %%os.path.join(cases.b.allocator, cases.b.cache_root, "build_jobs_suite"),
+                "test-asm-link", "test-parsec", "test-build-examples",
+            });
+            zig_build.cwd = cases.b.build_root;
+            cases.addCase(tc);
+        }
+
+        {
+            // the output of each command comes out in one piece
+            const tc = cases.create("zig build -j 4 passing steps");
+            const zig_build = tc.addZig([][]const u8{"build", "-j", "4", "pass"});
+            zig_build.addFile("build.zig", build_jobs_source);
+            zig_build.addExpected("a1\na2\n");
+            zig_build.addExpected("b1\nb2\n");
+            zig_build.addUnexpected("failing\n");
+            cases.addCase(tc);
+        }
+
+        {
+            // the running commands finish, and the step which depends on the failed one
+            // does not run
+            const tc = cases.create("zig build -j 4 failing step");
+            const zig_build = tc.addZig([][]const u8{"build", "-j", "4", "fail"});
+            zig_build.addFile("build.zig", build_jobs_source);
+            zig_build.passed = false;
+            for ([][]const u8{"failing\n", "Process sh exited with error code 3\n", "a1\na2\n", "b1\nb2\n"}) |text| {
+                zig_build.addExpected(text);
+            }
+            zig_build.addUnexpected("after\n");
+            cases.addCase(tc);
+        }
+    }
+
+    {
+        // changes an imported file, an @embedFile input and a @cImport header in between
+        const tc = cases.create("zig build up to date check");
+        for (up_to_date_runs) |run, i| {
+            const zig_build = tc.addZig([][]const u8{"build", "--verbose"});
+            if (i == 0) {
+                zig_build.addFile("build.zig",
+                    \\const Builder = @import("std").build.Builder;
+                    \\
+                    \\pub fn build(b: &Builder) {
+                    \\    b.addCIncludePath(".");
+                    \\    const exe = b.addExecutable("app", "main.zig");
+                    \\    b.default_step.dependOn(&exe.step);
+                    \\}
+                    \\
+                );
+                zig_build.addFile("main.zig",
+                    \\const io = @import("std").io;
+                    \\const util = @import("util.zig");
+                    \\const c = @cImport(@cInclude("dim.h"));
+                    \\
+                    \\pub fn main() -> %void {
+                    \\    const data: []const u8 = @embedFile("data.txt");
+                    \\    %return io.stdout.printf("{} {} {}\n", util.value, data, i32(c.DIM));
+                    \\}
+                    \\
+                );
+            }
+            zig_build.addFile("util.zig", cases.b.fmt("pub const value: i32 = {};\n", run.value));
+            zig_build.addFile("data.txt", run.data);
+            zig_build.addFile("dim.h", cases.b.fmt("#define DIM {}\n", run.dim));
+            zig_build.addCheck(null, " is up to date\n", run.up_to_date);
+
+            const exe_path = if (builtin.os == builtin.Os.windows) "zig-cache/app.exe" else "zig-cache/app";
+            const app = tc.addRun([][]const u8{exe_path});
+            app.expected_output = run.output;
+        }
+        cases.addCase(tc);
+    }
+}
@@ -382,6 +382,27 @@ pub fn addCases(cases: &tests.CompareOutputContext) {
         \\}
     , "before\ndefer2\ndefer1\n");
 
+    cases.addFastDebug("defer and error return with the fast debug pipeline",
+        \\const io = @import("std").io;
+        \\pub fn main() -> %void {
+        \\    var sum: u32 = 0;
+        \\    for ([]u32{1, 2, 3, 4}) |x| {
+        \\        sum += x;
+        \\    }
+        \\    defer %%io.stdout.printf("defer\n");
+        \\    do_test(sum) %% |err| {
+        \\        %%io.stdout.printf("{}\n", @errorName(err));
+        \\        return;
+        \\    };
+        \\}
+        \\error SumIsTen;
+        \\fn do_test(sum: u32) -> %void {
+        \\    %defer %%io.stdout.printf("deferErr\n");
+        \\    %%io.stdout.printf("sum {}\n", sum);
+        \\    if (sum == 10) return error.SumIsTen;
+        \\}
+    , "sum 10\ndeferErr\nSumIsTen\ndefer\n");
+
     cases.add("%defer and it fails",
         \\const io = @import("std").io;
         \\pub fn main() -> %void {
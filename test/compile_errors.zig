@@ -2231,4 +2231,63 @@ pub fn addCases(cases: &tests.CompileErrorContext) {
         \\}
     ,
         ".tmp_source.zig:37:16: error: cannot store runtime value in compile time variable");
+
+    cases.add("vector of slices",
+        \\export fn entry() {
+        \\    var v: @Vector(4, []u8) = undefined;
+        \\}
+    ,
+        ".tmp_source.zig:2:23: error: vector element type must be an integer, float or bool, found '[]u8'");
+
+    cases.add("integer vector division",
+        \\export fn entry() {
+        \\    var a: @Vector(4, u32) = undefined;
+        \\    var b: @Vector(4, u32) = undefined;
+        \\    _ = a / b;
+        \\}
+    ,
+        ".tmp_source.zig:4:11: error: invalid operands to binary expression: '@Vector(4, u32)' and '@Vector(4, u32)'");
+
+    cases.add("vector addition overflow at compile time",
+        \\export fn entry() {
+        \\    const a: @Vector(2, u8) = []u8{1, 255};
+        \\    const b: @Vector(2, u8) = []u8{1, 1};
+        \\    _ = a + b;
+        \\}
+    ,
+        ".tmp_source.zig:4:11: error: operation caused overflow in element 1");
+
+    cases.add("bit cast of a bool vector at compile time",
+        \\export fn entry() {
+        \\    const v: @Vector(8, bool) = []bool{true, false, true, false, true, false, true, false};
+        \\    _ = @bitCast(u8, v);
+        \\}
+    ,
+        ".tmp_source.zig:3:9: error: unable to @bitCast '@Vector(8, bool)' at compile time: its elements are not whole bytes");
+
+    cases.add("shuffle mask index out of bounds",
+        \\export fn entry() {
+        \\    var a: @Vector(2, u8) = undefined;
+        \\    var b = @shuffle(a, a, []u32{0, 4});
+        \\}
+    ,
+        ".tmp_source.zig:3:28: error: shuffle mask index 1 out of bounds: the operands have 4 elements");
+
+    cases.add("atomicRmw on a float",
+        \\const builtin = @import("builtin");
+        \\export fn entry() {
+        \\    var x: f32 = 0;
+        \\    _ = @atomicRmw(&x, builtin.AtomicRmwOp.Add, 1, builtin.AtomicOrder.SeqCst);
+        \\}
+    ,
+        ".tmp_source.zig:4:20: error: expected integer type, found 'f32'");
+
+    cases.add("atomicLoad with release ordering",
+        \\const AtomicOrder = @import("builtin").AtomicOrder;
+        \\export fn entry() -> i32 {
+        \\    var x: i32 = 1;
+        \\    return @atomicLoad(&x, AtomicOrder.Release);
+        \\}
+    ,
+        ".tmp_source.zig:4:39: error: @atomicLoad atomic ordering must not be Release or AcqRel");
 }
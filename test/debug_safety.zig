@@ -38,6 +38,39 @@ pub fn addCases(cases: &tests.CompareOutputContext) {
         \\}
     );
 
+    cases.addDebugSafety("vector integer multiplication overflow",
+        \\pub fn panic(message: []const u8) -> noreturn {
+        \\    @import("std").os.exit(126);
+        \\}
+        \\error Whatever;
+        \\pub fn main() -> %void {
+        \\    var a: @Vector(4, i16) = []i16{1, 2, 300, 4};
+        \\    var b: @Vector(4, i16) = []i16{1, 2, 300, 4};
+        \\    const x: [4]i16 = mul(a, b);
+        \\    if (x[0] == 0) return error.Whatever;
+        \\}
+        \\fn mul(a: @Vector(4, i16), b: @Vector(4, i16)) -> @Vector(4, i16) {
+        \\    a * b
+        \\}
+    );
+
+    // Outside debug builds the two overflow checks share one crash block.
+    cases.addReleaseSafety("two integer overflow checks in one function",
+        \\pub fn panic(message: []const u8) -> noreturn {
+        \\    @import("std").os.exit(126);
+        \\}
+        \\error Whatever;
+        \\pub fn main() -> %void {
+        \\    const x = addThenMul(1, 2, 40000, 2);
+        \\    if (x == 0) return error.Whatever;
+        \\}
+        \\fn addThenMul(a: u16, b: u16, c: u16, d: u16) -> u16 {
+        \\    const sum = a + b;
+        \\    const product = c * d;
+        \\    return sum +% product;
+        \\}
+    );
+
     cases.addDebugSafety("integer subtraction overflow",
         \\pub fn panic(message: []const u8) -> noreturn {
         \\    @import("std").os.exit(126);
@@ -260,4 +293,46 @@ pub fn addCases(cases: &tests.CompareOutputContext) {
         \\    return int_slice[0];
         \\}
     );
+
+    // ReleaseSafe removes the bounds checks of loops whose condition bounds the
+    // index; these two loops must keep theirs.
+    cases.addReleaseSafety("out of bounds slice access in a loop the condition does not bound",
+        \\pub fn panic(message: []const u8) -> noreturn {
+        \\    @import("std").os.exit(126);
+        \\}
+        \\error Wrong;
+        \\pub fn main() -> %void {
+        \\    var array = []u8{1, 2, 3};
+        \\    if (sum(array[0..]) != 6) return error.Wrong;
+        \\}
+        \\fn sum(s: []const u8) -> u8 {
+        \\    var total: u8 = 0;
+        \\    var i: usize = 0;
+        \\    while (i <= s.len) : (i += 1) {
+        \\        total += s[i];
+        \\    }
+        \\    return total;
+        \\}
+    );
+
+    cases.addReleaseSafety("out of bounds slice access after the loop index changes",
+        \\pub fn panic(message: []const u8) -> noreturn {
+        \\    @import("std").os.exit(126);
+        \\}
+        \\error Wrong;
+        \\pub fn main() -> %void {
+        \\    var array = []u8{1, 2, 3};
+        \\    if (sum(array[0..]) != 2) return error.Wrong;
+        \\}
+        \\fn sum(s: []const u8) -> u8 {
+        \\    var total: u8 = 0;
+        \\    var i: usize = 0;
+        \\    while (i < s.len) : (i += 1) {
+        \\        total += s[i];
+        \\        i += 1;
+        \\        total += s[i];
+        \\    }
+        \\    return total;
+        \\}
+    );
 }
@@ -18,6 +18,7 @@ const compile_errors = @import("compile_errors.zig");
 const assemble_and_link = @import("assemble_and_link.zig");
 const debug_safety = @import("debug_safety.zig");
 const parsec = @import("parsec.zig");
+const command_sequences = @import("command_sequences.zig");
 
 const TestTarget = struct {
     os: builtin.Os,
@@ -134,6 +135,121 @@ pub fn addParseCTests(b: &build.Builder, test_filter: ?[]const u8) -> &build.Ste
     return cases.step;
 }
 
+pub fn addCommandSequenceTests(b: &build.Builder, test_filter: ?[]const u8) -> &build.Step {
+    const cases = %%b.allocator.create(CommandSequenceContext);
+    *cases = CommandSequenceContext {
+        .b = b,
+        .step = b.step("test-command-sequences", "Run the tests which check the output of a sequence of commands"),
+        .test_index = 0,
+        .test_filter = test_filter,
+    };
+
+    command_sequences.addCases(cases);
+
+    return cases.step;
+}
+
+/// Builds the behavior tests with and without --ir-gen-threads and checks that
+/// the two test binaries are the same. The test command copies each binary.
+pub fn addIrGenThreadsTests(b: &build.Builder) -> &build.Step {
+    const step = b.step("test-ir-gen-threads", "Check that --ir-gen-threads builds the same binary");
+    const serial_path = %%os.path.join(b.allocator, b.cache_root, "behavior-serial");
+    const parallel_path = %%os.path.join(b.allocator, b.cache_root, "behavior-ir-gen-threads");
+
+    const serial = b.addCommand(null, &b.env_map, [][]const u8{
+        b.zig_exe, "test", "test/behavior.zig",
+        "--test-cmd", "cp", "--test-cmd-bin", "--test-cmd", serial_path,
+    });
+    const parallel = b.addCommand(null, &b.env_map, [][]const u8{
+        b.zig_exe, "test", "test/behavior.zig", "--ir-gen-threads", "4",
+        "--test-cmd", "cp", "--test-cmd-bin", "--test-cmd", parallel_path,
+    });
+    // both builds write ./test
+    parallel.step.dependOn(&serial.step);
+
+    const compare = %%b.allocator.create(CompareFilesStep);
+    *compare = CompareFilesStep {
+        .step = build.Step.init("CompareFiles", b.allocator, CompareFilesStep.make),
+        .b = b,
+        .path_a = serial_path,
+        .path_b = parallel_path,
+    };
+    compare.step.dependOn(&parallel.step);
+
+    const run = b.addCommand(null, &b.env_map, [][]const u8{parallel_path});
+    run.step.dependOn(&compare.step);
+    step.dependOn(&run.step);
+    return step;
+}
+
+pub fn addLtoTests(b: &build.Builder) -> &build.Step {
+    const step = b.step("test-lto", "Run the behavior tests built with --lto");
+    for ([][]const u8{"thin", "full"}) |lto_mode| {
+        const run = b.addCommand(null, &b.env_map, [][]const u8{
+            b.zig_exe, "test", "test/behavior.zig", "--release-fast", "--lto", lto_mode,
+        });
+        step.dependOn(&run.step);
+    }
+    return step;
+}
+
+/// Runs the behavior tests with the module split across 4 codegen threads, in
+/// Debug and in ReleaseFast.
+pub fn addCodegenThreadsTests(b: &build.Builder) -> &build.Step {
+    const step = b.step("test-codegen-threads", "Run the behavior tests built with --codegen-threads");
+    var prev_run: ?&build.Step = null;
+    for ([]Mode{Mode.Debug, Mode.ReleaseFast}) |mode| {
+        var argv = ArrayList([]const u8).init(b.allocator);
+        %%argv.appendSlice([][]const u8{b.zig_exe, "test", "test/behavior.zig", "--codegen-threads", "4"});
+        switch (mode) {
+            Mode.Debug => {},
+            Mode.ReleaseSafe => %%argv.append("--release-safe"),
+            Mode.ReleaseFast => %%argv.append("--release-fast"),
+        }
+        const run = b.addCommand(null, &b.env_map, argv.toSliceConst());
+        // every build writes ./test
+        if (prev_run) |prev| {
+            run.step.dependOn(prev);
+        }
+        prev_run = &run.step;
+        step.dependOn(&run.step);
+    }
+    return step;
+}
+
+const CompareFilesStep = struct {
+    step: build.Step,
+    b: &build.Builder,
+    path_a: []const u8,
+    path_b: []const u8,
+
+    fn make(step: &build.Step) -> %void {
+        const self = @fieldParentPtr(CompareFilesStep, "step", step);
+        const b = self.b;
+
+        var contents_a = Buffer.initNull(b.allocator);
+        defer contents_a.deinit();
+        var contents_b = Buffer.initNull(b.allocator);
+        defer contents_b.deinit();
+        %return readFile(b, self.path_a, &contents_a);
+        %return readFile(b, self.path_b, &contents_b);
+
+        if (!mem.eql(u8, contents_a.toSliceConst(), contents_b.toSliceConst())) {
+            %%io.stderr.printf("{} and {} differ\n", self.path_a, self.path_b);
+            return error.TestFailed;
+        }
+    }
+
+    fn readFile(b: &build.Builder, path: []const u8, buf: &Buffer) -> %void {
+        var stream = io.InStream.open(path, b.allocator) %% |err| {
+            %%io.stderr.printf("Unable to open {}: {}\n", path, @errorName(err));
+            return err;
+        };
+        defer stream.close();
+        %return stream.readAll(buf);
+    }
+};
+
 pub fn addPkgTests(b: &build.Builder, test_filter: ?[]const u8, root_src: []const u8,
     name:[] const u8, desc: []const u8, with_lldb: bool) -> &build.Step
 {
@@ -178,6 +294,8 @@ pub const CompareOutputContext = struct {
         None,
         Asm,
         DebugSafety,
+        ReleaseSafety,
+        FastDebug,
     };
 
     const TestCase = struct {
@@ -391,6 +509,16 @@ pub const CompareOutputContext = struct {
         self.addCase(tc);
     }
 
+    pub fn addReleaseSafety(self: &CompareOutputContext, name: []const u8, source: []const u8) {
+        const tc = self.createExtra(name, source, undefined, Special.ReleaseSafety);
+        self.addCase(tc);
+    }
+
+    pub fn addFastDebug(self: &CompareOutputContext, name: []const u8, source: []const u8, expected_output: []const u8) {
+        const tc = self.createExtra(name, source, expected_output, Special.FastDebug);
+        self.addCase(tc);
+    }
+
     pub fn addCase(self: &CompareOutputContext, case: &const TestCase) {
         const b = self.b;
 
@@ -447,14 +575,19 @@ pub const CompareOutputContext = struct {
                     self.step.dependOn(&run_and_cmp_output.step);
                 }
             },
-            Special.DebugSafety => {
-                const annotated_case_name = %%fmt.allocPrint(self.b.allocator, "safety {}", case.name);
+            Special.DebugSafety, Special.ReleaseSafety => {
+                const mode = if (case.special == Special.ReleaseSafety) Mode.ReleaseSafe else Mode.Debug;
+                const annotated_case_name = if (mode == Mode.Debug)
+                    %%fmt.allocPrint(self.b.allocator, "safety {}", case.name)
+                else
+                    %%fmt.allocPrint(self.b.allocator, "safety {} ({})", case.name, @enumTagName(mode));
                 if (self.test_filter) |filter| {
                     if (mem.indexOf(u8, annotated_case_name, filter) == null)
                         return;
                 }
 
                 const exe = b.addExecutable("test", root_src);
+                exe.setBuildMode(mode);
                 if (case.link_libc) {
                     exe.linkSystemLibrary("c");
                 }
@@ -468,6 +601,32 @@ pub const CompareOutputContext = struct {
                 const run_and_cmp_output = DebugSafetyRunStep.create(self, exe.getOutputPath(), annotated_case_name);
                 run_and_cmp_output.step.dependOn(&exe.step);
 
+                self.step.dependOn(&run_and_cmp_output.step);
+            },
+            Special.FastDebug => {
+                const annotated_case_name = %%fmt.allocPrint(self.b.allocator, "compare-output {} (FastDebug)",
+                    case.name);
+                if (self.test_filter) |filter| {
+                    if (mem.indexOf(u8, annotated_case_name, filter) == null)
+                        return;
+                }
+
+                const exe = b.addExecutable("test", root_src);
+                exe.addCompileArg("--fast-debug");
+                if (case.link_libc) {
+                    exe.linkSystemLibrary("c");
+                }
+
+                for (case.sources.toSliceConst()) |src_file| {
+                    const expanded_src_path = %%os.path.join(b.allocator, b.cache_root, src_file.filename);
+                    const write_src = b.addWriteFile(expanded_src_path, src_file.source);
+                    exe.step.dependOn(&write_src.step);
+                }
+
+                const run_and_cmp_output = RunCompareOutputStep.create(self, exe.getOutputPath(),
+                    annotated_case_name, case.expected_output);
+                run_and_cmp_output.step.dependOn(&exe.step);
+
                 self.step.dependOn(&run_and_cmp_output.step);
             },
         }
@@ -953,3 +1112,287 @@ pub const ParseCContext = struct {
         }
     }
 };
+
+pub const CommandSequenceContext = struct {
+    b: &build.Builder,
+    step: &build.Step,
+    test_index: usize,
+    test_filter: ?[]const u8,
+
+    pub const Stream = enum {
+        Stdout,
+        Stderr,
+    };
+
+    /// Limits a check to the part of the output which starts with the first
+    /// `begin` after `marker` and ends before the next `end`.
+    pub const Section = struct {
+        marker: []const u8,
+        begin: []const u8,
+        end: []const u8,
+    };
+
+    const Check = struct {
+        section: ?Section,
+        text: []const u8,
+        present: bool,
+    };
+
+    pub const Command = struct {
+        argv: ArrayList([]const u8),
+        // argv[0] names a file of the case directory rather than a program
+        exe_in_dir: bool,
+        files: ArrayList(SourceFile),
+        // null runs the command in the case directory
+        cwd: ?[]const u8,
+        stdin: ?[]const u8,
+        // the stream the checks look at; the other one is ignored
+        stream: Stream,
+        passed: bool,
+        expected_output: ?[]const u8,
+        checks: ArrayList(Check),
+
+        const SourceFile = struct {
+            filename: []const u8,
+            source: []const u8,
+        };
+
+        pub fn addArgs(self: &Command, args: []const []const u8) {
+            %%self.argv.appendSlice(args);
+        }
+
+        pub fn addFile(self: &Command, filename: []const u8, source: []const u8) {
+            %%self.files.append(SourceFile {
+                .filename = filename,
+                .source = source,
+            });
+        }
+
+        pub fn addCheck(self: &Command, section: ?Section, text: []const u8, present: bool) {
+            %%self.checks.append(Check {
+                .section = section,
+                .text = text,
+                .present = present,
+            });
+        }
+
+        pub fn addExpected(self: &Command, text: []const u8) {
+            self.addCheck(null, text, true);
+        }
+
+        pub fn addUnexpected(self: &Command, text: []const u8) {
+            self.addCheck(null, text, false);
+        }
+    };
+
+    const TestCase = struct {
+        b: &build.Builder,
+        name: []const u8,
+        commands: ArrayList(&Command),
+
+        fn addCommand(self: &TestCase, argv: []const []const u8, exe_in_dir: bool, stream: Stream) -> &Command {
+            const allocator = self.b.allocator;
+            const command = %%allocator.create(Command);
+            *command = Command {
+                .argv = ArrayList([]const u8).init(allocator),
+                .exe_in_dir = exe_in_dir,
+                .files = ArrayList(Command.SourceFile).init(allocator),
+                .cwd = null,
+                .stdin = null,
+                .stream = stream,
+                .passed = true,
+                .expected_output = null,
+                .checks = ArrayList(Check).init(allocator),
+            };
+            command.addArgs(argv);
+            %%self.commands.append(command);
+            return command;
+        }
+
+        /// Adds a zig command, and checks what it prints to stderr.
+        pub fn addZig(self: &TestCase, args: []const []const u8) -> &Command {
+            const command = self.addCommand([][]const u8{self.b.zig_exe}, false, Stream.Stderr);
+            command.addArgs(args);
+            return command;
+        }
+
+        /// Adds a command which runs a file the case built, and checks what it prints
+        /// to stdout.
+        pub fn addRun(self: &TestCase, argv: []const []const u8) -> &Command {
+            return self.addCommand(argv, true, Stream.Stdout);
+        }
+    };
+
+    const RunCommandSequenceStep = struct {
+        step: build.Step,
+        context: &CommandSequenceContext,
+        name: []const u8,
+        case: &const TestCase,
+        test_index: usize,
+
+        pub fn create(context: &CommandSequenceContext, name: []const u8,
+            case: &const TestCase) -> &RunCommandSequenceStep
+        {
+            const allocator = context.b.allocator;
+            const ptr = %%allocator.create(RunCommandSequenceStep);
+            *ptr = RunCommandSequenceStep {
+                .context = context,
+                .name = name,
+                .case = case,
+                .test_index = context.test_index,
+                .step = build.Step.init("RunCommandSequence", allocator, make),
+            };
+            context.test_index += 1;
+            return ptr;
+        }
+
+        fn make(step: &build.Step) -> %void {
+            const self = @fieldParentPtr(RunCommandSequenceStep, "step", step);
+            const b = self.context.b;
+
+            %%io.stderr.printf("Test {}/{} {}...", self.test_index+1, self.context.test_index, self.name);
+
+            const dir = b.pathFromRoot(%%os.path.join(b.allocator, b.cache_root, dirName(b, self.case.name)));
+            %return os.deleteTree(b.allocator, dir);
+            %return b.makePath(dir);
+
+            var output = Buffer.initNull(b.allocator);
+            defer output.deinit();
+            for (self.case.commands.toSliceConst()) |command, i| {
+                for (command.files.toSliceConst()) |file| {
+                    %%io.writeFile(%%os.path.join(b.allocator, dir, file.filename), file.source, b.allocator);
+                }
+
+                var argv = ArrayList([]const u8).init(b.allocator);
+                defer argv.deinit();
+                %%argv.appendSlice(command.argv.toSliceConst());
+                if (command.exe_in_dir) {
+                    argv.items[0] = %%os.path.join(b.allocator, dir, argv.items[0]);
+                }
+
+                const code = %return runCommand(b, argv.toSliceConst(), command.cwd ?? dir, command, &output);
+                const text = output.toSliceConst();
+                if ((code == 0) != command.passed) {
+                    %%io.stderr.printf("\ncommand {}: expected to {} but it exited with code {}:\n",
+                        i + 1, if (command.passed) "pass" else "fail", code);
+                    printInvocation(argv.toSliceConst());
+                    %%io.stderr.printf("{}\n", text);
+                    return error.TestFailed;
+                }
+                if (command.expected_output) |expected_output| {
+                    if (!mem.eql(u8, expected_output, text)) {
+                        %%io.stderr.printf("\ncommand {}: expected it to print {}but it printed {}\n",
+                            i + 1, expected_output, text);
+                        printInvocation(argv.toSliceConst());
+                        return error.TestFailed;
+                    }
+                }
+                for (command.checks.toSliceConst()) |check| {
+                    var checked = text;
+                    if (check.section) |section| {
+                        checked = findSection(text, section) ?? {
+                            %%io.stderr.printf("\ncommand {}: expected it to print {} after {}:\n{}\n",
+                                i + 1, section.begin, section.marker, text);
+                            return error.TestFailed;
+                        };
+                    }
+                    if ((mem.indexOf(u8, checked, check.text) != null) != check.present) {
+                        %%io.stderr.printf("\ncommand {}: expected it {} \"{}\":\n{}\n",
+                            i + 1, if (check.present) "to print" else "not to print", check.text, checked);
+                        printInvocation(argv.toSliceConst());
+                        return error.TestFailed;
+                    }
+                }
+            }
+
+            %%io.stderr.printf("OK\n");
+        }
+
+        /// Runs argv in cwd and replaces the contents of out with what it prints to
+        /// the stream of the command. Returns the exit code.
+        fn runCommand(b: &build.Builder, argv: []const []const u8, cwd: []const u8, command: &const Command,
+            out: &Buffer) -> %i32
+        {
+            const child = %%os.ChildProcess.init(argv, b.allocator);
+            defer child.deinit();
+
+            child.stdin_behavior = if (command.stdin == null) StdIo.Ignore else StdIo.Pipe;
+            child.stdout_behavior = if (command.stream == Stream.Stdout) StdIo.Pipe else StdIo.Ignore;
+            child.stderr_behavior = if (command.stream == Stream.Stderr) StdIo.Pipe else StdIo.Ignore;
+            child.env_map = &b.env_map;
+            child.cwd = cwd;
+
+            child.spawn() %% |err| debug.panic("Unable to spawn {}: {}\n", argv[0], @errorName(err));
+
+            if (command.stdin) |input| {
+                const stdin = ??child.stdin;
+                %%stdin.write(input);
+                %%stdin.flush();
+                // a command which reads requests until the end of its input exits then
+                stdin.close();
+                b.allocator.destroy(stdin);
+                child.stdin = null;
+            }
+
+            const stream = if (command.stream == Stream.Stdout) child.stdout else child.stderr;
+            %%(??stream).readAll(out);
+
+            const term = child.wait() %% |err| {
+                debug.panic("Unable to spawn {}: {}\n", argv[0], @errorName(err));
+            };
+            switch (term) {
+                Term.Exited => |code| return code,
+                else => {
+                    %%io.stderr.printf("\n{} terminated unexpectedly\n", argv[0]);
+                    return error.TestFailed;
+                },
+            }
+        }
+
+        fn findSection(text: []const u8, section: &const Section) -> ?[]const u8 {
+            const marker_index = mem.indexOf(u8, text, section.marker) ?? return null;
+            const begin = mem.indexOfPos(u8, text, marker_index, section.begin) ?? return null;
+            const end = mem.indexOfPos(u8, text, begin, section.end) ?? return null;
+            return text[begin..end];
+        }
+
+        /// The case name with everything but letters and digits replaced by '_'.
+        fn dirName(b: &build.Builder, name: []const u8) -> []u8 {
+            const dir_name = %%mem.dupe(b.allocator, u8, name);
+            for (dir_name) |*c| {
+                switch (*c) {
+                    'a' ... 'z', 'A' ... 'Z', '0' ... '9' => {},
+                    else => *c = '_',
+                }
+            }
+            return dir_name;
+        }
+    };
+
+    fn printInvocation(args: []const []const u8) {
+        for (args) |arg| {
+            %%io.stderr.printf("{} ", arg);
+        }
+        %%io.stderr.printf("\n");
+    }
+
+    pub fn create(self: &CommandSequenceContext, name: []const u8) -> &TestCase {
+        const tc = %%self.b.allocator.create(TestCase);
+        *tc = TestCase {
+            .b = self.b,
+            .name = name,
+            .commands = ArrayList(&Command).init(self.b.allocator),
+        };
+        return tc;
+    }
+
+    pub fn addCase(self: &CommandSequenceContext, case: &const TestCase) {
+        if (self.test_filter) |filter| {
+            if (mem.indexOf(u8, case.name, filter) == null)
+                return;
+        }
+
+        const run_commands = RunCommandSequenceStep.create(self, case.name, case);
+        self.step.dependOn(&run_commands.step);
+    }
+};